@@ -0,0 +1,89 @@
+// CSV ingestion throughput: the getline/splitCSVLine/RowData path table
+// writes used before CSVReader, against CSVReader. Reported as bytes/s.
+
+#include <benchmark/benchmark.h>
+#include "CSVReader.hpp"
+#include "FormatConverter.hpp"
+#include <random>
+#include <sstream>
+
+using namespace sqlfuse;
+
+namespace {
+
+constexpr size_t ROWS = 20000;
+
+// id, name, email and a free-text column of which some values need quoting
+const std::string& document() {
+    static const std::string data = [] {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> length(20, 200);
+        std::uniform_int_distribution<int> pct(0, 99);
+
+        std::string out = "id,name,email,comment\n";
+        for (size_t i = 0; i < ROWS; ++i) {
+            std::string comment(length(rng), ' ');
+            for (char& c : comment) c = static_cast<char>(letter(rng));
+            bool quoted = pct(rng) < 10;
+            if (quoted) comment[comment.size() / 2] = ',';
+
+            out += std::to_string(i) + ",user " + std::to_string(i) + ",user" +
+                   std::to_string(i) + "@example.com,";
+            out += quoted ? "\"" + comment + "\"" : comment;
+            out += '\n';
+        }
+        return out;
+    }();
+    return data;
+}
+
+void BM_CSVParse_Legacy(benchmark::State& state) {
+    const std::string& data = document();
+    CSVOptions options;
+
+    for (auto _ : state) {
+        std::istringstream stream(data);
+        std::string line;
+        std::vector<std::string> headers;
+        std::vector<RowData> rows;
+        while (std::getline(stream, line)) {
+            auto fields = FormatConverter::splitCSVLine(line, options);
+            if (headers.empty()) {
+                headers = std::move(fields);
+                continue;
+            }
+            RowData row;
+            for (size_t i = 0; i < std::min(headers.size(), fields.size()); ++i) {
+                row[headers[i]] = fields[i];
+            }
+            rows.push_back(std::move(row));
+        }
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_CSVParse_Legacy);
+
+void BM_CSVParse_Reader(benchmark::State& state) {
+    const std::string& data = document();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::string buffer = data;  // Parsed in place
+        state.ResumeTiming();
+
+        CSVReader reader(buffer);
+        size_t bytes = 0;
+        while (reader.next()) {
+            for (const auto& field : reader.row()) bytes += field ? field->size() : 0;
+        }
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_CSVParse_Reader);
+
+}  // namespace
+
+BENCHMARK_MAIN();
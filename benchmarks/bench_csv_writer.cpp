@@ -0,0 +1,131 @@
+// CSV writer throughput: the per-field std::string / ostringstream path the
+// backends used before ResultBatch, against CSVBatchWriter, plus the bare
+// quoting scan with and without SIMD. Reported as bytes/s of input data.
+
+#include <benchmark/benchmark.h>
+#include "BatchWriter.hpp"
+#include "ResultBatch.hpp"
+#include <random>
+#include <sstream>
+
+using namespace sqlfuse;
+
+namespace {
+
+constexpr size_t ROWS = 10000;
+
+struct Dataset {
+    std::vector<std::string> names{"id", "name", "email", "comment"};
+    std::vector<std::vector<std::string>> rows;
+    size_t bytes = 0;
+};
+
+// Short keys, mid-sized names, and long free text of which a few need quoting
+const Dataset& dataset() {
+    static const Dataset data = [] {
+        Dataset d;
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> length(40, 400);
+        std::uniform_int_distribution<int> pct(0, 99);
+
+        for (size_t i = 0; i < ROWS; ++i) {
+            std::string comment(length(rng), ' ');
+            for (char& c : comment) c = static_cast<char>(letter(rng));
+            if (pct(rng) < 5) comment[comment.size() / 2] = ',';
+            if (pct(rng) < 2) comment[comment.size() / 3] = '"';
+
+            std::vector<std::string> row{
+                std::to_string(i),
+                "user name " + std::to_string(i),
+                "user" + std::to_string(i) + "@example.com",
+                std::move(comment)};
+            for (const auto& field : row) d.bytes += field.size();
+            d.rows.push_back(std::move(row));
+        }
+        return d;
+    }();
+    return data;
+}
+
+// Pre-ResultBatch FormatConverter::escapeCSVField
+std::string legacyEscape(const std::string& field, const CSVOptions& options) {
+    bool needs_quoting = options.quoteAll;
+    if (!needs_quoting) {
+        for (char c : field) {
+            if (c == options.delimiter || c == options.quote || c == '\n' || c == '\r') {
+                needs_quoting = true;
+                break;
+            }
+        }
+    }
+    if (!needs_quoting) return field;
+
+    std::string result;
+    result.reserve(field.size() + 2);
+    result += options.quote;
+    for (char c : field) {
+        if (c == options.quote) result += options.quote;
+        result += c;
+    }
+    result += options.quote;
+    return result;
+}
+
+void BM_CSV_Legacy(benchmark::State& state) {
+    const Dataset& data = dataset();
+    CSVOptions options;
+
+    for (auto _ : state) {
+        std::ostringstream out;
+        for (const auto& row : data.rows) {
+            for (size_t i = 0; i < row.size(); ++i) {
+                if (i > 0) out << options.delimiter;
+                // Backends copied each field out of the driver buffer first
+                std::string value(row[i].data(), row[i].size());
+                out << legacyEscape(value, options);
+            }
+            out << options.lineEnding;
+        }
+        benchmark::DoNotOptimize(out.str());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.bytes));
+}
+BENCHMARK(BM_CSV_Legacy);
+
+void BM_CSV_BatchWriter(benchmark::State& state) {
+    const Dataset& data = dataset();
+    ResultBatch batch(data.names, ROWS);
+    for (const auto& row : data.rows) {
+        for (size_t i = 0; i < row.size(); ++i) batch.column(i).appendText(row[i]);
+    }
+    CSVBatchWriter writer;
+
+    for (auto _ : state) {
+        std::string out;
+        writer.writeRows(batch, out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.bytes));
+}
+BENCHMARK(BM_CSV_BatchWriter);
+
+template<size_t (*Scan)(std::string_view, char, char)>
+void BM_CSV_Scan(benchmark::State& state) {
+    const Dataset& data = dataset();
+
+    for (auto _ : state) {
+        size_t total = 0;
+        for (const auto& row : data.rows) {
+            for (const auto& field : row) total += Scan(field, ',', '"');
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.bytes));
+}
+BENCHMARK_TEMPLATE(BM_CSV_Scan, findCSVSpecialScalar);
+BENCHMARK_TEMPLATE(BM_CSV_Scan, findCSVSpecial);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+// JSON ingestion throughput: the nlohmann DOM path table writes used before
+// JSONRowReader, against JSONRowReader. Reported as bytes/s.
+
+#include <benchmark/benchmark.h>
+#include "FormatConverter.hpp"
+#include "JSONRowReader.hpp"
+#include <random>
+
+using namespace sqlfuse;
+
+namespace {
+
+constexpr size_t ROWS = 20000;
+
+// The shape the JSON export writes: pretty-printed objects with an integer,
+// strings (some needing escapes), a real and a NULL
+const std::string& document() {
+    static const std::string data = [] {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> length(20, 200);
+        std::uniform_int_distribution<int> pct(0, 99);
+
+        std::string out = "[\n";
+        for (size_t i = 0; i < ROWS; ++i) {
+            std::string comment(length(rng), ' ');
+            for (char& c : comment) c = static_cast<char>(letter(rng));
+            if (pct(rng) < 10) comment.replace(comment.size() / 2, 1, "\\n");
+
+            if (i > 0) out += ",\n";
+            out += "  {\n    \"id\": " + std::to_string(i) + ",\n    \"name\": \"user " +
+                   std::to_string(i) + "\",\n    \"balance\": " + std::to_string(i * 1.25) +
+                   ",\n    \"deleted_at\": null,\n    \"comment\": \"" + comment + "\"\n  }";
+        }
+        out += "\n]";
+        return out;
+    }();
+    return data;
+}
+
+void BM_JSONParse_DOM(benchmark::State& state) {
+    const std::string& data = document();
+
+    for (auto _ : state) {
+        json parsed = json::parse(data);
+        std::vector<RowData> rows;
+        for (const auto& item : parsed) {
+            RowData row;
+            for (auto& [key, value] : item.items()) {
+                if (value.is_null()) {
+                    row[key] = std::nullopt;
+                } else if (value.is_string()) {
+                    row[key] = value.get<std::string>();
+                } else {
+                    row[key] = value.dump();
+                }
+            }
+            rows.push_back(std::move(row));
+        }
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_JSONParse_DOM);
+
+void BM_JSONParse_Reader(benchmark::State& state) {
+    const std::string& data = document();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::string buffer = data;  // Unescaped in place
+        state.ResumeTiming();
+
+        JSONRowReader reader(buffer);
+        size_t bytes = 0;
+        while (reader.next()) {
+            for (const auto& field : reader.row()) bytes += field ? field->size() : 0;
+        }
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_JSONParse_Reader);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,150 @@
+// PostgreSQL result decoding: the same rows as the server sends them in text
+// format and in binary format (pg_binary_results), taken into a ResultBatch
+// and written as CSV. Results are built in memory with libpq, so this
+// measures the client's CPU only, not the smaller binary transfer.
+
+#include <benchmark/benchmark.h>
+#include "BatchWriter.hpp"
+#include "PostgreSQLFormatConverter.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
+
+using namespace sqlfuse;
+
+namespace {
+
+constexpr int ROWS = 10000;
+
+constexpr Oid INT8OID = 20;
+constexpr Oid FLOAT8OID = 701;
+constexpr Oid NUMERICOID = 1700;
+constexpr Oid TIMESTAMPOID = 1114;
+constexpr Oid TEXTOID = 25;
+
+struct ResultDeleter {
+    void operator()(PGresult* result) const { PQclear(result); }
+};
+using Result = std::unique_ptr<PGresult, ResultDeleter>;
+
+template<typename T>
+std::string be(T value) {
+    using U = std::make_unsigned_t<T>;
+    U v = static_cast<U>(value);
+    std::string out(sizeof(T), '\0');
+    for (size_t i = sizeof(T); i-- > 0;) {
+        out[i] = static_cast<char>(v & 0xFF);
+        v = static_cast<U>(v >> 8);
+    }
+    return out;
+}
+
+struct Results {
+    Result text;
+    Result binary;
+    size_t bytes = 0;  // Text rendering size, for the rate
+};
+
+Result makeResult(int format) {
+    const char* names[] = {"id", "score", "amount", "created", "name"};
+    Oid types[] = {INT8OID, FLOAT8OID, NUMERICOID, TIMESTAMPOID, TEXTOID};
+    PGresAttDesc attrs[5];
+    for (int i = 0; i < 5; ++i) {
+        attrs[i] = PGresAttDesc{};
+        attrs[i].name = const_cast<char*>(names[i]);
+        attrs[i].typid = types[i];
+        attrs[i].format = format;
+        attrs[i].typlen = -1;
+        attrs[i].atttypmod = -1;
+    }
+    Result result(PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK));
+    PQsetResultAttrs(result.get(), 5, attrs);
+    return result;
+}
+
+void set(PGresult* result, int row, int col, const std::string& value) {
+    PQsetvalue(result, row, col, const_cast<char*>(value.data()), static_cast<int>(value.size()));
+}
+
+// An id, a float, a two-place numeric, a timestamp and a short name per row
+const Results& results() {
+    static const Results data = [] {
+        Results r{makeResult(0), makeResult(1), 0};
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> real(0, 1000);
+        std::uniform_int_distribution<int> cents(0, 9999999);
+        std::uniform_int_distribution<int64_t> usecs(0, 20LL * 365 * 86400000000LL);
+
+        for (int row = 0; row < ROWS; ++row) {
+            int64_t id = 1000000 + row;
+            double score = real(rng);
+            int amount = cents(rng);  // amount / 100, two decimal places
+            int64_t at = usecs(rng) / 1000000 * 1000000;
+            std::string name = "user name " + std::to_string(row);
+
+            std::string values[] = {
+                std::to_string(id), "", std::to_string(amount / 100) + "." +
+                (amount % 100 < 10 ? "0" : "") + std::to_string(amount % 100),
+                "", name};
+            // Text forms of the float and timestamp as the binary decoder renders them
+            PostgreSQLFormatConverter::appendBinaryValue(
+                values[1], FLOAT8OID, be<uint64_t>(std::bit_cast<uint64_t>(score)).data(), 8);
+            PostgreSQLFormatConverter::appendBinaryValue(
+                values[3], TIMESTAMPOID, be<int64_t>(at).data(), 8);
+            for (int col = 0; col < 5; ++col) {
+                set(r.text.get(), row, col, values[col]);
+                r.bytes += values[col].size();
+            }
+
+            // numeric: whole part in base-10000 groups, cents as one fraction group
+            int whole = amount / 100;
+            std::string numeric;
+            std::vector<int16_t> digits;
+            if (whole >= 10000) digits.push_back(static_cast<int16_t>(whole / 10000));
+            digits.push_back(static_cast<int16_t>(whole % 10000));
+            digits.push_back(static_cast<int16_t>(amount % 100 * 100));
+            numeric = be<int16_t>(static_cast<int16_t>(digits.size())) +
+                      be<int16_t>(static_cast<int16_t>(digits.size() - 2)) + be<uint16_t>(0) +
+                      be<uint16_t>(2);
+            for (int16_t digit : digits) numeric += be<int16_t>(digit);
+
+            set(r.binary.get(), row, 0, be<int64_t>(id));
+            set(r.binary.get(), row, 1, be<uint64_t>(std::bit_cast<uint64_t>(score)));
+            set(r.binary.get(), row, 2, numeric);
+            set(r.binary.get(), row, 3, be<int64_t>(at));
+            set(r.binary.get(), row, 4, name);
+        }
+        return r;
+    }();
+    return data;
+}
+
+void renderCSV(benchmark::State& state, PGresult* result) {
+    CSVBatchWriter writer;
+    ResultBatch batch(PostgreSQLFormatConverter::columnNames(result));
+
+    for (auto _ : state) {
+        std::string out;
+        int row = 0;
+        while (PostgreSQLFormatConverter::fillBatch(result, row, batch)) {
+            writer.writeRows(batch, out);
+            batch.clear();
+        }
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * results().bytes));
+}
+
+void BM_PG_TextResult(benchmark::State& state) {
+    renderCSV(state, results().text.get());
+}
+BENCHMARK(BM_PG_TextResult);
+
+void BM_PG_BinaryResult(benchmark::State& state) {
+    renderCSV(state, results().binary.get());
+}
+BENCHMARK(BM_PG_BinaryResult);
+
+}  // namespace
+
+BENCHMARK_MAIN();
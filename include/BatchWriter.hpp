@@ -0,0 +1,63 @@
+#pragma once
+
+#include "FormatConverter.hpp"
+#include "JSONWriter.hpp"
+#include "ResultBatch.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sqlfuse {
+
+// Index of the first byte of `data` that forces a CSV field to be quoted
+// (delimiter, quote, CR or LF), or data.size() if there is none. Scans 32 or
+// 16 bytes at a time when the target has AVX2 or SSE2.
+size_t findCSVSpecial(std::string_view data, char delimiter, char quote);
+
+// Byte-at-a-time reference for findCSVSpecial, used on targets without SIMD
+size_t findCSVSpecialScalar(std::string_view data, char delimiter, char quote);
+
+// Writes ResultBatches as CSV, appending to a caller-owned string.
+// NULL values are written as empty fields.
+class CSVBatchWriter {
+public:
+    explicit CSVBatchWriter(const CSVOptions& options = CSVOptions{});
+
+    void writeHeader(const ResultBatch& batch, std::string& out) const;
+    void writeRows(const ResultBatch& batch, std::string& out) const;
+
+    // Append one field, quoting it if it contains the delimiter, the quote
+    // character or a line break (or always with quoteAll). Fields that need
+    // no quoting are copied with a single append.
+    void writeField(std::string_view value, std::string& out) const;
+
+private:
+    CSVOptions m_options;
+};
+
+// Writes ResultBatches as a JSON array of objects (or {"rows": [...]}) with a
+// JSONWriter, appending to a caller-owned string. Output is identical whether
+// the rows arrive in one batch or many, and the string may be drained between
+// batches. Keys follow column order and are escaped once, on the first batch.
+class JSONBatchWriter {
+public:
+    explicit JSONBatchWriter(std::string& out, const JSONOptions& options = JSONOptions{});
+
+    void begin();
+    void writeRows(const ResultBatch& batch);
+    void finish();
+
+    // Write a single row as a JSON object (row files)
+    void writeObject(const ResultBatch& batch, size_t row);
+
+private:
+    void prepareKeys(const ResultBatch& batch);
+    void writeValue(const ResultColumn& column, size_t row);
+    void writeMixedValue(ValueType type, std::string_view text);
+
+    JSONOptions m_options;
+    JSONWriter m_json;
+    std::vector<std::string> m_keys;  // Quoted, escaped column names
+};
+
+}  // namespace sqlfuse
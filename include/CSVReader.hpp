@@ -0,0 +1,52 @@
+#pragma once
+
+#include "FormatConverter.hpp"
+#include "RowReader.hpp"
+#include <string>
+#include <vector>
+
+namespace sqlfuse {
+
+// Single-pass RFC 4180 CSV parser over a caller-owned buffer.
+//
+// Quoted fields may contain delimiters, doubled quotes and line breaks. Rows
+// end at LF, CRLF or CR; blank lines are skipped. Fields are string_views into
+// the buffer: doubled quotes are collapsed in place, so the buffer is modified
+// and must outlive the views. An unquoted empty field is NULL, a quoted empty
+// field ("") is the empty string. Unquoted runs are scanned with
+// findCSVSpecial (SSE2/AVX2), quoted runs with memchr.
+class CSVReader : public RowReader {
+public:
+    // With options.includeHeader the first record names the columns (unless
+    // `columns` is given, in which case it is skipped). Without a header and
+    // without `columns`, columns are named col0..colN-1 after the first record.
+    explicit CSVReader(std::string& data, const CSVOptions& options = CSVOptions{},
+                       std::vector<std::string> columns = {});
+
+    const std::vector<std::string>& columns() const override { return m_columns; }
+    bool next() override;
+    const std::vector<FieldView>& row() const override { return m_row; }
+
+    // 1-based line number where the current record starts
+    size_t line() const { return m_recordLine; }
+
+private:
+    // Parse one record into m_fields; false at end of input
+    bool readRecord();
+    std::string_view readQuoted();
+    std::string_view readUnquoted();
+
+    char* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    size_t m_line = 1;
+    size_t m_recordLine = 1;
+    CSVOptions m_options;
+
+    std::vector<std::string> m_columns;
+    std::vector<FieldView> m_fields;  // Fields of the last record as read
+    std::vector<FieldView> m_row;     // m_fields fitted to the column count
+    bool m_pending = false;           // m_fields holds a record not yet returned
+};
+
+}  // namespace sqlfuse
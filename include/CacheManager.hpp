@@ -5,6 +5,7 @@
 #include <optional>
 #include <unordered_map>
 #include <list>
+#include <set>
 #include <mutex>
 #include <shared_mutex>
 #include <chrono>
@@ -60,7 +61,8 @@ public:
     // Remove specific key
     void remove(const std::string& key);
 
-    // Invalidate entries matching pattern (supports * wildcard)
+    // Invalidate entries matching pattern (supports * wildcard). A pattern
+    // with its only * at the end touches just the keys it matches
     void invalidate(const std::string& pattern);
 
     // Invalidate entries for a specific database/table
@@ -92,6 +94,7 @@ private:
     std::unordered_map<std::string, CacheEntry> m_cache;
     std::list<std::string> m_lruList;
     std::unordered_map<std::string, std::list<std::string>::iterator> m_lruMap;
+    std::set<std::string> m_keys;  // Every key of m_cache, ordered for prefix lookups
 
     mutable std::shared_mutex m_mutex;
 
@@ -45,6 +45,22 @@ struct DataConfig {
     bool pretty_json = true;
     bool include_csv_header = true;
     std::string default_format = "csv";
+    size_t export_parallelism = 1;   // Table exports: key ranges fetched at once (1 = one query)
+    size_t export_parallel_min_rows = 100000;  // Smaller exports run as one query
+    bool export_offset_index = false;  // Cache where each range starts; later reads render only theirs
+    bool pg_binary_results = false;  // PostgreSQL: fetch table data in binary format
+    size_t fetch_batch_rows = 256;   // Oracle: rows per array fetch and prefetch
+    size_t insert_batch_rows = 1000; // Table writes: rows per INSERT statement
+    size_t insert_batch_bytes = 1024 * 1024;  // Table writes: max INSERT statement size
+    bool stream_table_writes = true; // Load sequential table writes as the data arrives
+    bool diff_table_writes = false;  // Table writes replace the file: apply changed rows only
+    bool replace_table_writes = false;  // Truncating table writes swap in the new contents
+    bool save_on_release = false;    // Save when the last descriptor closes, not at every close()
+    bool pg_copy_writes = true;      // PostgreSQL: load table writes with COPY FROM STDIN
+    bool pg_copy_upsert = false;     // PostgreSQL: COPY via a staging table and upsert on the PK
+    bool oracle_skip_bad_rows = true;    // Oracle: commit the good rows of a table write
+    bool mysql_load_data_writes = true;  // MySQL: load table writes with LOAD DATA LOCAL INFILE
+    std::string mysql_on_duplicate = "error";  // MySQL table writes: error, replace or ignore
 };
 
 struct SecurityConfig {
@@ -59,6 +75,24 @@ struct PerformanceConfig {
     size_t max_concurrent_queries = 20;
     size_t max_fuse_threads = 10;
     bool enable_query_cache = true;
+
+    // SQLite connection tuning
+    size_t sqlite_statement_cache = 32;         // Prepared statements kept per connection
+    size_t sqlite_mmap_size = 256 * 1024 * 1024; // PRAGMA mmap_size (bytes, 0 = off)
+    size_t sqlite_cache_size_kb = 65536;        // PRAGMA cache_size (KiB, 0 = default)
+    bool sqlite_wal = false;                    // Switch the database to WAL journal mode
+
+    // Row file saves committed in groups across file handles
+    std::string write_behind = "off";  // off, flush (close waits) or release (only release waits)
+    std::chrono::milliseconds write_behind_window{5};  // How long a group collects saves
+    size_t write_behind_max_batch = 256;               // Saves per group transaction
+    size_t write_behind_writers = 2;                   // Groups committed at once
+
+    // Key ranges of a split export (DataConfig::export_parallelism) rendered
+    // ahead of a sequential reader
+    size_t read_ahead_chunks = 0;      // Ranges ready past the read position (0 = off)
+    size_t read_ahead_threads = 4;     // Ranges rendered ahead at once, across files
+    size_t read_ahead_budget_mb = 256; // Rendered but unread bytes, across files
 };
 
 struct Config {
@@ -1,13 +1,17 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <optional>
+#include <functional>
 #include <nlohmann/json.hpp>
 
 namespace sqlfuse {
 
+class ResultBatch;
+
 using json = nlohmann::json;
 
 // Represents a single value that can be null
@@ -38,6 +42,28 @@ class FormatConverter {
 public:
     virtual ~FormatConverter() = default;
 
+    // Refills a cleared batch with up to batch.capacity() rows from a backend
+    // result; returns false once no more rows were added
+    using BatchSource = std::function<bool(ResultBatch&)>;
+
+    // Receives consecutive pieces of a streamed document
+    using OutputSink = std::function<void(std::string_view)>;
+
+    // Streaming batch conversion: output is handed to `sink` after every
+    // batch, so memory use is bounded by one batch whatever the row count
+    static void writeCSV(ResultBatch& batch, const BatchSource& fill, const OutputSink& sink,
+                         const CSVOptions& options = CSVOptions{});
+    static void writeJSON(ResultBatch& batch, const BatchSource& fill, const OutputSink& sink,
+                          const JSONOptions& options = JSONOptions{});
+
+    // Batch conversion - the single rendering path used by every backend
+    static std::string toCSV(ResultBatch& batch, const BatchSource& fill,
+                            const CSVOptions& options = CSVOptions{});
+    static std::string toJSON(ResultBatch& batch, const BatchSource& fill,
+                             const JSONOptions& options = JSONOptions{});
+    static std::string rowToJSON(const ResultBatch& batch, size_t row,
+                                const JSONOptions& options = JSONOptions{});
+
     // Generic CSV conversion (from vectors)
     static std::string toCSV(const std::vector<std::string>& columns,
                             const std::vector<std::vector<SqlValue>>& rows,
@@ -54,14 +80,16 @@ public:
                                 const JSONOptions& options = JSONOptions{});
     static std::string rowToJSON(const RowData& row, const JSONOptions& options = JSONOptions{});
 
-    // Parse CSV to rows
+    // Parse CSV to rows (RFC 4180 via CSVReader: quoted fields may contain
+    // line breaks; an unquoted empty field is NULL, "" is the empty string)
     static std::vector<RowData> parseCSV(const std::string& data,
                                          const CSVOptions& options = CSVOptions{});
     static std::vector<RowData> parseCSV(const std::string& data,
                                          const std::vector<std::string>& columns,
                                          const CSVOptions& options = CSVOptions{});
 
-    // Parse JSON to rows
+    // Parse JSON to rows (streamed via JSONRowReader: the first object's keys
+    // are the columns, keys missing from a later object read as NULL)
     static std::vector<RowData> parseJSON(const std::string& data);
     static RowData parseJSONRow(const std::string& data);
 
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "RowReader.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace sqlfuse {
+
+// Shape of a multi-row INSERT, built by each backend's format converter:
+// head + rowPrefix + (v, ...) [+ separator + rowPrefix + (v, ...)]... + tail
+struct InsertSyntax {
+    std::string head;       // e.g. INSERT INTO "t" ("a", "b") VALUES
+    std::string rowPrefix;  // Before each value list (Oracle: INTO "t" (...) VALUES)
+    std::string separator;  // Between value lists
+    std::string tail;       // After the last value list
+};
+
+// When a batch is sent: whichever limit is reached first
+struct InsertLimits {
+    size_t maxRows = 1000;
+    size_t maxBytes = 1024 * 1024;  // Statement text size
+};
+
+// How the batcher drives a connection. Each call returns false on error;
+// error() is read before rollback() so the message is not lost.
+struct InsertSession {
+    std::function<bool(const std::string& sql)> execute;
+    std::function<bool()> begin;
+    std::function<bool()> commit;
+    std::function<void()> rollback;
+    std::function<std::string()> error;
+    // Negative errno for the failure, mapped by ErrorHandler like the
+    // backend's own row writes; unset means -EIO
+    std::function<int()> errorCode = {};
+};
+
+// Loads the rows of a RowReader with multi-row INSERT statements inside one
+// transaction: either every row is inserted or, on any failure (including a
+// parse error part way through the input), none is.
+class InsertBatcher {
+public:
+    // Appends a value as a quoted, escaped SQL literal
+    using AppendLiteral = std::function<void(std::string& sql, std::string_view value)>;
+
+    InsertBatcher(InsertSyntax syntax, AppendLiteral literal, InsertSession session,
+                  const InsertLimits& limits = InsertLimits{});
+
+    // Insert every row. Returns false if a statement failed (see error());
+    // parse errors from the reader are rethrown after the rollback.
+    bool load(RowReader& reader);
+
+    // The steps of load(), for input that arrives as several readers: one
+    // begin(), append() per reader, then finish() to send the last statement
+    // and commit. Rows not yet sent are kept as SQL text, so a reader's
+    // buffer may go away after append(). A failed step has already rolled
+    // back; abort() rolls back a load that will not be finished.
+    bool begin();
+    bool append(RowReader& reader);
+    bool finish();
+    void abort();
+
+    const std::string& error() const { return m_error; }
+    size_t rows() const { return m_rows; }              // Rows in executed statements
+    size_t statements() const { return m_statements; }  // INSERTs executed
+
+private:
+    void appendRow(const std::vector<FieldView>& fields);
+    bool flush();
+    bool fail();
+
+    InsertSyntax m_syntax;
+    AppendLiteral m_literal;
+    InsertSession m_session;
+    InsertLimits m_limits;
+
+    std::string m_sql;
+    size_t m_pending = 0;  // Rows in m_sql
+    size_t m_rows = 0;
+    size_t m_statements = 0;
+    bool m_active = false;  // Transaction begun and not yet ended
+    std::string m_error;
+};
+
+}  // namespace sqlfuse
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "RowReader.hpp"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sqlfuse {
+
+// Streaming (SAX-style) reader for rows written to a table's .json file.
+//
+// Accepts an array of objects, {"rows": [...]} as produced by the JSON export
+// (with "rows" as the first key), or a single object. Objects are parsed one at a time as next() is called, so
+// memory does not grow with the number of rows. The first object's keys
+// define the columns; later objects are matched by key (missing keys read as
+// NULL, a key the first object did not have is an error). Values are views
+// into the buffer: strings are unescaped in place, so the buffer is modified
+// and must outlive the views. JSON null is NULL; numbers and booleans are
+// their literal text; nested objects and arrays are their raw JSON text.
+class JSONRowReader : public RowReader {
+public:
+    explicit JSONRowReader(std::string& data);
+
+    // With the columns given, every object is matched against them (used for
+    // the later pieces of a streamed write, whose first object may not carry
+    // every key)
+    JSONRowReader(std::string& data, std::vector<std::string> columns);
+
+    const std::vector<std::string>& columns() const override { return m_columns; }
+    bool next() override;
+    const std::vector<FieldView>& row() const override { return m_row; }
+
+private:
+    enum class Mode { Done, Array, Object };
+
+    // Detect the document shape and read the first row
+    void start();
+
+    // Parse the object at m_pos into m_row (defining the columns if none yet)
+    void readObject();
+    FieldView readValue();
+    std::string_view readString();
+    void skipValue();
+    void skipWhitespace();
+    bool consume(char c);
+    size_t columnIndex(std::string_view key, size_t position) const;
+    [[noreturn]] void fail(const char* what) const;
+
+    char* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    Mode m_mode = Mode::Done;
+    bool m_pending = false;  // m_row holds the first object, not yet returned
+    size_t m_items = 0;      // Array elements seen
+    size_t m_rowNumber = 0;  // Objects read, for error messages
+
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>()(key); }
+    };
+    std::vector<std::string> m_columns;
+    std::unordered_map<std::string, size_t, KeyHash, std::equal_to<>> m_index;
+    std::vector<FieldView> m_row;
+};
+
+}  // namespace sqlfuse
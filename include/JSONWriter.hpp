@@ -0,0 +1,56 @@
+#pragma once
+
+#include "FormatConverter.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sqlfuse {
+
+// Streaming JSON writer: appends tokens straight to a caller-owned string and
+// keeps track of commas and indentation, so no DOM is built. Pretty output is
+// laid out like nlohmann::json::dump(indent); compact output has no spaces.
+class JSONWriter {
+public:
+    explicit JSONWriter(std::string& out, const JSONOptions& options = JSONOptions{});
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // Object member name; the next call writes its value
+    void key(std::string_view name);
+    // Member name that is already quoted and escaped (via appendString), for
+    // keys written once per row
+    void rawKey(std::string_view quoted);
+
+    void string(std::string_view value);
+    void integer(int64_t value);
+    void real(double value);             // NaN and infinities are written as null
+    void number(std::string_view text);  // Numeric text, kept verbatim when it is a
+                                         // JSON number; otherwise normalized or quoted
+    void boolean(bool value);
+    void binary(std::string_view data);  // Uppercase hex string
+    void null();
+
+    // Number of open objects and arrays
+    size_t depth() const { return m_first.size(); }
+
+    // Append `value` as a quoted, escaped JSON string
+    static void appendString(std::string& out, std::string_view value);
+
+private:
+    void beforeValue();
+    void open(char bracket);
+    void close(char bracket);
+
+    std::string& m_out;
+    bool m_pretty;
+    int m_indent;
+    std::vector<bool> m_first;  // Per open container: nothing written yet
+    bool m_afterKey = false;
+};
+
+}  // namespace sqlfuse
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sqlfuse {
+
+// One slice of a table export: primary keys from `lower` (inclusive) up to
+// `upper` (exclusive), either end open when unset. A nonzero `limit` caps
+// the rows the slice returns.
+struct KeyRange {
+    std::optional<std::string> lower;
+    std::optional<std::string> upper;
+    size_t limit = 0;
+};
+
+// How a backend finds split points in a table's primary key. Either
+// function may be empty; both return nothing when the table has no rows
+// (or no row at that offset).
+struct KeySource {
+    // Smallest and largest key; leave empty unless the key column holds
+    // integers (isIntegerKeyType)
+    std::function<std::optional<std::pair<std::string, std::string>>()> bounds;
+    // The key `offset` rows past `from` (or past the first key), in key order
+    std::function<std::optional<std::string>(const std::optional<std::string>& from,
+                                             size_t offset)> keyAt;
+};
+
+// Whether a column's declared type (as a schema manager reports it, e.g.
+// "int(11) unsigned", "bigint" or "INTEGER") holds integers, so keys of it
+// sort numerically and their span between MIN and MAX can be cut evenly.
+// Text keys that merely look like numbers sort as text and do not.
+bool isIntegerKeyType(const std::string& type);
+
+// Split the first `rows` rows of a table (all of them if `limit` is 0) into
+// up to `parts` ranges in key order. An unlimited export whose `bounds` are
+// integers is cut into equal spans between the smallest and largest key; otherwise the
+// boundaries are every (rows / parts)-th key, and with a limit each range
+// returns exactly its share. A single range means the export is not worth
+// splitting.
+std::vector<KeyRange> planKeyRanges(const KeySource& source, size_t parts, size_t rows,
+                                    size_t limit);
+
+// Render each range with `render` on up to `workers` threads and return the
+// chunks in range order. The first exception thrown by `render` is rethrown
+// once every thread has stopped.
+std::vector<std::string> renderRanges(
+    const std::vector<KeyRange>& ranges, size_t workers,
+    const std::function<std::string(const KeyRange& range, size_t index)>& render);
+
+// Joins the chunks of a split export into one file, in chunk order and a
+// piece at a time: CSV chunks are concatenated (only the first carries the
+// header), JSON arrays are merged into one laid out as JSONWriter would have
+// written it in one go. `trailer` follows the last piece.
+class ExportJoiner {
+public:
+    ExportJoiner(bool json, bool pretty, std::string trailer = {});
+
+    // The bytes the next chunk adds to the file
+    std::string next(const std::string& chunk);
+
+    // The bytes that end the file
+    std::string finish();
+
+    // Continue a join whose earlier chunks added `offset` bytes, so a chunk
+    // can be joined on its own at the position it was joined at before
+    void resumeAt(size_t offset);
+
+private:
+    bool m_json;
+    bool m_pretty;
+    std::string m_trailer;
+    bool m_started = false;  // JSON: the opening bracket is out
+    bool m_any = false;      // JSON: an element is out
+};
+
+// Join JSON array renderings into one array
+std::string joinJSONArrays(const std::vector<std::string>& chunks, bool pretty);
+
+// Sparse index of a rendered split export: where the piece of each key
+// range starts in the file. Kept in the cache beside the file, it lets a
+// later open serve a read at any offset by rendering only the ranges that
+// hold it, and gives the file's size without rendering it.
+struct ExportIndex {
+    std::vector<KeyRange> ranges;
+    std::vector<size_t> offsets;  // Start of each range's piece, then of the ending
+    size_t size = 0;              // The whole file
+
+    std::string serialize() const;
+    // Nothing if `text` is not a well-formed index
+    static std::optional<ExportIndex> parse(const std::string& text);
+};
+
+}  // namespace sqlfuse
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "ParallelExport.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sqlfuse {
+
+// Threads that render export chunks ahead of sequential readers, shared by
+// every file of a mount. `budget` bounds the bytes rendered ahead but not
+// yet read, across all files. A chunk is reserved at the average size of
+// the file's chunks so far when it is queued, and held at its real size
+// once rendered, so a chunk larger than the others may overshoot.
+class ReadAheadExecutor {
+public:
+    ReadAheadExecutor(size_t threads, size_t window, size_t budget);
+    ~ReadAheadExecutor();  // Drops queued tasks and waits for running ones
+
+    ReadAheadExecutor(const ReadAheadExecutor&) = delete;
+    ReadAheadExecutor& operator=(const ReadAheadExecutor&) = delete;
+
+    void submit(std::function<void()> task);
+
+    size_t window() const { return m_window; }  // Unread chunks a reader may have rendered
+
+    // Bytes rendered (or being rendered) ahead and not yet read
+    bool reserve(size_t bytes);  // False if that would exceed the budget
+    void hold(size_t bytes) { m_held += bytes; }
+    void release(size_t bytes) { m_held -= bytes; }
+    size_t held() const { return m_held; }
+
+    size_t prefetched() const { return m_prefetched; }  // Chunks rendered ahead
+    size_t waited() const { return m_waited; }          // Reads that had to render
+    void countPrefetched() { ++m_prefetched; }
+    void countWaited() { ++m_waited; }
+
+private:
+    void run();
+
+    size_t m_window;
+    size_t m_budget;
+    std::atomic<size_t> m_held{0};
+    std::atomic<size_t> m_prefetched{0};
+    std::atomic<size_t> m_waited{0};
+
+    std::mutex m_mutex;  // Guards m_tasks and m_stop
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stop = false;
+    std::vector<std::thread> m_threads;
+};
+
+// A file made of chunks rendered in order as reads reach them, joined with
+// an ExportJoiner. While reads follow one another, the executor renders
+// chunks in the background until window() of them are ready past the read
+// position, so the reader does not wait for the query and rendering of each
+// chunk in turn.
+//
+// Given the offsets a previous rendering of the same chunks joined at (an
+// ExportIndex), a read anywhere renders only the chunks it covers. A chunk
+// that no longer joins to its indexed size fails the read: the file around
+// it would not line up.
+class ChunkedContent {
+public:
+    using Render = std::function<std::string(size_t index)>;
+
+    // `executor` may be null: chunks are then rendered only when read.
+    // `offsets`, if given, holds where each chunk's piece starts and then
+    // where the ending starts.
+    ChunkedContent(size_t chunks, Render render, ExportJoiner joiner,
+                   ReadAheadExecutor* executor, std::vector<size_t> offsets = {});
+    ~ChunkedContent();  // Cancels queued chunks and waits for those rendering
+
+    ChunkedContent(const ChunkedContent&) = delete;
+    ChunkedContent& operator=(const ChunkedContent&) = delete;
+
+    // Copy up to `size` bytes at `offset`, rendering (or waiting for) the
+    // chunks that hold them. Rethrows what rendering a needed chunk threw.
+    size_t read(char* buf, size_t size, size_t offset);
+
+    // Whether every chunk has been joined into the file
+    bool complete() const;
+
+    // The file's size, once known without rendering the rest
+    std::optional<size_t> size() const;
+
+    // Where each chunk's piece starts, then the ending; once complete()
+    std::vector<size_t> offsets() const;
+
+    // The whole file, rendering what is left; the content is moved out
+    std::string take();
+
+private:
+    enum class Status { Pending, Queued, Rendering, Done, Failed };
+
+    struct Chunk {
+        Status status = Status::Pending;
+        std::string data;     // The rendering, then the piece it adds to the file
+        std::exception_ptr error;
+        size_t held = 0;      // Budget held for a chunk queued or rendered ahead
+        bool placed = false;  // `data` is the piece at its offset
+    };
+
+    struct State {
+        std::mutex mutex;
+        std::condition_variable changed;
+        Render render;
+        ExportJoiner joiner;
+        ReadAheadExecutor* executor;
+        std::vector<Chunk> chunks;
+        std::vector<size_t> offsets;  // Known up to `joined`, or all when indexed
+        bool indexed;
+        std::string ending;
+        size_t joined = 0;      // Chunks placed in order
+        bool finished = false;  // The ending is known
+        bool cancelled = false;
+        size_t rendering = 0;  // Chunks being rendered by the executor
+        size_t readEnd = 0;    // Where the last read ended
+
+        State(Render r, ExportJoiner j, ReadAheadExecutor* e, size_t count,
+              std::vector<size_t> o)
+            : render(std::move(r))
+            , joiner(std::move(j))
+            , executor(e)
+            , chunks(count)
+            , offsets(std::move(o))
+            , indexed(!offsets.empty()) {}
+    };
+
+    // Render chunk `index` (marked Rendering) with the lock released
+    static void renderChunk(State& state, std::unique_lock<std::mutex>& lock, size_t index,
+                            bool ahead);
+    // Turn indexed chunk `index`, rendered, into its piece
+    static void place(State& state, size_t index);
+    // Append the chunks that are done, in order, to the file
+    static void join(State& state);
+    // The chunk holding byte `offset`, among those whose offset is known
+    static size_t chunkAt(const State& state, size_t offset);
+    // Place the chunks from `first` that hold bytes before `end`
+    static void fill(State& state, std::unique_lock<std::mutex>& lock, size_t first, size_t end);
+    // Queue the pending chunks from `first` that lie within window() of the
+    // reader, while the budget lasts; called with the state locked
+    void prefetch(size_t first);
+    // Give back the budget of chunks read up to `offset`
+    static void releaseRead(State& state, size_t offset);
+
+    std::shared_ptr<State> m_state;
+};
+
+}  // namespace sqlfuse
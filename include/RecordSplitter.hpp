@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace sqlfuse {
+
+// Finds where the complete records of a table write end, so that a file
+// arriving in pieces can be parsed before all of it is there.
+//
+// CSV records end at a line break outside quotes. JSON records are the
+// objects of a top-level array; any other JSON document is one record and
+// only complete at the end of the input (see streamable()). The scan is
+// incremental: each call continues where the previous one stopped, so every
+// byte is looked at once.
+class RecordSplitter {
+public:
+    enum class Format { CSV, JSON };
+
+    explicit RecordSplitter(Format format, char quote = '"');
+
+    // Scan `data` (the caller's buffer: everything not yet consumed, of
+    // which a prefix may have been scanned before) and return the offset
+    // just past the last complete record, 0 if there is none yet
+    size_t scan(std::string_view data);
+
+    // The caller dropped the first `n` bytes of its buffer (n <= scan())
+    void consume(size_t n);
+
+    // False once a JSON document turned out not to be an array
+    bool streamable() const { return m_streamable; }
+
+private:
+    void scanCSV(std::string_view data);
+    void scanJSON(std::string_view data);
+
+    Format m_format;
+    char m_quote;
+    size_t m_pos = 0;         // Next byte to scan
+    size_t m_boundary = 0;    // End of the last complete record
+    bool m_quoted = false;    // Inside a CSV quoted field or a JSON string
+    bool m_escaped = false;   // JSON: previous byte was a backslash
+    int m_depth = 0;          // JSON nesting depth
+    bool m_started = false;   // JSON: seen the first non-blank byte
+    bool m_streamable = true;
+};
+
+}  // namespace sqlfuse
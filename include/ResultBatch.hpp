@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sqlfuse {
+
+// How the values of a column are stored and rendered
+enum class ValueType : uint8_t {
+    Null,       // No non-NULL value seen yet
+    Integer,    // int64, stored natively
+    Real,       // double, stored natively
+    Number,     // Numeric text as returned by the server (DECIMAL, NUMBER, ...)
+    Boolean,    // "t" / "f" text (PostgreSQL form)
+    Text,       // Character data
+    Binary,     // Raw bytes (written as hex in JSON)
+    Mixed       // Values of several types: bytes, with a type per row (cellType())
+};
+
+// Number formatting shared by ResultBatch and the format writers: shortest
+// round-trip text via std::to_chars; integral reals keep a ".0"
+void appendInteger(std::string& out, int64_t value);
+void appendReal(std::string& out, double value);
+
+// One column of a ResultBatch: a typed value vector or an offsets + bytes
+// buffer, plus a NULL bitmap. The type is fixed by the first non-NULL value;
+// a later value of a different type turns the column Mixed: every value is
+// kept as its exact text and tagged with its own type, so nothing is converted
+// (SQLite columns can hold a different type in every row).
+class ResultColumn {
+public:
+    explicit ResultColumn(std::string name);
+
+    const std::string& name() const { return m_name; }
+    ValueType type() const { return m_type; }
+    size_t size() const { return m_rows; }
+    // Type of one value; differs from type() only in a Mixed column
+    ValueType cellType(size_t row) const {
+        return m_type == ValueType::Mixed ? m_cellTypes[row] : m_type;
+    }
+
+    bool isNull(size_t row) const {
+        return (m_nulls[row / 64] >> (row % 64)) & 1;
+    }
+    int64_t integer(size_t row) const { return m_ints[row]; }
+    double real(size_t row) const { return m_reals[row]; }
+    bool boolean(size_t row) const { return bytes(row) == "t"; }
+    std::string_view bytes(size_t row) const {
+        return std::string_view(m_bytes.data() + m_offsets[row], m_offsets[row + 1] - m_offsets[row]);
+    }
+
+    void appendNull();
+    void appendInteger(int64_t value);
+    void appendReal(double value);
+    void appendNumber(std::string_view text);
+    void appendBoolean(bool value);
+    void appendText(std::string_view text);
+    void appendBinary(std::string_view data);
+
+    // Build a Text value in place: append to the returned buffer, then call
+    // endText(). Lets callers stream large values (e.g. LOBs) without a copy.
+    std::string& beginText();
+    void endText();
+
+    // Drop all rows, keeping the name and the allocated capacity. The type
+    // is reset so the next batch is typed by its own values.
+    void clear();
+
+private:
+    void markNull(bool null);
+    void setType(ValueType type);
+    void promoteToMixed();
+    void appendBytes(ValueType type, std::string_view data);
+
+    std::string m_name;
+    ValueType m_type = ValueType::Null;
+    size_t m_rows = 0;
+    std::vector<uint64_t> m_nulls;     // Bit per row, set = NULL
+    std::vector<int64_t> m_ints;       // Integer
+    std::vector<double> m_reals;       // Real
+    std::vector<size_t> m_offsets{0};  // Number/Boolean/Text/Binary/Mixed: value i is [offsets[i], offsets[i+1])
+    std::vector<ValueType> m_cellTypes;  // Mixed
+    std::string m_bytes;
+};
+
+// A batch of result rows in columnar form. Backends append one value to
+// every column per row; the format writers (BatchWriter.hpp) consume it.
+class ResultBatch {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit ResultBatch(const std::vector<std::string>& columnNames,
+                         size_t capacity = DEFAULT_CAPACITY);
+
+    size_t columnCount() const { return m_columns.size(); }
+    size_t rowCount() const { return m_columns.empty() ? 0 : m_columns[0].size(); }
+    size_t capacity() const { return m_capacity; }
+    bool full() const { return rowCount() >= m_capacity; }
+
+    ResultColumn& column(size_t index) { return m_columns[index]; }
+    const ResultColumn& column(size_t index) const { return m_columns[index]; }
+
+    // Drop all rows for the next fill
+    void clear();
+
+private:
+    std::vector<ResultColumn> m_columns;
+    size_t m_capacity;
+};
+
+}  // namespace sqlfuse
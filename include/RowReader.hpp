@@ -0,0 +1,31 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sqlfuse {
+
+// One field of an ingested row; std::nullopt is SQL NULL
+using FieldView = std::optional<std::string_view>;
+
+// Pull interface over rows written to a table file. Column names are known
+// before the first row and stored once; every row has exactly one field per
+// column, in column order.
+class RowReader {
+public:
+    virtual ~RowReader() = default;
+
+    virtual const std::vector<std::string>& columns() const = 0;
+
+    // Advance to the next row; false at end of input. Throws
+    // std::runtime_error on malformed input.
+    virtual bool next() = 0;
+
+    // Fields of the current row. Views stay valid until next() is called
+    // again; readers over a caller-owned buffer may keep them valid longer.
+    virtual const std::vector<FieldView>& row() const = 0;
+};
+
+}  // namespace sqlfuse
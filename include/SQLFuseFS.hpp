@@ -8,6 +8,7 @@
 #include "SchemaManager.hpp"
 #include "VirtualFile.hpp"
 #include "VirtualFileHandleManager.hpp"
+#include "WriteBehindQueue.hpp"
 
 #ifdef WITH_MYSQL
 #include "MySQLConnectionPool.hpp"
@@ -160,7 +161,9 @@ private:
     > m_pool;
 
     std::unique_ptr<SchemaManager> m_schema;          // Depends on pool & cache
+    std::unique_ptr<ReadAheadExecutor> m_readAhead;           // Outlives the file handles
     std::unique_ptr<VirtualFileHandleManager> m_fileHandles;  // Depends on schema & cache
+    std::unique_ptr<WriteBehindQueue> m_writeBehind;          // Depends on pool & cache
 
     bool m_initialized = false;
 };
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "PathRouter.hpp"
+#include "RecordSplitter.hpp"
+#include "RowReader.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sqlfuse {
+
+// Backend side of a table write: rows arrive as one or more readers and go
+// into one open transaction. Calls return 0 or a negative errno, with the
+// message in error(); a failed call leaves the caller to abort().
+class TableWriteStream {
+public:
+    virtual ~TableWriteStream() = default;
+
+    virtual int begin() = 0;                   // Open the transaction
+    virtual int write(RowReader& reader) = 0;  // Load every row of `reader`
+    virtual int finish() = 0;                  // Commit
+    virtual void abort() = 0;                  // Roll back
+
+    const std::string& error() const { return m_error; }
+
+    // A stream whose begin() fails with `result` (e.g. no connection)
+    static std::unique_ptr<TableWriteStream> failed(int result, std::string error);
+
+protected:
+    std::string m_error;
+};
+
+// Loads a CSV or JSON table file while it is being written sequentially.
+//
+// Bytes are collected until `pieceBytes` have arrived; the complete records
+// among them are then parsed and handed to the backend stream, which is
+// opened (and its transaction begun) with the first piece, once the columns
+// are known. Only a partial record and one piece are held in memory at a
+// time. finish() loads the rest and commits, so the file still goes in all
+// at once or not at all.
+//
+// Before the stream is opened nothing has reached the database: if the
+// data cannot be streamed (a JSON document that is not an array, or a
+// backend without streaming support) declined() is set and pending() still
+// holds every byte received, for the caller to buffer instead.
+class StreamingTableWrite {
+public:
+    // Opens the backend stream for these columns; nullptr if it cannot stream
+    using OpenStream =
+        std::function<std::unique_ptr<TableWriteStream>(const std::vector<std::string>& columns)>;
+
+    StreamingTableWrite(FileFormat format, OpenStream open, size_t pieceBytes);
+    ~StreamingTableWrite();  // Rolls back an unfinished stream
+
+    StreamingTableWrite(const StreamingTableWrite&) = delete;
+    StreamingTableWrite& operator=(const StreamingTableWrite&) = delete;
+
+    // Offset the next sequential write must start at
+    size_t received() const { return m_received; }
+
+    // Rows may have reached the database; the data is no longer all here
+    bool started() const { return m_stream != nullptr; }
+    bool declined() const { return m_declined; }
+    bool failed() const { return m_result != 0; }
+
+    // Add the bytes of the next sequential write; 0 or negative errno
+    int append(const char* data, size_t size);
+
+    // Load the remaining records and commit; 0 or negative errno
+    int finish();
+
+    // Give up: roll back, and fail every later call with `reason`
+    void abort(const std::string& reason);
+
+    // Received bytes not yet loaded
+    std::string& pending() { return m_pending; }
+
+    const std::string& error() const { return m_error; }
+
+private:
+    // Parse m_pending[0, end) and load its rows; `last` at the end of input
+    int load(size_t end, bool last);
+    int fail(int result, const std::string& error);
+
+    FileFormat m_format;
+    OpenStream m_open;
+    size_t m_pieceBytes;
+    RecordSplitter m_splitter;
+
+    std::unique_ptr<TableWriteStream> m_stream;
+    std::vector<std::string> m_columns;
+    std::string m_pending;
+    size_t m_received = 0;
+    bool m_declined = false;
+    bool m_finished = false;
+    int m_result = 0;  // First failure, returned by every later call
+    std::string m_error;
+};
+
+}  // namespace sqlfuse
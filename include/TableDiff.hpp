@@ -0,0 +1,51 @@
+#pragma once
+
+#include "FormatConverter.hpp"
+#include "RowReader.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sqlfuse {
+
+// Row changes that turn one rendering of a table into another, matched by
+// primary key value
+struct TableDiff {
+    std::vector<RowData> inserts;                          // Rows with a new key
+    std::vector<std::pair<std::string, RowData>> updates;  // Key, changed columns only
+    std::vector<std::string> deletes;                      // Keys no longer present
+    size_t unchanged = 0;
+
+    bool empty() const { return inserts.empty() && updates.empty() && deletes.empty(); }
+};
+
+// Compare the rows of `before` (the file as last rendered) with `after`
+// (the file as written). Values are compared as text, so a row saved
+// unchanged produces no statement. Columns missing from `after` are left
+// alone; an empty rendering (no columns) makes every written row an
+// insert. Both readers must parse caller-owned buffers, as their field views
+// are kept until the end. Throws std::runtime_error if either side lacks
+// the key column, or a key in `after` is NULL or repeated.
+TableDiff diffTables(RowReader& before, RowReader& after, const std::string& pkColumn);
+
+// The diff as statements from a backend format converter's buildDelete,
+// buildUpdate and buildInsert. Deletes go first so a unique value may move
+// from a removed row to a new one.
+template <typename Converter>
+std::vector<std::string> diffStatements(const TableDiff& diff, const std::string& table,
+                                        const std::string& pkColumn) {
+    std::vector<std::string> statements;
+    statements.reserve(diff.deletes.size() + diff.updates.size() + diff.inserts.size());
+    for (const auto& key : diff.deletes) {
+        statements.push_back(Converter::buildDelete(table, pkColumn, key));
+    }
+    for (const auto& [key, row] : diff.updates) {
+        statements.push_back(Converter::buildUpdate(table, row, pkColumn, key));
+    }
+    for (const auto& row : diff.inserts) {
+        statements.push_back(Converter::buildInsert(table, row));
+    }
+    return statements;
+}
+
+}  // namespace sqlfuse
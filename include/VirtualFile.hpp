@@ -4,12 +4,35 @@
 #include "SchemaManager.hpp"
 #include "CacheManager.hpp"
 #include "Config.hpp"
+#include "InsertBatcher.hpp"
+#include "ParallelExport.hpp"
+#include "ReadAhead.hpp"
+#include "StreamingTableWrite.hpp"
+#include "TableDiff.hpp"
+#include "WriteBehindQueue.hpp"
+#include "WriteBuffer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <memory>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace sqlfuse {
 
+// Write activity across every open file, for tracing how saves coalesce:
+// editors send many writes and flushes for what should be one save
+struct WriteCounters {
+    std::atomic<uint64_t> writes{0};     // write() calls received
+    std::atomic<uint64_t> bytes{0};      // Bytes in them
+    std::atomic<uint64_t> truncates{0};
+    std::atomic<uint64_t> flushes{0};    // flush() calls, modified or not
+    std::atomic<uint64_t> saves{0};      // Saves that ran against the database
+    std::atomic<uint64_t> coalesced{0};  // Saves skipped: unchanged content or left for release
+};
+
 // Abstract base class for virtual files
 class VirtualFile {
 public:
@@ -25,13 +48,41 @@ public:
     // Get file size (may trigger content generation)
     size_t getSize();
 
+    // Copy up to `size` bytes of content at `offset`. A table exported in
+    // key ranges with read-ahead renders only the ranges read so far.
+    size_t read(char* buf, size_t size, off_t offset);
+
     // Check if content is available
     bool hasContent() const;
 
+    // Cache key of the file at `path`, and of the offset index a split
+    // table export leaves beside it (export_offset_index)
+    static std::string cacheKey(const ParsedPath& path);
+    static std::string exportIndexKey(const ParsedPath& path);
+
     // Write operations
     int write(const char* data, size_t size, off_t offset);
     int truncate(off_t size);
-    int flush();
+    // Save the written data; `release` when the last descriptor is closing
+    int flush(bool release = false);
+
+    // Row saves go through the write-behind queue (PerformanceConfig::write_behind)
+    void setWriteBehind(WriteBehindQueue* queue) { m_writeBehind = queue; }
+
+    // Split table exports render as they are read, ahead of sequential
+    // readers (PerformanceConfig::read_ahead_chunks; nullptr: all at once)
+    void setReadAhead(ReadAheadExecutor* executor) { m_readAhead = executor; }
+
+    // Stop rendering ahead; called before the file is destroyed, as the
+    // background rendering calls into the backend
+    void stopReadAhead();
+
+    // Counters shared by the files of one mount (nullptr: not counted)
+    void setWriteCounters(WriteCounters* counters) { m_counters = counters; }
+
+    // Wait for this handle's queued row saves to commit; 0 or the first
+    // failure's negative errno
+    int awaitWriteBehind();
 
     // Status
     bool isModified() const { return m_modified; }
@@ -60,21 +111,100 @@ protected:
     virtual std::string generateDatabaseInfo() = 0;
     virtual std::string generateUserInfo() = 0;
 
-    // Database-dependent write handlers (pure virtual)
-    virtual int handleTableWrite() = 0;
+    // Split points in the table's primary key for a parallel export
+    // (export_parallelism); empty if the backend exports in one query
+    virtual KeySource exportKeySource(const std::string& pkColumn);
+
+    // One key range of a parallel export in the file's format, fetched on
+    // its own pooled connection, in key order
+    virtual std::string renderKeyRange(const std::string& pkColumn, const KeyRange& range,
+                                       bool json, bool header);
+
+    // Database-dependent write handlers. The default table write parses the
+    // buffer and loads it through openTableWriteStream().
+    virtual int handleTableWrite();
     virtual int handleRowWrite() = 0;
 
+    // The statement that saves a written row file, for the write-behind
+    // queue; 0 or negative errno
+    virtual int rowWriteStatement(std::string& sql);
+
+    // Opens a transaction on a pooled connection for a write-behind group;
+    // empty if the backend saves rows only through handleRowWrite()
+    virtual WriteBehindQueue::OpenSession writeSession();
+
+    // Transaction that loads the rows of a table write into the table, for
+    // buffered writes and for writes streamed as they arrive; nullptr if the
+    // backend cannot load tables this way. With m_replace set the rows
+    // replace the table's contents, committed all at once.
+    virtual std::unique_ptr<TableWriteStream> openTableWriteStream(
+        const std::vector<std::string>& columns);
+
+    // Run the statements of a diff-applied table write (diff_table_writes)
+    // in one transaction; 0 or negative errno
+    virtual int applyTableDiff(const TableDiff& diff, const std::string& pkColumn);
+
     // Helper methods
     std::string getCacheKey() const;
     void loadContent();
 
+    // Reader over written table data in the file's format (CSV with a header
+    // row, or JSON); nullptr for any other format. Parses `data` in place.
+    std::unique_ptr<RowReader> openRowReader(std::string& data) const;
+
+    // Table export as primary key ranges rendered at once, followed by
+    // `trailer`; nothing if the table is small, has no key, or parallel
+    // exports are off. With read-ahead, or an offset index from an earlier
+    // rendering, the ranges go to m_chunked, to be rendered as the file is
+    // read, and the result is empty.
+    std::optional<std::string> parallelTableExport(bool json, const std::string& trailer = "");
+
+    // Cache where each range of a rendered split export starts
+    void recordExportIndex(const std::vector<KeyRange>& ranges,
+                           const std::vector<size_t>& offsets, size_t size);
+
+    // Join the rest of a chunked export into m_content and cache it
+    void materialize();
+
+    // Table write batch limits from the [data] section
+    InsertLimits insertLimits() const;
+
+    // Whether sequential writes to this file are loaded as they arrive
+    bool canStreamWrites() const;
+
+    // Move the bytes a StreamingTableWrite collected into m_writeBuffer
+    void stopStreaming();
+
+    // Table write as the file's new contents: diff against the rendering
+    // the writer last saw and apply only the changed rows
+    int handleTableDiff();
+
+    // Row save through m_writeBehind; waits for the commit only with
+    // WriteDurability::Flush
+    int queueRowWrite();
+
+    // Whether the buffered data is byte for byte what this handle's last
+    // save wrote, and saving it again would set the same rows (a row file,
+    // or a diffed or replacing table write)
+    bool unchangedSave();
+
     ParsedPath m_path;              // Stored by value (caller's path is temporary)
     SchemaManager& m_schema;
     CacheManager& m_cache;
     const DataConfig& m_config;
 
     std::string m_content;
-    std::string m_writeBuffer;
+    std::unique_ptr<ChunkedContent> m_chunked;  // Table export rendered as it is read
+    std::vector<KeyRange> m_chunkedRanges;      // The key range of each chunk
+    ReadAheadExecutor* m_readAhead = nullptr;
+    WriteBuffer m_writeBuffer;
+    std::unique_ptr<StreamingTableWrite> m_streaming;  // Table write being loaded as it arrives
+    bool m_replace = false;  // Table write replaces the table (truncated, replace_table_writes)
+    WriteBehindQueue* m_writeBehind = nullptr;
+    std::vector<std::shared_future<WriteBehindQueue::Outcome>> m_pendingWrites;  // Queued row saves
+    WriteCounters* m_counters = nullptr;
+    std::optional<std::string> m_saved;  // Data of this handle's last buffered save
+    size_t m_unsavedWrites = 0;          // write() calls since the last save
     bool m_contentLoaded = false;
     bool m_modified = false;
     std::string m_lastError;
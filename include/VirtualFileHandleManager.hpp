@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Config.hpp"
+#include "VirtualFile.hpp"
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -21,6 +22,7 @@ public:
     VirtualFileHandleManager(SchemaManager& schema,
                              CacheManager& cache,
                              const DataConfig& config);
+    ~VirtualFileHandleManager();
 
     // Create a new file handle
     uint64_t create(const ParsedPath& path);
@@ -34,10 +36,23 @@ public:
     // Get number of open handles
     size_t openCount() const;
 
+    // Write and save counts across every file this manager created
+    const WriteCounters& writeCounters() const { return m_counters; }
+
+    // Queue that files created from now on save rows through (nullptr: none)
+    void setWriteBehind(WriteBehindQueue* queue) { m_writeBehind = queue; }
+
+    // Executor that files created from now on render split exports ahead on
+    // (nullptr: split exports render all at once)
+    void setReadAhead(ReadAheadExecutor* executor) { m_readAhead = executor; }
+
 private:
     SchemaManager& m_schema;
     CacheManager& m_cache;
     DataConfig m_config;
+    WriteBehindQueue* m_writeBehind = nullptr;
+    ReadAheadExecutor* m_readAhead = nullptr;
+    WriteCounters m_counters;
 
     std::unordered_map<uint64_t, std::unique_ptr<VirtualFile>> m_handles;
     std::atomic<uint64_t> m_nextHandle{1};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "InsertBatcher.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sqlfuse {
+
+// How long a row save waits for its group: until flush (close) has seen it
+// committed, or only until the file handle is released
+enum class WriteDurability {
+    Flush,
+    Release
+};
+
+// Row file saves from any number of file handles, committed in groups: each
+// table has a queue, and a writer takes up to `maxBatch` statements from it
+// once the first has waited `window` (or the queue is full) and runs them
+// in one transaction on one pooled connection. A statement that fails is
+// reported to its own caller and the rest of the group is committed
+// without it.
+class WriteBehindQueue {
+public:
+    // Connection for one group; empty if none could be had. The session
+    // owns the connection until it is destroyed.
+    using OpenSession = std::function<std::optional<InsertSession>()>;
+    using Committed = std::function<void(const std::string& database, const std::string& table)>;
+
+    struct Outcome {
+        int result = 0;  // 0 or negative errno
+        std::string error;
+    };
+
+    WriteBehindQueue(Committed committed, WriteDurability durability,
+                     std::chrono::milliseconds window, size_t maxBatch, size_t writers);
+    ~WriteBehindQueue();  // Commits everything queued
+
+    WriteBehindQueue(const WriteBehindQueue&) = delete;
+    WriteBehindQueue& operator=(const WriteBehindQueue&) = delete;
+
+    // Queue a statement for the table; `open` is kept for the table's next
+    // group. The future is ready once the statement's group has committed.
+    std::shared_future<Outcome> enqueue(const std::string& database, const std::string& table,
+                                        std::string sql, OpenSession open);
+
+    WriteDurability durability() const { return m_durability; }
+
+    size_t groups() const { return m_groups; }          // Transactions committed
+    size_t statements() const { return m_statements; }  // Statements in them
+
+private:
+    struct Mutation {
+        std::string sql;
+        std::promise<Outcome> done;
+    };
+
+    struct Table {
+        std::string database;
+        std::string table;
+        OpenSession open;
+        std::deque<Mutation> queue;
+        std::chrono::steady_clock::time_point first;  // When the oldest queued statement came
+        bool busy = false;                            // A writer is committing a group
+    };
+
+    void run();
+    void commitGroup(const OpenSession& open, std::vector<Mutation>& group);
+
+    Committed m_committed;
+    WriteDurability m_durability;
+    std::chrono::milliseconds m_window;
+    size_t m_maxBatch;
+
+    std::mutex m_mutex;  // Guards m_tables and m_stop
+    std::condition_variable m_wake;
+    std::map<std::pair<std::string, std::string>, Table> m_tables;
+    bool m_stop = false;
+    std::vector<std::thread> m_writers;
+
+    std::atomic<size_t> m_groups{0};
+    std::atomic<size_t> m_statements{0};
+};
+
+}  // namespace sqlfuse
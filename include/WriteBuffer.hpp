@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sqlfuse {
+
+// Bytes written to an open file, kept as a rope of fixed-size chunks.
+// Writes may land at any offset (a gap reads as zero bytes, as in a sparse
+// file); growing the buffer allocates new chunks instead of reallocating and
+// copying everything written so far, as a std::string would.
+class WriteBuffer {
+public:
+    static constexpr size_t CHUNK_BYTES = 256 * 1024;
+
+    void write(size_t offset, const char* data, size_t size);
+
+    // Shrinks, or grows with zero bytes
+    void resize(size_t size);
+    void clear();
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    // Copy out [pos, pos + n) (clamped to the size); returns bytes copied
+    size_t copy(size_t pos, size_t n, char* out) const;
+    std::string substr(size_t pos, size_t n) const;
+    char at(size_t pos) const;
+
+    // Whether the buffer holds exactly `data`, compared in place
+    bool equals(std::string_view data) const;
+
+    // The whole buffer as one string (the readers parse a contiguous copy)
+    std::string str() const { return substr(0, m_size); }
+
+private:
+    std::vector<std::unique_ptr<char[]>> m_chunks;  // nullptr: all zero
+    size_t m_size = 0;
+};
+
+}  // namespace sqlfuse
@@ -12,6 +12,7 @@
 #include <mysql/mysql.h>
 #include <string>
 #include <cstdint>
+#include <functional>
 
 namespace sqlfuse {
 
@@ -151,6 +152,41 @@ public:
      */
     uint64_t insertId() const;
 
+    /**
+     * @brief Get the number of warnings raised by the last statement.
+     * @return Warning count (read them with SHOW WARNINGS).
+     */
+    unsigned int warningCount() const;
+
+    /**
+     * @brief Supplies the content of a LOAD DATA LOCAL INFILE.
+     *
+     * Called with an empty string to fill with the next piece of the file;
+     * leaving it empty ends the data. Throwing std::exception aborts the
+     * statement with the exception's message.
+     */
+    using InfileSource = std::function<void(std::string& chunk)>;
+
+    /**
+     * @brief Run a LOAD DATA LOCAL INFILE statement fed from memory.
+     * @param sql The LOAD DATA LOCAL INFILE statement (its file name is ignored).
+     * @param source Produces the file content on demand.
+     * @return true on success, false on error (check error() for details).
+     *
+     * A memory-backed local-infile handler is installed for this statement
+     * only; afterwards requests are refused again (see refuseLocalInfile).
+     */
+    bool loadLocalInfile(const std::string& sql, const InfileSource& source);
+
+    /**
+     * @brief Make LOCAL INFILE requests on a handle fail.
+     * @param conn The MYSQL handle to configure.
+     *
+     * Installed on every pooled connection, so a server can never make the
+     * client read a local file; only loadLocalInfile() serves data.
+     */
+    static void refuseLocalInfile(MYSQL* conn);
+
 private:
     friend class MySQLConnectionPool;
 
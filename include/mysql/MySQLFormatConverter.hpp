@@ -11,6 +11,8 @@
  */
 
 #include "FormatConverter.hpp"
+#include "InsertBatcher.hpp"
+#include "ResultBatch.hpp"
 #include <mysql/mysql.h>
 
 namespace sqlfuse {
@@ -26,7 +28,8 @@ namespace sqlfuse {
  * Key MySQL-specific behaviors:
  * - Identifiers are escaped with backticks (`identifier`)
  * - String literals use backslash escaping for special characters
- * - Field types from MYSQL_FIELD are used to determine JSON number vs string
+ * - Field types from MYSQL_FIELD are used to determine JSON number vs string;
+ *   numeric values keep the server's text, so DECIMAL keeps its precision
  * - NULL values are handled according to MySQL conventions
  *
  * Inherits from FormatConverter to access shared CSV field escaping utilities.
@@ -52,6 +55,7 @@ public:
      *
      * Numeric MySQL types (INT, FLOAT, DOUBLE, DECIMAL) are preserved as JSON numbers.
      * NULL values are included based on options.includeNull setting.
+     * Rows are fetched into a ResultBatch a batch at a time.
      */
     static std::string toJSON(MYSQL_RES* result, const JSONOptions& options = JSONOptions{});
 
@@ -67,6 +71,29 @@ public:
     static std::string rowToJSON(MYSQL_ROW row, MYSQL_RES* result,
                                  const JSONOptions& options = JSONOptions{});
 
+    /**
+     * @brief Get the column names of a result set.
+     * @param result The MYSQL_RES* to read field metadata from.
+     * @return Column names in order, for constructing a ResultBatch.
+     */
+    static std::vector<std::string> columnNames(MYSQL_RES* result);
+
+    /**
+     * @brief Fetch rows into a batch until it is full or the result is exhausted.
+     * @param result The MYSQL_RES* to fetch from.
+     * @param batch Batch with one column per result field.
+     * @return true if at least one row is in the batch.
+     */
+    static bool fillBatch(MYSQL_RES* result, ResultBatch& batch);
+
+    /**
+     * @brief Append one fetched row to a batch.
+     * @param row The MYSQL_ROW most recently fetched from result.
+     * @param result The MYSQL_RES* for field types and value lengths.
+     * @param batch Batch with one column per result field.
+     */
+    static void appendRow(MYSQL_ROW row, MYSQL_RES* result, ResultBatch& batch);
+
     /**
      * @brief Build an INSERT SQL statement with MySQL-specific escaping.
      * @param table Fully qualified table name (database.table or just table).
@@ -80,6 +107,48 @@ public:
                                    const RowData& row,
                                    bool escape = true);
 
+    /**
+     * @brief Describe a multi-row INSERT for InsertBatcher.
+     * @param table Fully qualified table name (database.table or just table).
+     * @param columns Column names, in value order.
+     * @param duplicates "replace" (REPLACE INTO), "ignore" (INSERT IGNORE) or
+     *        "error" (plain INSERT).
+     * @return Syntax for INSERT INTO `database`.`table` (`a`, `b`) VALUES (...), (...)
+     */
+    static InsertSyntax insertSyntax(const std::string& table,
+                                     const std::vector<std::string>& columns,
+                                     const std::string& duplicates = "error");
+
+    /**
+     * @brief Append a value as a quoted MySQL string literal.
+     * @param sql Statement being built.
+     * @param value Raw value (backslash-escaped as in escapeSQL()).
+     */
+    static void appendLiteral(std::string& sql, std::string_view value);
+
+    /**
+     * @brief Build a LOAD DATA LOCAL INFILE statement for a table write.
+     * @param table Fully qualified table name (database.table or just table).
+     * @param columns Column names, in field order.
+     * @param duplicates "replace" or "ignore" add that keyword; "error" adds
+     *        none (with LOCAL the server then skips duplicates with a
+     *        warning, which the caller must check).
+     * @return Statement reading the format written by appendLoadDataRow().
+     */
+    static std::string buildLoadData(const std::string& table,
+                                     const std::vector<std::string>& columns,
+                                     const std::string& duplicates = "error");
+
+    /**
+     * @brief Append a row in LOAD DATA's default text format.
+     * @param out Buffer receiving the row.
+     * @param fields Field values; std::nullopt is written as \N.
+     *
+     * Fields are tab-separated and the row ends with a newline; backslash,
+     * tab, newline, carriage return and NUL are backslash-escaped.
+     */
+    static void appendLoadDataRow(std::string& out, const std::vector<FieldView>& fields);
+
     /**
      * @brief Build an UPDATE SQL statement with MySQL-specific escaping.
      * @param table Fully qualified table name.
@@ -97,6 +166,24 @@ public:
                                    const std::string& pkValue,
                                    bool escape = true);
 
+    /**
+     * @brief Build a single-statement upsert with MySQL-specific escaping.
+     * @param table Fully qualified table name.
+     * @param row Map of column names to values; must include pkColumn.
+     * @param pkColumn Primary key column name.
+     * @param escape If true, escape string values (default: true).
+     * @return INSERT ... ON DUPLICATE KEY UPDATE statement.
+     *
+     * Inserts the row, or updates every column but the primary key if the
+     * key exists. Example output:
+     * INSERT INTO `t` (`id`, `name`) VALUES ('1', 'a')
+     * ON DUPLICATE KEY UPDATE `name` = VALUES(`name`)
+     */
+    static std::string buildUpsert(const std::string& table,
+                                   const RowData& row,
+                                   const std::string& pkColumn,
+                                   bool escape = true);
+
     /**
      * @brief Build a DELETE SQL statement with MySQL-specific escaping.
      * @param table Fully qualified table name.
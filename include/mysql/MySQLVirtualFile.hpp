@@ -76,6 +76,25 @@ protected:
      */
     std::string generateTableJSON() override;
 
+    /**
+     * @brief Find split points in the primary key for a parallel export.
+     * @param pkColumn Primary key column.
+     * @return MIN/MAX and LIMIT ... OFFSET lookups on the key index.
+     */
+    KeySource exportKeySource(const std::string& pkColumn) override;
+
+    /**
+     * @brief Fetch and render one key range of a parallel table export.
+     * @param pkColumn Primary key column.
+     * @param range Keys to export and the range's row limit.
+     * @param json Render JSON instead of CSV.
+     * @param header Include the CSV header row.
+     * @return The range's rows in key order.
+     * @throws MySQLException if the query fails.
+     */
+    std::string renderKeyRange(const std::string& pkColumn, const KeyRange& range,
+                               bool json, bool header) override;
+
     /**
      * @brief Generate JSON content for a single row.
      * @return JSON object for the row identified by m_path.row_id.
@@ -105,21 +124,57 @@ protected:
     // ----- Write operation handlers -----
 
     /**
-     * @brief Handle writes to table data files (bulk insert).
-     * @return 0 on success, negative errno on failure.
+     * @brief Open the transaction that loads a table write (bulk insert).
+     * @param columns Columns named by the written data.
+     * @return Stream sending rows with LOAD DATA LOCAL INFILE, straight from
+     *         memory, or with batched multi-row INSERTs when
+     *         DataConfig::mysql_load_data_writes is off or the server refuses
+     *         LOCAL INFILE.
      *
-     * Parses the write buffer as CSV or JSON and inserts all rows.
+     * Used for buffered writes and for writes loaded as they arrive.
+     * Duplicate keys follow DataConfig::mysql_on_duplicate; in "error" mode a
+     * load that reports any warning fails and is rolled back. A replacing
+     * write loads a CREATE TABLE ... LIKE copy and swaps it in with RENAME
+     * TABLE after COMMIT; tables with triggers or foreign keys have their
+     * rows deleted in the load's transaction instead.
      */
-    int handleTableWrite() override;
+    std::unique_ptr<TableWriteStream> openTableWriteStream(
+        const std::vector<std::string>& columns) override;
 
     /**
      * @brief Handle writes to individual row files (insert/update).
      * @return 0 on success, negative errno on failure.
      *
-     * If the row exists (by primary key), updates it; otherwise inserts.
+     * The file name is the primary key value. One INSERT ... ON DUPLICATE
+     * KEY UPDATE inserts the row or updates the written columns, whatever
+     * the key's type.
      */
     int handleRowWrite() override;
 
+    /**
+     * @brief Build the upsert that saves a written row file.
+     * @param sql Receives the statement.
+     * @return 0 on success, negative errno if the row cannot be saved.
+     */
+    int rowWriteStatement(std::string& sql) override;
+
+    /**
+     * @brief Open a write-behind group transaction on a pooled connection.
+     * @return Function acquiring the connection for each group.
+     */
+    WriteBehindQueue::OpenSession writeSession() override;
+
+    /**
+     * @brief Apply a diff-based table write (DataConfig::diff_table_writes).
+     * @param diff Rows to delete, update and insert.
+     * @param pkColumn Primary key column the diff is keyed on.
+     * @return 0 on success, negative errno on failure.
+     *
+     * Runs one DELETE, UPDATE or INSERT per changed row inside one transaction;
+     * any failure rolls the whole write back.
+     */
+    int applyTableDiff(const TableDiff& diff, const std::string& pkColumn) override;
+
 private:
     /**
      * @brief Get the MySQL connection pool from the schema manager.
@@ -11,12 +11,25 @@
 
 #include <oci.h>
 #include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
 #include <cstdint>
 
 namespace sqlfuse {
 
 class OracleConnectionPool;
 
+/**
+ * @struct OracleRowError
+ * @brief A row rejected by an array DML execution (OCI_BATCH_ERRORS).
+ */
+struct OracleRowError {
+    ub4 row = 0;          ///< Offset of the row within the batch
+    int code = 0;         ///< Oracle error code (e.g., 1 for ORA-00001)
+    std::string message;  ///< Full error text
+};
+
 /**
  * @class OracleConnection
  * @brief RAII wrapper for a pooled Oracle database connection.
@@ -92,12 +105,17 @@ public:
     /**
      * @brief Execute a SQL query and return the statement handle.
      * @param sql The SQL statement to execute.
-     * @return OCIStmt* on success (caller must free with OCIHandleFree), nullptr on error.
+     * @param prefetchRows Rows for OCI to prefetch with the execute round trip
+     *        of a SELECT (0 leaves the OCI default of one row).
+     * @return OCIStmt* on success (caller must release with OCIStmtRelease), nullptr on error.
      *
      * For SELECT statements, the returned handle can be used with OracleResultSet.
      * For DML statements, use executeNonQuery() instead for simpler handling.
      */
-    OCIStmt* execute(const std::string& sql);
+    OCIStmt* execute(const std::string& sql, ub4 prefetchRows = 0);
+
+    /** @brief Upper bound on memory OCI may use for prefetched rows. */
+    static constexpr ub4 PREFETCH_MEMORY_BYTES = 4 * 1024 * 1024;
 
     /**
      * @brief Execute a non-query SQL statement (INSERT, UPDATE, DELETE, DDL).
@@ -109,6 +127,31 @@ public:
      */
     bool executeNonQuery(const std::string& sql);
 
+    /** @brief One row of bind values; std::nullopt binds NULL. */
+    using BindRow = std::vector<std::optional<std::string_view>>;
+
+    /**
+     * @brief Execute a DML statement once for a whole batch of rows.
+     * @param sql Statement with positional binds :1 .. :n, one per value.
+     * @param rows Values for each execution; every row has n values.
+     * @param rowErrors Receives the rows the server rejected.
+     * @return true if the statement ran (possibly with rejected rows),
+     *         false on a statement-level error (check getError()).
+     *
+     * Each column is bound as a character array (OCIBindByPos plus
+     * OCIBindArrayOfStruct, stride = longest value in the column) and the
+     * statement is sent with one OCIStmtExecute of rows.size() iterations.
+     * Execution uses OCI_BATCH_ERRORS, so a row that fails (constraint,
+     * conversion, ...) is reported in rowErrors and the others are still
+     * applied. affectedRows() returns the number of rows applied. Values
+     * must not exceed MAX_ARRAY_BIND_BYTES.
+     */
+    bool executeArray(const std::string& sql, const std::vector<BindRow>& rows,
+                      std::vector<OracleRowError>& rowErrors);
+
+    /** @brief Longest value executeArray() can bind (VARCHAR2 limit). */
+    static constexpr size_t MAX_ARRAY_BIND_BYTES = 32767;
+
     /**
      * @brief Commit the current transaction.
      * @return true on success, false on error.
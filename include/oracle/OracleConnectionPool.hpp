@@ -5,8 +5,9 @@
  * @brief Thread-safe connection pool for Oracle database connections.
  *
  * This file implements a connection pool specifically for Oracle databases using
- * the Oracle Call Interface (OCI). The pool manages a fixed number of connections
- * that are shared across multiple threads, reducing connection overhead.
+ * the Oracle Call Interface (OCI). Sessions come from an OCI session pool
+ * (OCISessionPoolCreate) with the client-side statement cache enabled, and are
+ * shared across multiple threads, reducing connection and parse overhead.
  */
 
 #include "ConnectionPool.hpp"
@@ -14,7 +15,6 @@
 #include "OracleConnection.hpp"
 #include <oci.h>
 #include <memory>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
@@ -25,14 +25,19 @@ namespace sqlfuse {
  * @class OracleConnectionPool
  * @brief Thread-safe pool of reusable Oracle database connections.
  *
- * OracleConnectionPool manages a pool of OCI connections to an Oracle database.
- * Connections are pre-created at pool initialization and reused across requests,
- * avoiding the overhead of establishing new connections for each operation.
+ * OracleConnectionPool wraps an OCI session pool. OCI owns the sessions and
+ * their reuse; this class bounds the number of borrowed sessions so that
+ * acquire() can honour a timeout, and hands sessions out as OracleConnection
+ * wrappers.
  *
  * Key features:
- * - Pre-created connections at startup for immediate availability
- * - Automatic connection validation using OCIPing before returning to caller
- * - Automatic reconnection if a pooled connection has become stale
+ * - Homogeneous OCI session pool, opened at startup with one session
+ *   and grown on demand up to the pool size
+ * - Client-side statement cache per session (OCI_SPC_STMTCACHE), used by
+ *   OracleConnection::execute through OCIStmtPrepare2
+ * - Sessions are only pinged by OCI when they have been idle longer than
+ *   PING_INTERVAL_SECONDS, and never while m_mutex is held
+ * - Idle sessions are closed by OCI after IDLE_TIMEOUT_SECONDS
  * - Thread-safe acquire/release with condition variable for waiting
  * - Configurable pool size and acquisition timeout
  * - Clean shutdown with connection draining
@@ -50,16 +55,16 @@ namespace sqlfuse {
  */
 class OracleConnectionPool : public ConnectionPool {
 public:
+    static constexpr ub4 STATEMENT_CACHE_SIZE = 64;   ///< Cached statements per session
+    static constexpr ub4 PING_INTERVAL_SECONDS = 60;  ///< Idle time before OCI re-validates
+    static constexpr ub4 IDLE_TIMEOUT_SECONDS = 600;  ///< Idle time before OCI closes a session
+
     /**
      * @brief Create a new Oracle connection pool.
      * @param config Connection configuration (host, port, user, password, etc.).
-     * @param poolSize Number of connections to maintain in the pool (default: 10).
-     * @throws std::runtime_error if the OCI environment cannot be initialized
-     *         or if no connections can be created.
-     *
-     * The constructor attempts to create all poolSize connections. If some
-     * connections fail but at least one succeeds, the pool will operate
-     * with reduced capacity.
+     * @param poolSize Maximum number of sessions in the pool (default: 10).
+     * @throws std::runtime_error if the OCI environment or the session pool
+     *         cannot be created.
      */
     explicit OracleConnectionPool(const ConnectionConfig& config, size_t poolSize = 10);
 
@@ -73,9 +78,10 @@ public:
      * @param timeout Maximum time to wait for a connection (default: 5 seconds).
      * @return unique_ptr to OracleConnection, or nullptr on timeout/shutdown.
      *
-     * If the pool is empty, this method blocks until a connection becomes
-     * available or the timeout expires. The returned connection is validated
-     * before being returned; stale connections are automatically replaced.
+     * If all sessions are borrowed, this method blocks until one is released
+     * or the timeout expires. The session itself is taken from the OCI pool
+     * after m_mutex is released; OCI only pings it if it has been idle for
+     * longer than PING_INTERVAL_SECONDS and replaces it if the ping fails.
      */
     std::unique_ptr<OracleConnection> acquire(
         std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
@@ -85,21 +91,20 @@ public:
      * @return unique_ptr to OracleConnection if available, nullptr otherwise.
      *
      * Immediately returns nullptr if no connections are available.
-     * Does not validate the connection before returning.
      */
     std::unique_ptr<OracleConnection> tryAcquire();
 
     // ----- ConnectionPool interface implementation -----
 
     /**
-     * @brief Get the number of currently available (idle) connections.
-     * @return Number of connections ready to be acquired.
+     * @brief Get the number of connections that can be acquired without waiting.
+     * @return Pool size minus the number of borrowed connections.
      */
     size_t availableCount() const override;
 
     /**
-     * @brief Get the total number of connections managed by the pool.
-     * @return Total connection count (available + in-use).
+     * @brief Get the number of sessions currently open in the OCI pool.
+     * @return Open session count (idle + in-use).
      */
     size_t totalCount() const override;
 
@@ -113,8 +118,8 @@ public:
      * @brief Drain all connections and prepare for shutdown.
      *
      * After calling drain(), no new connections can be acquired.
-     * All currently available connections are destroyed.
-     * In-use connections will be destroyed when released.
+     * The OCI session pool is destroyed once no connections are in use;
+     * in-use sessions are dropped when released.
      */
     void drain() override;
 
@@ -149,15 +154,6 @@ public:
 private:
     friend class OracleConnection;  // For releaseConnection access
 
-    /**
-     * @struct PooledConnection
-     * @brief Internal representation of a pooled connection's OCI handles.
-     */
-    struct PooledConnection {
-        OCISvcCtx* svc;  ///< Service context handle
-        OCIError* err;   ///< Error handle
-    };
-
     /**
      * @brief Initialize the OCI environment.
      * @return true on success, false on failure.
@@ -165,40 +161,43 @@ private:
     bool initializeEnvironment();
 
     /**
-     * @brief Create a new OCI connection with full session setup.
-     * @return PooledConnection with initialized handles.
-     * @throws std::runtime_error on connection failure.
+     * @brief Create the OCI session pool with statement caching.
+     * @throws std::runtime_error on failure.
+     */
+    void createSessionPool();
+
+    /**
+     * @brief Take a session from the OCI pool.
+     * @return Connection wrapper, or nullptr if OCI could not provide a session.
+     *
+     * Must be called without m_mutex held; the caller has already reserved
+     * a slot in m_borrowed.
      */
-    PooledConnection createConnection();
+    std::unique_ptr<OracleConnection> getSession();
 
     /**
-     * @brief Return a connection to the pool.
-     * @param svc Service context handle.
-     * @param err Error handle.
+     * @brief Return a session to the OCI pool.
+     * @param svc Service context handle from OCISessionGet.
+     * @param err Error handle allocated for this connection.
      *
      * Called by OracleConnection destructor. If pool is shutting down,
-     * the connection is destroyed instead of being returned.
+     * the session is dropped instead of being kept for reuse.
      */
     void releaseConnection(OCISvcCtx* svc, OCIError* err);
 
     /**
-     * @brief Properly close and free a connection's OCI handles.
-     * @param svc Service context handle.
-     * @param err Error handle.
+     * @brief Give back a borrowed slot and wake one waiting thread.
      */
-    void destroyConnection(OCISvcCtx* svc, OCIError* err);
+    void releaseSlot();
 
     /**
-     * @brief Check if a connection is still valid using OCIPing.
-     * @param svc Service context handle.
-     * @param err Error handle.
-     * @return true if the connection responds to ping.
+     * @brief Destroy the OCI session pool and its error handle.
      */
-    bool validateConnection(OCISvcCtx* svc, OCIError* err);
+    void destroySessionPool();
 
     /**
      * @brief Build an Oracle connection string from configuration.
-     * @return Connection string suitable for OCIServerAttach.
+     * @return Connection string suitable for OCISessionPoolCreate.
      *
      * Supports Easy Connect format (host:port/service) and passes through
      * TNS names or full descriptors unchanged.
@@ -206,15 +205,18 @@ private:
     std::string buildConnectString() const;
 
     ConnectionConfig m_config;        ///< Connection parameters
-    size_t m_poolSize;                ///< Target pool size
+    size_t m_poolSize;                ///< Maximum sessions borrowed at once
 
     OCIEnv* m_env = nullptr;          ///< OCI environment (shared by all connections)
+    OCIError* m_poolErr = nullptr;    ///< Error handle for pool-level calls
+    OCISPool* m_spool = nullptr;      ///< OCI session pool handle
+    OraText* m_poolName = nullptr;    ///< Pool name returned by OCISessionPoolCreate
+    ub4 m_poolNameLen = 0;            ///< Length of m_poolName
 
-    std::queue<PooledConnection> m_available;  ///< Idle connections
-    std::atomic<size_t> m_createdCount{0};     ///< Total connections created
+    size_t m_borrowed = 0;                     ///< Connections currently handed out
     std::atomic<size_t> m_waitingCount{0};     ///< Threads blocked on acquire()
 
-    mutable std::mutex m_mutex;       ///< Protects m_available queue
+    mutable std::mutex m_mutex;       ///< Protects m_borrowed and pool teardown
     std::condition_variable m_cv;     ///< Signaled when connection available
     std::atomic<bool> m_shutdown{false};  ///< True if pool is draining
 };
@@ -11,7 +11,9 @@
  */
 
 #include "FormatConverter.hpp"
+#include "InsertBatcher.hpp"
 #include "OracleResultSet.hpp"
+#include "ResultBatch.hpp"
 #include <oci.h>
 
 namespace sqlfuse {
@@ -28,7 +30,7 @@ namespace sqlfuse {
  * - Identifiers are escaped with double quotes ("identifier")
  * - String literals use doubled single quotes for escaping ('O''Brien')
  * - Numeric types are preserved as numbers in JSON output
- * - LOB types are read with a size limit for safety
+ * - LOB types are streamed through their locators into the result batch
  *
  * Inherits from FormatConverter to access shared CSV field escaping utilities.
  */
@@ -68,6 +70,31 @@ public:
     static std::string rowToJSON(OracleResultSet& result,
                                  const JSONOptions& options = JSONOptions{});
 
+    /**
+     * @brief Get the column names of a result set.
+     * @param result The executed OracleResultSet.
+     * @return Column names in order, for constructing a ResultBatch.
+     */
+    static std::vector<std::string> columnNames(OracleResultSet& result);
+
+    /**
+     * @brief Fetch rows into a batch until it is full or the result is exhausted.
+     * @param result The OracleResultSet to fetch from.
+     * @param batch Batch with one column per result column.
+     * @return true if at least one row is in the batch.
+     */
+    static bool fillBatch(OracleResultSet& result, ResultBatch& batch);
+
+    /**
+     * @brief Append the current row of a result set to a batch.
+     * @param result Result set positioned on a row (after fetchRow()).
+     * @param batch Batch with one column per result column.
+     *
+     * LOB values are streamed into the batch with readLob(); BLOBs are
+     * rendered as uppercase hex.
+     */
+    static void appendRow(OracleResultSet& result, ResultBatch& batch);
+
     /**
      * @brief Build an INSERT SQL statement with Oracle-specific escaping.
      * @param table Fully qualified table name (schema.table or just table).
@@ -81,6 +108,32 @@ public:
                                    const RowData& row,
                                    bool escape = true);
 
+    /**
+     * @brief Describe a multi-row INSERT for InsertBatcher.
+     * @param table Fully qualified table name (schema.table or just table).
+     * @param columns Column names, in value order.
+     * @return INSERT ALL syntax: one INTO ... VALUES (...) per row, closed
+     *         by SELECT 1 FROM DUAL (multi-row VALUES needs Oracle 23c).
+     */
+    static InsertSyntax insertSyntax(const std::string& table,
+                                     const std::vector<std::string>& columns);
+
+    /**
+     * @brief Build an INSERT with positional binds for array DML.
+     * @param table Fully qualified table name (schema.table or just table).
+     * @param columns Column names, in bind order.
+     * @return INSERT INTO "S"."T" ("A", "B") VALUES (:1, :2)
+     */
+    static std::string buildArrayInsert(const std::string& table,
+                                        const std::vector<std::string>& columns);
+
+    /**
+     * @brief Append a value as a quoted Oracle string literal.
+     * @param sql Statement being built.
+     * @param value Raw value (single quotes doubled).
+     */
+    static void appendLiteral(std::string& sql, std::string_view value);
+
     /**
      * @brief Build an UPDATE SQL statement with Oracle-specific escaping.
      * @param table Fully qualified table name.
@@ -98,6 +151,25 @@ public:
                                    const std::string& pkValue,
                                    bool escape = true);
 
+    /**
+     * @brief Build a single-statement upsert with Oracle-specific escaping.
+     * @param table Fully qualified table name (schema.table).
+     * @param row Map of column names to values; must include pkColumn.
+     * @param pkColumn Primary key column name (the MERGE join column).
+     * @param escape If true, escape string values (default: true).
+     * @return MERGE INTO ... USING (SELECT ... FROM DUAL) statement.
+     *
+     * Inserts the row, or updates every column but the primary key if the
+     * key exists. Example output:
+     * MERGE INTO "S"."T" t USING (SELECT '1' AS "ID", 'a' AS "NAME" FROM DUAL) s
+     * ON (t."ID" = s."ID") WHEN MATCHED THEN UPDATE SET t."NAME" = s."NAME"
+     * WHEN NOT MATCHED THEN INSERT ("ID", "NAME") VALUES (s."ID", s."NAME")
+     */
+    static std::string buildUpsert(const std::string& table,
+                                   const RowData& row,
+                                   const std::string& pkColumn,
+                                   bool escape = true);
+
     /**
      * @brief Build a DELETE SQL statement with Oracle-specific escaping.
      * @param table Fully qualified table name.
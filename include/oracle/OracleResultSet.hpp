@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <functional>
 
 namespace sqlfuse {
 
@@ -27,6 +28,16 @@ namespace sqlfuse {
  * All column values are fetched as strings (SQLT_STR) for simplicity,
  * with numeric type information preserved for JSON output where appropriate.
  *
+ * Rows are array-fetched: output buffers hold a batch of rows per column
+ * and fetchRow() only goes back to the server when the batch is used up.
+ * The batch is capped so that the buffers stay within MAX_BATCH_BYTES.
+ *
+ * CLOB and BLOB columns are defined as LOB locators when a service context
+ * is supplied, so their size is not limited by a fixed define buffer.
+ * readLob() streams a LOB value in LOB_CHUNK_BYTES pieces; getValue() reads
+ * the whole value for callers that need it as a string (BLOBs as hex).
+ * Without a service context LOBs fall back to a 4,000-byte string define.
+ *
  * Usage:
  * @code
  *   OCIStmt* stmt = conn->execute("SELECT id, name FROM employees");
@@ -45,16 +56,28 @@ namespace sqlfuse {
  */
 class OracleResultSet {
 public:
+    static constexpr ub4 DEFAULT_FETCH_BATCH_ROWS = 100;    ///< Rows per array fetch
+    static constexpr size_t MAX_BATCH_BYTES = 16 * 1024 * 1024;  ///< Buffer cap per batch
+    static constexpr size_t LOB_CHUNK_BYTES = 64 * 1024;         ///< Piece size for LOB reads
+
+    /// Receives one piece of a LOB value; return false to stop reading.
+    using LobSink = std::function<bool(const char* data, size_t length)>;
+
     /**
      * @brief Construct a result set from an executed statement.
-     * @param stmt OCI statement handle (takes ownership, will be freed on destruction).
+     * @param stmt OCI statement handle (takes ownership, released to the statement cache on destruction).
      * @param err OCI error handle (borrowed, not freed).
      * @param env OCI environment handle (borrowed, not freed).
+     * @param svc OCI service context used to read LOB values (borrowed);
+     *        nullptr fetches LOB columns through a truncating string buffer.
+     * @param fetchBatchRows Rows fetched per server round trip (array fetch size).
      *
      * Automatically describes columns and sets up output buffers for SELECT statements.
      * For non-SELECT statements, hasData() returns false.
      */
-    OracleResultSet(OCIStmt* stmt, OCIError* err, OCIEnv* env);
+    OracleResultSet(OCIStmt* stmt, OCIError* err, OCIEnv* env,
+                    OCISvcCtx* svc = nullptr,
+                    ub4 fetchBatchRows = DEFAULT_FETCH_BATCH_ROWS);
 
     /**
      * @brief Destructor - frees the statement handle if still owned.
@@ -104,6 +127,7 @@ public:
      *
      * After calling fetchRow(), use getValue() to access column data.
      * Continue calling until it returns false to iterate through all rows.
+     * A server round trip happens only once per batch of rows.
      */
     bool fetchRow();
 
@@ -113,9 +137,29 @@ public:
      * @return Null-terminated string value, or nullptr if NULL or invalid index.
      *
      * The returned pointer is valid until the next fetchRow() call.
+     * For LOB columns this reads the entire value; prefer readLob() when
+     * the value can be consumed piece by piece.
      */
     const char* getValue(int col) const;
 
+    /**
+     * @brief Check if a column is fetched through a LOB locator.
+     * @param col Zero-based column index.
+     * @return true for CLOB/BLOB columns when a service context was given.
+     */
+    bool isLob(int col) const;
+
+    /**
+     * @brief Stream a LOB value of the current row in pieces.
+     * @param col Zero-based column index (must satisfy isLob()).
+     * @param sink Called with each piece; raw bytes for BLOBs.
+     * @return true if the whole value was read (or the sink stopped early).
+     *
+     * Uses OCILobRead2 in polling mode, so memory use is bounded by
+     * LOB_CHUNK_BYTES regardless of the LOB size.
+     */
+    bool readLob(int col, const LobSink& sink) const;
+
     /**
      * @brief Check if a column value is NULL.
      * @param col Zero-based column index.
@@ -165,7 +209,7 @@ public:
     std::vector<std::string> getColumnNames() const;
 
     /**
-     * @brief Free the statement handle and reset state.
+     * @brief Release the statement handle and reset state.
      *
      * After calling reset(), the result set cannot be used.
      */
@@ -190,19 +234,38 @@ private:
     /**
      * @brief Allocate output buffers and define OCI output variables.
      *
-     * Sets up buffers for fetching column values as strings.
+     * Sets up buffers for fetching column values as strings, one slot per
+     * row of the fetch batch, and registers the strides with
+     * OCIDefineArrayOfStruct().
      */
     void defineOutputVariables();
 
+    /**
+     * @brief Fetch the next batch of rows into the output buffers.
+     * @return true if at least one row was fetched.
+     */
+    bool fetchBatch();
+
+    /**
+     * @brief Free the LOB locators allocated by defineOutputVariables().
+     */
+    void freeLobLocators();
+
     OCIStmt* m_stmt;      ///< OCI statement handle (owned)
     OCIError* m_err;      ///< OCI error handle (borrowed)
     OCIEnv* m_env;        ///< OCI environment handle (borrowed)
+    OCISvcCtx* m_svc;     ///< OCI service context for LOB reads (borrowed)
 
     bool m_hasData = false;     ///< True if SELECT with columns
     bool m_hasError = false;    ///< True if setup failed
     std::string m_errorMsg;     ///< Error message if m_hasError
     int m_fetchedRows = 0;      ///< Count of fetched rows
 
+    ub4 m_batchRows;            ///< Rows per array fetch (after buffer cap)
+    ub4 m_rowsInBatch = 0;      ///< Rows returned by the last array fetch
+    ub4 m_batchRow = 0;         ///< Current row within the batch
+    bool m_lastBatch = false;   ///< True once the server reported OCI_NO_DATA
+
     /**
      * @struct ColumnInfo
      * @brief Metadata and buffer for a single result column.
@@ -213,12 +276,18 @@ private:
         ub4 size;               ///< Maximum data size in bytes
         sb2 precision;          ///< Numeric precision
         sb1 scale;              ///< Numeric scale
-        std::vector<char> data; ///< Output buffer for fetched value
-        sb2 indicator;          ///< NULL indicator (-1 = NULL)
-        ub2 returnLen;          ///< Actual length of fetched value
+        ub4 bufSize = 0;        ///< Bytes per value slot in data
+        std::vector<char> data; ///< Output buffer, bufSize bytes per batch row
+        std::vector<sb2> indicator;  ///< NULL indicators per batch row (-1 = NULL)
+        std::vector<ub2> returnLen;  ///< Actual value lengths per batch row
         OCIDefine* define = nullptr;  ///< OCI define handle for this column
+        std::vector<OCILobLocator*> locators;  ///< LOB locators per batch row (LOB columns)
+        mutable std::string lobValue;          ///< getValue() copy of the current LOB
+        mutable int lobValueRow = -1;          ///< Row number lobValue was read for
     };
 
+    mutable std::vector<char> m_lobBuffer;  ///< Piece buffer for readLob()
+
     std::vector<ColumnInfo> m_columns;  ///< Column metadata and buffers
     bool m_columnsDescribed = false;    ///< True after describeColumns()
 };
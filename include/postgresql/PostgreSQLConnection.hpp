@@ -12,6 +12,7 @@
 
 #include <libpq-fe.h>
 #include <string>
+#include <string_view>
 #include <cstdint>
 
 namespace sqlfuse {
@@ -119,14 +120,49 @@ public:
      * @param sql SQL statement with $1, $2, etc. placeholders.
      * @param paramValues Array of parameter value strings.
      * @param nParams Number of parameters.
+     * @param resultFormat 0 for text results (default), 1 for binary results.
      * @return PGresult* handle (caller must PQclear() when done).
      *
      * Parameterized queries prevent SQL injection by separating
      * SQL structure from data values. Use this for user-provided data.
+     * Binary results carry values in network byte order and must be
+     * decoded by type OID (see PostgreSQLFormatConverter::appendBinaryValue).
      */
     PGresult* executeParams(const std::string& sql,
                             const char* const* paramValues,
-                            int nParams);
+                            int nParams,
+                            int resultFormat = 0);
+
+    /**
+     * @brief Start a COPY ... FROM STDIN.
+     * @param sql The COPY statement.
+     * @return true once the server waits for data (PGRES_COPY_IN); on
+     *         failure check error().
+     *
+     * Follow with putCopyData() for each chunk and finish with endCopy().
+     */
+    bool beginCopy(const std::string& sql);
+
+    /**
+     * @brief Send the next chunk of COPY data.
+     * @param data Bytes in the format named by the COPY statement; chunks
+     *        need not end on a row boundary.
+     * @return true on success, false on error (check error()).
+     *
+     * Wraps PQputCopyData() on a blocking connection.
+     */
+    bool putCopyData(std::string_view data);
+
+    /**
+     * @brief Finish or abort a COPY started with beginCopy().
+     * @param abortMessage nullptr to finish; otherwise the COPY fails with
+     *        this message and nothing is loaded.
+     * @return The COPY's PGresult* (caller must PQclear()); PGRES_COMMAND_OK
+     *         on success, with the row count in PQcmdTuples().
+     *
+     * Drains any further results so the connection is idle again.
+     */
+    PGresult* endCopy(const char* abortMessage = nullptr);
 
     /**
      * @brief Get the last error message.
@@ -11,7 +11,9 @@
  */
 
 #include "FormatConverter.hpp"
+#include "InsertBatcher.hpp"
 #include "PostgreSQLResultSet.hpp"
+#include "ResultBatch.hpp"
 #include <libpq-fe.h>
 
 namespace sqlfuse {
@@ -92,6 +94,36 @@ public:
     static std::string rowToJSON(PGresult* result, int row,
                                  const JSONOptions& options = JSONOptions{});
 
+    // ----- Result Batches -----
+
+    /**
+     * @brief Get the column names of a result.
+     * @param result PostgreSQL result handle.
+     * @return Column names in order, for constructing a ResultBatch.
+     */
+    static std::vector<std::string> columnNames(PGresult* result);
+
+    /**
+     * @brief Append rows to a batch until it is full or the result is exhausted.
+     * @param result PostgreSQL result handle.
+     * @param nextRow Index of the next row to append; advanced past the rows taken.
+     * @param batch Batch with one column per result field.
+     * @return true if at least one row is in the batch.
+     */
+    static bool fillBatch(PGresult* result, int& nextRow, ResultBatch& batch);
+
+    /**
+     * @brief Append one row of a result to a batch.
+     * @param result PostgreSQL result handle.
+     * @param row Zero-based row index.
+     * @param batch Batch with one column per result field.
+     *
+     * Text-format numeric columns keep the server's text; boolean becomes
+     * true/false. Binary-format integers and booleans are decoded natively,
+     * everything else through appendBinaryValue().
+     */
+    static void appendRow(PGresult* result, int row, ResultBatch& batch);
+
     // ----- SQL Statement Generation -----
 
     /**
@@ -107,6 +139,22 @@ public:
                                    const RowData& row,
                                    bool escape = true);
 
+    /**
+     * @brief Describe a multi-row INSERT for InsertBatcher.
+     * @param table Table name.
+     * @param columns Column names, in value order.
+     * @return Syntax for INSERT INTO "table" ("a", "b") VALUES (...), (...)
+     */
+    static InsertSyntax insertSyntax(const std::string& table,
+                                     const std::vector<std::string>& columns);
+
+    /**
+     * @brief Append a value as a quoted PostgreSQL string literal.
+     * @param sql Statement being built.
+     * @param value Raw value (single quotes doubled; values containing backslashes use the E'' form).
+     */
+    static void appendLiteral(std::string& sql, std::string_view value);
+
     /**
      * @brief Build an UPDATE SQL statement with PostgreSQL-specific escaping.
      * @param table Table name.
@@ -124,6 +172,24 @@ public:
                                    const std::string& pkValue,
                                    bool escape = true);
 
+    /**
+     * @brief Build a single-statement upsert with PostgreSQL-specific escaping.
+     * @param table Table name.
+     * @param row Map of column names to values; must include pkColumn.
+     * @param pkColumn Primary key column name (the conflict target).
+     * @param escape If true, escape string values (default: true).
+     * @return INSERT ... ON CONFLICT (pk) DO UPDATE statement.
+     *
+     * Inserts the row, or updates every column but the primary key if the
+     * key exists. Example output:
+     * INSERT INTO "t" ("id", "name") VALUES ('1', 'a')
+     * ON CONFLICT ("id") DO UPDATE SET "name" = EXCLUDED."name"
+     */
+    static std::string buildUpsert(const std::string& table,
+                                   const RowData& row,
+                                   const std::string& pkColumn,
+                                   bool escape = true);
+
     /**
      * @brief Build a DELETE SQL statement with PostgreSQL-specific escaping.
      * @param table Table name.
@@ -185,6 +251,62 @@ public:
      * @return true if the type is BOOL (Oid 16).
      */
     static bool isBooleanType(Oid type);
+
+    // ----- Binary Result Format -----
+
+    /**
+     * @brief Check if a type Oid has a client-side binary decoder.
+     * @param type The Oid to check.
+     * @return true for int2/4/8, float4/8, numeric, bool, date, timestamp,
+     *         uuid, bytea and the text-like types (text, varchar, bpchar,
+     *         name, json) whose binary form is the text itself.
+     *
+     * Types without a decoder must be cast to text before a query is run
+     * with resultFormat = 1 (see buildBinarySelect()).
+     */
+    static bool isBinaryDecodable(Oid type);
+
+    /**
+     * @brief Check that every column of a result has a binary decoder.
+     * @param result Result whose column type Oids are checked.
+     * @return true if isBinaryDecodable() accepts every column type.
+     */
+    static bool isBinaryDecodable(PGresult* result);
+
+    /**
+     * @brief Build the select list that makes a query safe to execute in
+     *        binary result format.
+     * @param description Any result of the query (typically run with zero
+     *        rows), used only for its column names and type Oids.
+     * @return Select list of the query's columns, with every column that
+     *         isBinaryDecodable() rejects cast to text.
+     */
+    static std::string buildBinaryColumns(PGresult* description);
+
+    /**
+     * @brief Put the given columns in place of a query's "SELECT *".
+     * @param columns Select list from buildBinaryColumns().
+     * @param sql The original statement, starting with "SELECT * ".
+     * @return The statement selecting columns, or empty if sql does not
+     *         start with "SELECT * ".
+     *
+     * A column cast to text keeps its name, so an ORDER BY of sql that
+     * must sort by the column itself has to qualify it with the table.
+     */
+    static std::string buildBinarySelect(const std::string& columns, const std::string& sql);
+
+    /**
+     * @brief Append the text rendering of a binary-format value.
+     * @param out Output buffer to append to.
+     * @param type Column type Oid from PQftype().
+     * @param data Value bytes from PQgetvalue() (network byte order).
+     * @param length Value length from PQgetlength().
+     *
+     * The output matches what the server sends in text format with default
+     * settings (DateStyle ISO, bytea_output hex), so CSV output is the same
+     * in both modes. Unknown types are appended as raw bytes.
+     */
+    static void appendBinaryValue(std::string& out, Oid type, const char* data, int length);
 };
 
 }  // namespace sqlfuse
@@ -78,6 +78,25 @@ protected:
      */
     std::string generateTableJSON() override;
 
+    /**
+     * @brief Find split points in the primary key for a parallel export.
+     * @param pkColumn Primary key column.
+     * @return MIN/MAX and LIMIT ... OFFSET lookups on the key index.
+     */
+    KeySource exportKeySource(const std::string& pkColumn) override;
+
+    /**
+     * @brief Fetch and render one key range of a parallel table export.
+     * @param pkColumn Primary key column.
+     * @param range Keys to export and the range's row limit.
+     * @param json Render JSON instead of CSV.
+     * @param header Include the CSV header row.
+     * @return The range's rows in key order.
+     * @throws std::runtime_error if the query fails.
+     */
+    std::string renderKeyRange(const std::string& pkColumn, const KeyRange& range,
+                               bool json, bool header) override;
+
     /**
      * @brief Generate JSON content for a single row.
      * @return JSON object for the row identified by m_path.row_id.
@@ -107,27 +126,79 @@ protected:
     // ----- Write operation handlers -----
 
     /**
-     * @brief Handle writes to table data files (bulk insert).
-     * @return 0 on success, negative errno on failure.
+     * @brief Open the transaction that loads a table write (bulk insert).
+     * @param columns Columns named by the written data.
+     * @return Stream sending the rows, CSV or JSON alike, re-encoded as CSV
+     *         through one COPY ... FROM STDIN (FORMAT csv) kept open across
+     *         writes, or with batched multi-row INSERTs when
+     *         DataConfig::pg_copy_writes is off.
      *
-     * Parses the write buffer as CSV or JSON and inserts all rows.
+     * Used for buffered writes and for writes loaded as they arrive. With
+     * DataConfig::pg_copy_upsert the rows are copied into a temporary
+     * staging table and merged with INSERT ... SELECT ... ON CONFLICT (pk)
+     * DO UPDATE, all in one transaction. A replacing write is staged the
+     * same way and moved in with DELETE and INSERT ... SELECT at commit,
+     * so the table is locked only for that final copy; readers keep their
+     * snapshot of the old rows, and foreign keys and triggers apply.
      */
-    int handleTableWrite() override;
+    std::unique_ptr<TableWriteStream> openTableWriteStream(
+        const std::vector<std::string>& columns) override;
 
     /**
      * @brief Handle writes to individual row files (insert/update).
      * @return 0 on success, negative errno on failure.
      *
-     * If the row exists (by primary key), updates it; otherwise inserts.
+     * The file name is the primary key value. One INSERT ... ON CONFLICT
+     * (pk) DO UPDATE inserts the row or updates the written columns,
+     * whatever the key's type.
      */
     int handleRowWrite() override;
 
+    /**
+     * @brief Build the upsert that saves a written row file.
+     * @param sql Receives the statement.
+     * @return 0 on success, negative errno if the row cannot be saved.
+     */
+    int rowWriteStatement(std::string& sql) override;
+
+    /**
+     * @brief Open a write-behind group transaction on a pooled connection.
+     * @return Function acquiring the connection for each group.
+     */
+    WriteBehindQueue::OpenSession writeSession() override;
+
+    /**
+     * @brief Apply a diff-based table write (DataConfig::diff_table_writes).
+     * @param diff Rows to delete, update and insert.
+     * @param pkColumn Primary key column the diff is keyed on.
+     * @return 0 on success, negative errno on failure.
+     *
+     * Runs one DELETE, UPDATE or INSERT per changed row inside one transaction;
+     * any failure rolls the whole write back.
+     */
+    int applyTableDiff(const TableDiff& diff, const std::string& pkColumn) override;
+
 private:
     /**
      * @brief Get the PostgreSQL connection pool from the schema manager.
      * @return Pointer to PostgreSQLConnectionPool, or nullptr if wrong type.
      */
     PostgreSQLConnectionPool* getPool();
+
+    /**
+     * @brief Run a data SELECT, in binary result format when enabled.
+     * @param conn Connection to run the query on.
+     * @param sql The SELECT statement.
+     * @return PGresult* handle (caller must PQclear() when done).
+     *
+     * With DataConfig::pg_binary_results set, the query is executed with
+     * resultFormat = 1. If a result has columns without a binary decoder,
+     * the table is remembered (Schema TTL) and its queries from then on
+     * are described by a zero-row run and have those columns cast to text
+     * in place of the "SELECT *" (see buildBinarySelect()). Otherwise this
+     * is conn.execute(sql).
+     */
+    PGresult* executeSelect(PostgreSQLConnection& conn, const std::string& sql);
 };
 
 }  // namespace sqlfuse
@@ -13,9 +13,23 @@
 #include <sqlite3.h>
 #include <string>
 #include <cstdint>
+#include <list>
+#include <unordered_map>
 
 namespace sqlfuse {
 
+/**
+ * @struct SQLiteOptions
+ * @brief Open mode and tuning applied to an SQLite connection.
+ */
+struct SQLiteOptions {
+    bool read_only = false;             ///< Open with SQLITE_OPEN_READONLY
+    size_t statement_cache_size = 32;   ///< Prepared statements kept by prepareCached()
+    size_t mmap_size = 0;               ///< PRAGMA mmap_size in bytes (0 = leave default)
+    size_t cache_size_kb = 0;           ///< PRAGMA cache_size in KiB (0 = leave default)
+    bool wal = false;                   ///< Set PRAGMA journal_mode=WAL (writer only)
+};
+
 /**
  * @class SQLiteConnection
  * @brief RAII wrapper for an SQLite database file connection.
@@ -41,20 +55,30 @@ namespace sqlfuse {
  *   }
  * @endcode
  *
+ * Statement Cache:
+ * prepareCached() keeps compiled statements in a per-connection LRU keyed
+ * by SQL text. A cached statement is handed out reset with its bindings
+ * cleared, and goes back into the cache through releaseCached() (which
+ * SQLiteResultSet does automatically when constructed with the connection).
+ *
  * Thread Safety:
  * - SQLite supports multiple concurrent readers but only one writer
- * - Connections are opened with SQLITE_OPEN_FULLMUTEX for serialized mode
+ * - A connection and its statement cache must be used by one thread at a time
  */
 class SQLiteConnection {
 public:
+    static constexpr int BUSY_TIMEOUT_MS = 5000;  ///< Wait for locks before SQLITE_BUSY
+
     /**
      * @brief Open a connection to an SQLite database file.
      * @param dbPath Path to the SQLite database file.
+     * @param options Open mode and PRAGMA tuning.
      *
-     * Creates the database file if it doesn't exist.
-     * Uses SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX.
+     * Read-write connections use SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE and
+     * create the database file if it doesn't exist. Read-only connections use
+     * SQLITE_OPEN_READONLY.
      */
-    explicit SQLiteConnection(const std::string& dbPath);
+    explicit SQLiteConnection(const std::string& dbPath, const SQLiteOptions& options = {});
 
     /**
      * @brief Destructor - closes the database connection.
@@ -101,6 +125,31 @@ public:
      */
     sqlite3_stmt* prepare(const std::string& sql);
 
+    /**
+     * @brief Get a prepared statement from the connection's statement cache.
+     * @param sql The SQL statement (also the cache key).
+     * @return sqlite3_stmt* ready for binding, or nullptr on error.
+     *
+     * On a cache hit the statement is taken out of the cache, so it is never
+     * handed out twice. Return it with releaseCached() instead of finalizing
+     * it, typically via SQLiteResultSet(stmt, &conn).
+     */
+    sqlite3_stmt* prepareCached(const std::string& sql);
+
+    /**
+     * @brief Return a statement obtained from prepareCached().
+     * @param stmt Statement to reset and put back into the cache.
+     *
+     * The least recently used statement is finalized when the cache is full.
+     */
+    void releaseCached(sqlite3_stmt* stmt);
+
+    /**
+     * @brief Check if the connection was opened read-only.
+     * @return true for SQLITE_OPEN_READONLY connections.
+     */
+    bool isReadOnly() const { return m_options.read_only; }
+
     /**
      * @brief Get the last SQLite error message.
      * @return Error description from the last failed operation.
@@ -126,8 +175,24 @@ public:
     int changes() const;
 
 private:
+    /**
+     * @brief Apply the PRAGMA settings from m_options.
+     */
+    void applyOptions();
+
+    /**
+     * @brief Finalize every statement in the cache.
+     */
+    void clearStatementCache();
+
     sqlite3* m_db = nullptr;  ///< SQLite database handle
     std::string m_path;       ///< Path to database file
+    SQLiteOptions m_options;  ///< Open mode and tuning
+
+    /// Cached statements, most recently used first
+    std::list<std::pair<std::string, sqlite3_stmt*>> m_stmtLru;
+    /// SQL text to position in m_stmtLru
+    std::unordered_map<std::string, std::list<std::pair<std::string, sqlite3_stmt*>>::iterator> m_stmtIndex;
 };
 
 }  // namespace sqlfuse
@@ -6,8 +6,8 @@
  *
  * This file implements a connection pool for SQLite databases. While SQLite
  * doesn't strictly require connection pooling (since it's a file-based
- * database), pooling can still help by reusing prepared statements and
- * avoiding repeated file opens.
+ * database), pooling still pays off by keeping each connection's prepared
+ * statement cache and page cache warm and avoiding repeated file opens.
  */
 
 #include "ConnectionPool.hpp"
@@ -25,30 +25,51 @@ namespace sqlfuse {
  *
  * Unlike server-based databases, SQLite doesn't have a server to connect to.
  * Each "connection" is simply an open file handle. This pool manages multiple
- * open handles to the same database file, which can be useful for:
- * - Concurrent read operations (SQLite supports multiple readers)
- * - Reusing prepared statement caches
- * - Consistent interface with other database backends
+ * open handles to the same database file:
+ * - Read connections, opened SQLITE_OPEN_READONLY with mmap and page cache
+ *   tuning, handed out by acquire()
+ * - One read-write connection, handed out exclusively by acquireWriter()
+ *
+ * Connections are returned to the pool automatically when the Handle
+ * returned by acquire()/acquireWriter() goes out of scope.
  *
  * SQLite Concurrency Notes:
  * - Multiple connections can read simultaneously
- * - Only one connection can write at a time (database-level locking)
- * - WAL mode allows concurrent reads during writes
+ * - Only one connection can write at a time (database-level locking), so
+ *   writes are serialized on the single writer instead of contending for
+ *   the file lock
+ * - WAL mode (SQLiteOptions::wal) allows concurrent reads during writes
  *
  * @see SQLiteConnection for individual connection usage
  */
 class SQLiteConnectionPool : public ConnectionPool {
 public:
+    /**
+     * @brief unique_ptr deleter that returns a connection to its pool.
+     */
+    struct ConnectionReturner {
+        SQLiteConnectionPool* pool = nullptr;  ///< Owning pool
+        bool writer = false;                   ///< True for the writer connection
+
+        void operator()(SQLiteConnection* conn) const;
+    };
+
+    /// Pooled connection; returned to the pool when destroyed.
+    using Handle = std::unique_ptr<SQLiteConnection, ConnectionReturner>;
+
     /**
      * @brief Create a new SQLite connection pool.
      * @param dbPath Path to the SQLite database file.
-     * @param poolSize Number of connections to maintain (default: 5).
+     * @param poolSize Number of read connections to maintain (default: 5).
+     * @param options Tuning applied to every connection; read_only is
+     *        set per connection by the pool.
      *
-     * Creates the database file if it doesn't exist.
-     * For SQLite, a smaller pool size is often sufficient since
+     * Opens the writer first, which creates the database file if it doesn't
+     * exist. For SQLite, a smaller pool size is often sufficient since
      * connections are just file handles.
      */
-    explicit SQLiteConnectionPool(const std::string& dbPath, size_t poolSize = 5);
+    explicit SQLiteConnectionPool(const std::string& dbPath, size_t poolSize = 5,
+                                  const SQLiteOptions& options = {});
 
     /**
      * @brief Destructor - closes all connections.
@@ -56,21 +77,34 @@ public:
     ~SQLiteConnectionPool() override;
 
     /**
-     * @brief Acquire a connection from the pool.
-     * @return unique_ptr to SQLiteConnection, or nullptr if pool is exhausted.
+     * @brief Acquire a read-only connection from the pool.
+     * @return Handle to a read-only SQLiteConnection.
      *
      * Note: Unlike MySQL/PostgreSQL pools, this doesn't block - it creates
-     * a new connection if the pool is empty (up to poolSize limit).
+     * a new connection if the pool is empty. Connections beyond poolSize
+     * are closed instead of being pooled when released.
      */
-    std::unique_ptr<SQLiteConnection> acquire();
+    Handle acquire();
 
     /**
-     * @brief Return a connection to the pool.
-     * @param conn Connection to return.
+     * @brief Acquire the read-write connection, waiting while it is in use.
+     * @return Handle to the writer, or nullptr if the database could not be
+     *         opened for writing or the writer stayed busy for
+     *         SQLiteConnection::BUSY_TIMEOUT_MS (see isWritable()).
      *
-     * The connection is added back to the available pool for reuse.
+     * Use this for every INSERT, UPDATE, DELETE and DDL statement. The wait
+     * is bounded because a handle can be held across FUSE calls (a table
+     * file loaded as it is written), and a process writing another file of
+     * the same database meanwhile would otherwise wait for itself.
+     */
+    Handle acquireWriter();
+
+    /**
+     * @brief Check whether the database was opened for writing.
+     * @return false if acquireWriter() can never succeed; a nullptr from
+     *         acquireWriter() on a writable pool means the writer was busy.
      */
-    void release(std::unique_ptr<SQLiteConnection> conn);
+    bool isWritable() const { return m_writable; }
 
     // ----- ConnectionPool interface implementation -----
 
@@ -112,11 +146,26 @@ public:
         const DataConfig& config) override;
 
 private:
+    /**
+     * @brief Put a read connection back into m_available, or close it.
+     */
+    void release(SQLiteConnection* conn);
+
+    /**
+     * @brief Open a new read-only connection.
+     */
+    std::unique_ptr<SQLiteConnection> createReader();
+
     std::string m_dbPath;         ///< Path to SQLite database file
     size_t m_poolSize;            ///< Maximum pool size
+    SQLiteOptions m_options;      ///< Connection tuning
     std::vector<std::unique_ptr<SQLiteConnection>> m_available;  ///< Idle connections
     std::atomic<size_t> m_createdCount{0};   ///< Total connections created
     mutable std::mutex m_mutex;   ///< Protects m_available
+
+    std::unique_ptr<SQLiteConnection> m_writer;  ///< The only read-write connection
+    std::timed_mutex m_writerMutex;  ///< Held while the writer is handed out
+    bool m_writable = false;      ///< The writer opened successfully
 };
 
 }  // namespace sqlfuse
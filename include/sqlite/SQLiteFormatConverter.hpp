@@ -5,11 +5,15 @@
  * @brief SQLite-specific data format conversion utilities for SQL-FUSE.
  *
  * This file provides format conversion functionality tailored for SQLite databases,
- * including SQL statement generation with proper SQLite-specific escaping
- * (double quotes for identifiers, doubled single quotes for string literals).
+ * including conversion of SQLite result sets to CSV and JSON, and SQL statement
+ * generation with proper SQLite-specific escaping (double quotes for identifiers,
+ * doubled single quotes for string literals).
  */
 
 #include "FormatConverter.hpp"
+#include "InsertBatcher.hpp"
+#include "ResultBatch.hpp"
+#include "SQLiteResultSet.hpp"
 
 namespace sqlfuse {
 
@@ -17,8 +21,9 @@ namespace sqlfuse {
  * @class SQLiteFormatConverter
  * @brief Static utility class for SQLite-specific data format conversions.
  *
- * Provides methods to generate SQL statements (INSERT, UPDATE, DELETE) with
- * proper SQLite escaping. All methods are static as the class maintains no state.
+ * Provides methods to convert SQLite result sets to CSV and JSON formats, and
+ * to generate SQL statements (INSERT, UPDATE, DELETE) with proper SQLite
+ * escaping. All methods are static as the class maintains no state.
  *
  * Key SQLite-specific behaviors:
  * - Identifiers are escaped with double quotes ("identifier")
@@ -29,12 +34,65 @@ namespace sqlfuse {
  * - Identifiers: Double quotes with internal quotes doubled ("table""name")
  * - Strings: Single quotes with internal quotes doubled ('value''s')
  *
+ * Result rows are copied into a ResultBatch by dispatching on
+ * sqlite3_column_type() for every cell, then rendered by the shared batch
+ * writers:
+ * - INTEGER and REAL values keep their native type and become JSON numbers
+ * - TEXT values are copied straight from sqlite3_column_text()
+ * - BLOB values are written raw to CSV and as uppercase hex strings to JSON
+ *
  * Inherits from FormatConverter to access shared CSV field escaping utilities.
- * Note: Unlike MySQL/Oracle converters, this doesn't have toCSV/toJSON methods
- * since SQLite result sets use a different API (sqlite3_stmt vs result sets).
  */
 class SQLiteFormatConverter : public FormatConverter {
 public:
+    /**
+     * @brief Convert all remaining rows of a result set to CSV.
+     * @param result Result set positioned before its first row.
+     * @param options CSV formatting options.
+     * @return CSV formatted string with optional header row.
+     *
+     * NULL values are written as empty fields.
+     */
+    static std::string toCSV(SQLiteResultSet& result, const CSVOptions& options = CSVOptions{});
+
+    /**
+     * @brief Convert all remaining rows of a result set to a JSON array.
+     * @param result Result set positioned before its first row.
+     * @param options JSON formatting options.
+     * @return JSON array of objects, keys in column order.
+     */
+    static std::string toJSON(SQLiteResultSet& result, const JSONOptions& options = JSONOptions{});
+
+    /**
+     * @brief Convert the current row of a result set to a JSON object.
+     * @param result Result set positioned on a row (after a successful step()).
+     * @param options JSON formatting options.
+     * @return JSON object string.
+     */
+    static std::string rowToJSON(SQLiteResultSet& result, const JSONOptions& options = JSONOptions{});
+
+    /**
+     * @brief Get the column names of a result set.
+     * @param result Prepared result set.
+     * @return Column names in order, for constructing a ResultBatch.
+     */
+    static std::vector<std::string> columnNames(SQLiteResultSet& result);
+
+    /**
+     * @brief Step the result set and append rows until the batch is full.
+     * @param result Result set to read from.
+     * @param batch Batch with one column per result column.
+     * @return true if at least one row is in the batch.
+     */
+    static bool fillBatch(SQLiteResultSet& result, ResultBatch& batch);
+
+    /**
+     * @brief Append the current row of a result set to a batch.
+     * @param result Result set positioned on a row.
+     * @param batch Batch with one column per result column.
+     */
+    static void appendRow(SQLiteResultSet& result, ResultBatch& batch);
+
     /**
      * @brief Build an INSERT SQL statement with SQLite-specific escaping.
      * @param table Table name.
@@ -48,6 +106,24 @@ public:
                                    const RowData& row,
                                    bool escape = true);
 
+    /**
+     * @brief Describe a multi-row INSERT for InsertBatcher.
+     * @param table Table name.
+     * @param columns Column names, in value order.
+     * @param replace Use INSERT OR REPLACE (rows with an existing key replace it).
+     * @return Syntax for INSERT INTO "table" ("a", "b") VALUES (...), (...)
+     */
+    static InsertSyntax insertSyntax(const std::string& table,
+                                     const std::vector<std::string>& columns,
+                                     bool replace = false);
+
+    /**
+     * @brief Append a value as a quoted SQLite string literal.
+     * @param sql Statement being built.
+     * @param value Raw value (single quotes doubled).
+     */
+    static void appendLiteral(std::string& sql, std::string_view value);
+
     /**
      * @brief Build an UPDATE SQL statement with SQLite-specific escaping.
      * @param table Table name.
@@ -65,6 +141,24 @@ public:
                                    const std::string& pkValue,
                                    bool escape = true);
 
+    /**
+     * @brief Build a single-statement upsert with SQLite-specific escaping.
+     * @param table Table name.
+     * @param row Map of column names to values; must include pkColumn.
+     * @param pkColumn Primary key column name (the conflict target).
+     * @param escape If true, escape string values (default: true).
+     * @return INSERT ... ON CONFLICT (pk) DO UPDATE statement.
+     *
+     * Inserts the row, or updates every column but the primary key if the
+     * key exists. Example output:
+     * INSERT INTO "t" ("id", "name") VALUES ('1', 'a')
+     * ON CONFLICT ("id") DO UPDATE SET "name" = excluded."name"
+     */
+    static std::string buildUpsert(const std::string& table,
+                                   const RowData& row,
+                                   const std::string& pkColumn,
+                                   bool escape = true);
+
     /**
      * @brief Build a DELETE SQL statement with SQLite-specific escaping.
      * @param table Table name.
@@ -14,13 +14,16 @@
 
 namespace sqlfuse {
 
+class SQLiteConnection;
+
 /**
  * @class SQLiteResultSet
  * @brief RAII wrapper for SQLite prepared statement results.
  *
  * SQLiteResultSet manages a sqlite3_stmt handle, providing methods to
  * step through rows and access column values. The statement is automatically
- * finalized when the wrapper is destroyed.
+ * finalized when the wrapper is destroyed, or returned to the connection's
+ * statement cache if it came from SQLiteConnection::prepareCached().
  *
  * SQLite Result Iteration:
  * Unlike MySQL/PostgreSQL which separate query execution from result retrieval,
@@ -46,8 +49,10 @@ public:
     /**
      * @brief Construct a result set wrapper.
      * @param stmt sqlite3_stmt handle to manage (takes ownership), or nullptr.
+     * @param cache Connection whose statement cache @p stmt came from; the
+     *        statement is returned there instead of being finalized.
      */
-    explicit SQLiteResultSet(sqlite3_stmt* stmt = nullptr);
+    explicit SQLiteResultSet(sqlite3_stmt* stmt = nullptr, SQLiteConnection* cache = nullptr);
 
     /**
      * @brief Destructor - finalizes the statement if still owned.
@@ -73,12 +78,22 @@ public:
      */
     operator bool() const { return m_stmt != nullptr; }
 
+    /**
+     * @brief Bind a text value to a statement parameter.
+     * @param index One-based parameter index.
+     * @param value Value to bind (copied by SQLite).
+     * @return true on success.
+     */
+    bool bind(int index, const std::string& value);
+
     /**
      * @brief Step to the next row.
      * @return true if a row is available, false if done or error.
      *
      * Returns true when sqlite3_step() returns SQLITE_ROW.
-     * Returns false when SQLITE_DONE (no more rows) or on error.
+     * Returns false when SQLITE_DONE (no more rows) or on error, and keeps
+     * returning false until reset() so a finished statement is never
+     * restarted by accident.
      */
     bool step();
 
@@ -130,12 +145,15 @@ public:
      * @brief Finalize the statement and release resources.
      *
      * After calling finalize(), the statement cannot be used.
-     * This is called automatically by the destructor.
+     * This is called automatically by the destructor. Cached statements
+     * are handed back to their connection instead of being finalized.
      */
     void finalize();
 
 private:
-    sqlite3_stmt* m_stmt;  ///< SQLite prepared statement handle (owned)
+    sqlite3_stmt* m_stmt;        ///< SQLite prepared statement handle (owned)
+    SQLiteConnection* m_cache;   ///< Statement cache owner, or nullptr
+    bool m_done = false;         ///< Set once step() has returned false
 };
 
 }  // namespace sqlfuse
@@ -0,0 +1,241 @@
+#include "BatchWriter.hpp"
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace sqlfuse {
+
+// ============================================================================
+// CSV
+// ============================================================================
+
+size_t findCSVSpecialScalar(std::string_view data, char delimiter, char quote) {
+    for (size_t i = 0; i < data.size(); ++i) {
+        char c = data[i];
+        if (c == delimiter || c == quote || c == '\n' || c == '\r') return i;
+    }
+    return data.size();
+}
+
+size_t findCSVSpecial(std::string_view data, char delimiter, char quote) {
+    [[maybe_unused]] const char* p = data.data();
+    [[maybe_unused]] size_t size = data.size();
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i d32 = _mm256_set1_epi8(delimiter);
+    const __m256i q32 = _mm256_set1_epi8(quote);
+    const __m256i lf32 = _mm256_set1_epi8('\n');
+    const __m256i cr32 = _mm256_set1_epi8('\r');
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, d32), _mm256_cmpeq_epi8(v, q32)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lf32), _mm256_cmpeq_epi8(v, cr32)));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+        if (mask) return i + std::countr_zero(mask);
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i d16 = _mm_set1_epi8(delimiter);
+    const __m128i q16 = _mm_set1_epi8(quote);
+    const __m128i lf16 = _mm_set1_epi8('\n');
+    const __m128i cr16 = _mm_set1_epi8('\r');
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, d16), _mm_cmpeq_epi8(v, q16)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, lf16), _mm_cmpeq_epi8(v, cr16)));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hit));
+        if (mask) return i + std::countr_zero(mask);
+    }
+#endif
+
+    // Tail shorter than a vector, or no SIMD on this target
+    return i + findCSVSpecialScalar(data.substr(i), delimiter, quote);
+}
+
+CSVBatchWriter::CSVBatchWriter(const CSVOptions& options) : m_options(options) {}
+
+void CSVBatchWriter::writeField(std::string_view value, std::string& out) const {
+    size_t special = findCSVSpecial(value, m_options.delimiter, m_options.quote);
+    if (special == value.size() && !m_options.quoteAll) {
+        out.append(value);
+        return;
+    }
+
+    // Everything before the first special byte needs no escaping; from there
+    // on, memchr finds the quotes to double
+    out += m_options.quote;
+    const char* run = value.data();
+    const char* end = value.data() + value.size();
+    const char* p = run + special;
+    while (p < end &&
+           (p = static_cast<const char*>(std::memchr(p, m_options.quote, end - p)))) {
+        out.append(run, p - run + 1);
+        out += m_options.quote;  // Double the quote
+        run = ++p;
+    }
+    out.append(run, end - run);
+    out += m_options.quote;
+}
+
+void CSVBatchWriter::writeHeader(const ResultBatch& batch, std::string& out) const {
+    if (!m_options.includeHeader) return;
+
+    for (size_t col = 0; col < batch.columnCount(); ++col) {
+        if (col > 0) out += m_options.delimiter;
+        writeField(batch.column(col).name(), out);
+    }
+    out += m_options.lineEnding;
+}
+
+void CSVBatchWriter::writeRows(const ResultBatch& batch, std::string& out) const {
+    std::string number;
+    size_t rows = batch.rowCount();
+
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < batch.columnCount(); ++col) {
+            if (col > 0) out += m_options.delimiter;
+
+            const ResultColumn& column = batch.column(col);
+            if (column.isNull(row)) continue;
+
+            switch (column.type()) {
+                case ValueType::Integer:
+                    number.clear();
+                    appendInteger(number, column.integer(row));
+                    writeField(number, out);
+                    break;
+                case ValueType::Real:
+                    number.clear();
+                    appendReal(number, column.real(row));
+                    writeField(number, out);
+                    break;
+                case ValueType::Null:
+                    break;
+                default:
+                    writeField(column.bytes(row), out);
+            }
+        }
+        out += m_options.lineEnding;
+    }
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+JSONBatchWriter::JSONBatchWriter(std::string& out, const JSONOptions& options)
+    : m_options(options), m_json(out, options) {}
+
+void JSONBatchWriter::prepareKeys(const ResultBatch& batch) {
+    if (m_keys.size() == batch.columnCount()) return;
+
+    m_keys.clear();
+    for (size_t col = 0; col < batch.columnCount(); ++col) {
+        std::string key;
+        JSONWriter::appendString(key, batch.column(col).name());
+        m_keys.push_back(std::move(key));
+    }
+}
+
+void JSONBatchWriter::begin() {
+    if (!m_options.arrayFormat) {
+        m_json.beginObject();
+        m_json.key("rows");
+    }
+    m_json.beginArray();
+}
+
+void JSONBatchWriter::writeRows(const ResultBatch& batch) {
+    for (size_t row = 0; row < batch.rowCount(); ++row) {
+        writeObject(batch, row);
+    }
+}
+
+void JSONBatchWriter::finish() {
+    m_json.endArray();
+    if (!m_options.arrayFormat) {
+        m_json.endObject();
+    }
+}
+
+void JSONBatchWriter::writeObject(const ResultBatch& batch, size_t row) {
+    prepareKeys(batch);
+
+    m_json.beginObject();
+    for (size_t col = 0; col < batch.columnCount(); ++col) {
+        const ResultColumn& column = batch.column(col);
+        bool null = column.isNull(row);
+        if (null && !m_options.includeNull) continue;
+
+        m_json.rawKey(m_keys[col]);
+        if (null) {
+            m_json.null();
+        } else {
+            writeValue(column, row);
+        }
+    }
+    m_json.endObject();
+}
+
+void JSONBatchWriter::writeValue(const ResultColumn& column, size_t row) {
+    switch (column.type()) {
+        case ValueType::Integer:
+            m_json.integer(column.integer(row));
+            return;
+        case ValueType::Real:
+            m_json.real(column.real(row));
+            return;
+        case ValueType::Number:
+            m_json.number(column.bytes(row));
+            return;
+        case ValueType::Boolean:
+            m_json.boolean(column.boolean(row));
+            return;
+        case ValueType::Binary:
+            m_json.binary(column.bytes(row));
+            return;
+        case ValueType::Mixed:
+            writeMixedValue(column.cellType(row), column.bytes(row));
+            return;
+        case ValueType::Null:
+            m_json.null();
+            return;
+        default:
+            m_json.string(column.bytes(row));
+    }
+}
+
+// A value of a Mixed column is its exact text; render it as the type it had
+// when appended, the same as in a column of that type
+void JSONBatchWriter::writeMixedValue(ValueType type, std::string_view text) {
+    switch (type) {
+        case ValueType::Integer:
+        case ValueType::Number:
+            m_json.number(text);
+            return;
+        case ValueType::Real: {
+            double value = 0;
+            std::from_chars(text.data(), text.data() + text.size(), value);
+            m_json.real(value);
+            return;
+        }
+        case ValueType::Boolean:
+            m_json.boolean(text == "t");
+            return;
+        case ValueType::Binary:
+            m_json.binary(text);
+            return;
+        default:
+            m_json.string(text);
+    }
+}
+
+}  // namespace sqlfuse
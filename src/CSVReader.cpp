@@ -0,0 +1,134 @@
+#include "CSVReader.hpp"
+#include "BatchWriter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace sqlfuse {
+
+CSVReader::CSVReader(std::string& data, const CSVOptions& options,
+                     std::vector<std::string> columns)
+    : m_data(data.data()),
+      m_size(data.size()),
+      m_options(options),
+      m_columns(std::move(columns)) {
+    if (m_options.includeHeader && readRecord() && m_columns.empty()) {
+        for (const auto& field : m_fields) {
+            m_columns.emplace_back(field.value_or(std::string_view()));
+        }
+    }
+
+    if (m_columns.empty() && readRecord()) {
+        // No header: size the columns from the first record and keep it as data
+        for (size_t i = 0; i < m_fields.size(); ++i) {
+            m_columns.push_back("col" + std::to_string(i));
+        }
+        m_pending = true;
+    }
+}
+
+bool CSVReader::next() {
+    if (m_pending) {
+        m_pending = false;
+    } else if (!readRecord()) {
+        return false;
+    }
+
+    // Short records are padded with NULLs, extra fields are dropped
+    m_row.assign(m_columns.size(), std::nullopt);
+    std::copy_n(m_fields.begin(), std::min(m_fields.size(), m_row.size()), m_row.begin());
+    return true;
+}
+
+bool CSVReader::readRecord() {
+    m_fields.clear();
+
+    // Skip blank lines
+    while (m_pos < m_size && (m_data[m_pos] == '\n' || m_data[m_pos] == '\r')) {
+        if (m_data[m_pos] == '\r' && m_pos + 1 < m_size && m_data[m_pos + 1] == '\n') {
+            ++m_pos;
+        }
+        ++m_pos;
+        ++m_line;
+    }
+    if (m_pos >= m_size) {
+        return false;
+    }
+    m_recordLine = m_line;
+
+    for (;;) {
+        if (m_pos < m_size && m_data[m_pos] == m_options.quote) {
+            m_fields.emplace_back(readQuoted());
+        } else {
+            std::string_view value = readUnquoted();
+            m_fields.push_back(value.empty() ? FieldView() : FieldView(value));
+        }
+
+        if (m_pos >= m_size) {
+            return true;
+        }
+
+        char c = m_data[m_pos++];
+        if (c == m_options.delimiter) {
+            continue;
+        }
+        if (c == '\r' || c == '\n') {
+            if (c == '\r' && m_pos < m_size && m_data[m_pos] == '\n') {
+                ++m_pos;
+            }
+            ++m_line;
+            return true;
+        }
+        throw std::runtime_error("CSV line " + std::to_string(m_line) +
+                                 ": unexpected character after closing quote");
+    }
+}
+
+std::string_view CSVReader::readUnquoted() {
+    size_t start = m_pos;
+    for (;;) {
+        m_pos += findCSVSpecial(std::string_view(m_data + m_pos, m_size - m_pos),
+                                m_options.delimiter, m_options.quote);
+        // A quote inside an unquoted field has no special meaning
+        if (m_pos < m_size && m_data[m_pos] == m_options.quote) {
+            ++m_pos;
+            continue;
+        }
+        return std::string_view(m_data + start, m_pos - start);
+    }
+}
+
+std::string_view CSVReader::readQuoted() {
+    char* start = m_data + m_pos + 1;  // Past the opening quote
+    char* end = m_data + m_size;
+    char* write = start;
+    char* p = start;
+
+    for (;;) {
+        char* q = static_cast<char*>(std::memchr(p, m_options.quote, end - p));
+        if (!q) {
+            throw std::runtime_error("CSV line " + std::to_string(m_recordLine) +
+                                     ": unterminated quoted field");
+        }
+        m_line += std::count(p, q, '\n');
+
+        // Shift the run left over the quotes collapsed so far
+        if (write != p) {
+            std::memmove(write, p, q - p);
+        }
+        write += q - p;
+
+        if (q + 1 < end && q[1] == m_options.quote) {
+            *write++ = m_options.quote;
+            p = q + 2;
+            continue;
+        }
+        p = q + 1;
+        break;
+    }
+
+    m_pos = p - m_data;
+    return std::string_view(start, write - start);
+}
+
+}  // namespace sqlfuse
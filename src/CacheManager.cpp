@@ -29,6 +29,7 @@ std::optional<std::string> CacheManager::get(const std::string& key) {
         m_stats.currentSize -= it->second.size;
         m_lruList.erase(m_lruMap[key]);
         m_lruMap.erase(key);
+        m_keys.erase(key);
         m_cache.erase(it);
         m_stats.misses++;
         return std::nullopt;
@@ -77,6 +78,7 @@ void CacheManager::put(const std::string& key, std::string data,
     };
 
     m_cache[key] = std::move(entry);
+    m_keys.insert(key);
     m_lruList.push_front(key);
     m_lruMap[key] = m_lruList.begin();
 
@@ -115,6 +117,7 @@ void CacheManager::remove(const std::string& key) {
         m_stats.currentSize -= it->second.size;
         m_lruList.erase(m_lruMap[key]);
         m_lruMap.erase(key);
+        m_keys.erase(key);
         m_cache.erase(it);
         m_stats.entryCount = m_cache.size();
     }
@@ -125,9 +128,21 @@ void CacheManager::invalidate(const std::string& pattern) {
 
     std::vector<std::string> to_remove;
 
-    for (const auto& [key, entry] : m_cache) {
-        if (matchesPattern(key, pattern)) {
-            to_remove.push_back(key);
+    size_t star = pattern.find('*');
+    if (!pattern.empty() && star == pattern.size() - 1) {
+        // A prefix: its keys are adjacent in the ordered index, so the
+        // table invalidation after each row delete is a lookup, not a pass
+        // over the whole cache
+        std::string prefix = pattern.substr(0, star);
+        for (auto it = m_keys.lower_bound(prefix);
+             it != m_keys.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+            to_remove.push_back(*it);
+        }
+    } else {
+        for (const auto& [key, entry] : m_cache) {
+            if (matchesPattern(key, pattern)) {
+                to_remove.push_back(key);
+            }
         }
     }
 
@@ -137,6 +152,7 @@ void CacheManager::invalidate(const std::string& pattern) {
             m_stats.currentSize -= it->second.size;
             m_lruList.erase(m_lruMap[key]);
             m_lruMap.erase(key);
+            m_keys.erase(key);
             m_cache.erase(it);
         }
     }
@@ -168,6 +184,7 @@ void CacheManager::clear() {
     m_cache.clear();
     m_lruList.clear();
     m_lruMap.clear();
+    m_keys.clear();
 
     m_stats.currentSize = 0;
     m_stats.entryCount = 0;
@@ -193,6 +210,7 @@ void CacheManager::pruneExpired() {
             m_stats.currentSize -= it->second.size;
             m_lruList.erase(m_lruMap[key]);
             m_lruMap.erase(key);
+            m_keys.erase(key);
             m_cache.erase(it);
         }
     }
@@ -237,6 +255,7 @@ void CacheManager::evictLRU() {
     }
 
     m_lruMap.erase(key);
+    m_keys.erase(key);
     m_stats.evictions++;
 }
 
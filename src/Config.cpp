@@ -119,6 +119,38 @@ std::optional<Config> Config::loadFromFile(const std::filesystem::path& path) {
                 config.data.include_csv_header = (value == "true" || value == "1");
             else if (key == "default_format")
                 config.data.default_format = value;
+            else if (key == "export_parallelism")
+                config.data.export_parallelism = static_cast<size_t>(std::stoul(value));
+            else if (key == "export_parallel_min_rows")
+                config.data.export_parallel_min_rows = static_cast<size_t>(std::stoul(value));
+            else if (key == "export_offset_index")
+                config.data.export_offset_index = (value == "true" || value == "1");
+            else if (key == "pg_binary_results")
+                config.data.pg_binary_results = (value == "true" || value == "1");
+            else if (key == "fetch_batch_rows")
+                config.data.fetch_batch_rows = static_cast<size_t>(std::stoul(value));
+            else if (key == "insert_batch_rows")
+                config.data.insert_batch_rows = static_cast<size_t>(std::stoul(value));
+            else if (key == "insert_batch_bytes")
+                config.data.insert_batch_bytes = static_cast<size_t>(std::stoul(value));
+            else if (key == "stream_table_writes")
+                config.data.stream_table_writes = (value == "true" || value == "1");
+            else if (key == "diff_table_writes")
+                config.data.diff_table_writes = (value == "true" || value == "1");
+            else if (key == "replace_table_writes")
+                config.data.replace_table_writes = (value == "true" || value == "1");
+            else if (key == "save_on_release")
+                config.data.save_on_release = (value == "true" || value == "1");
+            else if (key == "pg_copy_writes")
+                config.data.pg_copy_writes = (value == "true" || value == "1");
+            else if (key == "pg_copy_upsert")
+                config.data.pg_copy_upsert = (value == "true" || value == "1");
+            else if (key == "oracle_skip_bad_rows")
+                config.data.oracle_skip_bad_rows = (value == "true" || value == "1");
+            else if (key == "mysql_load_data_writes")
+                config.data.mysql_load_data_writes = (value == "true" || value == "1");
+            else if (key == "mysql_on_duplicate")
+                config.data.mysql_on_duplicate = value;
         }
         else if (current_section == "security") {
             if (key == "read_only")
@@ -139,6 +171,28 @@ std::optional<Config> Config::loadFromFile(const std::filesystem::path& path) {
                 config.performance.max_fuse_threads = static_cast<size_t>(std::stoul(value));
             else if (key == "enable_query_cache")
                 config.performance.enable_query_cache = (value == "true" || value == "1");
+            else if (key == "sqlite_statement_cache")
+                config.performance.sqlite_statement_cache = static_cast<size_t>(std::stoul(value));
+            else if (key == "sqlite_mmap_size")
+                config.performance.sqlite_mmap_size = static_cast<size_t>(std::stoull(value));
+            else if (key == "sqlite_cache_size_kb")
+                config.performance.sqlite_cache_size_kb = static_cast<size_t>(std::stoul(value));
+            else if (key == "sqlite_wal")
+                config.performance.sqlite_wal = (value == "true" || value == "1");
+            else if (key == "write_behind")
+                config.performance.write_behind = value;
+            else if (key == "write_behind_window_ms")
+                config.performance.write_behind_window = std::chrono::milliseconds(std::stoi(value));
+            else if (key == "write_behind_max_batch")
+                config.performance.write_behind_max_batch = static_cast<size_t>(std::stoul(value));
+            else if (key == "write_behind_writers")
+                config.performance.write_behind_writers = static_cast<size_t>(std::stoul(value));
+            else if (key == "read_ahead_chunks")
+                config.performance.read_ahead_chunks = static_cast<size_t>(std::stoul(value));
+            else if (key == "read_ahead_threads")
+                config.performance.read_ahead_threads = static_cast<size_t>(std::stoul(value));
+            else if (key == "read_ahead_budget_mb")
+                config.performance.read_ahead_budget_mb = static_cast<size_t>(std::stoul(value));
         }
     }
 
@@ -285,6 +339,25 @@ bool Config::validate() const {
         }
     }
 
+    if (data.diff_table_writes && data.replace_table_writes) {
+        spdlog::error("diff_table_writes and replace_table_writes cannot both be set");
+        return false;
+    }
+
+    if (data.mysql_on_duplicate != "error" && data.mysql_on_duplicate != "replace" &&
+        data.mysql_on_duplicate != "ignore") {
+        spdlog::error("mysql_on_duplicate must be error, replace or ignore: {}",
+                      data.mysql_on_duplicate);
+        return false;
+    }
+
+    if (performance.write_behind != "off" && performance.write_behind != "flush" &&
+        performance.write_behind != "release") {
+        spdlog::error("write_behind must be off, flush or release: {}",
+                      performance.write_behind);
+        return false;
+    }
+
     return true;
 }
 
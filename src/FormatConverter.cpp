@@ -1,228 +1,171 @@
 #include "FormatConverter.hpp"
+#include "BatchWriter.hpp"
+#include "CSVReader.hpp"
+#include "JSONRowReader.hpp"
+#include "ResultBatch.hpp"
 #include <sstream>
 #include <algorithm>
 #include <stdexcept>
 
 namespace sqlfuse {
 
-std::string FormatConverter::toCSV(const std::vector<std::string>& columns,
-                                   const std::vector<std::vector<SqlValue>>& rows,
-                                   const CSVOptions& options) {
-    std::ostringstream out;
+void FormatConverter::writeCSV(ResultBatch& batch, const BatchSource& fill,
+                               const OutputSink& sink, const CSVOptions& options) {
+    CSVBatchWriter writer(options);
+    std::string buffer;
+
+    writer.writeHeader(batch, buffer);
+    batch.clear();
+    while (fill(batch)) {
+        writer.writeRows(batch, buffer);
+        batch.clear();
+        sink(buffer);
+        buffer.clear();
+    }
+    if (!buffer.empty()) sink(buffer);
+}
 
-    // Header
-    if (options.includeHeader) {
-        for (size_t i = 0; i < columns.size(); ++i) {
-            if (i > 0) out << options.delimiter;
-            out << escapeCSVField(columns[i], options);
-        }
-        out << options.lineEnding;
+void FormatConverter::writeJSON(ResultBatch& batch, const BatchSource& fill,
+                                const OutputSink& sink, const JSONOptions& options) {
+    std::string buffer;
+    JSONBatchWriter writer(buffer, options);
+
+    writer.begin();
+    batch.clear();
+    while (fill(batch)) {
+        writer.writeRows(batch);
+        batch.clear();
+        sink(buffer);
+        buffer.clear();
     }
+    writer.finish();
+    sink(buffer);
+}
 
-    // Rows
-    for (const auto& row : rows) {
-        for (size_t i = 0; i < row.size(); ++i) {
-            if (i > 0) out << options.delimiter;
+std::string FormatConverter::toCSV(ResultBatch& batch, const BatchSource& fill,
+                                   const CSVOptions& options) {
+    std::string out;
+    writeCSV(batch, fill, [&out](std::string_view chunk) { out += chunk; }, options);
+    return out;
+}
 
-            if (row[i].has_value()) {
-                out << escapeCSVField(row[i].value(), options);
-            }
-        }
-        out << options.lineEnding;
+std::string FormatConverter::toJSON(ResultBatch& batch, const BatchSource& fill,
+                                    const JSONOptions& options) {
+    std::string out;
+    writeJSON(batch, fill, [&out](std::string_view chunk) { out += chunk; }, options);
+    return out;
+}
+
+std::string FormatConverter::rowToJSON(const ResultBatch& batch, size_t row,
+                                       const JSONOptions& options) {
+    if (row >= batch.rowCount()) {
+        return "{}";
     }
 
-    return out.str();
+    std::string out;
+    JSONBatchWriter writer(out, options);
+    writer.writeObject(batch, row);
+    return out;
 }
 
-std::string FormatConverter::toJSON(const std::vector<std::string>& columns,
-                                    const std::vector<std::vector<SqlValue>>& rows,
-                                    const JSONOptions& options) {
-    json arr = json::array();
+namespace {
 
+// Copy string rows into a batch of Text columns
+ResultBatch textBatch(const std::vector<std::string>& columns,
+                      const std::vector<std::vector<SqlValue>>& rows) {
+    ResultBatch batch(columns, std::max<size_t>(rows.size(), 1));
     for (const auto& row : rows) {
-        json obj = json::object();
-
-        for (size_t i = 0; i < std::min(columns.size(), row.size()); ++i) {
-            if (row[i].has_value()) {
-                obj[columns[i]] = row[i].value();
-            } else if (options.includeNull) {
-                obj[columns[i]] = nullptr;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i < row.size() && row[i].has_value()) {
+                batch.column(i).appendText(row[i].value());
+            } else {
+                batch.column(i).appendNull();
             }
         }
-
-        arr.push_back(std::move(obj));
     }
+    return batch;
+}
 
-    if (options.arrayFormat) {
-        return options.pretty ? arr.dump(options.indent) : arr.dump();
-    } else {
-        json wrapper = json::object();
-        wrapper["rows"] = std::move(arr);
-        return options.pretty ? wrapper.dump(options.indent) : wrapper.dump();
-    }
+}  // namespace
+
+std::string FormatConverter::toCSV(const std::vector<std::string>& columns,
+                                   const std::vector<std::vector<SqlValue>>& rows,
+                                   const CSVOptions& options) {
+    ResultBatch batch = textBatch(columns, rows);
+    CSVBatchWriter writer(options);
+    std::string out;
+    writer.writeHeader(batch, out);
+    writer.writeRows(batch, out);
+    return out;
+}
+
+std::string FormatConverter::toJSON(const std::vector<std::string>& columns,
+                                    const std::vector<std::vector<SqlValue>>& rows,
+                                    const JSONOptions& options) {
+    ResultBatch batch = textBatch(columns, rows);
+    std::string out;
+    JSONBatchWriter writer(out, options);
+    writer.begin();
+    writer.writeRows(batch);
+    writer.finish();
+    return out;
 }
 
 std::string FormatConverter::rowToJSON(const std::vector<std::string>& columns,
                                        const std::vector<SqlValue>& values,
                                        const JSONOptions& options) {
-    json obj = json::object();
-
-    for (size_t i = 0; i < std::min(columns.size(), values.size()); ++i) {
-        if (values[i].has_value()) {
-            obj[columns[i]] = values[i].value();
-        } else if (options.includeNull) {
-            obj[columns[i]] = nullptr;
-        }
-    }
-
-    return options.pretty ? obj.dump(options.indent) : obj.dump();
+    return rowToJSON(textBatch(columns, {values}), 0, options);
 }
 
 std::string FormatConverter::rowToJSON(const RowData& row, const JSONOptions& options) {
-    json obj = json::object();
-
+    std::vector<std::string> columns;
+    std::vector<SqlValue> values;
     for (const auto& [key, value] : row) {
-        if (value.has_value()) {
-            obj[key] = value.value();
-        } else if (options.includeNull) {
-            obj[key] = nullptr;
-        }
+        columns.push_back(key);
+        values.push_back(value);
     }
-
-    return options.pretty ? obj.dump(options.indent) : obj.dump();
+    return rowToJSON(columns, values, options);
 }
 
-std::vector<RowData> FormatConverter::parseCSV(const std::string& data,
-                                                const CSVOptions& options) {
-    std::vector<RowData> result;
-
-    if (data.empty()) {
-        return result;
-    }
-
-    std::istringstream stream(data);
-    std::string line;
-    std::vector<std::string> headers;
-    bool firstLine = true;
-
-    while (std::getline(stream, line)) {
-        // Remove trailing \r if present
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-
-        if (line.empty()) continue;
+namespace {
 
-        auto fields = splitCSVLine(line, options);
-
-        if (firstLine && options.includeHeader) {
-            headers = std::move(fields);
-            firstLine = false;
-            continue;
-        }
-
-        if (headers.empty()) {
-            // No headers - use column indices
-            for (size_t i = 0; i < fields.size(); ++i) {
-                headers.push_back("col" + std::to_string(i));
-            }
-            firstLine = false;
-        }
+std::vector<RowData> readRows(RowReader& reader) {
+    std::vector<RowData> result;
+    const auto& columns = reader.columns();
 
+    while (reader.next()) {
         RowData row;
-        for (size_t i = 0; i < std::min(headers.size(), fields.size()); ++i) {
-            if (fields[i].empty()) {
-                row[headers[i]] = std::nullopt;
-            } else {
-                row[headers[i]] = fields[i];
-            }
+        const auto& fields = reader.row();
+        for (size_t i = 0; i < columns.size(); ++i) {
+            row[columns[i]] = fields[i] ? SqlValue(std::string(*fields[i])) : std::nullopt;
         }
-
         result.push_back(std::move(row));
     }
 
     return result;
 }
 
+}  // namespace
+
 std::vector<RowData> FormatConverter::parseCSV(const std::string& data,
-                                                const std::vector<std::string>& columns,
                                                 const CSVOptions& options) {
-    std::vector<RowData> result;
-
-    if (data.empty()) {
-        return result;
-    }
-
-    std::istringstream stream(data);
-    std::string line;
-
-    while (std::getline(stream, line)) {
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-
-        if (line.empty()) continue;
-
-        auto fields = splitCSVLine(line, options);
-
-        RowData row;
-        for (size_t i = 0; i < std::min(columns.size(), fields.size()); ++i) {
-            if (fields[i].empty()) {
-                row[columns[i]] = std::nullopt;
-            } else {
-                row[columns[i]] = fields[i];
-            }
-        }
-
-        result.push_back(std::move(row));
-    }
+    std::string buffer = data;  // CSVReader collapses quotes in place
+    CSVReader reader(buffer, options);
+    return readRows(reader);
+}
 
-    return result;
+std::vector<RowData> FormatConverter::parseCSV(const std::string& data,
+                                                const std::vector<std::string>& columns,
+                                                const CSVOptions& options) {
+    std::string buffer = data;
+    CSVReader reader(buffer, options, columns);
+    return readRows(reader);
 }
 
 std::vector<RowData> FormatConverter::parseJSON(const std::string& data) {
-    std::vector<RowData> result;
-
-    if (data.empty()) {
-        return result;
-    }
-
-    try {
-        json parsed = json::parse(data);
-
-        json rows_array;
-        if (parsed.is_array()) {
-            rows_array = parsed;
-        } else if (parsed.is_object() && parsed.contains("rows")) {
-            rows_array = parsed["rows"];
-        } else if (parsed.is_object()) {
-            // Single object - treat as one row
-            rows_array = json::array({parsed});
-        } else {
-            return result;
-        }
-
-        for (const auto& item : rows_array) {
-            if (!item.is_object()) continue;
-
-            RowData row;
-            for (auto& [key, value] : item.items()) {
-                if (value.is_null()) {
-                    row[key] = std::nullopt;
-                } else if (value.is_string()) {
-                    row[key] = value.get<std::string>();
-                } else {
-                    row[key] = value.dump();
-                }
-            }
-
-            result.push_back(std::move(row));
-        }
-    } catch (const json::exception& e) {
-        throw std::runtime_error("JSON parse error: " + std::string(e.what()));
-    }
-
-    return result;
+    std::string buffer = data;  // JSONRowReader unescapes strings in place
+    JSONRowReader reader(buffer);
+    return readRows(reader);
 }
 
 RowData FormatConverter::parseJSONRow(const std::string& data) {
@@ -276,34 +219,8 @@ std::string FormatConverter::escapeSQL(const std::string& value) {
 
 std::string FormatConverter::escapeCSVField(const std::string& field,
                                              const CSVOptions& options) {
-    bool needs_quoting = options.quoteAll;
-
-    if (!needs_quoting) {
-        for (char c : field) {
-            if (c == options.delimiter || c == options.quote ||
-                c == '\n' || c == '\r') {
-                needs_quoting = true;
-                break;
-            }
-        }
-    }
-
-    if (!needs_quoting) {
-        return field;
-    }
-
     std::string result;
-    result.reserve(field.size() + 2);
-    result += options.quote;
-
-    for (char c : field) {
-        if (c == options.quote) {
-            result += options.quote;  // Double the quote
-        }
-        result += c;
-    }
-
-    result += options.quote;
+    CSVBatchWriter(options).writeField(field, result);
     return result;
 }
 
@@ -0,0 +1,98 @@
+#include "InsertBatcher.hpp"
+#include <algorithm>
+
+namespace sqlfuse {
+
+InsertBatcher::InsertBatcher(InsertSyntax syntax, AppendLiteral literal, InsertSession session,
+                             const InsertLimits& limits)
+    : m_syntax(std::move(syntax)),
+      m_literal(std::move(literal)),
+      m_session(std::move(session)),
+      m_limits(limits) {
+    m_limits.maxRows = std::max<size_t>(m_limits.maxRows, 1);
+}
+
+bool InsertBatcher::load(RowReader& reader) {
+    return begin() && append(reader) && finish();
+}
+
+bool InsertBatcher::begin() {
+    if (!m_session.begin()) {
+        m_error = m_session.error();
+        return false;
+    }
+    m_active = true;
+    return true;
+}
+
+bool InsertBatcher::append(RowReader& reader) {
+    try {
+        while (reader.next()) {
+            appendRow(reader.row());
+            if (m_pending >= m_limits.maxRows || m_sql.size() >= m_limits.maxBytes) {
+                if (!flush()) return fail();
+            }
+        }
+    } catch (...) {
+        abort();
+        throw;
+    }
+    return true;
+}
+
+bool InsertBatcher::finish() {
+    if (!flush() || !m_session.commit()) return fail();
+    m_active = false;
+    return true;
+}
+
+void InsertBatcher::abort() {
+    if (m_active) {
+        m_session.rollback();
+        m_active = false;
+    }
+    m_pending = 0;
+    m_sql.clear();
+}
+
+void InsertBatcher::appendRow(const std::vector<FieldView>& fields) {
+    if (m_pending == 0) {
+        m_sql = m_syntax.head;
+    } else {
+        m_sql += m_syntax.separator;
+    }
+    m_sql += m_syntax.rowPrefix;
+
+    m_sql += '(';
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i > 0) m_sql += ", ";
+        if (fields[i]) {
+            m_literal(m_sql, *fields[i]);
+        } else {
+            m_sql += "NULL";
+        }
+    }
+    m_sql += ')';
+    ++m_pending;
+}
+
+bool InsertBatcher::flush() {
+    if (m_pending == 0) return true;
+
+    m_sql += m_syntax.tail;
+    if (!m_session.execute(m_sql)) return false;
+
+    m_rows += m_pending;
+    ++m_statements;
+    m_pending = 0;
+    m_sql.clear();
+    return true;
+}
+
+bool InsertBatcher::fail() {
+    m_error = m_session.error();
+    abort();
+    return false;
+}
+
+}  // namespace sqlfuse
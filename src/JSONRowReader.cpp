@@ -0,0 +1,330 @@
+#include "JSONRowReader.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace sqlfuse {
+
+namespace {
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Write a code point as UTF-8; returns the number of bytes written
+size_t encodeUTF8(uint32_t cp, char* out) {
+    if (cp < 0x80) {
+        out[0] = static_cast<char>(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (cp >> 18));
+    out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+}  // namespace
+
+JSONRowReader::JSONRowReader(std::string& data)
+    : m_data(data.data()), m_size(data.size()) {
+    start();
+}
+
+JSONRowReader::JSONRowReader(std::string& data, std::vector<std::string> columns)
+    : m_data(data.data()), m_size(data.size()), m_columns(std::move(columns)) {
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        m_index.emplace(m_columns[i], i);
+    }
+    start();
+}
+
+void JSONRowReader::start() {
+    skipWhitespace();
+    if (m_pos >= m_size) return;
+
+    if (m_data[m_pos] == '[') {
+        ++m_pos;
+        m_mode = Mode::Array;
+    } else if (m_data[m_pos] == '{') {
+        // {"rows": [...]} streams the array; any other object is one row
+        size_t start = m_pos;
+        ++m_pos;
+        skipWhitespace();
+        constexpr std::string_view rowsKey = "\"rows\"";
+        if (std::string_view(m_data + m_pos, m_size - m_pos).starts_with(rowsKey)) {
+            m_pos += rowsKey.size();
+            skipWhitespace();
+            if (consume(':')) {
+                skipWhitespace();
+                if (consume('[')) {
+                    m_mode = Mode::Array;
+                }
+            }
+        }
+        if (m_mode != Mode::Array) {
+            m_pos = start;
+            m_mode = Mode::Object;
+        }
+    } else {
+        fail("expected an array or an object");
+    }
+
+    // Read the first row now so the columns are known up front
+    m_pending = next();
+}
+
+bool JSONRowReader::next() {
+    if (m_pending) {
+        m_pending = false;
+        return true;
+    }
+
+    while (m_mode != Mode::Done) {
+        skipWhitespace();
+        if (m_mode == Mode::Object) {
+            readObject();
+            m_mode = Mode::Done;
+            return true;
+        }
+
+        if (consume(']')) {
+            m_mode = Mode::Done;
+            return false;
+        }
+        if (m_items > 0) {
+            if (!consume(',')) fail("expected ',' or ']'");
+            skipWhitespace();
+        }
+        if (m_pos >= m_size) fail("unterminated array");
+        ++m_items;
+
+        if (m_data[m_pos] == '{') {
+            readObject();
+            return true;
+        }
+        // Non-object array items carry no row
+        skipValue();
+    }
+    return false;
+}
+
+void JSONRowReader::readObject() {
+    bool defining = m_columns.empty();
+    ++m_rowNumber;
+    ++m_pos;  // '{'
+
+    if (!defining) {
+        m_row.assign(m_columns.size(), std::nullopt);
+    } else {
+        m_row.clear();
+    }
+
+    skipWhitespace();
+    if (consume('}')) return;
+
+    for (size_t position = 0;; ++position) {
+        skipWhitespace();
+        if (m_pos >= m_size || m_data[m_pos] != '"') fail("expected a key");
+        std::string_view key = readString();
+        skipWhitespace();
+        if (!consume(':')) fail("expected ':'");
+        skipWhitespace();
+        FieldView value = readValue();
+
+        if (defining) {
+            auto [it, inserted] = m_index.emplace(std::string(key), m_columns.size());
+            if (inserted) {
+                m_columns.emplace_back(key);
+                m_row.push_back(value);
+            } else {
+                m_row[it->second] = value;  // Duplicate key: last one wins
+            }
+        } else {
+            m_row[columnIndex(key, position)] = value;
+        }
+
+        skipWhitespace();
+        if (consume('}')) return;
+        if (!consume(',')) fail("expected ',' or '}'");
+    }
+}
+
+size_t JSONRowReader::columnIndex(std::string_view key, size_t position) const {
+    // Rows usually repeat the first object's key order
+    if (position < m_columns.size() && m_columns[position] == key) {
+        return position;
+    }
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        throw std::runtime_error("JSON row " + std::to_string(m_rowNumber) + ": column '" +
+                                 std::string(key) + "' is not in the first row");
+    }
+    return it->second;
+}
+
+FieldView JSONRowReader::readValue() {
+    if (m_pos >= m_size) fail("expected a value");
+
+    char c = m_data[m_pos];
+    if (c == '"') {
+        return readString();
+    }
+
+    size_t start = m_pos;
+    if (c == '{' || c == '[') {
+        skipValue();
+        return std::string_view(m_data + start, m_pos - start);
+    }
+
+    // Literal: number, true, false or null
+    while (m_pos < m_size) {
+        char t = m_data[m_pos];
+        if (t == ',' || t == '}' || t == ']' || t == ' ' || t == '\t' || t == '\n' || t == '\r') {
+            break;
+        }
+        ++m_pos;
+    }
+    std::string_view literal(m_data + start, m_pos - start);
+    if (literal == "null") return std::nullopt;
+    if (literal.empty()) fail("expected a value");
+    if (literal != "true" && literal != "false" &&
+        !(literal[0] == '-' || (literal[0] >= '0' && literal[0] <= '9'))) {
+        fail("invalid literal");
+    }
+    return literal;
+}
+
+std::string_view JSONRowReader::readString() {
+    char* start = m_data + m_pos + 1;  // Past the opening quote
+    char* end = m_data + m_size;
+    char* read = start;
+    char* write = start;
+
+    for (;;) {
+        // Copy the run up to the next quote or backslash
+        char* stop = read;
+        while (stop < end && *stop != '"' && *stop != '\\') ++stop;
+        if (stop == end) fail("unterminated string");
+        if (write != read) std::memmove(write, read, stop - read);
+        write += stop - read;
+        read = stop;
+
+        if (*read == '"') break;
+
+        // Escape sequence; the decoded form is never longer than the escape
+        if (read + 1 >= end) fail("unterminated string");
+        char e = read[1];
+        read += 2;
+        switch (e) {
+            case '"':  *write++ = '"'; break;
+            case '\\': *write++ = '\\'; break;
+            case '/':  *write++ = '/'; break;
+            case 'b':  *write++ = '\b'; break;
+            case 'f':  *write++ = '\f'; break;
+            case 'n':  *write++ = '\n'; break;
+            case 'r':  *write++ = '\r'; break;
+            case 't':  *write++ = '\t'; break;
+            case 'u': {
+                auto hex4 = [&](const char* p) -> int32_t {
+                    if (end - p < 4) return -1;
+                    int32_t v = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        int d = hexDigit(p[i]);
+                        if (d < 0) return -1;
+                        v = (v << 4) | d;
+                    }
+                    return v;
+                };
+                int32_t cp = hex4(read);
+                if (cp < 0) fail("invalid \\u escape");
+                read += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF && end - read >= 6 &&
+                    read[0] == '\\' && read[1] == 'u') {
+                    int32_t low = hex4(read + 2);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        read += 6;
+                    }
+                }
+                write += encodeUTF8(static_cast<uint32_t>(cp), write);
+                break;
+            }
+            default:
+                fail("invalid escape");
+        }
+    }
+
+    m_pos = (read + 1) - m_data;
+    return std::string_view(start, write - start);
+}
+
+void JSONRowReader::skipValue() {
+    if (m_pos >= m_size) fail("expected a value");
+    if (m_data[m_pos] == '"') {
+        readString();
+        return;
+    }
+    if (m_data[m_pos] != '{' && m_data[m_pos] != '[') {
+        readValue();
+        return;
+    }
+
+    // Nested container: track depth, stepping over strings
+    size_t depth = 0;
+    while (m_pos < m_size) {
+        char c = m_data[m_pos];
+        if (c == '"') {
+            // Skip without unescaping so the raw text stays intact
+            ++m_pos;
+            while (m_pos < m_size && m_data[m_pos] != '"') {
+                m_pos += m_data[m_pos] == '\\' ? 2 : 1;
+            }
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                ++m_pos;
+                return;
+            }
+        }
+        ++m_pos;
+    }
+    fail("unterminated object or array");
+}
+
+void JSONRowReader::skipWhitespace() {
+    while (m_pos < m_size) {
+        char c = m_data[m_pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        ++m_pos;
+    }
+}
+
+bool JSONRowReader::consume(char c) {
+    if (m_pos < m_size && m_data[m_pos] == c) {
+        ++m_pos;
+        return true;
+    }
+    return false;
+}
+
+void JSONRowReader::fail(const char* what) const {
+    throw std::runtime_error("JSON parse error at offset " + std::to_string(m_pos) + ": " + what);
+}
+
+}  // namespace sqlfuse
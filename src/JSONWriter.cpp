@@ -0,0 +1,185 @@
+#include "JSONWriter.hpp"
+#include "ResultBatch.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace sqlfuse {
+
+namespace {
+
+// JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isJSONNumber(std::string_view text) {
+    size_t i = 0;
+    auto digits = [&]() {
+        size_t start = i;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9') ++i;
+        return i - start;
+    };
+
+    if (i < text.size() && text[i] == '-') ++i;
+    if (i < text.size() && text[i] == '0') {
+        ++i;
+    } else if (digits() == 0) {
+        return false;
+    }
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        if (digits() == 0) return false;
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        ++i;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-')) ++i;
+        if (digits() == 0) return false;
+    }
+    return i == text.size();
+}
+
+}  // namespace
+
+JSONWriter::JSONWriter(std::string& out, const JSONOptions& options)
+    : m_out(out), m_pretty(options.pretty), m_indent(options.indent) {}
+
+void JSONWriter::appendString(std::string& out, std::string_view value) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    size_t run = 0;  // Start of the pending run of bytes that need no escaping
+    for (size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.append(value.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0x0F];
+        }
+    }
+    out.append(value.data() + run, value.size() - run);
+    out += '"';
+}
+
+// Comma and line break before a value, unless it follows its member name
+void JSONWriter::beforeValue() {
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_first.empty()) return;
+
+    if (!m_first.back()) m_out += ',';
+    m_first.back() = false;
+    if (m_pretty) {
+        m_out += '\n';
+        m_out.append(static_cast<size_t>(m_indent) * m_first.size(), ' ');
+    }
+}
+
+void JSONWriter::open(char bracket) {
+    beforeValue();
+    m_out += bracket;
+    m_first.push_back(true);
+}
+
+void JSONWriter::close(char bracket) {
+    bool empty = m_first.back();
+    m_first.pop_back();
+    if (!empty && m_pretty) {
+        m_out += '\n';
+        m_out.append(static_cast<size_t>(m_indent) * m_first.size(), ' ');
+    }
+    m_out += bracket;
+}
+
+void JSONWriter::beginObject() { open('{'); }
+void JSONWriter::endObject() { close('}'); }
+void JSONWriter::beginArray() { open('['); }
+void JSONWriter::endArray() { close(']'); }
+
+void JSONWriter::key(std::string_view name) {
+    beforeValue();
+    appendString(m_out, name);
+    m_out += m_pretty ? ": " : ":";
+    m_afterKey = true;
+}
+
+void JSONWriter::rawKey(std::string_view quoted) {
+    beforeValue();
+    m_out += quoted;
+    m_out += m_pretty ? ": " : ":";
+    m_afterKey = true;
+}
+
+void JSONWriter::string(std::string_view value) {
+    beforeValue();
+    appendString(m_out, value);
+}
+
+void JSONWriter::integer(int64_t value) {
+    beforeValue();
+    appendInteger(m_out, value);
+}
+
+void JSONWriter::real(double value) {
+    beforeValue();
+    if (std::isfinite(value)) {
+        appendReal(m_out, value);
+    } else {
+        m_out += "null";  // JSON has no Inf/NaN
+    }
+}
+
+void JSONWriter::number(std::string_view text) {
+    beforeValue();
+    if (isJSONNumber(text)) {
+        m_out += text;
+        return;
+    }
+
+    // Forms like ".5" or "007": normalize; NaN/Infinity stay strings
+    const char* last = text.data() + text.size();
+    int64_t integer = 0;
+    auto [intEnd, intEc] = std::from_chars(text.data(), last, integer);
+    if (intEc == std::errc() && intEnd == last) {
+        appendInteger(m_out, integer);
+        return;
+    }
+    double value = 0;
+    auto [end, ec] = std::from_chars(text.data(), last, value);
+    if (ec == std::errc() && end == last && std::isfinite(value)) {
+        appendReal(m_out, value);
+    } else {
+        appendString(m_out, text);
+    }
+}
+
+void JSONWriter::boolean(bool value) {
+    beforeValue();
+    m_out += value ? "true" : "false";
+}
+
+void JSONWriter::binary(std::string_view data) {
+    static const char hex[] = "0123456789ABCDEF";
+    beforeValue();
+    m_out += '"';
+    for (unsigned char c : data) {
+        m_out += hex[c >> 4];
+        m_out += hex[c & 0x0F];
+    }
+    m_out += '"';
+}
+
+void JSONWriter::null() {
+    beforeValue();
+    m_out += "null";
+}
+
+}  // namespace sqlfuse
@@ -0,0 +1,350 @@
+#include "ParallelExport.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace sqlfuse {
+
+namespace {
+
+std::optional<long long> parseInteger(const std::string& text) {
+    long long value = 0;
+    const char* last = text.data() + text.size();
+    auto [end, ec] = std::from_chars(text.data(), last, value);
+    if (ec != std::errc() || end != last || text.empty()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Equal spans between `min` and `max`, the outer ranges left open so keys
+// added beyond either end since are still exported
+std::vector<KeyRange> splitIntegers(long long min, long long max, size_t parts) {
+    // Unsigned difference cannot overflow even for the full range of keys
+    unsigned long long span = static_cast<unsigned long long>(max) -
+                              static_cast<unsigned long long>(min);
+    unsigned long long count = parts;
+    unsigned long long width = span / count;
+    unsigned long long rest = span % count;
+    if (span < count) {
+        count = span + 1;  // One key per range
+        width = 1;
+        rest = 0;
+    }
+
+    std::vector<KeyRange> ranges;
+    std::optional<std::string> from;
+    std::optional<unsigned long long> previous;
+    for (unsigned long long i = 1; i < count; ++i) {
+        unsigned long long offset = width * i + rest * i / count;
+        if (offset == 0 || (previous && offset <= *previous)) {
+            continue;
+        }
+        previous = offset;
+        long long boundary = static_cast<long long>(static_cast<unsigned long long>(min) + offset);
+        std::string key = std::to_string(boundary);
+        ranges.push_back(KeyRange{from, key, 0});
+        from = std::move(key);
+    }
+    ranges.push_back(KeyRange{from, std::nullopt, 0});
+    return ranges;
+}
+
+}  // namespace
+
+bool isIntegerKeyType(const std::string& type) {
+    // The base type name: "int(11) unsigned" -> "int"
+    std::string name;
+    for (char c : type) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) break;
+        name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    static const char* const integers[] = {"tinyint",  "smallint", "mediumint", "int",
+                                           "integer",  "bigint",   "int2",      "int4",
+                                           "int8",     "serial",   "smallserial",
+                                           "bigserial"};
+    return std::find(std::begin(integers), std::end(integers), name) != std::end(integers);
+}
+
+std::vector<KeyRange> planKeyRanges(const KeySource& source, size_t parts, size_t rows,
+                                    size_t limit) {
+    KeyRange whole{std::nullopt, std::nullopt, limit};
+    if (parts < 2) {
+        return {whole};
+    }
+
+    if (limit == 0 && source.bounds) {
+        auto bounds = source.bounds();
+        if (!bounds) {
+            return {whole};
+        }
+        auto min = parseInteger(bounds->first);
+        auto max = parseInteger(bounds->second);
+        if (min && max && *min < *max) {
+            return splitIntegers(*min, *max, parts);
+        }
+    }
+
+    if (!source.keyAt || rows < 2) {
+        return {whole};
+    }
+
+    // Each boundary is found from the one before, so the index is walked
+    // once rather than from the start for every boundary
+    size_t step = (rows + parts - 1) / parts;
+    std::vector<KeyRange> ranges;
+    std::optional<std::string> from;
+    size_t covered = 0;
+    while (ranges.size() + 1 < parts && covered + step < rows) {
+        auto key = source.keyAt(from, step);
+        if (!key) {
+            break;
+        }
+        ranges.push_back(KeyRange{from, *key, limit > 0 ? step : 0});
+        from = std::move(key);
+        covered += step;
+    }
+    ranges.push_back(KeyRange{from, std::nullopt, limit > 0 ? limit - covered : 0});
+    return ranges;
+}
+
+std::vector<std::string> renderRanges(
+    const std::vector<KeyRange>& ranges, size_t workers,
+    const std::function<std::string(const KeyRange& range, size_t index)>& render) {
+    std::vector<std::string> chunks(ranges.size());
+    size_t threads = std::min(std::max<size_t>(workers, 1), ranges.size());
+    if (threads <= 1) {
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            chunks[i] = render(ranges[i], i);
+        }
+        return chunks;
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto work = [&] {
+        while (!failed) {
+            size_t i = next++;
+            if (i >= ranges.size()) {
+                return;
+            }
+            try {
+                chunks[i] = render(ranges[i], i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return chunks;
+}
+
+ExportJoiner::ExportJoiner(bool json, bool pretty, std::string trailer)
+    : m_json(json)
+    , m_pretty(pretty)
+    , m_trailer(std::move(trailer)) {
+}
+
+std::string ExportJoiner::next(const std::string& chunk) {
+    if (!m_json) {
+        return chunk;
+    }
+
+    std::string out;
+    if (!m_started) {
+        out += '[';
+        m_started = true;
+    }
+
+    // A pretty array is "[\n  a,\n  b\n]" and a compact one "[a,b]": the
+    // elements are what lies between the brackets, less the newline before
+    // the closing one
+    if (chunk.size() < 2 || chunk.front() != '[' || chunk.back() != ']') {
+        return out;
+    }
+    size_t end = chunk.size() - 1;
+    if (m_pretty && end > 1 && chunk[end - 1] == '\n') {
+        --end;
+    }
+    if (end <= 1) {
+        return out;  // Empty array
+    }
+    if (m_any) {
+        out += ',';
+    }
+    out.append(chunk, 1, end - 1);
+    m_any = true;
+    return out;
+}
+
+std::string ExportJoiner::finish() {
+    std::string out;
+    if (m_json) {
+        if (!m_started) {
+            out += '[';
+        }
+        if (m_any && m_pretty) {
+            out += '\n';
+        }
+        out += ']';
+    }
+    return out + m_trailer;
+}
+
+void ExportJoiner::resumeAt(size_t offset) {
+    // A JSON file opens with its bracket; any byte past it is an element
+    m_started = offset > 0;
+    m_any = offset > 1;
+}
+
+std::string joinJSONArrays(const std::vector<std::string>& chunks, bool pretty) {
+    ExportJoiner joiner(true, pretty);
+    std::string out;
+    for (const auto& chunk : chunks) {
+        out += joiner.next(chunk);
+    }
+    return out + joiner.finish();
+}
+
+// Numbers and keys separated by spaces; a key is "-" when unset, or its
+// length, a colon and its bytes, so keys may hold any character
+namespace {
+
+void writeKey(std::string& out, const std::optional<std::string>& key) {
+    if (!key) {
+        out += '-';
+        return;
+    }
+    out += std::to_string(key->size());
+    out += ':';
+    out += *key;
+}
+
+class IndexReader {
+public:
+    explicit IndexReader(const std::string& text) : m_text(text) {}
+
+    bool number(size_t& value) {
+        const char* first = m_text.data() + m_pos;
+        const char* last = m_text.data() + m_text.size();
+        auto [end, ec] = std::from_chars(first, last, value);
+        if (ec != std::errc()) {
+            return false;
+        }
+        m_pos = static_cast<size_t>(end - m_text.data());
+        return separator();
+    }
+
+    bool key(std::optional<std::string>& value) {
+        if (m_pos < m_text.size() && m_text[m_pos] == '-') {
+            ++m_pos;
+            value.reset();
+            return separator();
+        }
+        size_t length = 0;
+        const char* first = m_text.data() + m_pos;
+        const char* last = m_text.data() + m_text.size();
+        auto [end, ec] = std::from_chars(first, last, length);
+        if (ec != std::errc() || end == last || *end != ':') {
+            return false;
+        }
+        m_pos = static_cast<size_t>(end - m_text.data()) + 1;
+        if (length > m_text.size() - m_pos) {
+            return false;
+        }
+        value = m_text.substr(m_pos, length);
+        m_pos += length;
+        return separator();
+    }
+
+    bool done() const { return m_pos == m_text.size(); }
+
+private:
+    // Skip the space after a field; the last field has none
+    bool separator() {
+        if (m_pos == m_text.size()) {
+            return true;
+        }
+        if (m_text[m_pos] != ' ') {
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+
+    const std::string& m_text;
+    size_t m_pos = 0;
+};
+
+}  // namespace
+
+std::string ExportIndex::serialize() const {
+    std::string out = std::to_string(size) + ' ' + std::to_string(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        out += ' ' + std::to_string(offsets[i]) + ' ' + std::to_string(ranges[i].limit) + ' ';
+        writeKey(out, ranges[i].lower);
+        out += ' ';
+        writeKey(out, ranges[i].upper);
+    }
+    out += ' ' + std::to_string(offsets.back());
+    return out;
+}
+
+std::optional<ExportIndex> ExportIndex::parse(const std::string& text) {
+    IndexReader reader(text);
+    ExportIndex index;
+    size_t count = 0;
+    if (!reader.number(index.size) || !reader.number(count)) {
+        return std::nullopt;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t offset = 0;
+        KeyRange range;
+        if (!reader.number(offset) || !reader.number(range.limit) ||
+            !reader.key(range.lower) || !reader.key(range.upper)) {
+            return std::nullopt;
+        }
+        index.offsets.push_back(offset);
+        index.ranges.push_back(std::move(range));
+    }
+    size_t ending = 0;
+    if (!reader.number(ending) || !reader.done()) {
+        return std::nullopt;
+    }
+    index.offsets.push_back(ending);
+
+    // Pieces follow one another and end within the file
+    if (index.ranges.empty() || index.offsets.front() != 0 ||
+        !std::is_sorted(index.offsets.begin(), index.offsets.end()) ||
+        index.offsets.back() > index.size) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+}  // namespace sqlfuse
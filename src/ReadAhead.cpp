@@ -0,0 +1,336 @@
+#include "ReadAhead.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace sqlfuse {
+
+ReadAheadExecutor::ReadAheadExecutor(size_t threads, size_t window, size_t budget)
+    : m_window(window)
+    , m_budget(budget) {
+    for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i) {
+        m_threads.emplace_back(&ReadAheadExecutor::run, this);
+    }
+}
+
+ReadAheadExecutor::~ReadAheadExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_tasks.clear();
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool ReadAheadExecutor::reserve(size_t bytes) {
+    size_t held = m_held;
+    do {
+        if (held + bytes > m_budget) {
+            return false;
+        }
+    } while (!m_held.compare_exchange_weak(held, held + bytes));
+    return true;
+}
+
+void ReadAheadExecutor::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) {
+            return;
+        }
+        m_tasks.push_back(std::move(task));
+    }
+    m_wake.notify_one();
+}
+
+void ReadAheadExecutor::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+        if (m_stop) {
+            return;
+        }
+        auto task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+ChunkedContent::ChunkedContent(size_t chunks, Render render, ExportJoiner joiner,
+                               ReadAheadExecutor* executor, std::vector<size_t> offsets)
+    : m_state(std::make_shared<State>(std::move(render), std::move(joiner), executor, chunks,
+                                      std::move(offsets))) {
+    State& state = *m_state;
+    if (!state.indexed) {
+        state.offsets.assign(chunks + 1, 0);
+        join(state);  // An export of no chunks is only the joiner's ending
+        return;
+    }
+
+    if (state.offsets.size() != chunks + 1) {
+        throw std::invalid_argument("export index does not match its chunks");
+    }
+    // The ending follows the last piece as it did when indexed
+    ExportJoiner ending = state.joiner;
+    ending.resumeAt(state.offsets.back());
+    state.ending = ending.finish();
+    state.finished = true;
+}
+
+ChunkedContent::~ChunkedContent() {
+    State& state = *m_state;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    // Queued tasks still hold the state but will find it cancelled; the
+    // render function may not outlive this object
+    state.cancelled = true;
+    state.changed.wait(lock, [&] { return state.rendering == 0; });
+    releaseRead(state, static_cast<size_t>(-1));
+}
+
+void ChunkedContent::renderChunk(State& state, std::unique_lock<std::mutex>& lock, size_t index,
+                                 bool ahead) {
+    std::string data;
+    std::exception_ptr error;
+    lock.unlock();
+    try {
+        data = state.render(index);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    lock.lock();
+
+    Chunk& chunk = state.chunks[index];
+    if (state.executor && chunk.held > 0) {
+        state.executor->release(chunk.held);  // The estimate it was queued with
+        chunk.held = 0;
+    }
+    if (error) {
+        chunk.status = Status::Failed;
+        chunk.error = error;
+    } else {
+        chunk.status = Status::Done;
+        chunk.data = std::move(data);
+        if (state.indexed) {
+            place(state, index);
+        }
+    }
+    if (chunk.status == Status::Done && ahead && state.executor) {
+        chunk.held = chunk.data.size();
+        state.executor->hold(chunk.held);
+        state.executor->countPrefetched();
+    }
+    if (!state.indexed) {
+        join(state);
+    }
+    state.changed.notify_all();
+}
+
+void ChunkedContent::place(State& state, size_t index) {
+    Chunk& chunk = state.chunks[index];
+    ExportJoiner joiner = state.joiner;
+    joiner.resumeAt(state.offsets[index]);
+    std::string piece = joiner.next(chunk.data);
+    if (piece.size() != state.offsets[index + 1] - state.offsets[index]) {
+        chunk.status = Status::Failed;
+        chunk.error = std::make_exception_ptr(std::runtime_error(
+            "export range " + std::to_string(index) + " changed since the export was indexed"));
+        std::string().swap(chunk.data);
+        return;
+    }
+    chunk.data = std::move(piece);
+    chunk.placed = true;
+}
+
+void ChunkedContent::join(State& state) {
+    while (state.joined < state.chunks.size() &&
+           state.chunks[state.joined].status == Status::Done) {
+        Chunk& chunk = state.chunks[state.joined];
+        chunk.data = state.joiner.next(chunk.data);
+        chunk.placed = true;
+        state.offsets[state.joined + 1] = state.offsets[state.joined] + chunk.data.size();
+        ++state.joined;
+    }
+    if (state.joined == state.chunks.size() && !state.finished) {
+        state.ending = state.joiner.finish();
+        state.finished = true;
+    }
+}
+
+size_t ChunkedContent::chunkAt(const State& state, size_t offset) {
+    // The ending counts as the chunk after the last
+    size_t known = state.indexed ? state.chunks.size() : state.joined;
+    auto begin = state.offsets.begin();
+    auto it = std::upper_bound(begin, begin + static_cast<std::ptrdiff_t>(known) + 1, offset);
+    return it == begin ? 0 : static_cast<size_t>(it - begin) - 1;
+}
+
+void ChunkedContent::fill(State& state, std::unique_lock<std::mutex>& lock, size_t first,
+                          size_t end) {
+    // Without an index, pieces are only placed in order
+    size_t index = state.indexed ? first : state.joined;
+    while (index < state.chunks.size() && state.offsets[index] < end) {
+        Chunk& chunk = state.chunks[index];
+        switch (chunk.status) {
+            case Status::Failed:
+                std::rethrow_exception(chunk.error);
+            case Status::Rendering:
+                state.changed.wait(lock);
+                break;
+            case Status::Pending:
+            case Status::Queued:
+                // Not started yet: render it here rather than wait for a thread
+                if (state.executor) {
+                    state.executor->countWaited();
+                }
+                chunk.status = Status::Rendering;
+                renderChunk(state, lock, index, false);
+                break;
+            case Status::Done:
+                ++index;
+                break;
+        }
+    }
+}
+
+void ChunkedContent::prefetch(size_t first) {
+    State& state = *m_state;
+    ReadAheadExecutor* executor = state.executor;
+    if (!executor || (!state.indexed && state.joined == 0)) {
+        return;
+    }
+
+    // The window counts from the first chunk the reader has not finished.
+    // Indexed chunks reserve their known size, others the average so far.
+    size_t unread = chunkAt(state, state.readEnd);
+    size_t estimate = state.indexed ? 0 : state.offsets[state.joined] / state.joined;
+    size_t last = std::min(state.chunks.size(), unread + executor->window());
+    for (size_t index = first; index < last; ++index) {
+        if (state.chunks[index].status != Status::Pending) {
+            continue;
+        }
+        size_t bytes = state.indexed ? state.offsets[index + 1] - state.offsets[index] : estimate;
+        if (!executor->reserve(bytes)) {
+            break;
+        }
+        state.chunks[index].held = bytes;
+        state.chunks[index].status = Status::Queued;
+        executor->submit([weak = std::weak_ptr<State>(m_state), index] {
+            auto shared = weak.lock();
+            if (!shared) {
+                return;
+            }
+            State& state = *shared;
+            std::unique_lock<std::mutex> lock(state.mutex);
+            if (state.cancelled || state.chunks[index].status != Status::Queued) {
+                return;
+            }
+            state.chunks[index].status = Status::Rendering;
+            ++state.rendering;
+            renderChunk(state, lock, index, true);
+            --state.rendering;
+            state.changed.notify_all();
+        });
+    }
+}
+
+void ChunkedContent::releaseRead(State& state, size_t offset) {
+    if (!state.executor) {
+        return;
+    }
+    size_t known = state.indexed ? state.chunks.size() : state.joined;
+    for (size_t i = 0; i < state.chunks.size(); ++i) {
+        Chunk& chunk = state.chunks[i];
+        bool read = i < known && state.offsets[i + 1] <= offset;
+        if (chunk.held > 0 && (read || offset == static_cast<size_t>(-1))) {
+            state.executor->release(chunk.held);
+            chunk.held = 0;
+        }
+    }
+}
+
+size_t ChunkedContent::read(char* buf, size_t size, size_t offset) {
+    State& state = *m_state;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    size_t end = offset + size;
+
+    // A read that starts where the last one ended is taken as sequential.
+    // The chunks the read needs are rendered here, and without an index
+    // nothing is queued before the first chunk has given a size to reserve.
+    bool sequential = offset == state.readEnd;
+    if (sequential && state.indexed) {
+        prefetch(chunkAt(state, end > 0 ? end - 1 : 0) + 1);
+    } else if (sequential && state.joined > 0) {
+        bool covered = state.finished || state.offsets[state.joined] >= end;
+        prefetch(covered ? state.joined : state.joined + 1);
+    }
+
+    fill(state, lock, chunkAt(state, offset), end);
+
+    size_t copied = 0;
+    size_t count = state.chunks.size();
+    for (size_t i = chunkAt(state, offset); i <= count && copied < size; ++i) {
+        if (i < count ? !state.chunks[i].placed : !state.finished) {
+            break;
+        }
+        const std::string& piece = i < count ? state.chunks[i].data : state.ending;
+        size_t at = offset + copied;
+        size_t start = state.offsets[i];
+        if (at >= start + piece.size()) {
+            continue;
+        }
+        size_t n = std::min(size - copied, start + piece.size() - at);
+        std::memcpy(buf + copied, piece.data() + (at - start), n);
+        copied += n;
+    }
+    state.readEnd = offset + copied;
+    releaseRead(state, state.readEnd);
+
+    if (sequential) {
+        // Keep the window full past what was just read
+        prefetch(state.indexed ? chunkAt(state, state.readEnd) : state.joined);
+    }
+    return copied;
+}
+
+bool ChunkedContent::complete() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->finished &&
+           std::all_of(m_state->chunks.begin(), m_state->chunks.end(),
+                       [](const Chunk& chunk) { return chunk.placed; });
+}
+
+std::optional<size_t> ChunkedContent::size() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if (!m_state->finished) {
+        return std::nullopt;
+    }
+    return m_state->offsets.back() + m_state->ending.size();
+}
+
+std::vector<size_t> ChunkedContent::offsets() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->offsets;
+}
+
+std::string ChunkedContent::take() {
+    State& state = *m_state;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    fill(state, lock, 0, static_cast<size_t>(-1));
+    releaseRead(state, static_cast<size_t>(-1));
+
+    std::string out;
+    out.reserve(state.offsets.back() + state.ending.size());
+    for (auto& chunk : state.chunks) {
+        out += chunk.data;
+        std::string().swap(chunk.data);
+    }
+    out += state.ending;
+    return out;
+}
+
+}  // namespace sqlfuse
@@ -0,0 +1,98 @@
+#include "RecordSplitter.hpp"
+#include <cstring>
+
+namespace sqlfuse {
+
+RecordSplitter::RecordSplitter(Format format, char quote) : m_format(format), m_quote(quote) {}
+
+size_t RecordSplitter::scan(std::string_view data) {
+    if (m_pos < data.size()) {
+        if (m_format == Format::CSV) {
+            scanCSV(data);
+        } else {
+            scanJSON(data);
+        }
+    }
+    return m_boundary;
+}
+
+void RecordSplitter::consume(size_t n) {
+    m_pos -= n;
+    m_boundary -= n;
+}
+
+void RecordSplitter::scanCSV(std::string_view data) {
+    const char* p = data.data();
+    for (size_t i = m_pos; i < data.size(); ++i) {
+        if (m_quoted) {
+            // Jump to the closing quote; a doubled quote reopens right away
+            const void* q = std::memchr(p + i, m_quote, data.size() - i);
+            if (!q) {
+                i = data.size();
+                break;
+            }
+            i = static_cast<const char*>(q) - p;
+            m_quoted = false;
+        } else if (p[i] == m_quote) {
+            m_quoted = true;
+        } else if (p[i] == '\n') {
+            m_boundary = i + 1;
+        }
+    }
+    m_pos = data.size();
+}
+
+void RecordSplitter::scanJSON(std::string_view data) {
+    size_t i = m_pos;
+    if (!m_started) {
+        while (i < data.size() &&
+               (data[i] == ' ' || data[i] == '\t' || data[i] == '\r' || data[i] == '\n')) {
+            ++i;
+        }
+        if (i == data.size()) {
+            m_pos = i;
+            return;
+        }
+        m_started = true;
+        if (data[i] != '[') {
+            m_streamable = false;
+        }
+    }
+    if (!m_streamable) {
+        m_pos = data.size();
+        return;
+    }
+
+    for (; i < data.size(); ++i) {
+        char c = data[i];
+        if (m_quoted) {
+            if (m_escaped) {
+                m_escaped = false;
+            } else if (c == '\\') {
+                m_escaped = true;
+            } else if (c == '"') {
+                m_quoted = false;
+            }
+            continue;
+        }
+        switch (c) {
+            case '"':
+                m_quoted = true;
+                break;
+            case '[':
+            case '{':
+                ++m_depth;
+                break;
+            case ']':
+            case '}':
+                // An object closing back at the array level ends a record
+                if (--m_depth == 1 && c == '}') m_boundary = i + 1;
+                break;
+            default:
+                break;
+        }
+    }
+    m_pos = data.size();
+}
+
+}  // namespace sqlfuse
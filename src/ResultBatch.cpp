@@ -0,0 +1,198 @@
+#include "ResultBatch.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace sqlfuse {
+
+void appendInteger(std::string& out, int64_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+void appendReal(std::string& out, double value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    std::string_view text(buf, result.ptr - buf);
+    out.append(text);
+    if (std::isfinite(value) && text.find_first_of(".e") == std::string_view::npos) {
+        out += ".0";
+    }
+}
+
+// ============================================================================
+// ResultColumn
+// ============================================================================
+
+ResultColumn::ResultColumn(std::string name) : m_name(std::move(name)) {}
+
+void ResultColumn::markNull(bool null) {
+    if (m_rows % 64 == 0) {
+        m_nulls.push_back(0);
+    }
+    if (null) {
+        m_nulls.back() |= uint64_t(1) << (m_rows % 64);
+    }
+    ++m_rows;
+}
+
+// Fix the column type on the first non-NULL value, or switch to Mixed when
+// a value of another type shows up
+void ResultColumn::setType(ValueType type) {
+    if (m_type == type || m_type == ValueType::Mixed) return;
+
+    if (m_type == ValueType::Null) {
+        // Give the NULL rows seen so far a slot in the new storage
+        m_type = type;
+        if (type == ValueType::Integer) {
+            m_ints.resize(m_rows);
+        } else if (type == ValueType::Real) {
+            m_reals.resize(m_rows);
+        } else {
+            m_offsets.resize(m_rows + 1, m_bytes.size());
+        }
+        return;
+    }
+
+    promoteToMixed();
+}
+
+// Keep every value seen so far as its exact text, tagged with the column's
+// old type. Integers are never widened to double.
+void ResultColumn::promoteToMixed() {
+    if (m_type == ValueType::Integer || m_type == ValueType::Real) {
+        m_offsets.assign(1, 0);
+        m_bytes.clear();
+        for (size_t row = 0; row < m_rows; ++row) {
+            if (!isNull(row)) {
+                if (m_type == ValueType::Integer) {
+                    sqlfuse::appendInteger(m_bytes, m_ints[row]);
+                } else {
+                    sqlfuse::appendReal(m_bytes, m_reals[row]);
+                }
+            }
+            m_offsets.push_back(m_bytes.size());
+        }
+        m_ints.clear();
+        m_reals.clear();
+    }
+    // Number/Boolean/Text/Binary values are already stored as bytes
+    m_cellTypes.clear();
+    for (size_t row = 0; row < m_rows; ++row) {
+        m_cellTypes.push_back(isNull(row) ? ValueType::Null : m_type);
+    }
+    m_type = ValueType::Mixed;
+}
+
+void ResultColumn::appendNull() {
+    switch (m_type) {
+        case ValueType::Null:
+            break;
+        case ValueType::Integer:
+            m_ints.push_back(0);
+            break;
+        case ValueType::Real:
+            m_reals.push_back(0);
+            break;
+        case ValueType::Mixed:
+            m_cellTypes.push_back(ValueType::Null);
+            [[fallthrough]];
+        default:
+            m_offsets.push_back(m_bytes.size());
+    }
+    markNull(true);
+}
+
+void ResultColumn::appendInteger(int64_t value) {
+    setType(ValueType::Integer);
+    if (m_type == ValueType::Integer) {
+        m_ints.push_back(value);
+    } else {
+        sqlfuse::appendInteger(m_bytes, value);
+        m_offsets.push_back(m_bytes.size());
+        m_cellTypes.push_back(ValueType::Integer);
+    }
+    markNull(false);
+}
+
+void ResultColumn::appendReal(double value) {
+    setType(ValueType::Real);
+    if (m_type == ValueType::Real) {
+        m_reals.push_back(value);
+    } else {
+        sqlfuse::appendReal(m_bytes, value);
+        m_offsets.push_back(m_bytes.size());
+        m_cellTypes.push_back(ValueType::Real);
+    }
+    markNull(false);
+}
+
+void ResultColumn::appendBytes(ValueType type, std::string_view data) {
+    setType(type);
+    m_bytes.append(data);
+    m_offsets.push_back(m_bytes.size());
+    if (m_type == ValueType::Mixed) {
+        m_cellTypes.push_back(type);
+    }
+    markNull(false);
+}
+
+void ResultColumn::appendNumber(std::string_view text) {
+    appendBytes(ValueType::Number, text);
+}
+
+void ResultColumn::appendBoolean(bool value) {
+    appendBytes(ValueType::Boolean, value ? "t" : "f");
+}
+
+void ResultColumn::appendText(std::string_view text) {
+    appendBytes(ValueType::Text, text);
+}
+
+void ResultColumn::appendBinary(std::string_view data) {
+    appendBytes(ValueType::Binary, data);
+}
+
+std::string& ResultColumn::beginText() {
+    setType(ValueType::Text);
+    return m_bytes;
+}
+
+void ResultColumn::endText() {
+    m_offsets.push_back(m_bytes.size());
+    if (m_type == ValueType::Mixed) {
+        m_cellTypes.push_back(ValueType::Text);
+    }
+    markNull(false);
+}
+
+void ResultColumn::clear() {
+    m_type = ValueType::Null;
+    m_rows = 0;
+    m_nulls.clear();
+    m_ints.clear();
+    m_reals.clear();
+    m_offsets.assign(1, 0);
+    m_bytes.clear();
+    m_cellTypes.clear();
+}
+
+// ============================================================================
+// ResultBatch
+// ============================================================================
+
+ResultBatch::ResultBatch(const std::vector<std::string>& columnNames, size_t capacity)
+    : m_capacity(capacity > 0 ? capacity : DEFAULT_CAPACITY) {
+    m_columns.reserve(columnNames.size());
+    for (const auto& name : columnNames) {
+        m_columns.emplace_back(name);
+    }
+}
+
+void ResultBatch::clear() {
+    for (auto& column : m_columns) {
+        column.clear();
+    }
+}
+
+}  // namespace sqlfuse
@@ -85,9 +85,16 @@ int SQLFuseFS::init(const Config& config) {
                     }
                 }
 
+                SQLiteOptions sqliteOptions;
+                sqliteOptions.statement_cache_size = m_config.performance.sqlite_statement_cache;
+                sqliteOptions.mmap_size = m_config.performance.sqlite_mmap_size;
+                sqliteOptions.cache_size_kb = m_config.performance.sqlite_cache_size_kb;
+                sqliteOptions.wal = m_config.performance.sqlite_wal;
+
                 auto pool = std::make_unique<SQLiteConnectionPool>(
                     dbPath,
-                    m_config.performance.connection_pool_size);
+                    m_config.performance.connection_pool_size,
+                    sqliteOptions);
 
                 if (!pool->healthCheck()) {
                     spdlog::error("Failed to open SQLite database: {}", dbPath);
@@ -166,6 +173,29 @@ int SQLFuseFS::init(const Config& config) {
                 throw std::invalid_argument("Unknown database type");
         }
 
+        // Render split exports ahead of sequential readers (read_ahead_chunks)
+        if (m_config.performance.read_ahead_chunks > 0) {
+            m_readAhead = std::make_unique<ReadAheadExecutor>(
+                m_config.performance.read_ahead_threads,
+                m_config.performance.read_ahead_chunks,
+                m_config.performance.read_ahead_budget_mb * 1024 * 1024);
+            m_fileHandles->setReadAhead(m_readAhead.get());
+        }
+
+        // Commit row file saves in groups (write_behind)
+        if (m_config.performance.write_behind != "off") {
+            m_writeBehind = std::make_unique<WriteBehindQueue>(
+                [this](const std::string& database, const std::string& table) {
+                    m_cache->invalidateTable(database, table);
+                },
+                m_config.performance.write_behind == "release" ? WriteDurability::Release
+                                                               : WriteDurability::Flush,
+                m_config.performance.write_behind_window,
+                m_config.performance.write_behind_max_batch,
+                m_config.performance.write_behind_writers);
+            m_fileHandles->setWriteBehind(m_writeBehind.get());
+        }
+
         m_initialized = true;
         spdlog::info("SQL FUSE filesystem initialized");
 
@@ -247,6 +277,12 @@ int SQLFuseFS::run(int argc, char* argv[]) {
 }
 
 void SQLFuseFS::shutdown() {
+    // Commit pending row saves while the pool still has connections
+    if (m_fileHandles) {
+        m_fileHandles->setWriteBehind(nullptr);
+    }
+    m_writeBehind.reset();
+
     // Drain the appropriate connection pool
     std::visit([](auto&& pool) {
         using T = std::decay_t<decltype(pool)>;
@@ -315,6 +351,15 @@ int SQLFuseFS::fillStatForNode(const ParsedPath& parsed, struct stat* stbuf) {
         // Try to get size (this may involve querying the database)
         // For now, report a reasonable estimate
         stbuf->st_size = 4096;  // Will be updated on open/read
+
+        // A split table export rendered before knows its size
+        if (parsed.type == NodeType::TableFile && m_config.data.export_offset_index) {
+            if (auto cached = m_cache->get(VirtualFile::exportIndexKey(parsed))) {
+                if (auto index = ExportIndex::parse(*cached)) {
+                    stbuf->st_size = static_cast<off_t>(index->size);
+                }
+            }
+        }
     }
 
     return 0;
@@ -621,6 +666,14 @@ int SQLFuseFS::open(const char* path, fuse_file_info* fi) {
     uint64_t handle = m_fileHandles->create(parsed);
     fi->fh = handle;
 
+    // With atomic O_TRUNC the kernel sends no separate truncate
+    if ((fi->flags & O_TRUNC) && (fi->flags & O_ACCMODE) != O_RDONLY &&
+        parsed.type == NodeType::TableFile) {
+        if (VirtualFile* file = m_fileHandles->get(handle)) {
+            file->truncate(0);
+        }
+    }
+
     return 0;
 }
 
@@ -634,18 +687,7 @@ int SQLFuseFS::read(const char* path, char* buf, size_t size, off_t offset,
     }
 
     try {
-        std::string content = file->getContent();
-
-        if (offset >= static_cast<off_t>(content.size())) {
-            return 0;
-        }
-
-        size_t available = content.size() - static_cast<size_t>(offset);
-        size_t to_read = std::min(size, available);
-
-        memcpy(buf, content.data() + offset, to_read);
-
-        return static_cast<int>(to_read);
+        return static_cast<int>(file->read(buf, size, offset));
 
     } catch (const std::exception& e) {
         spdlog::error("read error: {}", e.what());
@@ -743,13 +785,15 @@ int SQLFuseFS::unlink(const char* path) {
             if (!pool || !*pool) {
                 return -EIO;
             }
-            auto conn = (*pool)->acquire();
-            if (!conn || !conn->execute(sql)) {
-                spdlog::error("SQLite delete error: {}", conn ? conn->error() : "null connection");
+            auto conn = (*pool)->acquireWriter();
+            if (!conn) {
+                return (*pool)->isWritable() ? -EBUSY : -EROFS;
+            }
+            if (!conn->execute(sql)) {
+                spdlog::error("SQLite delete error: {}", conn->error());
                 return -EIO;
             }
             affected_rows = conn->changes();
-            (*pool)->release(std::move(conn));
         }
 #endif
 
@@ -840,11 +884,16 @@ int SQLFuseFS::release(const char* path, fuse_file_info* fi) {
     if (file) {
         // Flush any pending writes
         if (file->isModified()) {
-            int result = file->flush();
+            int result = file->flush(true);
             if (result != 0) {
                 spdlog::error("Failed to flush writes: {}", file->lastError());
             }
         }
+
+        // Return once the handle's queued row saves have committed
+        if (file->awaitWriteBehind() != 0) {
+            spdlog::error("Write-behind save failed: {}", file->lastError());
+        }
     }
 
     m_fileHandles->release(fi->fh);
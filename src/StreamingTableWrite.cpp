@@ -0,0 +1,153 @@
+#include "StreamingTableWrite.hpp"
+#include "CSVReader.hpp"
+#include "JSONRowReader.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+
+namespace sqlfuse {
+
+namespace {
+
+class FailedTableWriteStream : public TableWriteStream {
+public:
+    FailedTableWriteStream(int result, std::string error) : m_result(result) {
+        m_error = std::move(error);
+    }
+
+    int begin() override { return m_result; }
+    int write(RowReader&) override { return m_result; }
+    int finish() override { return m_result; }
+    void abort() override {}
+
+private:
+    int m_result;
+};
+
+}  // namespace
+
+std::unique_ptr<TableWriteStream> TableWriteStream::failed(int result, std::string error) {
+    return std::make_unique<FailedTableWriteStream>(result, std::move(error));
+}
+
+StreamingTableWrite::StreamingTableWrite(FileFormat format, OpenStream open, size_t pieceBytes)
+    : m_format(format),
+      m_open(std::move(open)),
+      m_pieceBytes(pieceBytes),
+      m_splitter(format == FileFormat::JSON ? RecordSplitter::Format::JSON
+                                            : RecordSplitter::Format::CSV) {}
+
+StreamingTableWrite::~StreamingTableWrite() {
+    if (m_stream && !m_finished && m_result == 0) {
+        m_stream->abort();
+    }
+}
+
+int StreamingTableWrite::append(const char* data, size_t size) {
+    if (m_result != 0) return m_result;
+
+    m_pending.append(data, size);
+    m_received += size;
+    if (m_declined || m_pending.size() < m_pieceBytes) return 0;
+
+    size_t end = m_splitter.scan(m_pending);
+    if (!m_splitter.streamable()) {
+        m_declined = true;
+        return 0;
+    }
+    return end > 0 ? load(end, false) : 0;
+}
+
+int StreamingTableWrite::finish() {
+    if (m_result != 0) return m_result;
+    if (m_finished) return 0;
+
+    if (int result = load(m_pending.size(), true)) return result;
+    if (m_declined) return 0;  // Nothing to load, or handed back for buffering
+
+    if (m_stream) {
+        if (int result = m_stream->finish()) {
+            return fail(result, m_stream->error());
+        }
+    }
+    m_finished = true;
+    return 0;
+}
+
+void StreamingTableWrite::abort(const std::string& reason) {
+    if (m_result == 0) fail(-EIO, reason);
+}
+
+int StreamingTableWrite::load(size_t end, bool last) {
+    size_t content = std::min(m_pending.find_first_not_of(" \t\r\n"), end);
+    if (content == end && (!m_stream || m_format == FileFormat::CSV)) {
+        // Blank: no rows here, and no columns to open a stream with
+        if (!m_stream) {
+            m_declined = true;
+            return 0;
+        }
+        m_pending.erase(0, end);
+        m_splitter.consume(end);
+        return 0;
+    }
+
+    std::string piece;
+    std::unique_ptr<RowReader> reader;
+
+    try {
+        if (m_format == FileFormat::JSON) {
+            // The first piece opens the array, later ones start with the ','
+            // after the previous object: wrap each as an array of its own. The
+            // last piece brings the closing bracket with it.
+            size_t start = content;
+            if (start < end && m_pending[start] == (m_stream ? ',' : '[')) ++start;
+            piece = "[";
+            piece.append(m_pending, start, end - start);
+            if (!last) piece += ']';
+            reader = m_columns.empty() ? std::make_unique<JSONRowReader>(piece)
+                                       : std::make_unique<JSONRowReader>(piece, m_columns);
+        } else {
+            piece.assign(m_pending, 0, end);
+            CSVOptions options;
+            options.includeHeader = m_columns.empty();
+            reader = std::make_unique<CSVReader>(piece, options, m_columns);
+        }
+
+        if (!m_stream) {
+            if (reader->columns().empty()) {
+                m_declined = true;
+                return 0;
+            }
+            m_columns = reader->columns();
+            m_stream = m_open(m_columns);
+            if (!m_stream) {
+                m_declined = true;
+                return 0;
+            }
+            if (int result = m_stream->begin()) {
+                return fail(result, m_stream->error());
+            }
+        }
+
+        if (int result = m_stream->write(*reader)) {
+            return fail(result, m_stream->error());
+        }
+    } catch (const std::exception& e) {
+        return fail(-EINVAL, e.what());
+    }
+
+    m_pending.erase(0, end);
+    m_splitter.consume(end);
+    return 0;
+}
+
+int StreamingTableWrite::fail(int result, const std::string& error) {
+    m_result = result;
+    m_error = error;
+    if (m_stream && !m_finished) {
+        m_stream->abort();
+    }
+    return result;
+}
+
+}  // namespace sqlfuse
@@ -0,0 +1,102 @@
+#include "TableDiff.hpp"
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace sqlfuse {
+
+namespace {
+
+size_t keyIndex(const RowReader& reader, const std::string& pkColumn, const char* side) {
+    const auto& columns = reader.columns();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i] == pkColumn) return i;
+    }
+    throw std::runtime_error(std::string(side) + " has no primary key column " + pkColumn);
+}
+
+SqlValue toValue(const FieldView& field) {
+    return field ? SqlValue(std::string(*field)) : std::nullopt;
+}
+
+}  // namespace
+
+TableDiff diffTables(RowReader& before, RowReader& after, const std::string& pkColumn) {
+    const size_t afterKey = keyIndex(after, pkColumn, "Written data");
+    const bool rendered = !before.columns().empty();
+    const size_t beforeKey = rendered ? keyIndex(before, pkColumn, "Rendered table") : 0;
+
+    // Snapshot rows by key; the views point into the snapshot's buffer
+    std::vector<std::vector<FieldView>> rows;
+    std::unordered_map<std::string_view, size_t> byKey;
+    while (rendered && before.next()) {
+        const auto& fields = before.row();
+        if (!fields[beforeKey]) continue;  // Not addressable by key
+        byKey.emplace(*fields[beforeKey], rows.size());
+        rows.push_back(fields);
+    }
+
+    // Where each written column sits in the snapshot, if it is there at all
+    const auto& columns = after.columns();
+    std::unordered_map<std::string_view, size_t> beforeColumns;
+    for (size_t i = 0; i < before.columns().size(); ++i) {
+        beforeColumns.emplace(before.columns()[i], i);
+    }
+    std::vector<std::optional<size_t>> mapped(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (auto it = beforeColumns.find(columns[i]); it != beforeColumns.end()) {
+            mapped[i] = it->second;
+        }
+    }
+
+    TableDiff diff;
+    std::vector<bool> kept(rows.size(), false);
+    std::unordered_set<std::string_view> seen;
+    size_t rowNumber = 0;
+
+    while (after.next()) {
+        ++rowNumber;
+        const auto& fields = after.row();
+        if (!fields[afterKey]) {
+            throw std::runtime_error("row " + std::to_string(rowNumber) + ": " + pkColumn +
+                                     " is NULL");
+        }
+        std::string_view key = *fields[afterKey];
+        if (!seen.insert(key).second) {
+            throw std::runtime_error("row " + std::to_string(rowNumber) + ": " + pkColumn + " " +
+                                     std::string(key) + " appears more than once");
+        }
+
+        auto it = byKey.find(key);
+        if (it == byKey.end()) {
+            RowData row;
+            for (size_t i = 0; i < columns.size(); ++i) {
+                row[columns[i]] = toValue(fields[i]);
+            }
+            diff.inserts.push_back(std::move(row));
+            continue;
+        }
+
+        kept[it->second] = true;
+        const auto& old = rows[it->second];
+        RowData changed;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i == afterKey) continue;
+            if (mapped[i] && old[*mapped[i]] == fields[i]) continue;
+            changed[columns[i]] = toValue(fields[i]);
+        }
+        if (changed.empty()) {
+            ++diff.unchanged;
+        } else {
+            diff.updates.emplace_back(std::string(key), std::move(changed));
+        }
+    }
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (!kept[i]) diff.deletes.emplace_back(*rows[i][beforeKey]);
+    }
+
+    return diff;
+}
+
+}  // namespace sqlfuse
@@ -1,7 +1,12 @@
 #include "VirtualFile.hpp"
 #include "FormatConverter.hpp"
+#include "CSVReader.hpp"
+#include "JSONRowReader.hpp"
 #include "ErrorHandler.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <sstream>
 #include <iomanip>
 
@@ -20,6 +25,7 @@ std::string VirtualFile::getContent() {
     if (!m_contentLoaded) {
         loadContent();
     }
+    materialize();
 
     return m_content;
 }
@@ -30,10 +36,73 @@ size_t VirtualFile::getSize() {
     if (!m_contentLoaded) {
         loadContent();
     }
+    if (m_chunked) {
+        if (auto size = m_chunked->size()) {
+            return *size;  // Known from the export's index
+        }
+    }
+    materialize();
 
     return m_content.size();
 }
 
+size_t VirtualFile::read(char* buf, size_t size, off_t offset) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_contentLoaded) {
+        loadContent();
+    }
+
+    if (m_chunked) {
+        size_t copied = 0;
+        try {
+            copied = m_chunked->read(buf, size, static_cast<size_t>(offset));
+        } catch (const std::exception&) {
+            // The table may have changed under its index
+            m_cache.remove(exportIndexKey(m_path));
+            throw;
+        }
+        if (m_chunked->complete()) {
+            materialize();
+        }
+        return copied;
+    }
+
+    if (offset >= static_cast<off_t>(m_content.size())) {
+        return 0;
+    }
+    size_t copied = std::min(size, m_content.size() - static_cast<size_t>(offset));
+    std::memcpy(buf, m_content.data() + offset, copied);
+    return copied;
+}
+
+void VirtualFile::stopReadAhead() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_chunked.reset();
+    m_chunkedRanges.clear();
+}
+
+void VirtualFile::materialize() {
+    if (!m_chunked) {
+        return;
+    }
+
+    try {
+        m_content = m_chunked->take();
+        if (!m_content.empty()) {
+            recordExportIndex(m_chunkedRanges, m_chunked->offsets(), m_content.size());
+            m_cache.put(getCacheKey(), m_content, CacheManager::Category::Data);
+        }
+    } catch (const std::exception& e) {
+        m_lastError = e.what();
+        spdlog::error("Failed to load content for {}: {}", getCacheKey(), e.what());
+        m_cache.remove(exportIndexKey(m_path));
+        m_content = "";
+    }
+    m_chunked.reset();
+    m_chunkedRanges.clear();
+}
+
 bool VirtualFile::hasContent() const {
     std::lock_guard<std::mutex> lock(m_mutex);
     return m_contentLoaded;
@@ -45,15 +114,45 @@ int VirtualFile::write(const char* data, size_t size, off_t offset) {
     }
 
     std::lock_guard<std::mutex> lock(m_mutex);
+    m_modified = true;
+    ++m_unsavedWrites;
+    if (m_counters) {
+        ++m_counters->writes;
+        m_counters->bytes += size;
+    }
 
-    // Ensure buffer is large enough
-    if (static_cast<size_t>(offset) + size > m_writeBuffer.size()) {
-        m_writeBuffer.resize(static_cast<size_t>(offset) + size);
+    if (!m_streaming && offset == 0 && m_writeBuffer.empty() && canStreamWrites()) {
+        m_streaming = std::make_unique<StreamingTableWrite>(
+            m_path.format,
+            [this](const std::vector<std::string>& columns) {
+                return openTableWriteStream(columns);
+            },
+            m_config.insert_batch_bytes);
     }
 
-    std::memcpy(m_writeBuffer.data() + offset, data, size);
-    m_modified = true;
+    if (m_streaming) {
+        if (static_cast<size_t>(offset) == m_streaming->received()) {
+            if (int result = m_streaming->append(data, size)) {
+                m_lastError = m_streaming->error();
+                return result;
+            }
+            if (m_streaming->declined()) {
+                stopStreaming();
+            }
+            return static_cast<int>(size);
+        }
+
+        if (m_streaming->started()) {
+            // The rows before this offset are already in the open transaction
+            m_streaming->abort("Non-sequential write to a table file being loaded as it "
+                               "arrives (set stream_table_writes = false to buffer it)");
+            m_lastError = m_streaming->error();
+            return -EIO;
+        }
+        stopStreaming();
+    }
 
+    m_writeBuffer.write(static_cast<size_t>(offset), data, size);
     return static_cast<int>(size);
 }
 
@@ -63,6 +162,26 @@ int VirtualFile::truncate(off_t size) {
     }
 
     std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_counters) {
+        ++m_counters->truncates;
+    }
+
+    if (size == 0 && m_path.type == NodeType::TableFile && m_config.replace_table_writes) {
+        // The whole file is being rewritten: load it as the table's contents
+        m_replace = true;
+    }
+
+    if (m_streaming) {
+        if (static_cast<size_t>(size) == m_streaming->received()) {
+            return 0;
+        }
+        if (m_streaming->started()) {
+            m_streaming->abort("Truncate of a table file being loaded as it arrives");
+            m_lastError = m_streaming->error();
+            return -EIO;
+        }
+        stopStreaming();
+    }
 
     m_writeBuffer.resize(static_cast<size_t>(size));
     m_modified = true;
@@ -70,21 +189,54 @@ int VirtualFile::truncate(off_t size) {
     return 0;
 }
 
-int VirtualFile::flush() {
+int VirtualFile::flush(bool release) {
+    if (m_counters) {
+        ++m_counters->flushes;
+    }
     if (!m_modified) {
         return 0;
     }
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (m_config.save_on_release && !release) {
+        // close() of one of several descriptors: the save waits for the last
+        if (m_counters) ++m_counters->coalesced;
+        return 0;
+    }
+
+    if (unchangedSave()) {
+        spdlog::debug("{}: save after {} writes is unchanged, skipped", getCacheKey(),
+                      m_unsavedWrites);
+        if (m_counters) ++m_counters->coalesced;
+        m_modified = false;
+        m_replace = false;
+        m_unsavedWrites = 0;
+        m_writeBuffer.clear();
+        return 0;
+    }
+
     int result = 0;
+    bool queued = false;  // The queue invalidates the cache when the group commits
 
     switch (m_path.type) {
         case NodeType::TableFile:
-            result = handleTableWrite();
+            if (m_config.diff_table_writes) {
+                result = handleTableDiff();
+            } else if (m_streaming && (m_streaming->started() || m_streaming->failed())) {
+                result = m_streaming->finish();
+                if (result != 0) {
+                    m_lastError = m_streaming->error();
+                }
+            } else {
+                // Too small to have started streaming: load it as a buffered write
+                if (m_streaming) stopStreaming();
+                result = handleTableWrite();
+            }
             break;
         case NodeType::TableRowFile:
-            result = handleRowWrite();
+            queued = m_writeBehind != nullptr;
+            result = queued ? queueRowWrite() : handleRowWrite();
             break;
         default:
             result = -EROFS;
@@ -92,11 +244,21 @@ int VirtualFile::flush() {
     }
 
     if (result == 0) {
+        spdlog::debug("{}: saved after {} writes", getCacheKey(), m_unsavedWrites);
+        if (m_counters) ++m_counters->saves;
+        if (m_path.type == NodeType::TableRowFile || m_config.diff_table_writes || m_replace) {
+            m_saved = m_writeBuffer.str();
+        } else {
+            m_saved.reset();
+        }
+        m_unsavedWrites = 0;
         m_modified = false;
+        m_replace = false;
         m_writeBuffer.clear();
+        m_streaming.reset();
 
         // Invalidate cache for this table
-        if (!m_path.database.empty() && !m_path.object_name.empty()) {
+        if (!queued && !m_path.database.empty() && !m_path.object_name.empty()) {
             m_cache.invalidateTable(m_path.database, m_path.object_name);
         }
     }
@@ -104,28 +266,378 @@ int VirtualFile::flush() {
     return result;
 }
 
+int VirtualFile::queueRowWrite() {
+    if (m_writeBuffer.empty()) {
+        return 0;
+    }
+
+    auto open = writeSession();
+    if (!open) {
+        return handleRowWrite();
+    }
+
+    std::string sql;
+    if (int result = rowWriteStatement(sql); result != 0) {
+        return result;
+    }
+
+    // Saves of one table commit in queue order, so a later save of this
+    // row cannot be overtaken by an earlier one
+    auto done = m_writeBehind->enqueue(m_path.database, m_path.object_name, std::move(sql),
+                                       std::move(open));
+    if (m_writeBehind->durability() == WriteDurability::Flush) {
+        const auto& outcome = done.get();
+        if (outcome.result != 0) {
+            m_lastError = outcome.error;
+        }
+        return outcome.result;
+    }
+
+    m_pendingWrites.push_back(std::move(done));
+    return 0;
+}
+
+bool VirtualFile::unchangedSave() {
+    if (m_path.type != NodeType::TableFile && m_path.type != NodeType::TableRowFile) {
+        return false;
+    }
+    if (m_streaming) {
+        if (m_streaming->started() || m_streaming->failed()) {
+            return false;  // Rows already sent
+        }
+        stopStreaming();
+    }
+    if (!m_saved || m_writeBuffer.empty()) {
+        return false;
+    }
+
+    // Only against what this handle wrote itself: a rendering read earlier
+    // (or cached by another handle) may be older than the row in the database
+    bool sameRows = m_path.type == NodeType::TableRowFile || m_config.diff_table_writes ||
+                    m_replace;
+    return sameRows && m_writeBuffer.equals(*m_saved);
+}
+
+int VirtualFile::awaitWriteBehind() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int result = 0;
+    for (const auto& done : m_pendingWrites) {
+        const auto& outcome = done.get();
+        if (outcome.result != 0 && result == 0) {
+            result = outcome.result;
+            m_lastError = outcome.error;
+        }
+    }
+    m_pendingWrites.clear();
+
+    return result;
+}
+
 bool VirtualFile::isReadOnly() const {
     return m_path.isReadOnly();
 }
 
+std::unique_ptr<RowReader> VirtualFile::openRowReader(std::string& data) const {
+    switch (m_path.format) {
+        case FileFormat::CSV: {
+            CSVOptions opts;
+            opts.includeHeader = true;  // Assume header in written data
+            return std::make_unique<CSVReader>(data, opts);
+        }
+        case FileFormat::JSON:
+            return std::make_unique<JSONRowReader>(data);
+        default:
+            return nullptr;
+    }
+}
+
+int VirtualFile::handleTableWrite() {
+    if (m_writeBuffer.empty()) {
+        return 0;
+    }
+
+    try {
+        // Readers parse in place; keep the write buffer intact for a retry
+        std::string data = m_writeBuffer.str();
+        auto reader = openRowReader(data);
+        if (!reader) {
+            return -EINVAL;
+        }
+        if (reader->columns().empty()) {
+            return 0;
+        }
+
+        auto stream = openTableWriteStream(reader->columns());
+        if (!stream) {
+            m_lastError = "Table writes are not supported for this database";
+            return -EROFS;
+        }
+
+        int result = stream->begin();
+        if (result == 0) {
+            try {
+                result = stream->write(*reader);
+            } catch (...) {
+                stream->abort();
+                throw;
+            }
+        }
+        if (result == 0) {
+            result = stream->finish();
+        }
+        if (result != 0) {
+            m_lastError = stream->error();
+            stream->abort();
+        }
+        return result;
+
+    } catch (const std::exception& e) {
+        m_lastError = e.what();
+        return -EINVAL;
+    }
+}
+
+std::unique_ptr<TableWriteStream> VirtualFile::openTableWriteStream(
+    const std::vector<std::string>& /*columns*/) {
+    return nullptr;
+}
+
+int VirtualFile::applyTableDiff(const TableDiff& /*diff*/, const std::string& /*pkColumn*/) {
+    m_lastError = "Table writes are not supported for this database";
+    return -EROFS;
+}
+
+int VirtualFile::rowWriteStatement(std::string& /*sql*/) {
+    m_lastError = "Row writes are not supported for this database";
+    return -EROFS;
+}
+
+WriteBehindQueue::OpenSession VirtualFile::writeSession() {
+    return {};
+}
+
+KeySource VirtualFile::exportKeySource(const std::string& /*pkColumn*/) {
+    return {};
+}
+
+std::string VirtualFile::renderKeyRange(const std::string& /*pkColumn*/,
+                                        const KeyRange& /*range*/, bool /*json*/,
+                                        bool /*header*/) {
+    return "";
+}
+
+std::optional<std::string> VirtualFile::parallelTableExport(bool json,
+                                                            const std::string& trailer) {
+    size_t parts = m_config.export_parallelism;
+    if (parts < 2) {
+        return std::nullopt;
+    }
+
+    auto info = m_schema.getTableInfo(m_path.database, m_path.object_name);
+    if (!info || info->primaryKeyColumn.empty()) {
+        return std::nullopt;
+    }
+
+    // Ranges of one column of a composite key would not split evenly
+    size_t keyColumns = std::count_if(info->columns.begin(), info->columns.end(),
+                                      [](const ColumnInfo& column) { return column.key == "PRI"; });
+    if (keyColumns > 1) {
+        return std::nullopt;
+    }
+
+    std::string pk = info->primaryKeyColumn;
+    bool header = m_config.include_csv_header;
+    ExportJoiner joiner(json, m_config.pretty_json, trailer);
+    auto startChunked = [&](std::vector<KeyRange> ranges, std::vector<size_t> offsets) {
+        m_chunkedRanges = ranges;
+        m_chunked = std::make_unique<ChunkedContent>(
+            ranges.size(),
+            [this, pk, ranges, json, header](size_t index) {
+                return renderKeyRange(pk, ranges[index], json, index == 0 && header);
+            },
+            joiner, m_readAhead, std::move(offsets));
+    };
+
+    // Split before: render only the ranges that reads reach
+    if (m_config.export_offset_index) {
+        std::optional<ExportIndex> index;
+        if (auto cached = m_cache.get(exportIndexKey(m_path))) {
+            index = ExportIndex::parse(*cached);
+        }
+        if (index) {
+            startChunked(index->ranges, index->offsets);
+            if (m_chunked->size() == index->size) {
+                spdlog::debug("Exporting {}.{} from its index of {} key ranges", m_path.database,
+                              m_path.object_name, index->ranges.size());
+                return std::string();
+            }
+            m_chunked.reset();
+            m_chunkedRanges.clear();
+            m_cache.remove(exportIndexKey(m_path));
+        }
+    }
+
+    // Rows the export will return, as far as the statistics tell
+    size_t limit = m_config.max_rows_per_file;
+    size_t rows = static_cast<size_t>(info->rowsEstimate);
+    if (limit > 0 && (rows == 0 || rows > limit)) {
+        rows = limit;
+    }
+    if (rows < m_config.export_parallel_min_rows) {
+        return std::nullopt;
+    }
+
+    KeySource source = exportKeySource(info->primaryKeyColumn);
+    auto keyColumn = std::find_if(info->columns.begin(), info->columns.end(),
+                                  [&](const ColumnInfo& column) { return column.name == pk; });
+    if (keyColumn == info->columns.end() || !isIntegerKeyType(keyColumn->type)) {
+        // A text key that parses as a number still sorts as text
+        source.bounds = nullptr;
+    }
+    if (!source.bounds && !source.keyAt) {
+        return std::nullopt;
+    }
+
+    auto ranges = planKeyRanges(source, parts, rows, limit);
+    if (ranges.size() < 2) {
+        return std::nullopt;
+    }
+
+    if (m_readAhead) {
+        // Rendered as the reader reaches each range
+        spdlog::debug("Exporting {}.{} in {} key ranges as read", m_path.database,
+                      m_path.object_name, ranges.size());
+        startChunked(std::move(ranges), {});
+        return std::string();
+    }
+
+    auto chunks = renderRanges(ranges, parts, [&](const KeyRange& range, size_t index) {
+        return renderKeyRange(pk, range, json, index == 0 && header);
+    });
+    spdlog::debug("Exported {}.{} in {} key ranges", m_path.database, m_path.object_name,
+                  ranges.size());
+
+    std::string out;
+    size_t size = 0;
+    for (const auto& chunk : chunks) {
+        size += chunk.size();
+    }
+    out.reserve(size + trailer.size() + 2);
+    std::vector<size_t> offsets;
+    for (const auto& chunk : chunks) {
+        offsets.push_back(out.size());
+        out += joiner.next(chunk);
+    }
+    offsets.push_back(out.size());
+    out += joiner.finish();
+    recordExportIndex(ranges, offsets, out.size());
+    return out;
+}
+
+void VirtualFile::recordExportIndex(const std::vector<KeyRange>& ranges,
+                                    const std::vector<size_t>& offsets, size_t size) {
+    if (!m_config.export_offset_index || ranges.empty()) {
+        return;
+    }
+    ExportIndex index{ranges, offsets, size};
+    m_cache.put(exportIndexKey(m_path), index.serialize(), CacheManager::Category::Data);
+}
+
+int VirtualFile::handleTableDiff() {
+    if (m_writeBuffer.empty()) {
+        return 0;  // An emptied file is not taken to mean "delete every row"
+    }
+
+    auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
+    if (!table_info || table_info->primaryKeyColumn.empty()) {
+        m_lastError = "diff_table_writes needs a primary key";
+        return -EINVAL;
+    }
+
+    try {
+        // The file as last rendered: the cached copy the writer read, or a
+        // fresh rendering once that has expired
+        if (!m_contentLoaded) {
+            loadContent();
+        }
+        materialize();
+        std::string snapshot = m_content;
+        std::string data = m_writeBuffer.str();
+        auto before = openRowReader(snapshot);
+        auto after = openRowReader(data);
+        if (!before || !after) {
+            return -EINVAL;
+        }
+        if (after->columns().empty()) {
+            return 0;
+        }
+
+        TableDiff diff = diffTables(*before, *after, table_info->primaryKeyColumn);
+        spdlog::debug("{}.{}: {} inserts, {} updates, {} deletes, {} rows unchanged",
+                      m_path.database, m_path.object_name, diff.inserts.size(),
+                      diff.updates.size(), diff.deletes.size(), diff.unchanged);
+        int result = diff.empty() ? 0 : applyTableDiff(diff, table_info->primaryKeyColumn);
+        if (result == 0) {
+            // A later save through this handle diffs against what it wrote
+            m_content = m_writeBuffer.str();
+            m_contentLoaded = true;
+        }
+        return result;
+
+    } catch (const std::exception& e) {
+        m_lastError = e.what();
+        return -EINVAL;
+    }
+}
+
+bool VirtualFile::canStreamWrites() const {
+    return m_config.stream_table_writes && !m_config.diff_table_writes &&
+           m_path.type == NodeType::TableFile &&
+           (m_path.format == FileFormat::CSV || m_path.format == FileFormat::JSON);
+}
+
+void VirtualFile::stopStreaming() {
+    // Only valid before anything was loaded: pending() is still the whole file
+    std::string& pending = m_streaming->pending();
+    m_writeBuffer.write(0, pending.data(), pending.size());
+    m_streaming.reset();
+}
+
+InsertLimits VirtualFile::insertLimits() const {
+    InsertLimits limits;
+    limits.maxRows = m_config.insert_batch_rows;
+    limits.maxBytes = m_config.insert_batch_bytes;
+    return limits;
+}
+
 std::string VirtualFile::getCacheKey() const {
-    std::string key = m_path.database;
+    return cacheKey(m_path);
+}
+
+std::string VirtualFile::cacheKey(const ParsedPath& path) {
+    std::string key = path.database;
 
-    if (!m_path.object_name.empty()) {
-        key += "/" + m_path.object_name;
+    if (!path.object_name.empty()) {
+        key += "/" + path.object_name;
     }
 
-    if (m_path.format != FileFormat::None) {
-        key += PathRouter::formatToExtension(m_path.format);
+    if (path.format != FileFormat::None) {
+        key += PathRouter::formatToExtension(path.format);
     }
 
-    if (!m_path.row_id.empty()) {
-        key += "/rows/" + m_path.row_id;
+    if (!path.row_id.empty()) {
+        key += "/rows/" + path.row_id;
     }
 
     return key;
 }
 
+std::string VirtualFile::exportIndexKey(const ParsedPath& path) {
+    // Under the file's key, so invalidating the table drops it too
+    return cacheKey(path) + "/index";
+}
+
 void VirtualFile::loadContent() {
     // Try cache first
     std::string cache_key = getCacheKey();
@@ -342,6 +854,25 @@ std::string VirtualFile::generateServerInfo() {
     out << "Questions: " << info.questions << "\n";
     out << "Slow Queries: " << info.slowQueries << "\n";
 
+    if (m_counters) {
+        out << "\nFile Writes\n";
+        out << std::string(40, '=') << "\n\n";
+        out << "Writes Received: " << m_counters->writes << "\n";
+        out << "Bytes Written: " << m_counters->bytes << "\n";
+        out << "Truncates: " << m_counters->truncates << "\n";
+        out << "Flushes: " << m_counters->flushes << "\n";
+        out << "Saves Executed: " << m_counters->saves << "\n";
+        out << "Saves Coalesced: " << m_counters->coalesced << "\n";
+    }
+
+    if (m_readAhead) {
+        out << "\nRead-Ahead\n";
+        out << std::string(40, '=') << "\n\n";
+        out << "Ranges Prefetched: " << m_readAhead->prefetched() << "\n";
+        out << "Reads That Waited: " << m_readAhead->waited() << "\n";
+        out << "Bytes Held: " << m_readAhead->held() << "\n";
+    }
+
     return out.str();
 }
 
@@ -16,8 +16,11 @@ uint64_t VirtualFileHandleManager::create(const ParsedPath& path) {
 
     uint64_t handle = m_nextHandle++;
 
-    m_handles[handle] = m_schema.connectionPool().createVirtualFile(
-        path, m_schema, m_cache, m_config);
+    auto file = m_schema.connectionPool().createVirtualFile(path, m_schema, m_cache, m_config);
+    file->setWriteBehind(m_writeBehind);
+    file->setReadAhead(m_readAhead);
+    file->setWriteCounters(&m_counters);
+    m_handles[handle] = std::move(file);
 
     return handle;
 }
@@ -33,9 +36,25 @@ VirtualFile* VirtualFileHandleManager::get(uint64_t handle) {
     return it->second.get();
 }
 
+VirtualFileHandleManager::~VirtualFileHandleManager() {
+    for (auto& [handle, file] : m_handles) {
+        file->stopReadAhead();
+    }
+}
+
 void VirtualFileHandleManager::release(uint64_t handle) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_handles.erase(handle);
+    std::unique_ptr<VirtualFile> file;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_handles.find(handle);
+        if (it == m_handles.end()) {
+            return;
+        }
+        file = std::move(it->second);
+        m_handles.erase(it);
+    }
+    // Wait for ranges being rendered ahead outside the lock
+    file->stopReadAhead();
 }
 
 size_t VirtualFileHandleManager::openCount() const {
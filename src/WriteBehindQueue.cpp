@@ -0,0 +1,184 @@
+#include "WriteBehindQueue.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cerrno>
+#include <iterator>
+
+namespace sqlfuse {
+
+WriteBehindQueue::WriteBehindQueue(Committed committed, WriteDurability durability,
+                                   std::chrono::milliseconds window, size_t maxBatch,
+                                   size_t writers)
+    : m_committed(std::move(committed))
+    , m_durability(durability)
+    , m_window(window)
+    , m_maxBatch(std::max<size_t>(maxBatch, 1)) {
+    for (size_t i = 0; i < std::max<size_t>(writers, 1); ++i) {
+        m_writers.emplace_back(&WriteBehindQueue::run, this);
+    }
+}
+
+WriteBehindQueue::~WriteBehindQueue() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& writer : m_writers) {
+        writer.join();
+    }
+}
+
+std::shared_future<WriteBehindQueue::Outcome> WriteBehindQueue::enqueue(
+    const std::string& database, const std::string& table, std::string sql, OpenSession open) {
+    Mutation mutation{std::move(sql), {}};
+    std::shared_future<Outcome> done = mutation.done.get_future().share();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Table& entry = m_tables[{database, table}];
+        if (entry.table.empty()) {
+            entry.database = database;
+            entry.table = table;
+        }
+        entry.open = std::move(open);
+        if (entry.queue.empty()) {
+            entry.first = std::chrono::steady_clock::now();
+        }
+        entry.queue.push_back(std::move(mutation));
+    }
+    m_wake.notify_one();
+
+    return done;
+}
+
+void WriteBehindQueue::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        Table* ready = nullptr;
+        std::optional<std::chrono::steady_clock::time_point> next;
+
+        for (auto& [key, entry] : m_tables) {
+            if (entry.busy || entry.queue.empty()) {
+                continue;
+            }
+            auto due = entry.first + m_window;
+            if (m_stop || entry.queue.size() >= m_maxBatch || due <= now) {
+                ready = &entry;
+                break;
+            }
+            if (!next || due < *next) {
+                next = due;
+            }
+        }
+
+        if (!ready) {
+            if (m_stop) {
+                return;
+            }
+            if (next) {
+                m_wake.wait_until(lock, *next);
+            } else {
+                m_wake.wait(lock);
+            }
+            continue;
+        }
+
+        // Take one group; anything left over is due at once
+        size_t count = std::min(ready->queue.size(), m_maxBatch);
+        std::vector<Mutation> group(std::make_move_iterator(ready->queue.begin()),
+                                    std::make_move_iterator(ready->queue.begin() +
+                                                            static_cast<std::ptrdiff_t>(count)));
+        ready->queue.erase(ready->queue.begin(),
+                           ready->queue.begin() + static_cast<std::ptrdiff_t>(count));
+        ready->busy = true;
+        OpenSession open = ready->open;
+
+        lock.unlock();
+        commitGroup(open, group);
+        if (m_committed) {
+            m_committed(ready->database, ready->table);
+        }
+        lock.lock();
+
+        ready->busy = false;
+        m_wake.notify_all();
+    }
+}
+
+void WriteBehindQueue::commitGroup(const OpenSession& open, std::vector<Mutation>& group) {
+    auto finish = [](Mutation& mutation, int result, const std::string& error) {
+        mutation.done.set_value(Outcome{result, error});
+    };
+
+    std::optional<InsertSession> session = open ? open() : std::nullopt;
+    // The failure's errno, as the backend reports it for a row write without
+    // write-behind; read before rollback() like error()
+    auto errorCode = [&session] {
+        int code = session->errorCode ? session->errorCode() : 0;
+        return code < 0 ? code : -EIO;
+    };
+    if (!session) {
+        for (auto& mutation : group) {
+            finish(mutation, -EIO, "No connection available");
+        }
+        return;
+    }
+
+    // Indices still to commit; a failed statement is answered and dropped,
+    // and the group is run again without it
+    std::vector<size_t> pending(group.size());
+    for (size_t i = 0; i < pending.size(); ++i) {
+        pending[i] = i;
+    }
+
+    while (!pending.empty()) {
+        if (!session->begin()) {
+            std::string error = session->error();
+            int code = errorCode();
+            for (size_t i : pending) {
+                finish(group[i], code, error);
+            }
+            return;
+        }
+
+        auto failed = pending.end();
+        for (auto it = pending.begin(); it != pending.end(); ++it) {
+            if (!session->execute(group[*it].sql)) {
+                failed = it;
+                break;
+            }
+        }
+
+        if (failed != pending.end()) {
+            std::string error = session->error();
+            int code = errorCode();
+            session->rollback();
+            spdlog::error("Write-behind statement failed: {}", error);
+            finish(group[*failed], code, error);
+            pending.erase(failed);
+            continue;
+        }
+
+        if (!session->commit()) {
+            std::string error = session->error();
+            int code = errorCode();
+            session->rollback();
+            spdlog::error("Write-behind commit of {} statements failed: {}", pending.size(), error);
+            for (size_t i : pending) {
+                finish(group[i], code, error);
+            }
+            return;
+        }
+
+        ++m_groups;
+        m_statements += pending.size();
+        for (size_t i : pending) {
+            finish(group[i], 0, {});
+        }
+        return;
+    }
+}
+
+}  // namespace sqlfuse
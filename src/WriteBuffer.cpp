@@ -0,0 +1,99 @@
+#include "WriteBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace sqlfuse {
+
+void WriteBuffer::write(size_t offset, const char* data, size_t size) {
+    if (size == 0) return;
+    if (offset + size > m_size) {
+        resize(offset + size);
+    }
+
+    while (size > 0) {
+        size_t index = offset / CHUNK_BYTES;
+        size_t within = offset % CHUNK_BYTES;
+        size_t n = std::min(size, CHUNK_BYTES - within);
+
+        auto& chunk = m_chunks[index];
+        if (!chunk) {
+            chunk = std::make_unique<char[]>(CHUNK_BYTES);  // Zeroed
+        }
+        std::memcpy(chunk.get() + within, data, n);
+
+        offset += n;
+        data += n;
+        size -= n;
+    }
+}
+
+void WriteBuffer::resize(size_t size) {
+    if (size < m_size) {
+        // Bytes past the new end must read as zero if the file grows again
+        size_t within = size % CHUNK_BYTES;
+        size_t keep = (size + CHUNK_BYTES - 1) / CHUNK_BYTES;
+        if (within > 0 && m_chunks[size / CHUNK_BYTES]) {
+            std::memset(m_chunks[size / CHUNK_BYTES].get() + within, 0, CHUNK_BYTES - within);
+        }
+        m_chunks.resize(keep);
+    } else {
+        m_chunks.resize((size + CHUNK_BYTES - 1) / CHUNK_BYTES);
+    }
+    m_size = size;
+}
+
+void WriteBuffer::clear() {
+    m_chunks.clear();
+    m_size = 0;
+}
+
+size_t WriteBuffer::copy(size_t pos, size_t n, char* out) const {
+    if (pos >= m_size) return 0;
+    n = std::min(n, m_size - pos);
+
+    size_t copied = 0;
+    while (copied < n) {
+        size_t index = pos / CHUNK_BYTES;
+        size_t within = pos % CHUNK_BYTES;
+        size_t len = std::min(n - copied, CHUNK_BYTES - within);
+
+        if (m_chunks[index]) {
+            std::memcpy(out + copied, m_chunks[index].get() + within, len);
+        } else {
+            std::memset(out + copied, 0, len);
+        }
+
+        pos += len;
+        copied += len;
+    }
+    return copied;
+}
+
+std::string WriteBuffer::substr(size_t pos, size_t n) const {
+    if (pos >= m_size) return {};
+    std::string out(std::min(n, m_size - pos), '\0');
+    copy(pos, out.size(), out.data());
+    return out;
+}
+
+char WriteBuffer::at(size_t pos) const {
+    const auto& chunk = m_chunks[pos / CHUNK_BYTES];
+    return chunk ? chunk[pos % CHUNK_BYTES] : '\0';
+}
+
+bool WriteBuffer::equals(std::string_view data) const {
+    if (data.size() != m_size) return false;
+
+    for (size_t pos = 0; pos < m_size; pos += CHUNK_BYTES) {
+        size_t len = std::min(CHUNK_BYTES, m_size - pos);
+        const auto& chunk = m_chunks[pos / CHUNK_BYTES];
+        if (chunk) {
+            if (std::memcmp(chunk.get(), data.data() + pos, len) != 0) return false;
+        } else if (data.find_first_not_of('\0', pos) < pos + len) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace sqlfuse
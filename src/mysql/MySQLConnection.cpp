@@ -8,6 +8,10 @@
 
 #include "MySQLConnection.hpp"
 #include "MySQLConnectionPool.hpp"
+#include <mysql/errmsg.h>
+#include <algorithm>
+#include <cstring>
+#include <exception>
 
 namespace sqlfuse {
 
@@ -128,6 +132,81 @@ uint64_t MySQLConnection::insertId() const {
     return mysql_insert_id(m_conn);
 }
 
+unsigned int MySQLConnection::warningCount() const {
+    if (!m_conn) return 0;
+    return mysql_warning_count(m_conn);
+}
+
+// ============================================================================
+// LOAD DATA LOCAL INFILE
+// ============================================================================
+
+namespace {
+
+// libmysqlclient local-infile callbacks. userdata is the InfileState of the
+// running loadLocalInfile(), or nullptr for the refusing handler.
+struct InfileState {
+    const MySQLConnection::InfileSource* source = nullptr;
+    std::string chunk;
+    size_t pos = 0;
+    std::string error;
+};
+
+int infileInit(void** ptr, const char* /*filename*/, void* userdata) {
+    *ptr = userdata;
+    return userdata ? 0 : 1;
+}
+
+int infileRead(void* ptr, char* buf, unsigned int buf_len) {
+    auto* state = static_cast<InfileState*>(ptr);
+    if (state->pos == state->chunk.size()) {
+        state->chunk.clear();
+        state->pos = 0;
+        try {
+            (*state->source)(state->chunk);
+        } catch (const std::exception& e) {
+            state->error = e.what();
+            return -1;
+        }
+        if (state->chunk.empty()) return 0;
+    }
+
+    size_t n = std::min<size_t>(buf_len, state->chunk.size() - state->pos);
+    std::memcpy(buf, state->chunk.data() + state->pos, n);
+    state->pos += n;
+    return static_cast<int>(n);
+}
+
+void infileEnd(void* /*ptr*/) {}
+
+int infileError(void* ptr, char* error_msg, unsigned int error_msg_len) {
+    auto* state = static_cast<InfileState*>(ptr);
+    const char* message = state ? state->error.c_str()
+                                : "LOCAL INFILE is only served for sql-fuse table writes";
+    if (error_msg_len > 0) {
+        std::strncpy(error_msg, message, error_msg_len - 1);
+        error_msg[error_msg_len - 1] = '\0';
+    }
+    return CR_UNKNOWN_ERROR;
+}
+
+}  // namespace
+
+bool MySQLConnection::loadLocalInfile(const std::string& sql, const InfileSource& source) {
+    if (!isValid()) return false;
+
+    InfileState state;
+    state.source = &source;
+    mysql_set_local_infile_handler(m_conn, infileInit, infileRead, infileEnd, infileError, &state);
+    bool ok = query(sql);
+    refuseLocalInfile(m_conn);
+    return ok;
+}
+
+void MySQLConnection::refuseLocalInfile(MYSQL* conn) {
+    mysql_set_local_infile_handler(conn, infileInit, infileRead, infileEnd, infileError, nullptr);
+}
+
 // ============================================================================
 // Connection Pool Integration
 // ============================================================================
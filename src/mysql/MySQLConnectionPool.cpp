@@ -76,6 +76,12 @@ MYSQL* MySQLConnectionPool::createConnection() {
     bool reconnect = true;
     mysql_options(conn, MYSQL_OPT_RECONNECT, &reconnect);
 
+    // Allow LOAD DATA LOCAL INFILE for table writes; the handler refuses
+    // every request except those served from memory by loadLocalInfile()
+    unsigned int localInfile = 1;
+    mysql_options(conn, MYSQL_OPT_LOCAL_INFILE, &localInfile);
+    MySQLConnection::refuseLocalInfile(conn);
+
     // Configure SSL if enabled
     if (m_config.use_ssl) {
         mysql_ssl_set(conn,
@@ -7,122 +7,76 @@
  */
 
 #include "MySQLFormatConverter.hpp"
+#include "ResultBatch.hpp"
 #include <sstream>
 
 namespace sqlfuse {
 
 // ============================================================================
-// Result Set to CSV Conversion
+// Result Set Conversion
 // ============================================================================
 
-std::string MySQLFormatConverter::toCSV(MYSQL_RES* result, const CSVOptions& options) {
-    if (!result) {
-        return "";
-    }
-
-    std::ostringstream out;
-
+std::vector<std::string> MySQLFormatConverter::columnNames(MYSQL_RES* result) {
     unsigned int num_fields = mysql_num_fields(result);
     MYSQL_FIELD* fields = mysql_fetch_fields(result);
 
-    // Write header row with column names
-    if (options.includeHeader) {
-        for (unsigned int i = 0; i < num_fields; ++i) {
-            if (i > 0) out << options.delimiter;
-            out << escapeCSVField(fields[i].name, options);
-        }
-        out << options.lineEnding;
+    std::vector<std::string> names;
+    names.reserve(num_fields);
+    for (unsigned int i = 0; i < num_fields; ++i) {
+        names.emplace_back(fields[i].name);
     }
+    return names;
+}
 
-    // Write data rows
-    MYSQL_ROW row;
-    unsigned long* lengths;
+void MySQLFormatConverter::appendRow(MYSQL_ROW row, MYSQL_RES* result, ResultBatch& batch) {
+    MYSQL_FIELD* fields = mysql_fetch_fields(result);
+    unsigned long* lengths = mysql_fetch_lengths(result);
 
-    while ((row = mysql_fetch_row(result))) {
-        lengths = mysql_fetch_lengths(result);
+    for (size_t i = 0; i < batch.columnCount(); ++i) {
+        ResultColumn& column = batch.column(i);
 
-        for (unsigned int i = 0; i < num_fields; ++i) {
-            if (i > 0) out << options.delimiter;
+        if (!row[i]) {
+            column.appendNull();
+            continue;
+        }
 
-            if (row[i]) {
-                // Use length to handle binary data correctly
-                std::string value(row[i], lengths[i]);
-                out << escapeCSVField(value, options);
-            }
-            // NULL values are represented as empty fields
+        // Use length to handle binary data correctly
+        std::string_view value(row[i], lengths[i]);
+
+        // IS_NUM covers the integer, floating point and DECIMAL types; their
+        // text is kept as sent by the server so DECIMAL keeps its precision
+        if (IS_NUM(fields[i].type)) {
+            column.appendNumber(value);
+        } else {
+            column.appendText(value);
         }
-        out << options.lineEnding;
     }
-
-    return out.str();
 }
 
-// ============================================================================
-// Result Set to JSON Conversion
-// ============================================================================
-
-std::string MySQLFormatConverter::toJSON(MYSQL_RES* result, const JSONOptions& options) {
-    if (!result) {
-        return options.arrayFormat ? "[]" : "{\"rows\": []}";
+bool MySQLFormatConverter::fillBatch(MYSQL_RES* result, ResultBatch& batch) {
+    MYSQL_ROW row;
+    while (!batch.full() && (row = mysql_fetch_row(result))) {
+        appendRow(row, result, batch);
     }
+    return batch.rowCount() > 0;
+}
 
-    unsigned int num_fields = mysql_num_fields(result);
-    MYSQL_FIELD* fields = mysql_fetch_fields(result);
-
-    // Extract column names for JSON keys
-    std::vector<std::string> column_names;
-    column_names.reserve(num_fields);
-    for (unsigned int i = 0; i < num_fields; ++i) {
-        column_names.emplace_back(fields[i].name);
+std::string MySQLFormatConverter::toCSV(MYSQL_RES* result, const CSVOptions& options) {
+    if (!result) {
+        return "";
     }
 
-    json arr = json::array();
-    MYSQL_ROW row;
-    unsigned long* lengths;
-
-    while ((row = mysql_fetch_row(result))) {
-        lengths = mysql_fetch_lengths(result);
-        json obj = json::object();
-
-        for (unsigned int i = 0; i < num_fields; ++i) {
-            if (row[i]) {
-                std::string value(row[i], lengths[i]);
-
-                // Preserve numeric types in JSON output
-                // IS_NUM macro checks MySQL field type flags
-                if (IS_NUM(fields[i].type)) {
-                    try {
-                        if (fields[i].type == MYSQL_TYPE_FLOAT ||
-                            fields[i].type == MYSQL_TYPE_DOUBLE ||
-                            fields[i].type == MYSQL_TYPE_DECIMAL ||
-                            fields[i].type == MYSQL_TYPE_NEWDECIMAL) {
-                            obj[column_names[i]] = std::stod(value);
-                        } else {
-                            obj[column_names[i]] = std::stoll(value);
-                        }
-                    } catch (...) {
-                        // Fall back to string if conversion fails
-                        obj[column_names[i]] = value;
-                    }
-                } else {
-                    obj[column_names[i]] = value;
-                }
-            } else if (options.includeNull) {
-                obj[column_names[i]] = nullptr;
-            }
-        }
+    ResultBatch batch(columnNames(result));
+    return FormatConverter::toCSV(batch, [&](ResultBatch& b) { return fillBatch(result, b); }, options);
+}
 
-        arr.push_back(std::move(obj));
+std::string MySQLFormatConverter::toJSON(MYSQL_RES* result, const JSONOptions& options) {
+    if (!result) {
+        return options.arrayFormat ? "[]" : "{\"rows\": []}";
     }
 
-    // Format output based on options
-    if (options.arrayFormat) {
-        return options.pretty ? arr.dump(options.indent) : arr.dump();
-    } else {
-        json wrapper = json::object();
-        wrapper["rows"] = std::move(arr);
-        return options.pretty ? wrapper.dump(options.indent) : wrapper.dump();
-    }
+    ResultBatch batch(columnNames(result));
+    return FormatConverter::toJSON(batch, [&](ResultBatch& b) { return fillBatch(result, b); }, options);
 }
 
 std::string MySQLFormatConverter::rowToJSON(MYSQL_ROW row, MYSQL_RES* result,
@@ -131,39 +85,9 @@ std::string MySQLFormatConverter::rowToJSON(MYSQL_ROW row, MYSQL_RES* result,
         return "{}";
     }
 
-    unsigned int num_fields = mysql_num_fields(result);
-    MYSQL_FIELD* fields = mysql_fetch_fields(result);
-    unsigned long* lengths = mysql_fetch_lengths(result);
-
-    json obj = json::object();
-
-    for (unsigned int i = 0; i < num_fields; ++i) {
-        if (row[i]) {
-            std::string value(row[i], lengths[i]);
-
-            // Apply same numeric type preservation as toJSON
-            if (IS_NUM(fields[i].type)) {
-                try {
-                    if (fields[i].type == MYSQL_TYPE_FLOAT ||
-                        fields[i].type == MYSQL_TYPE_DOUBLE ||
-                        fields[i].type == MYSQL_TYPE_DECIMAL ||
-                        fields[i].type == MYSQL_TYPE_NEWDECIMAL) {
-                        obj[fields[i].name] = std::stod(value);
-                    } else {
-                        obj[fields[i].name] = std::stoll(value);
-                    }
-                } catch (...) {
-                    obj[fields[i].name] = value;
-                }
-            } else {
-                obj[fields[i].name] = value;
-            }
-        } else if (options.includeNull) {
-            obj[fields[i].name] = nullptr;
-        }
-    }
-
-    return options.pretty ? obj.dump(options.indent) : obj.dump();
+    ResultBatch batch(columnNames(result), 1);
+    appendRow(row, result, batch);
+    return FormatConverter::rowToJSON(batch, 0, options);
 }
 
 // ============================================================================
@@ -208,6 +132,68 @@ std::string MySQLFormatConverter::buildInsert(const std::string& table,
     return sql.str();
 }
 
+InsertSyntax MySQLFormatConverter::insertSyntax(const std::string& table,
+                                                const std::vector<std::string>& columns,
+                                                const std::string& duplicates) {
+    InsertSyntax syntax;
+    if (duplicates == "replace") {
+        syntax.head = "REPLACE INTO ";
+    } else if (duplicates == "ignore") {
+        syntax.head = "INSERT IGNORE INTO ";
+    } else {
+        syntax.head = "INSERT INTO ";
+    }
+    syntax.head += escapeIdentifier(table) + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) syntax.head += ", ";
+        syntax.head += escapeIdentifier(columns[i]);
+    }
+    syntax.head += ") VALUES ";
+    syntax.separator = ", ";
+    return syntax;
+}
+
+std::string MySQLFormatConverter::buildLoadData(const std::string& table,
+                                               const std::vector<std::string>& columns,
+                                               const std::string& duplicates) {
+    std::string sql = "LOAD DATA LOCAL INFILE 'sql-fuse'";
+    if (duplicates == "replace") {
+        sql += " REPLACE";
+    } else if (duplicates == "ignore") {
+        sql += " IGNORE";
+    }
+    sql += " INTO TABLE " + escapeIdentifier(table) + " CHARACTER SET utf8mb4";
+    sql += " FIELDS TERMINATED BY '\\t' ESCAPED BY '\\\\' LINES TERMINATED BY '\\n' (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) sql += ", ";
+        sql += escapeIdentifier(columns[i]);
+    }
+    sql += ")";
+    return sql;
+}
+
+void MySQLFormatConverter::appendLoadDataRow(std::string& out,
+                                             const std::vector<FieldView>& fields) {
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i > 0) out += '\t';
+        if (!fields[i]) {
+            out += "\\N";
+            continue;
+        }
+        for (char c : *fields[i]) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\0': out += "\\0"; break;
+                default:   out += c; break;
+            }
+        }
+    }
+    out += '\n';
+}
+
 std::string MySQLFormatConverter::buildUpdate(const std::string& table,
                                                const RowData& row,
                                                const std::string& pkColumn,
@@ -254,6 +240,32 @@ std::string MySQLFormatConverter::buildUpdate(const std::string& table,
     return sql.str();
 }
 
+std::string MySQLFormatConverter::buildUpsert(const std::string& table,
+                                              const RowData& row,
+                                              const std::string& pkColumn,
+                                              bool escape) {
+    std::string sql = buildInsert(table, row, escape);
+    if (sql.empty()) {
+        return sql;
+    }
+
+    // VALUES(col) rather than a row alias: MariaDB has no alias syntax
+    std::string updates;
+    for (const auto& [col, val] : row) {
+        if (col == pkColumn) continue;
+        if (!updates.empty()) updates += ", ";
+        std::string quoted = escapeIdentifier(col);
+        updates += quoted + " = VALUES(" + quoted + ")";
+    }
+    if (updates.empty()) {
+        // Only the key was written: leave an existing row as it is
+        std::string quoted = escapeIdentifier(pkColumn);
+        updates = quoted + " = " + quoted;
+    }
+
+    return sql + " ON DUPLICATE KEY UPDATE " + updates;
+}
+
 std::string MySQLFormatConverter::buildDelete(const std::string& table,
                                                const std::string& pkColumn,
                                                const std::string& pkValue,
@@ -298,25 +310,37 @@ std::string MySQLFormatConverter::escapeIdentifier(const std::string& identifier
     return result;
 }
 
-std::string MySQLFormatConverter::escapeSQL(const std::string& value) {
-    // MySQL uses backslash escaping for special characters
-    std::string result;
-    result.reserve(value.size() * 2);
+namespace {
 
+// MySQL uses backslash escaping for special characters
+void appendEscaped(std::string& out, std::string_view value) {
     for (char c : value) {
         switch (c) {
-            case '\0': result += "\\0"; break;    // NUL byte
-            case '\n': result += "\\n"; break;    // Newline
-            case '\r': result += "\\r"; break;    // Carriage return
-            case '\\': result += "\\\\"; break;   // Backslash
-            case '\'': result += "\\'"; break;    // Single quote
-            case '"':  result += "\\\""; break;   // Double quote
-            case '\x1a': result += "\\Z"; break;  // Ctrl+Z (Windows EOF)
-            default:   result += c; break;
+            case '\0': out += "\\0"; break;    // NUL byte
+            case '\n': out += "\\n"; break;    // Newline
+            case '\r': out += "\\r"; break;    // Carriage return
+            case '\\': out += "\\\\"; break;   // Backslash
+            case '\'': out += "\\'"; break;    // Single quote
+            case '"':  out += "\\\""; break;   // Double quote
+            case '\x1a': out += "\\Z"; break;  // Ctrl+Z (Windows EOF)
+            default:   out += c; break;
         }
     }
+}
+
+}  // namespace
 
+std::string MySQLFormatConverter::escapeSQL(const std::string& value) {
+    std::string result;
+    result.reserve(value.size() * 2);
+    appendEscaped(result, value);
     return result;
 }
 
+void MySQLFormatConverter::appendLiteral(std::string& sql, std::string_view value) {
+    sql += '\'';
+    appendEscaped(sql, value);
+    sql += '\'';
+}
+
 }  // namespace sqlfuse
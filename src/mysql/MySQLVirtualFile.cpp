@@ -12,6 +12,7 @@
 #include "FormatConverter.hpp"
 #include "ErrorHandler.hpp"
 #include <spdlog/spdlog.h>
+#include <optional>
 #include <sstream>
 
 namespace sqlfuse {
@@ -41,6 +42,9 @@ std::string MySQLVirtualFile::generateTableCSV() {
         m_lastError = "No MySQL connection pool";
         return "";
     }
+    if (auto parallel = parallelTableExport(false)) {
+        return *parallel;
+    }
     auto conn = pool->acquire();
 
     // Build SELECT query with optional row limit
@@ -67,6 +71,9 @@ std::string MySQLVirtualFile::generateTableJSON() {
         m_lastError = "No MySQL connection pool";
         return "";
     }
+    if (auto parallel = parallelTableExport(true)) {
+        return *parallel;
+    }
     auto conn = pool->acquire();
 
     // Build SELECT query with optional row limit
@@ -87,6 +94,78 @@ std::string MySQLVirtualFile::generateTableJSON() {
     return MySQLFormatConverter::toJSON(result.get(), opts);
 }
 
+KeySource MySQLVirtualFile::exportKeySource(const std::string& pkColumn) {
+    std::string table = "`" + m_path.database + "`.`" + m_path.object_name + "`";
+    std::string key = "`" + pkColumn + "`";
+
+    KeySource source;
+    source.bounds = [this, table, key]() -> std::optional<std::pair<std::string, std::string>> {
+        auto conn = getPool()->acquire();
+        if (!conn->query("SELECT MIN(" + key + "), MAX(" + key + ") FROM " + table)) {
+            throw MySQLException(conn->get());
+        }
+        MySQLResultSet result(conn->storeResult());
+        MYSQL_ROW row = result.fetchRow();
+        if (!row || !row[0] || !row[1]) {
+            return std::nullopt;
+        }
+        return std::make_pair(std::string(row[0]), std::string(row[1]));
+    };
+    source.keyAt = [this, table, key](const std::optional<std::string>& from,
+                                      size_t offset) -> std::optional<std::string> {
+        std::string sql = "SELECT " + key + " FROM " + table;
+        if (from) {
+            sql += " WHERE " + key + " >= '" + MySQLFormatConverter::escapeSQL(*from) + "'";
+        }
+        sql += " ORDER BY " + key + " LIMIT 1 OFFSET " + std::to_string(offset);
+
+        auto conn = getPool()->acquire();
+        if (!conn->query(sql)) {
+            throw MySQLException(conn->get());
+        }
+        MySQLResultSet result(conn->storeResult());
+        MYSQL_ROW row = result.fetchRow();
+        if (!row || !row[0]) {
+            return std::nullopt;
+        }
+        return std::string(row[0]);
+    };
+    return source;
+}
+
+std::string MySQLVirtualFile::renderKeyRange(const std::string& pkColumn, const KeyRange& range,
+                                             bool json, bool header) {
+    std::string key = "`" + pkColumn + "`";
+    std::string sql = "SELECT * FROM `" + m_path.database + "`.`" + m_path.object_name + "`";
+    if (range.lower) {
+        sql += " WHERE " + key + " >= '" + MySQLFormatConverter::escapeSQL(*range.lower) + "'";
+    }
+    if (range.upper) {
+        sql += range.lower ? " AND " : " WHERE ";
+        sql += key + " < '" + MySQLFormatConverter::escapeSQL(*range.upper) + "'";
+    }
+    sql += " ORDER BY " + key;
+    if (range.limit > 0) {
+        sql += " LIMIT " + std::to_string(range.limit);
+    }
+
+    auto conn = getPool()->acquire();
+    if (!conn->query(sql)) {
+        throw MySQLException(conn->get());
+    }
+
+    MySQLResultSet result(conn->storeResult());
+
+    if (json) {
+        JSONOptions opts;
+        opts.pretty = m_config.pretty_json;
+        return MySQLFormatConverter::toJSON(result.get(), opts);
+    }
+    CSVOptions opts;
+    opts.includeHeader = header;
+    return MySQLFormatConverter::toCSV(result.get(), opts);
+}
+
 // ============================================================================
 // Row Content Generation
 // ============================================================================
@@ -280,45 +359,256 @@ std::string MySQLVirtualFile::generateUserInfo() {
 // Write Operations
 // ============================================================================
 
-int MySQLVirtualFile::handleTableWrite() {
-    if (m_writeBuffer.empty()) {
+namespace {
+
+constexpr size_t LOAD_DATA_CHUNK_BYTES = 256 * 1024;  // Bytes per infile read
+constexpr size_t MAX_IDENTIFIER_LENGTH = 64;
+
+// ER_NOT_ALLOWED_COMMAND, CR_LOAD_DATA_LOCAL_INFILE_REJECTED,
+// ER_CLIENT_LOCAL_FILES_DISABLED: LOCAL INFILE is switched off
+bool localInfileDisabled(unsigned int errorNumber) {
+    return errorNumber == 1148 || errorNumber == 2068 || errorNumber == 3948;
+}
+
+// How a replacing write (replace_table_writes) puts its rows in place:
+// either loaded into a staging table that is renamed over the table after
+// COMMIT, or loaded into the table after deleting its rows in the same
+// transaction. Empty for an ordinary write.
+struct ReplacePlan {
+    std::string clear;      // After START TRANSACTION
+    std::string swap;       // After COMMIT; a failure fails the write
+    std::string dropOld;    // After the swap
+    std::string dropStage;  // On abort
+};
+
+// One table write in one transaction. Each write() is one LOAD DATA LOCAL
+// INFILE statement whose rows are re-encoded LOAD_DATA_CHUNK_BYTES at a time
+// as the client library asks for them, so no temporary file is written. If
+// the server has LOCAL INFILE disabled, multi-row INSERTs are used instead.
+class MySQLTableWriteStream : public TableWriteStream {
+public:
+    MySQLTableWriteStream(std::unique_ptr<MySQLConnection> conn, std::string table,
+                          const std::vector<std::string>& columns, const DataConfig& config,
+                          const InsertLimits& limits, ReplacePlan replace = {})
+        : m_conn(std::move(conn)),
+          m_table(std::move(table)),
+          m_replace(std::move(replace)),
+          m_duplicates(config.mysql_on_duplicate),
+          m_loadData(config.mysql_load_data_writes),
+          m_loadSQL(MySQLFormatConverter::buildLoadData(m_table, columns, m_duplicates)),
+          m_batcher(MySQLFormatConverter::insertSyntax(m_table, columns, m_duplicates),
+                    MySQLFormatConverter::appendLiteral,
+                    InsertSession{[this](const std::string& sql) { return run(sql); },
+                                  [] { return true; },  // The stream owns the transaction
+                                  [] { return true; },
+                                  [] {},
+                                  [this] { return std::string(m_conn->error()); }},
+                    limits) {}
+
+    int begin() override {
+        if (!run("START TRANSACTION")) return fail(m_conn->error());
+        if (!m_replace.clear.empty() && !run(m_replace.clear)) return fail(m_conn->error());
+        m_batcher.begin();
         return 0;
     }
 
-    auto* pool = getPool();
-    if (!pool) {
-        m_lastError = "No MySQL connection pool";
-        return -EIO;
+    int write(RowReader& reader) override {
+        if (m_loadData) {
+            if (auto result = loadData(reader)) {
+                return *result;
+            }
+            spdlog::warn("LOCAL INFILE disabled on the server ({}); loading {} with INSERTs",
+                         m_error, m_table);
+            m_loadData = false;
+        }
+        return m_batcher.append(reader) ? 0 : fail(m_batcher.error());
     }
 
-    try {
-        // Parse written data as CSV or JSON
-        std::vector<RowData> rows;
+    int finish() override {
+        if (!m_batcher.finish()) return fail(m_batcher.error());
+        if (!run("COMMIT")) return fail(m_conn->error());
+
+        if (!m_replace.swap.empty()) {
+            // RENAME TABLE swaps both names atomically
+            if (!run(m_replace.swap)) return fail(m_conn->error());
+            m_replace.dropStage.clear();
+            if (!run(m_replace.dropOld)) {
+                spdlog::warn("Replaced {} but could not drop the old rows: {}", m_table,
+                             m_conn->error());
+            }
+        }
 
-        if (m_path.format == FileFormat::CSV) {
-            CSVOptions opts;
-            opts.includeHeader = true;  // Assume header in written data
-            rows = FormatConverter::parseCSV(m_writeBuffer, opts);
+        spdlog::debug("Loaded {} rows into {} ({} LOAD DATA, {} INSERT statements)",
+                      m_loaded + m_batcher.rows(), m_table, m_loads, m_batcher.statements());
+        return 0;
+    }
 
-        } else if (m_path.format == FileFormat::JSON) {
-            rows = FormatConverter::parseJSON(m_writeBuffer);
-        } else {
-            return -EINVAL;
+    void abort() override {
+        m_batcher.abort();
+        m_conn->query("ROLLBACK");
+        if (!m_replace.dropStage.empty()) {
+            m_conn->query(m_replace.dropStage);
         }
+    }
 
-        auto conn = pool->acquire();
+private:
+    bool run(const std::string& sql) {
+        if (m_conn->query(sql)) return true;
+        m_errorNumber = m_conn->errorNumber();
+        return false;
+    }
 
-        // Insert each row
-        for (const auto& row : rows) {
-            std::string sql = MySQLFormatConverter::buildInsert(
-                m_path.database + "." + m_path.object_name, row, true);
+    int fail(const std::string& error) {
+        m_error = error;
+        int err = ErrorHandler::mysqlToErrno(m_errorNumber);
+        return err ? -err : -EIO;
+    }
+
+    // std::nullopt if LOCAL INFILE is disabled and no row was consumed
+    std::optional<int> loadData(RowReader& reader) {
+        size_t rows = 0;
+        bool started = false;
+        auto source = [&](std::string& chunk) {
+            started = true;
+            while (chunk.size() < LOAD_DATA_CHUNK_BYTES && reader.next()) {
+                MySQLFormatConverter::appendLoadDataRow(chunk, reader.row());
+                ++rows;
+            }
+        };
+
+        if (!m_conn->loadLocalInfile(m_loadSQL, source)) {
+            m_errorNumber = m_conn->errorNumber();
+            m_error = m_conn->error();
+            if (!started && localInfileDisabled(m_errorNumber)) {
+                return std::nullopt;
+            }
+            return fail(m_error);
+        }
 
-            if (!conn->query(sql)) {
-                m_lastError = conn->error();
-                return -ErrorHandler::mysqlToErrno(conn->errorNumber());
+        if (m_duplicates == "error" && m_conn->warningCount() > 0) {
+            // Without REPLACE/IGNORE a LOCAL load skips duplicate keys with a
+            // warning instead of failing; truncated values also warn
+            std::string message = "LOAD DATA reported warnings";
+            if (m_conn->query("SHOW WARNINGS LIMIT 1")) {
+                MySQLResultSet warnings(m_conn->storeResult());
+                if (MYSQL_ROW row = warnings.fetchRow(); row && row[2]) {
+                    message = row[2];
+                }
             }
+            m_errorNumber = 0;
+            return fail(message);
         }
 
+        m_loaded += rows;
+        ++m_loads;
+        return 0;
+    }
+
+    std::unique_ptr<MySQLConnection> m_conn;
+    std::string m_table;
+    ReplacePlan m_replace;
+    std::string m_duplicates;
+    bool m_loadData;
+    std::string m_loadSQL;
+    InsertBatcher m_batcher;
+    unsigned int m_errorNumber = 0;
+    size_t m_loaded = 0;  // Rows sent with LOAD DATA
+    size_t m_loads = 0;
+};
+
+// Plan a replacing write of `database`.`table`. The staging-table swap is
+// used only when it loses nothing CREATE TABLE ... LIKE does not copy:
+// triggers, and foreign keys in either direction (InnoDB would move
+// references to the renamed old table). `target` becomes the table to load.
+ReplacePlan planReplace(MySQLConnection& conn, const std::string& database,
+                        const std::string& table, std::string& target) {
+    const std::string qualified = database + "." + table;
+    const std::string stage = table + "_sqlfuse_new";
+    const std::string old = table + "_sqlfuse_old";
+
+    ReplacePlan deleting;
+    deleting.clear = "DELETE FROM " + MySQLFormatConverter::escapeIdentifier(qualified);
+
+    if (old.size() > MAX_IDENTIFIER_LENGTH) {
+        return deleting;
+    }
+
+    const std::string db = MySQLFormatConverter::escapeSQL(database);
+    const std::string name = MySQLFormatConverter::escapeSQL(table);
+    std::string dependents =
+        "SELECT (SELECT COUNT(*) FROM information_schema.TRIGGERS"
+        " WHERE EVENT_OBJECT_SCHEMA = '" + db + "' AND EVENT_OBJECT_TABLE = '" + name + "')"
+        " + (SELECT COUNT(*) FROM information_schema.KEY_COLUMN_USAGE"
+        " WHERE REFERENCED_TABLE_NAME IS NOT NULL"
+        " AND ((TABLE_SCHEMA = '" + db + "' AND TABLE_NAME = '" + name + "')"
+        " OR (REFERENCED_TABLE_SCHEMA = '" + db + "' AND REFERENCED_TABLE_NAME = '" + name + "')))";
+    if (!conn.query(dependents)) {
+        return deleting;
+    }
+    MySQLResultSet result(conn.storeResult());
+    MYSQL_ROW row = result.fetchRow();
+    if (!row || !row[0] || std::string(row[0]) != "0") {
+        return deleting;
+    }
+
+    const std::string stageName = MySQLFormatConverter::escapeIdentifier(database + "." + stage);
+    const std::string oldName = MySQLFormatConverter::escapeIdentifier(database + "." + old);
+    const std::string tableName = MySQLFormatConverter::escapeIdentifier(qualified);
+
+    // Left behind by an interrupted replace
+    conn.query("DROP TABLE IF EXISTS " + stageName + ", " + oldName);
+    if (!conn.query("CREATE TABLE " + stageName + " LIKE " + tableName)) {
+        spdlog::warn("Cannot create a staging table for {} ({}); replacing its rows in place",
+                     qualified, conn.error());
+        return deleting;
+    }
+
+    target = database + "." + stage;
+    ReplacePlan swap;
+    swap.swap = "RENAME TABLE " + tableName + " TO " + oldName + ", " + stageName + " TO " +
+                tableName;
+    swap.dropOld = "DROP TABLE " + oldName;
+    swap.dropStage = "DROP TABLE IF EXISTS " + stageName;
+    return swap;
+}
+
+}  // namespace
+
+std::unique_ptr<TableWriteStream> MySQLVirtualFile::openTableWriteStream(
+    const std::vector<std::string>& columns) {
+    auto* pool = getPool();
+    if (!pool) {
+        return TableWriteStream::failed(-EIO, "No MySQL connection pool");
+    }
+
+    auto conn = pool->acquire();
+    if (!conn) {
+        return TableWriteStream::failed(-EIO, "No MySQL connection available");
+    }
+
+    std::string target = m_path.database + "." + m_path.object_name;
+    ReplacePlan replace;
+    if (m_replace) {
+        replace = planReplace(*conn, m_path.database, m_path.object_name, target);
+    }
+
+    return std::make_unique<MySQLTableWriteStream>(std::move(conn), target, columns, m_config,
+                                                   insertLimits(), std::move(replace));
+}
+
+int MySQLVirtualFile::rowWriteStatement(std::string& sql) {
+    try {
+        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
+        if (!table_info || table_info->primaryKeyColumn.empty()) {
+            m_lastError = "No primary key defined";
+            return -EINVAL;
+        }
+
+        // The file name identifies the row; one statement inserts or updates it
+        RowData row = FormatConverter::parseJSONRow(m_writeBuffer.str());
+        row[table_info->primaryKeyColumn] = m_path.row_id;
+        sql = MySQLFormatConverter::buildUpsert(
+            m_path.database + "." + m_path.object_name, row, table_info->primaryKeyColumn);
         return 0;
 
     } catch (const std::exception& e) {
@@ -338,51 +628,14 @@ int MySQLVirtualFile::handleRowWrite() {
         return -EIO;
     }
 
-    try {
-        // Get primary key info for INSERT/UPDATE decision
-        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
-        if (!table_info || table_info->primaryKeyColumn.empty()) {
-            m_lastError = "No primary key defined";
-            return -EINVAL;
-        }
-
-        RowData row = FormatConverter::parseJSONRow(m_writeBuffer);
+    std::string sql;
+    if (int result = rowWriteStatement(sql); result != 0) {
+        return result;
+    }
 
+    try {
         auto conn = pool->acquire();
 
-        // Check if row exists to decide between INSERT and UPDATE
-        bool rowExists = false;
-        bool isNumericId = !m_path.row_id.empty() &&
-                          m_path.row_id.find_first_not_of("0123456789") == std::string::npos;
-
-        if (isNumericId) {
-            std::string checkSql = "SELECT 1 FROM `" + m_path.database + "`.`" + m_path.object_name +
-                                   "` WHERE `" + table_info->primaryKeyColumn + "` = '" +
-                                   MySQLFormatConverter::escapeSQL(m_path.row_id) + "' LIMIT 1";
-            if (conn->query(checkSql)) {
-                MySQLResultSet result(conn->storeResult());
-                rowExists = (result.fetchRow() != nullptr);
-            }
-        }
-
-        std::string sql;
-
-        if (rowExists) {
-            // UPDATE existing row
-            sql = MySQLFormatConverter::buildUpdate(
-                m_path.database + "." + m_path.object_name,
-                row,
-                table_info->primaryKeyColumn,
-                m_path.row_id,
-                true);
-        } else {
-            // INSERT new row
-            sql = MySQLFormatConverter::buildInsert(
-                m_path.database + "." + m_path.object_name,
-                row,
-                true);
-        }
-
         if (!conn->query(sql)) {
             m_lastError = conn->error();
             return -ErrorHandler::mysqlToErrno(conn->errorNumber());
@@ -392,8 +645,65 @@ int MySQLVirtualFile::handleRowWrite() {
 
     } catch (const std::exception& e) {
         m_lastError = e.what();
-        return -EINVAL;
+        return -EIO;
+    }
+}
+
+WriteBehindQueue::OpenSession MySQLVirtualFile::writeSession() {
+    auto* pool = getPool();
+    if (!pool) {
+        return {};
+    }
+
+    return [pool]() -> std::optional<InsertSession> {
+        std::shared_ptr<MySQLConnection> conn = pool->acquire();
+        if (!conn) {
+            return std::nullopt;
+        }
+        return InsertSession{[conn](const std::string& sql) { return conn->query(sql); },
+                             [conn] { return conn->query("START TRANSACTION"); },
+                             [conn] { return conn->query("COMMIT"); },
+                             [conn] { conn->query("ROLLBACK"); },
+                             [conn] { return conn->error(); },
+                             [conn] { return -ErrorHandler::mysqlToErrno(conn->errorNumber()); }};
+    };
+}
+
+int MySQLVirtualFile::applyTableDiff(const TableDiff& diff, const std::string& pkColumn) {
+    auto* pool = getPool();
+    if (!pool) {
+        m_lastError = "No MySQL connection pool";
+        return -EIO;
+    }
+
+    auto conn = pool->acquire();
+    if (!conn) {
+        m_lastError = "No MySQL connection available";
+        return -EIO;
+    }
+
+    auto fail = [&] {
+        m_lastError = conn->error();
+        int err = ErrorHandler::mysqlToErrno(conn->errorNumber());
+        conn->query("ROLLBACK");
+        return err ? -err : -EIO;
+    };
+
+    if (!conn->query("START TRANSACTION")) {
+        return fail();
+    }
+
+    for (const auto& sql : diffStatements<MySQLFormatConverter>(
+             diff, m_path.database + "." + m_path.object_name, pkColumn)) {
+        if (!conn->query(sql)) {
+            return fail();
+        }
+    }
+
+    if (!conn->query("COMMIT")) {
+        return fail();
     }
+    return 0;
 }
 
 }  // namespace sqlfuse
@@ -10,6 +10,8 @@
 #include "OracleConnection.hpp"
 #include "OracleConnectionPool.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
 
 namespace sqlfuse {
 
@@ -119,19 +121,24 @@ bool OracleConnection::ping() {
  * Execute a SQL statement and return the statement handle.
  *
  * This method handles the full OCI statement lifecycle:
- * 1. Allocate a statement handle
- * 2. Prepare the SQL text
+ * 1. Get a prepared statement from the session's statement cache
+ * 2. (OCIStmtPrepare2 parses the SQL only on a cache miss)
  * 3. Determine statement type (SELECT vs DML/DDL)
  * 4. Execute with appropriate iteration count
  * 5. Capture affected rows for DML statements
  *
  * For SELECT statements, the caller receives an executed statement ready
- * for fetching. The caller is responsible for freeing the handle when done,
- * typically by passing it to OracleResultSet which takes ownership.
+ * for fetching. The caller is responsible for releasing the handle with
+ * OCIStmtRelease when done, typically by passing it to OracleResultSet
+ * which takes ownership. Releasing returns the statement to the cache,
+ * keyed by its SQL text, so the next identical query skips the parse.
  *
  * For DML/DDL statements, prefer executeNonQuery() which handles cleanup.
+ *
+ * When prefetchRows is set, the first rows of a SELECT come back with the
+ * execute round trip instead of costing a separate fetch.
  */
-OCIStmt* OracleConnection::execute(const std::string& sql) {
+OCIStmt* OracleConnection::execute(const std::string& sql, ub4 prefetchRows) {
     if (!isValid()) {
         spdlog::error("Oracle connection not valid");
         return nullptr;
@@ -140,19 +147,12 @@ OCIStmt* OracleConnection::execute(const std::string& sql) {
     OCIStmt* stmt = nullptr;
     sword status;
 
-    // Step 1: Allocate statement handle from the environment
-    status = OCIHandleAlloc(m_env, (void**)&stmt, OCI_HTYPE_STMT, 0, nullptr);
-    if (status != OCI_SUCCESS) {
-        spdlog::error("Failed to allocate Oracle statement handle");
-        return nullptr;
-    }
-
-    // Step 2: Prepare (parse) the SQL statement
-    status = OCIStmtPrepare(stmt, m_err, (const OraText*)sql.c_str(), sql.length(),
-                           OCI_NTV_SYNTAX, OCI_DEFAULT);
-    if (status != OCI_SUCCESS) {
+    // Steps 1-2: Take the statement from the cache, or prepare (parse) it
+    status = OCIStmtPrepare2(m_svc, &stmt, m_err, (const OraText*)sql.c_str(), sql.length(),
+                             nullptr, 0, OCI_NTV_SYNTAX, OCI_DEFAULT);
+    if (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO) {
         spdlog::error("Failed to prepare Oracle statement: {}", getError());
-        OCIHandleFree(stmt, OCI_HTYPE_STMT);
+        OCIStmtRelease(stmt, m_err, nullptr, 0, OCI_STRLS_CACHE_DELETE);
         return nullptr;
     }
 
@@ -162,6 +162,13 @@ OCIStmt* OracleConnection::execute(const std::string& sql) {
     ub2 stmtType = 0;
     OCIAttrGet(stmt, OCI_HTYPE_STMT, &stmtType, nullptr, OCI_ATTR_STMT_TYPE, m_err);
 
+    // Prefetch must be configured before execute to cover the first round trip
+    if (stmtType == OCI_STMT_SELECT && prefetchRows > 0) {
+        ub4 memory = PREFETCH_MEMORY_BYTES;
+        OCIAttrSet(stmt, OCI_HTYPE_STMT, &prefetchRows, 0, OCI_ATTR_PREFETCH_ROWS, m_err);
+        OCIAttrSet(stmt, OCI_HTYPE_STMT, &memory, 0, OCI_ATTR_PREFETCH_MEMORY, m_err);
+    }
+
     // Step 4: Execute the statement
     ub4 iters = (stmtType == OCI_STMT_SELECT) ? 0 : 1;
     status = OCIStmtExecute(m_svc, stmt, m_err, iters, 0, nullptr, nullptr, OCI_DEFAULT);
@@ -169,7 +176,8 @@ OCIStmt* OracleConnection::execute(const std::string& sql) {
     if (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO) {
         m_lastErrorCode = getErrorCode();
         spdlog::error("Failed to execute Oracle statement: {}", getError());
-        OCIHandleFree(stmt, OCI_HTYPE_STMT);
+        // Don't keep a statement that failed (e.g. invalidated by DDL) in the cache
+        OCIStmtRelease(stmt, m_err, nullptr, 0, OCI_STRLS_CACHE_DELETE);
         return nullptr;
     }
 
@@ -187,7 +195,7 @@ OCIStmt* OracleConnection::execute(const std::string& sql) {
  * Execute a non-query SQL statement (INSERT, UPDATE, DELETE, DDL).
  *
  * This is a convenience wrapper around execute() that automatically
- * frees the statement handle. Use this for statements that don't
+ * releases the statement handle back to the statement cache. Use this for statements that don't
  * return result sets.
  *
  * After calling, use affectedRows() to get the number of modified rows.
@@ -195,12 +203,127 @@ OCIStmt* OracleConnection::execute(const std::string& sql) {
 bool OracleConnection::executeNonQuery(const std::string& sql) {
     OCIStmt* stmt = execute(sql);
     if (stmt) {
-        OCIHandleFree(stmt, OCI_HTYPE_STMT);
+        OCIStmtRelease(stmt, m_err, nullptr, 0, OCI_DEFAULT);
         return true;
     }
     return false;
 }
 
+/**
+ * Execute a DML statement for a batch of rows with array binding.
+ *
+ * Values are copied column by column into fixed-stride buffers, with an
+ * indicator array for NULLs and a length array for the actual sizes, and
+ * each column is bound once for all rows. A single OCIStmtExecute with
+ * iters = rows.size() then sends the whole batch in one round trip.
+ *
+ * With OCI_BATCH_ERRORS the execute reports failed rows instead of stopping
+ * at the first: OCI_ATTR_NUM_DML_ERRORS gives their count, and each one is
+ * read through OCIParamGet on the error handle (row offset plus message).
+ */
+bool OracleConnection::executeArray(const std::string& sql, const std::vector<BindRow>& rows,
+                                    std::vector<OracleRowError>& rowErrors) {
+    rowErrors.clear();
+    m_affectedRows = 0;
+    if (!isValid()) {
+        spdlog::error("Oracle connection not valid");
+        return false;
+    }
+    if (rows.empty()) return true;
+
+    const size_t columns = rows.front().size();
+    const ub4 iters = static_cast<ub4>(rows.size());
+
+    struct BindColumn {
+        std::vector<char> data;
+        std::vector<sb2> indicators;
+        std::vector<ub2> lengths;
+        size_t width = 1;
+    };
+    std::vector<BindColumn> binds(columns);
+    for (size_t col = 0; col < columns; ++col) {
+        BindColumn& bind = binds[col];
+        for (const auto& row : rows) {
+            if (row[col]) bind.width = std::max(bind.width, row[col]->size());
+        }
+        bind.data.resize(bind.width * rows.size());
+        bind.indicators.resize(rows.size());
+        bind.lengths.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const auto& value = rows[i][col];
+            bind.indicators[i] = value ? 0 : -1;
+            bind.lengths[i] = value ? static_cast<ub2>(value->size()) : 0;
+            if (value) std::memcpy(bind.data.data() + i * bind.width, value->data(), value->size());
+        }
+    }
+
+    OCIStmt* stmt = nullptr;
+    sword status = OCIStmtPrepare2(m_svc, &stmt, m_err, (const OraText*)sql.c_str(), sql.length(),
+                                   nullptr, 0, OCI_NTV_SYNTAX, OCI_DEFAULT);
+    if (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO) {
+        m_lastErrorCode = getErrorCode();
+        spdlog::error("Failed to prepare Oracle statement: {}", getError());
+        OCIStmtRelease(stmt, m_err, nullptr, 0, OCI_STRLS_CACHE_DELETE);
+        return false;
+    }
+
+    for (size_t col = 0; col < columns; ++col) {
+        BindColumn& bind = binds[col];
+        OCIBind* handle = nullptr;
+        status = OCIBindByPos(stmt, &handle, m_err, static_cast<ub4>(col + 1), bind.data.data(),
+                              static_cast<sb4>(bind.width), SQLT_CHR, bind.indicators.data(),
+                              bind.lengths.data(), nullptr, 0, nullptr, OCI_DEFAULT);
+        if (status == OCI_SUCCESS) {
+            status = OCIBindArrayOfStruct(handle, m_err, static_cast<ub4>(bind.width),
+                                          sizeof(sb2), sizeof(ub2), 0);
+        }
+        if (status != OCI_SUCCESS) {
+            m_lastErrorCode = getErrorCode();
+            spdlog::error("Failed to bind Oracle array column {}: {}", col + 1, getError());
+            OCIStmtRelease(stmt, m_err, nullptr, 0, OCI_DEFAULT);
+            return false;
+        }
+    }
+
+    status = OCIStmtExecute(m_svc, stmt, m_err, iters, 0, nullptr, nullptr, OCI_BATCH_ERRORS);
+
+    ub4 errorCount = 0;
+    OCIAttrGet(stmt, OCI_HTYPE_STMT, &errorCount, nullptr, OCI_ATTR_NUM_DML_ERRORS, m_err);
+    if (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO && errorCount == 0) {
+        m_lastErrorCode = getErrorCode();
+        spdlog::error("Failed to execute Oracle array DML: {}", getError());
+        OCIStmtRelease(stmt, m_err, nullptr, 0, OCI_STRLS_CACHE_DELETE);
+        return false;
+    }
+
+    if (errorCount > 0) {
+        OCIError* rowErr = nullptr;
+        OCIHandleAlloc(m_env, (void**)&rowErr, OCI_HTYPE_ERROR, 0, nullptr);
+        for (ub4 i = 0; i < errorCount; ++i) {
+            if (OCIParamGet(m_err, OCI_HTYPE_ERROR, m_err, (void**)&rowErr, i) != OCI_SUCCESS) {
+                break;
+            }
+            OracleRowError error;
+            OCIAttrGet(rowErr, OCI_HTYPE_ERROR, &error.row, nullptr, OCI_ATTR_DML_ROW_OFFSET, m_err);
+            sb4 code = 0;
+            char errBuf[512] = {};
+            OCIErrorGet(rowErr, 1, nullptr, &code, (OraText*)errBuf, sizeof(errBuf), OCI_HTYPE_ERROR);
+            error.code = code;
+            error.message = errBuf;
+            while (!error.message.empty() && error.message.back() == '\n') error.message.pop_back();
+            rowErrors.push_back(std::move(error));
+        }
+        if (rowErr) OCIHandleFree(rowErr, OCI_HTYPE_ERROR);
+    }
+
+    ub4 rowCount = 0;
+    OCIAttrGet(stmt, OCI_HTYPE_STMT, &rowCount, nullptr, OCI_ATTR_ROW_COUNT, m_err);
+    m_affectedRows = rowCount;
+
+    OCIStmtRelease(stmt, m_err, nullptr, 0, OCI_DEFAULT);
+    return true;
+}
+
 // =============================================================================
 // Transaction Control
 // =============================================================================
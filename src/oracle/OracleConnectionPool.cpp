@@ -2,17 +2,20 @@
  * @file OracleConnectionPool.cpp
  * @brief Implementation of the thread-safe Oracle connection pool.
  *
- * This file implements connection pooling for Oracle databases using OCI
- * (Oracle Call Interface). The pool manages a set of pre-established
- * connections that can be reused across multiple operations, reducing
- * the overhead of connection establishment.
+ * This file implements connection pooling for Oracle databases on top of
+ * OCI's native session pool. OCI keeps the sessions, grows and shrinks the
+ * pool, and re-validates sessions that have been idle; this class only
+ * bounds how many sessions are borrowed at once so acquire() can time out.
  *
  * OCI Handle Hierarchy:
  * - OCIEnv: Environment handle (one per pool, shared by all connections)
- * - OCISvcCtx: Service context (one per connection, wraps server+session)
- * - OCIServer: Server handle (represents the database server attachment)
- * - OCISession: Session handle (represents the authenticated user session)
+ * - OCISPool: Session pool handle (one per pool)
+ * - OCISvcCtx: Service context (one per borrowed session, from OCISessionGet)
  * - OCIError: Error handle (one per connection for thread safety)
+ *
+ * Statement caching is enabled on the session pool, so statements prepared
+ * with OCIStmtPrepare2 and released with OCIStmtRelease are reused by SQL
+ * text within each session.
  */
 
 #include "OracleConnectionPool.hpp"
@@ -22,6 +25,17 @@
 
 namespace sqlfuse {
 
+namespace {
+
+std::string ociErrorText(OCIError* err) {
+    sb4 errCode = 0;
+    char errBuf[512] = {0};
+    OCIErrorGet(err, 1, nullptr, &errCode, (OraText*)errBuf, sizeof(errBuf), OCI_HTYPE_ERROR);
+    return errBuf;
+}
+
+}  // namespace
+
 // =============================================================================
 // Constructor and Destructor
 // =============================================================================
@@ -29,37 +43,31 @@ namespace sqlfuse {
 /**
  * Create a new connection pool with the specified configuration.
  *
- * Initializes the OCI environment and pre-creates the specified number
- * of connections. If any connections fail to create (except the first),
- * the pool continues with reduced capacity.
+ * Initializes the OCI environment and creates the OCI session pool.
+ * The session pool opens one session up front (which also verifies the
+ * credentials) and grows on demand up to poolSize.
  *
  * @throws std::runtime_error if OCI environment fails to initialize
- *         or if no connections can be created
+ *         or if the session pool cannot be created
  */
 OracleConnectionPool::OracleConnectionPool(const ConnectionConfig& config, size_t poolSize)
-    : m_config(config), m_poolSize(poolSize) {
+    : m_config(config), m_poolSize(poolSize > 0 ? poolSize : 1) {
 
     // Initialize the OCI environment (required before any other OCI calls)
     if (!initializeEnvironment()) {
         throw std::runtime_error("Failed to initialize Oracle environment");
     }
 
-    // Pre-create all connections for the pool
-    for (size_t i = 0; i < poolSize; ++i) {
-        try {
-            auto conn = createConnection();
-            m_available.push(conn);
-            ++m_createdCount;
-        } catch (const std::exception& e) {
-            spdlog::error("Failed to create Oracle connection {}: {}", i, e.what());
-            if (i == 0) {
-                throw;  // Can't create even one connection - fatal error
-            }
-            // Continue with reduced pool size for subsequent failures
-        }
+    try {
+        createSessionPool();
+    } catch (...) {
+        OCIHandleFree(m_env, OCI_HTYPE_ENV);
+        m_env = nullptr;
+        throw;
     }
 
-    spdlog::info("Oracle connection pool created with {} connections", m_createdCount.load());
+    spdlog::info("Oracle session pool created (max {} sessions, statement cache {})",
+                 m_poolSize, STATEMENT_CACHE_SIZE);
 }
 
 /**
@@ -68,6 +76,9 @@ OracleConnectionPool::OracleConnectionPool(const ConnectionConfig& config, size_
 OracleConnectionPool::~OracleConnectionPool() {
     drain();
 
+    // Anything still borrowed at this point can't be returned any more
+    destroySessionPool();
+
     if (m_env) {
         OCIHandleFree(m_env, OCI_HTYPE_ENV);
         m_env = nullptr;
@@ -133,158 +144,108 @@ std::string OracleConnectionPool::buildConnectString() const {
 }
 
 // =============================================================================
-// Connection Lifecycle Management
+// Session Pool Lifecycle
 // =============================================================================
 
 /**
- * Create a new Oracle connection with full handle setup.
+ * Create the OCI session pool.
  *
- * The connection creation process involves multiple OCI calls:
- * 1. Allocate error handle for this connection
- * 2. Allocate server handle
- * 3. Attach to the database server
- * 4. Allocate service context to wrap the connection
- * 5. Allocate session handle for authentication
- * 6. Set username and password credentials
- * 7. Begin the authenticated session
- * 8. Link the session to the service context
+ * The pool is homogeneous (every session uses the configured credentials)
+ * and has the client-side statement cache enabled. Idle handling is left
+ * to OCI:
+ * - OCI_ATTR_SPOOL_TIMEOUT closes sessions idle for IDLE_TIMEOUT_SECONDS
+ * - OCI_ATTR_PING_INTERVAL makes OCISessionGet ping a session only if it
+ *   has been idle longer than PING_INTERVAL_SECONDS
  *
- * On any failure, all previously allocated handles are freed before throwing.
- *
- * @return PooledConnection with initialized svc and err handles
  * @throws std::runtime_error on any OCI failure
  */
-OracleConnectionPool::PooledConnection OracleConnectionPool::createConnection() {
-    PooledConnection conn{nullptr, nullptr};
-
-    // Step 1: Allocate per-connection error handle
-    sword status = OCIHandleAlloc(m_env, (void**)&conn.err, OCI_HTYPE_ERROR, 0, nullptr);
+void OracleConnectionPool::createSessionPool() {
+    sword status = OCIHandleAlloc(m_env, (void**)&m_poolErr, OCI_HTYPE_ERROR, 0, nullptr);
     if (status != OCI_SUCCESS) {
         throw std::runtime_error("Failed to allocate Oracle error handle");
     }
 
-    // Step 2: Allocate server handle
-    OCIServer* server = nullptr;
-    OCISession* session = nullptr;
-
-    status = OCIHandleAlloc(m_env, (void**)&server, OCI_HTYPE_SERVER, 0, nullptr);
+    status = OCIHandleAlloc(m_env, (void**)&m_spool, OCI_HTYPE_SPOOL, 0, nullptr);
     if (status != OCI_SUCCESS) {
-        OCIHandleFree(conn.err, OCI_HTYPE_ERROR);
-        throw std::runtime_error("Failed to allocate Oracle server handle");
+        OCIHandleFree(m_poolErr, OCI_HTYPE_ERROR);
+        m_poolErr = nullptr;
+        throw std::runtime_error("Failed to allocate Oracle session pool handle");
     }
 
-    // Step 3: Attach to the database server using connection string
+    // Must be set before the pool is created to apply to its sessions
+    ub4 cacheSize = STATEMENT_CACHE_SIZE;
+    OCIAttrSet(m_spool, OCI_HTYPE_SPOOL, &cacheSize, 0, OCI_ATTR_SPOOL_STMTCACHESIZE, m_poolErr);
+
     std::string connStr = buildConnectString();
-    status = OCIServerAttach(server, conn.err, (const OraText*)connStr.c_str(),
-                            connStr.length(), OCI_DEFAULT);
-    if (status != OCI_SUCCESS) {
-        sb4 errCode = 0;
-        char errBuf[512];
-        OCIErrorGet(conn.err, 1, nullptr, &errCode, (OraText*)errBuf, sizeof(errBuf), OCI_HTYPE_ERROR);
-        OCIHandleFree(server, OCI_HTYPE_SERVER);
-        OCIHandleFree(conn.err, OCI_HTYPE_ERROR);
-        throw std::runtime_error("Failed to attach to Oracle server: " + std::string(errBuf));
+    status = OCISessionPoolCreate(
+        m_env, m_poolErr, m_spool, &m_poolName, &m_poolNameLen,
+        (const OraText*)connStr.c_str(), connStr.length(),
+        1, static_cast<ub4>(m_poolSize), 1,
+        (OraText*)m_config.user.c_str(), m_config.user.length(),
+        (OraText*)m_config.password.c_str(), m_config.password.length(),
+        OCI_SPC_HOMOGENEOUS | OCI_SPC_STMTCACHE);
+    if (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO) {
+        std::string error = ociErrorText(m_poolErr);
+        OCIHandleFree(m_spool, OCI_HTYPE_SPOOL);
+        OCIHandleFree(m_poolErr, OCI_HTYPE_ERROR);
+        m_spool = nullptr;
+        m_poolErr = nullptr;
+        throw std::runtime_error("Failed to create Oracle session pool: " + error);
     }
 
-    // Step 4: Allocate service context handle (wraps server + session)
-    status = OCIHandleAlloc(m_env, (void**)&conn.svc, OCI_HTYPE_SVCCTX, 0, nullptr);
-    if (status != OCI_SUCCESS) {
-        OCIServerDetach(server, conn.err, OCI_DEFAULT);
-        OCIHandleFree(server, OCI_HTYPE_SERVER);
-        OCIHandleFree(conn.err, OCI_HTYPE_ERROR);
-        throw std::runtime_error("Failed to allocate Oracle service context");
-    }
+    // acquire() already limits borrowing to m_poolSize, so OCI never has to block
+    ub1 getMode = OCI_SPOOL_ATTRVAL_NOWAIT;
+    ub4 idleTimeout = IDLE_TIMEOUT_SECONDS;
+    ub4 pingInterval = PING_INTERVAL_SECONDS;
+    OCIAttrSet(m_spool, OCI_HTYPE_SPOOL, &getMode, 0, OCI_ATTR_SPOOL_GETMODE, m_poolErr);
+    OCIAttrSet(m_spool, OCI_HTYPE_SPOOL, &idleTimeout, 0, OCI_ATTR_SPOOL_TIMEOUT, m_poolErr);
+    OCIAttrSet(m_spool, OCI_HTYPE_SPOOL, &pingInterval, 0, OCI_ATTR_PING_INTERVAL, m_poolErr);
+}
 
-    // Link server to service context
-    OCIAttrSet(conn.svc, OCI_HTYPE_SVCCTX, server, 0, OCI_ATTR_SERVER, conn.err);
+/**
+ * Destroy the OCI session pool.
+ * OCI_SPD_FORCE closes sessions even if some are still checked out.
+ */
+void OracleConnectionPool::destroySessionPool() {
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-    // Step 5: Allocate session handle for authentication
-    status = OCIHandleAlloc(m_env, (void**)&session, OCI_HTYPE_SESSION, 0, nullptr);
-    if (status != OCI_SUCCESS) {
-        OCIServerDetach(server, conn.err, OCI_DEFAULT);
-        OCIHandleFree(conn.svc, OCI_HTYPE_SVCCTX);
-        OCIHandleFree(server, OCI_HTYPE_SERVER);
-        OCIHandleFree(conn.err, OCI_HTYPE_ERROR);
-        throw std::runtime_error("Failed to allocate Oracle session handle");
+    if (m_spool) {
+        OCISessionPoolDestroy(m_spool, m_poolErr, OCI_SPD_FORCE);
+        OCIHandleFree(m_spool, OCI_HTYPE_SPOOL);
+        m_spool = nullptr;
     }
-
-    // Step 6: Set authentication credentials
-    OCIAttrSet(session, OCI_HTYPE_SESSION,
-               (void*)m_config.user.c_str(), m_config.user.length(),
-               OCI_ATTR_USERNAME, conn.err);
-    OCIAttrSet(session, OCI_HTYPE_SESSION,
-               (void*)m_config.password.c_str(), m_config.password.length(),
-               OCI_ATTR_PASSWORD, conn.err);
-
-    // Step 7: Begin the authenticated session
-    status = OCISessionBegin(conn.svc, conn.err, session, OCI_CRED_RDBMS, OCI_DEFAULT);
-    if (status != OCI_SUCCESS) {
-        sb4 errCode = 0;
-        char errBuf[512];
-        OCIErrorGet(conn.err, 1, nullptr, &errCode, (OraText*)errBuf, sizeof(errBuf), OCI_HTYPE_ERROR);
-        OCIHandleFree(session, OCI_HTYPE_SESSION);
-        OCIServerDetach(server, conn.err, OCI_DEFAULT);
-        OCIHandleFree(conn.svc, OCI_HTYPE_SVCCTX);
-        OCIHandleFree(server, OCI_HTYPE_SERVER);
-        OCIHandleFree(conn.err, OCI_HTYPE_ERROR);
-        throw std::runtime_error("Failed to begin Oracle session: " + std::string(errBuf));
+    if (m_poolErr) {
+        OCIHandleFree(m_poolErr, OCI_HTYPE_ERROR);
+        m_poolErr = nullptr;
     }
-
-    // Step 8: Link session to service context
-    OCIAttrSet(conn.svc, OCI_HTYPE_SVCCTX, session, 0, OCI_ATTR_SESSION, conn.err);
-
-    return conn;
 }
 
 /**
- * Properly close and free all handles associated with a connection.
+ * Take a session from the OCI session pool.
  *
- * Cleanup is performed in reverse order of creation:
- * 1. End the session (OCISessionEnd)
- * 2. Free the session handle
- * 3. Detach from the server
- * 4. Free the server handle
- * 5. Free the service context handle
- * 6. Free the error handle
+ * Each connection gets its own error handle so that concurrent connections
+ * never share error state. OCI pings the session first only if it has been
+ * idle longer than the ping interval, and transparently replaces it if the
+ * ping fails.
  */
-void OracleConnectionPool::destroyConnection(OCISvcCtx* svc, OCIError* err) {
-    if (svc) {
-        // Extract embedded handles from service context
-        OCIServer* server = nullptr;
-        OCISession* session = nullptr;
-
-        OCIAttrGet(svc, OCI_HTYPE_SVCCTX, &session, nullptr, OCI_ATTR_SESSION, err);
-        OCIAttrGet(svc, OCI_HTYPE_SVCCTX, &server, nullptr, OCI_ATTR_SERVER, err);
-
-        // End the authenticated session
-        if (session) {
-            OCISessionEnd(svc, err, session, OCI_DEFAULT);
-            OCIHandleFree(session, OCI_HTYPE_SESSION);
-        }
-
-        // Detach from the database server
-        if (server) {
-            OCIServerDetach(server, err, OCI_DEFAULT);
-            OCIHandleFree(server, OCI_HTYPE_SERVER);
-        }
-
-        OCIHandleFree(svc, OCI_HTYPE_SVCCTX);
+std::unique_ptr<OracleConnection> OracleConnectionPool::getSession() {
+    OCIError* err = nullptr;
+    sword status = OCIHandleAlloc(m_env, (void**)&err, OCI_HTYPE_ERROR, 0, nullptr);
+    if (status != OCI_SUCCESS) {
+        spdlog::error("Failed to allocate Oracle error handle");
+        return nullptr;
     }
 
-    if (err) {
+    OCISvcCtx* svc = nullptr;
+    status = OCISessionGet(m_env, err, &svc, nullptr, m_poolName, m_poolNameLen,
+                           nullptr, 0, nullptr, nullptr, nullptr, OCI_SESSGET_SPOOL);
+    if (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO) {
+        spdlog::error("Failed to get Oracle session from pool: {}", ociErrorText(err));
         OCIHandleFree(err, OCI_HTYPE_ERROR);
+        return nullptr;
     }
-}
-
-/**
- * Validate that a connection is still alive using OCIPing.
- * This is more efficient than executing "SELECT 1 FROM dual".
- */
-bool OracleConnectionPool::validateConnection(OCISvcCtx* svc, OCIError* err) {
-    if (!svc || !err) return false;
 
-    sword status = OCIPing(svc, err, OCI_DEFAULT);
-    return status == OCI_SUCCESS;
+    return std::make_unique<OracleConnection>(this, m_env, svc, err);
 }
 
 // =============================================================================
@@ -294,93 +255,88 @@ bool OracleConnectionPool::validateConnection(OCISvcCtx* svc, OCIError* err) {
 /**
  * Acquire a connection from the pool, blocking if necessary.
  *
- * If no connections are available, blocks until one becomes available
- * or the timeout expires. Before returning a connection, validates it
- * using OCIPing. If validation fails, the stale connection is destroyed
- * and a new one is created.
+ * The mutex only guards the borrowed-slot count: a slot is reserved under
+ * the lock, and the OCI session is fetched after the lock is released, so
+ * a slow network round trip (idle ping, new session) never blocks other
+ * threads that are acquiring or releasing.
  *
  * Thread Safety: Protected by m_mutex and m_cv condition variable.
  */
 std::unique_ptr<OracleConnection> OracleConnectionPool::acquire(std::chrono::milliseconds timeout) {
-    std::unique_lock<std::mutex> lock(m_mutex);
-    ++m_waitingCount;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_waitingCount;
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        // Wait for a slot to become available
+        while (m_borrowed >= m_poolSize && !m_shutdown) {
+            if (m_cv.wait_until(lock, deadline) == std::cv_status::timeout) {
+                --m_waitingCount;
+                spdlog::warn("Oracle connection pool timeout after {}ms", timeout.count());
+                return nullptr;
+            }
+        }
 
-    auto deadline = std::chrono::steady_clock::now() + timeout;
+        --m_waitingCount;
 
-    // Wait for a connection to become available
-    while (m_available.empty() && !m_shutdown) {
-        if (m_cv.wait_until(lock, deadline) == std::cv_status::timeout) {
-            --m_waitingCount;
-            spdlog::warn("Oracle connection pool timeout after {}ms", timeout.count());
+        if (m_shutdown) {
             return nullptr;
         }
-    }
-
-    --m_waitingCount;
 
-    if (m_shutdown || m_available.empty()) {
-        return nullptr;
+        ++m_borrowed;
     }
 
-    auto conn = m_available.front();
-    m_available.pop();
-
-    // Validate connection before returning (outside the lock would be better
-    // but requires restructuring - keeping simple for now)
-    if (!validateConnection(conn.svc, conn.err)) {
-        spdlog::warn("Oracle connection validation failed, destroying and creating new");
-        destroyConnection(conn.svc, conn.err);
-        --m_createdCount;
-
-        try {
-            conn = createConnection();
-            ++m_createdCount;
-        } catch (const std::exception& e) {
-            spdlog::error("Failed to recreate Oracle connection: {}", e.what());
-            return nullptr;
-        }
+    auto conn = getSession();
+    if (!conn) {
+        releaseSlot();
     }
-
-    return std::make_unique<OracleConnection>(this, m_env, conn.svc, conn.err);
+    return conn;
 }
 
 /**
  * Try to acquire a connection without blocking.
- * Returns nullptr immediately if no connections are available.
- * Does not validate the connection (caller should handle stale connections).
+ * Returns nullptr immediately if all connections are borrowed.
  */
 std::unique_ptr<OracleConnection> OracleConnectionPool::tryAcquire() {
-    std::unique_lock<std::mutex> lock(m_mutex);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
 
-    if (m_available.empty() || m_shutdown) {
-        return nullptr;
-    }
+        if (m_borrowed >= m_poolSize || m_shutdown) {
+            return nullptr;
+        }
 
-    auto conn = m_available.front();
-    m_available.pop();
+        ++m_borrowed;
+    }
 
-    return std::make_unique<OracleConnection>(this, m_env, conn.svc, conn.err);
+    auto conn = getSession();
+    if (!conn) {
+        releaseSlot();
+    }
+    return conn;
 }
 
 /**
  * Return a connection to the pool.
  *
- * Called by OracleConnection destructor. If the pool is shutting down,
- * the connection is destroyed instead of being returned. Otherwise, it's
- * added back to the available queue and waiting threads are notified.
+ * Called by OracleConnection destructor. The session goes back to the OCI
+ * pool (keeping its statement cache) unless the pool is draining, in which
+ * case it is dropped. The OCI call happens outside m_mutex.
  */
 void OracleConnectionPool::releaseConnection(OCISvcCtx* svc, OCIError* err) {
-    std::unique_lock<std::mutex> lock(m_mutex);
+    ub4 mode = m_shutdown ? OCI_SESSRLS_DROPSESS : OCI_DEFAULT;
+    OCISessionRelease(svc, err, nullptr, 0, mode);
+    OCIHandleFree(err, OCI_HTYPE_ERROR);
 
-    if (m_shutdown) {
-        // Pool is draining - destroy instead of returning
-        destroyConnection(svc, err);
-        --m_createdCount;
-    } else {
-        // Return to pool and notify waiting threads
-        m_available.push({svc, err});
-        m_cv.notify_one();
+    releaseSlot();
+}
+
+void OracleConnectionPool::releaseSlot() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_borrowed > 0) {
+        --m_borrowed;
     }
+    m_cv.notify_one();
 }
 
 // =============================================================================
@@ -388,18 +344,24 @@ void OracleConnectionPool::releaseConnection(OCISvcCtx* svc, OCIError* err) {
 // =============================================================================
 
 /**
- * Get the number of idle connections currently available.
+ * Get the number of connections that can be acquired without waiting.
  */
 size_t OracleConnectionPool::availableCount() const {
     std::lock_guard<std::mutex> lock(m_mutex);
-    return m_available.size();
+    return m_poolSize - m_borrowed;
 }
 
 /**
- * Get the total number of connections managed by the pool.
+ * Get the number of sessions currently open in the OCI session pool.
  */
 size_t OracleConnectionPool::totalCount() const {
-    return m_createdCount.load();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_spool) return 0;
+
+    ub4 openCount = 0;
+    OCIAttrGet(m_spool, OCI_HTYPE_SPOOL, &openCount, nullptr,
+               OCI_ATTR_SPOOL_OPEN_COUNT, m_poolErr);
+    return openCount;
 }
 
 /**
@@ -427,22 +389,23 @@ bool OracleConnectionPool::healthCheck() {
 /**
  * Drain all connections from the pool.
  *
- * Sets the shutdown flag to prevent new acquisitions, wakes up all
- * waiting threads, and destroys all available connections. Connections
- * currently in use will be destroyed when released.
+ * Sets the shutdown flag to prevent new acquisitions and wakes up all
+ * waiting threads. If nothing is borrowed the session pool is destroyed
+ * right away; otherwise borrowed sessions are dropped as they are
+ * released and the destructor tears the pool down.
  */
 void OracleConnectionPool::drain() {
     m_shutdown = true;
     m_cv.notify_all();  // Wake up any waiting threads
 
-    std::unique_lock<std::mutex> lock(m_mutex);
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        idle = (m_borrowed == 0);
+    }
 
-    // Destroy all available connections
-    while (!m_available.empty()) {
-        auto conn = m_available.front();
-        m_available.pop();
-        destroyConnection(conn.svc, conn.err);
-        --m_createdCount;
+    if (idle) {
+        destroySessionPool();
     }
 }
 
@@ -8,6 +8,7 @@
  */
 
 #include "OracleFormatConverter.hpp"
+#include "ResultBatch.hpp"
 #include <sstream>
 #include <oci.h>
 
@@ -47,7 +48,7 @@ bool OracleFormatConverter::isDateTimeType(int oracleType) {
 
 /**
  * Check if an OCI type code represents a Large Object (LOB).
- * LOBs require special handling and may be truncated in output.
+ * LOBs are read through locators (see OracleResultSet::readLob).
  */
 bool OracleFormatConverter::isLobType(int oracleType) {
     return oracleType == SQLT_CLOB ||  // Character LOB
@@ -56,63 +57,94 @@ bool OracleFormatConverter::isLobType(int oracleType) {
 }
 
 // =============================================================================
-// Result Set to CSV Conversion
+// Result Set Conversion
 // =============================================================================
 
+std::vector<std::string> OracleFormatConverter::columnNames(OracleResultSet& result) {
+    int numFields = result.numFields();
+    std::vector<std::string> names;
+    names.reserve(numFields);
+    for (int i = 0; i < numFields; ++i) {
+        names.emplace_back(result.fieldName(i));
+    }
+    return names;
+}
+
 /**
- * Convert an Oracle result set to CSV format.
- *
- * Iterates through all rows in the result set, formatting each value
- * according to CSV conventions. Uses the base class escapeCSVField()
- * method for proper quoting of fields containing special characters.
+ * Append the current row of a result set to a batch.
  *
- * NULL values are represented as empty fields (no quotes, no content).
+ * Numeric columns keep Oracle's text so NUMBER values keep every digit.
+ * LOBs are streamed piece by piece straight into the batch buffer, so a
+ * large CLOB or BLOB is copied once; BLOBs are written as uppercase hex,
+ * the rendering Oracle uses for RAW to string conversion.
  */
-std::string OracleFormatConverter::toCSV(OracleResultSet& result, const CSVOptions& options) {
-    std::ostringstream out;
+void OracleFormatConverter::appendRow(OracleResultSet& result, ResultBatch& batch) {
+    static constexpr char hex[] = "0123456789ABCDEF";
 
-    int numFields = result.numFields();
-    if (numFields == 0) {
-        return "";
-    }
+    for (size_t i = 0; i < batch.columnCount(); ++i) {
+        int col = static_cast<int>(i);
+        ResultColumn& column = batch.column(i);
 
-    // Write header row with column names
-    if (options.includeHeader) {
-        for (int i = 0; i < numFields; ++i) {
-            if (i > 0) out << options.delimiter;
-            out << escapeCSVField(result.fieldName(i), options);
+        if (result.isNull(col)) {
+            column.appendNull();
+            continue;
         }
-        out << options.lineEnding;
-    }
-
-    // Write data rows
-    while (result.fetchRow()) {
-        for (int i = 0; i < numFields; ++i) {
-            if (i > 0) out << options.delimiter;
 
-            if (!result.isNull(i)) {
-                const char* value = result.getValue(i);
-                if (value) {
-                    out << escapeCSVField(value, options);
+        if (result.isLob(col)) {
+            bool binary = result.fieldType(col) == SQLT_BLOB;
+            std::string& out = column.beginText();
+            result.readLob(col, [&](const char* data, size_t length) {
+                if (binary) {
+                    for (size_t k = 0; k < length; ++k) {
+                        unsigned char b = static_cast<unsigned char>(data[k]);
+                        out += hex[b >> 4];
+                        out += hex[b & 0x0F];
+                    }
+                } else {
+                    out.append(data, length);
                 }
-            }
-            // NULL values are represented as empty (no output)
+                return true;
+            });
+            column.endText();
+            continue;
+        }
+
+        std::string_view value(result.getValue(col), result.getLength(col));
+        if (isNumericType(result.fieldType(col))) {
+            column.appendNumber(value);
+        } else {
+            column.appendText(value);
         }
-        out << options.lineEnding;
     }
+}
 
-    return out.str();
+bool OracleFormatConverter::fillBatch(OracleResultSet& result, ResultBatch& batch) {
+    while (!batch.full() && result.fetchRow()) {
+        appendRow(result, batch);
+    }
+    return batch.rowCount() > 0;
 }
 
-// =============================================================================
-// Result Set to JSON Conversion
-// =============================================================================
+/**
+ * Convert an Oracle result set to CSV format.
+ *
+ * Rows are fetched into a ResultBatch and written by the shared CSV writer.
+ * NULL values are represented as empty fields (no quotes, no content).
+ */
+std::string OracleFormatConverter::toCSV(OracleResultSet& result, const CSVOptions& options) {
+    if (result.numFields() == 0) {
+        return "";
+    }
+
+    ResultBatch batch(columnNames(result));
+    return FormatConverter::toCSV(batch, [&](ResultBatch& b) { return fillBatch(result, b); }, options);
+}
 
 /**
  * Convert an Oracle result set to JSON array format.
  *
  * Each row becomes a JSON object with column names as keys.
- * Numeric Oracle types are converted to JSON numbers to preserve type info.
+ * Numeric Oracle types are written as JSON numbers to preserve type info.
  * Non-numeric types are stored as JSON strings.
  *
  * The output format depends on options.arrayFormat:
@@ -120,66 +152,12 @@ std::string OracleFormatConverter::toCSV(OracleResultSet& result, const CSVOptio
  * - false: Returns wrapped format: {"rows": [...]}
  */
 std::string OracleFormatConverter::toJSON(OracleResultSet& result, const JSONOptions& options) {
-    int numFields = result.numFields();
-    if (numFields == 0) {
+    if (result.numFields() == 0) {
         return options.arrayFormat ? "[]" : "{\"rows\": []}";
     }
 
-    // Cache column metadata for efficient access during row iteration
-    std::vector<std::string> columnNames;
-    std::vector<int> columnTypes;
-    columnNames.reserve(numFields);
-    columnTypes.reserve(numFields);
-
-    for (int i = 0; i < numFields; ++i) {
-        columnNames.push_back(result.fieldName(i));
-        columnTypes.push_back(result.fieldType(i));
-    }
-
-    json arr = json::array();
-
-    // Process each row
-    while (result.fetchRow()) {
-        json obj = json::object();
-
-        for (int i = 0; i < numFields; ++i) {
-            if (!result.isNull(i)) {
-                const char* value = result.getValue(i);
-                if (value) {
-                    // Preserve numeric types as JSON numbers
-                    if (isNumericType(columnTypes[i])) {
-                        try {
-                            std::string strVal(value);
-                            // Use floating point for decimals, integer for whole numbers
-                            if (strVal.find('.') != std::string::npos) {
-                                obj[columnNames[i]] = std::stod(strVal);
-                            } else {
-                                obj[columnNames[i]] = std::stoll(strVal);
-                            }
-                        } catch (...) {
-                            // Fall back to string if number parsing fails
-                            obj[columnNames[i]] = value;
-                        }
-                    } else {
-                        obj[columnNames[i]] = value;
-                    }
-                }
-            } else if (options.includeNull) {
-                obj[columnNames[i]] = nullptr;
-            }
-        }
-
-        arr.push_back(std::move(obj));
-    }
-
-    // Format output based on options
-    if (options.arrayFormat) {
-        return options.pretty ? arr.dump(options.indent) : arr.dump();
-    } else {
-        json wrapper = json::object();
-        wrapper["rows"] = std::move(arr);
-        return options.pretty ? wrapper.dump(options.indent) : wrapper.dump();
-    }
+    ResultBatch batch(columnNames(result));
+    return FormatConverter::toJSON(batch, [&](ResultBatch& b) { return fillBatch(result, b); }, options);
 }
 
 /**
@@ -190,42 +168,13 @@ std::string OracleFormatConverter::toJSON(OracleResultSet& result, const JSONOpt
  * individual row file access (e.g., /schema/tables/TABLE/rows/1.json).
  */
 std::string OracleFormatConverter::rowToJSON(OracleResultSet& result, const JSONOptions& options) {
-    int numFields = result.numFields();
-    if (numFields == 0) {
+    if (result.numFields() == 0) {
         return "{}";
     }
 
-    json obj = json::object();
-
-    for (int i = 0; i < numFields; ++i) {
-        const char* fieldName = result.fieldName(i);
-        int fieldType = result.fieldType(i);
-
-        if (!result.isNull(i)) {
-            const char* value = result.getValue(i);
-            if (value) {
-                // Preserve numeric types as JSON numbers
-                if (isNumericType(fieldType)) {
-                    try {
-                        std::string strVal(value);
-                        if (strVal.find('.') != std::string::npos) {
-                            obj[fieldName] = std::stod(strVal);
-                        } else {
-                            obj[fieldName] = std::stoll(strVal);
-                        }
-                    } catch (...) {
-                        obj[fieldName] = value;
-                    }
-                } else {
-                    obj[fieldName] = value;
-                }
-            }
-        } else if (options.includeNull) {
-            obj[fieldName] = nullptr;
-        }
-    }
-
-    return options.pretty ? obj.dump(options.indent) : obj.dump();
+    ResultBatch batch(columnNames(result), 1);
+    appendRow(result, batch);
+    return FormatConverter::rowToJSON(batch, 0, options);
 }
 
 // =============================================================================
@@ -279,6 +228,54 @@ std::string OracleFormatConverter::buildInsert(const std::string& table,
     return sql.str();
 }
 
+/**
+ * Describe a multi-row INSERT for Oracle.
+ *
+ * Generates: INSERT ALL INTO "S"."T" ("A", "B") VALUES ('1', '2')
+ *                       INTO "S"."T" ("A", "B") VALUES ('3', '4')
+ *            SELECT 1 FROM DUAL
+ *
+ * Multi-row VALUES lists are only available from Oracle 23c; INSERT ALL
+ * works on every supported release and is still a single statement.
+ */
+InsertSyntax OracleFormatConverter::insertSyntax(const std::string& table,
+                                                 const std::vector<std::string>& columns) {
+    InsertSyntax syntax;
+    syntax.head = "INSERT ALL";
+    syntax.rowPrefix = " INTO " + escapeIdentifier(table) + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) syntax.rowPrefix += ", ";
+        syntax.rowPrefix += escapeIdentifier(columns[i]);
+    }
+    syntax.rowPrefix += ") VALUES ";
+    syntax.tail = " SELECT 1 FROM DUAL";
+    return syntax;
+}
+
+/**
+ * Build an INSERT for OracleConnection::executeArray().
+ *
+ * Generates: INSERT INTO "S"."T" ("A", "B") VALUES (:1, :2)
+ *
+ * The text is the same for every batch of a table, so the statement cache
+ * parses it once.
+ */
+std::string OracleFormatConverter::buildArrayInsert(const std::string& table,
+                                                    const std::vector<std::string>& columns) {
+    std::string sql = "INSERT INTO " + escapeIdentifier(table) + " (";
+    std::string values;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) {
+            sql += ", ";
+            values += ", ";
+        }
+        sql += escapeIdentifier(columns[i]);
+        values += ":" + std::to_string(i + 1);
+    }
+    sql += ") VALUES (" + values + ")";
+    return sql;
+}
+
 /**
  * Build an UPDATE statement for Oracle.
  *
@@ -333,6 +330,66 @@ std::string OracleFormatConverter::buildUpdate(const std::string& table,
     return sql.str();
 }
 
+/**
+ * Build a MERGE statement for Oracle (Oracle has no INSERT ... ON CONFLICT).
+ *
+ * Generates: MERGE INTO "schema"."table" t USING (SELECT 'v' AS "col", ...
+ * FROM DUAL) s ON (t."pk" = s."pk") WHEN MATCHED THEN UPDATE SET ...
+ * WHEN NOT MATCHED THEN INSERT (...) VALUES (...)
+ *
+ * The WHEN MATCHED branch is left out when only the key was written.
+ */
+std::string OracleFormatConverter::buildUpsert(const std::string& table,
+                                               const RowData& row,
+                                               const std::string& pkColumn,
+                                               bool escape) {
+    if (row.empty()) {
+        return "";
+    }
+
+    std::ostringstream source;
+    std::ostringstream updates;
+    std::ostringstream columns;
+    std::ostringstream values;
+
+    bool first = true;
+    bool firstUpdate = true;
+    for (const auto& [col, val] : row) {
+        std::string quoted = escapeIdentifier(col);
+        if (!first) {
+            source << ", ";
+            columns << ", ";
+            values << ", ";
+        }
+        first = false;
+
+        if (val.has_value()) {
+            source << "'" << (escape ? escapeSQL(val.value()) : val.value()) << "'";
+        } else {
+            source << "NULL";
+        }
+        source << " AS " << quoted;
+        columns << quoted;
+        values << "s." << quoted;
+
+        if (col == pkColumn) continue;
+        if (!firstUpdate) updates << ", ";
+        firstUpdate = false;
+        updates << "t." << quoted << " = s." << quoted;
+    }
+
+    std::string pk = escapeIdentifier(pkColumn);
+    std::ostringstream sql;
+    sql << "MERGE INTO " << escapeIdentifier(table) << " t USING (SELECT " << source.str()
+        << " FROM DUAL) s ON (t." << pk << " = s." << pk << ")";
+    if (!firstUpdate) {
+        sql << " WHEN MATCHED THEN UPDATE SET " << updates.str();
+    }
+    sql << " WHEN NOT MATCHED THEN INSERT (" << columns.str() << ") VALUES (" << values.str()
+        << ")";
+    return sql.str();
+}
+
 /**
  * Build a DELETE statement for Oracle.
  *
@@ -420,4 +477,21 @@ std::string OracleFormatConverter::escapeSQL(const std::string& value) {
     return result;
 }
 
+/**
+ * Append a value as a quoted Oracle string literal ('O''Brien').
+ *
+ * Copies the runs between single quotes in bulk rather than byte by byte.
+ */
+void OracleFormatConverter::appendLiteral(std::string& sql, std::string_view value) {
+    sql += '\'';
+    size_t start = 0;
+    for (size_t quote; (quote = value.find('\'', start)) != std::string_view::npos;
+         start = quote + 1) {
+        sql.append(value, start, quote + 1 - start);
+        sql += '\'';  // Double single quote to escape
+    }
+    sql.append(value, start);
+    sql += '\'';
+}
+
 }  // namespace sqlfuse
@@ -1,11 +1,14 @@
 #include "OracleResultSet.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <cstring>
 
 namespace sqlfuse {
 
-OracleResultSet::OracleResultSet(OCIStmt* stmt, OCIError* err, OCIEnv* env)
-    : m_stmt(stmt), m_err(err), m_env(env) {
+OracleResultSet::OracleResultSet(OCIStmt* stmt, OCIError* err, OCIEnv* env,
+                                 OCISvcCtx* svc, ub4 fetchBatchRows)
+    : m_stmt(stmt), m_err(err), m_env(env), m_svc(svc),
+      m_batchRows(fetchBatchRows > 0 ? fetchBatchRows : 1) {
 
     if (m_stmt && m_err) {
         // Check statement type
@@ -34,10 +37,15 @@ OracleResultSet::OracleResultSet(OracleResultSet&& other) noexcept
     : m_stmt(other.m_stmt)
     , m_err(other.m_err)
     , m_env(other.m_env)
+    , m_svc(other.m_svc)
     , m_hasData(other.m_hasData)
     , m_hasError(other.m_hasError)
     , m_errorMsg(std::move(other.m_errorMsg))
     , m_fetchedRows(other.m_fetchedRows)
+    , m_batchRows(other.m_batchRows)
+    , m_rowsInBatch(other.m_rowsInBatch)
+    , m_batchRow(other.m_batchRow)
+    , m_lastBatch(other.m_lastBatch)
     , m_columns(std::move(other.m_columns))
     , m_columnsDescribed(other.m_columnsDescribed) {
     other.m_stmt = nullptr;
@@ -51,10 +59,15 @@ OracleResultSet& OracleResultSet::operator=(OracleResultSet&& other) noexcept {
         m_stmt = other.m_stmt;
         m_err = other.m_err;
         m_env = other.m_env;
+        m_svc = other.m_svc;
         m_hasData = other.m_hasData;
         m_hasError = other.m_hasError;
         m_errorMsg = std::move(other.m_errorMsg);
         m_fetchedRows = other.m_fetchedRows;
+        m_batchRows = other.m_batchRows;
+        m_rowsInBatch = other.m_rowsInBatch;
+        m_batchRow = other.m_batchRow;
+        m_lastBatch = other.m_lastBatch;
         m_columns = std::move(other.m_columns);
         m_columnsDescribed = other.m_columnsDescribed;
 
@@ -113,9 +126,9 @@ void OracleResultSet::describeColumns() {
 void OracleResultSet::defineOutputVariables() {
     if (!m_stmt || !m_err || m_columns.empty()) return;
 
-    for (size_t i = 0; i < m_columns.size(); ++i) {
-        auto& col = m_columns[i];
+    size_t rowBytes = 0;
 
+    for (auto& col : m_columns) {
         // Allocate buffer based on type
         // Convert most types to string for simplicity
         ub4 bufSize = 4000;  // Default buffer size
@@ -141,62 +154,198 @@ void OracleResultSet::defineOutputVariables() {
                 break;
             case SQLT_CLOB:
             case SQLT_BLOB:
-                // For LOBs, we'll read a limited amount
-                bufSize = 4000;
+                // With a service context LOBs are read through locators;
+                // otherwise we can only read a limited amount
+                bufSize = m_svc ? sizeof(OCILobLocator*) : 4000;
                 break;
             default:
                 bufSize = 4000;
                 break;
         }
 
-        col.data.resize(bufSize);
-        col.indicator = 0;
-        col.returnLen = 0;
+        col.bufSize = bufSize;
+        rowBytes += bufSize + sizeof(sb2) + sizeof(ub2);
+    }
+
+    // Keep wide rows from turning the batch into a huge allocation
+    size_t maxRows = std::max<size_t>(1, MAX_BATCH_BYTES / rowBytes);
+    m_batchRows = static_cast<ub4>(std::min<size_t>(m_batchRows, maxRows));
+
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        auto& col = m_columns[i];
+
+        col.indicator.assign(m_batchRows, 0);
+        col.returnLen.assign(m_batchRows, 0);
+
+        void* valuep = nullptr;
+        ub2 defineType = SQLT_STR;
+
+        if (m_svc && (col.type == SQLT_CLOB || col.type == SQLT_BLOB)) {
+            // One locator per batch row; the value is read on demand
+            col.locators.assign(m_batchRows, nullptr);
+            for (auto& locator : col.locators) {
+                OCIDescriptorAlloc(m_env, (void**)&locator, OCI_DTYPE_LOB, 0, nullptr);
+            }
+            valuep = col.locators.data();
+            defineType = col.type;
+        } else {
+            col.data.assign(static_cast<size_t>(col.bufSize) * m_batchRows, '\0');
+            valuep = col.data.data();
+        }
 
         // Define output variable - fetch as string for simplicity
         sword status = OCIDefineByPos(m_stmt, &col.define, m_err, i + 1,
-                                      col.data.data(), bufSize, SQLT_STR,
-                                      &col.indicator, &col.returnLen, nullptr, OCI_DEFAULT);
+                                      valuep, col.bufSize, defineType,
+                                      col.indicator.data(), col.returnLen.data(),
+                                      nullptr, OCI_DEFAULT);
         if (status != OCI_SUCCESS) {
             spdlog::warn("Failed to define output for column {}", col.name);
+            continue;
+        }
+
+        // Consecutive rows of the batch are one slot apart in each array
+        status = OCIDefineArrayOfStruct(col.define, m_err, col.bufSize,
+                                        sizeof(sb2), sizeof(ub2), 0);
+        if (status != OCI_SUCCESS) {
+            spdlog::warn("Failed to define array fetch for column {}", col.name);
         }
     }
 }
 
-bool OracleResultSet::fetchRow() {
-    if (!m_stmt || !m_err || !m_hasData) return false;
+bool OracleResultSet::fetchBatch() {
+    if (m_lastBatch) return false;
 
-    sword status = OCIStmtFetch2(m_stmt, m_err, 1, OCI_FETCH_NEXT, 0, OCI_DEFAULT);
+    sword status = OCIStmtFetch2(m_stmt, m_err, m_batchRows, OCI_FETCH_NEXT, 0, OCI_DEFAULT);
 
-    if (status == OCI_SUCCESS || status == OCI_SUCCESS_WITH_INFO) {
-        ++m_fetchedRows;
-        return true;
-    } else if (status == OCI_NO_DATA) {
-        return false;
-    } else {
+    if (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO && status != OCI_NO_DATA) {
         sb4 errCode = 0;
         char errBuf[512];
         OCIErrorGet(m_err, 1, nullptr, &errCode, (OraText*)errBuf, sizeof(errBuf), OCI_HTYPE_ERROR);
         spdlog::error("Oracle fetch error: {}", errBuf);
+        m_lastBatch = true;
+        return false;
+    }
+
+    // A short final batch comes back with OCI_NO_DATA and a non-zero count
+    ub4 rows = 0;
+    OCIAttrGet(m_stmt, OCI_HTYPE_STMT, &rows, nullptr, OCI_ATTR_ROWS_FETCHED, m_err);
+    m_rowsInBatch = rows;
+    m_batchRow = 0;
+    m_lastBatch = (status == OCI_NO_DATA);
+
+    return m_rowsInBatch > 0;
+}
+
+bool OracleResultSet::fetchRow() {
+    if (!m_stmt || !m_err || !m_hasData) return false;
+
+    if (m_rowsInBatch > 0 && m_batchRow + 1 < m_rowsInBatch) {
+        ++m_batchRow;
+    } else if (!fetchBatch()) {
+        m_rowsInBatch = 0;
         return false;
     }
+
+    ++m_fetchedRows;
+    return true;
 }
 
 const char* OracleResultSet::getValue(int col) const {
     if (col < 0 || col >= static_cast<int>(m_columns.size())) return nullptr;
-    if (m_columns[col].indicator == -1) return nullptr;  // NULL
-    return m_columns[col].data.data();
+    const auto& c = m_columns[col];
+    if (c.indicator.empty() || c.indicator[m_batchRow] == -1) return nullptr;  // NULL
+
+    if (!c.locators.empty()) {
+        // Materialize the LOB once per row
+        if (c.lobValueRow != m_fetchedRows) {
+            static constexpr char hex[] = "0123456789ABCDEF";
+            bool binary = c.type == SQLT_BLOB;
+            c.lobValue.clear();
+            readLob(col, [&](const char* data, size_t length) {
+                if (binary) {
+                    // Same rendering Oracle uses for RAW to string conversion
+                    for (size_t i = 0; i < length; ++i) {
+                        unsigned char b = static_cast<unsigned char>(data[i]);
+                        c.lobValue += hex[b >> 4];
+                        c.lobValue += hex[b & 0x0F];
+                    }
+                } else {
+                    c.lobValue.append(data, length);
+                }
+                return true;
+            });
+            c.lobValueRow = m_fetchedRows;
+        }
+        return c.lobValue.c_str();
+    }
+
+    return c.data.data() + static_cast<size_t>(m_batchRow) * c.bufSize;
+}
+
+bool OracleResultSet::isLob(int col) const {
+    if (col < 0 || col >= static_cast<int>(m_columns.size())) return false;
+    return !m_columns[col].locators.empty();
+}
+
+bool OracleResultSet::readLob(int col, const LobSink& sink) const {
+    if (!isLob(col) || isNull(col) || !m_svc) return false;
+
+    OCILobLocator* locator = m_columns[col].locators[m_batchRow];
+    if (m_lobBuffer.size() < LOB_CHUNK_BYTES) {
+        m_lobBuffer.resize(LOB_CHUNK_BYTES);
+    }
+
+    // Polling mode: amount 0 on the first piece means "read to the end",
+    // and each OCI_NEED_DATA return hands us the next piece
+    ub8 byteAmt = 0;
+    ub8 charAmt = 0;
+    ub1 piece = OCI_FIRST_PIECE;
+    sword status;
+
+    do {
+        status = OCILobRead2(m_svc, m_err, locator, &byteAmt, &charAmt, 1,
+                             m_lobBuffer.data(), m_lobBuffer.size(), piece,
+                             nullptr, nullptr, 0, SQLCS_IMPLICIT);
+        if (status != OCI_SUCCESS && status != OCI_NEED_DATA) {
+            if (status == OCI_NO_DATA) return true;  // Empty LOB
+            sb4 errCode = 0;
+            char errBuf[512];
+            OCIErrorGet(m_err, 1, nullptr, &errCode, (OraText*)errBuf, sizeof(errBuf), OCI_HTYPE_ERROR);
+            spdlog::error("Oracle LOB read error on column {}: {}", m_columns[col].name, errBuf);
+            return false;
+        }
+
+        if (byteAmt > 0 && !sink(m_lobBuffer.data(), static_cast<size_t>(byteAmt))) {
+            // Caller stopped early; finish the polling sequence so the
+            // connection is usable again
+            while (status == OCI_NEED_DATA) {
+                status = OCILobRead2(m_svc, m_err, locator, &byteAmt, &charAmt, 1,
+                                     m_lobBuffer.data(), m_lobBuffer.size(), OCI_NEXT_PIECE,
+                                     nullptr, nullptr, 0, SQLCS_IMPLICIT);
+            }
+            return true;
+        }
+        piece = OCI_NEXT_PIECE;
+    } while (status == OCI_NEED_DATA);
+
+    return true;
 }
 
 bool OracleResultSet::isNull(int col) const {
     if (col < 0 || col >= static_cast<int>(m_columns.size())) return true;
-    return m_columns[col].indicator == -1;
+    const auto& c = m_columns[col];
+    return c.indicator.empty() || c.indicator[m_batchRow] == -1;
 }
 
 int OracleResultSet::getLength(int col) const {
     if (col < 0 || col >= static_cast<int>(m_columns.size())) return 0;
-    if (m_columns[col].indicator == -1) return 0;
-    return m_columns[col].returnLen;
+    const auto& c = m_columns[col];
+    if (c.indicator.empty() || c.indicator[m_batchRow] == -1) return 0;
+    if (!c.locators.empty()) {
+        getValue(col);
+        return static_cast<int>(c.lobValue.size());
+    }
+    return c.returnLen[m_batchRow];
 }
 
 int OracleResultSet::numFields() const {
@@ -226,22 +375,36 @@ std::vector<std::string> OracleResultSet::getColumnNames() const {
     return names;
 }
 
+void OracleResultSet::freeLobLocators() {
+    for (auto& col : m_columns) {
+        for (auto* locator : col.locators) {
+            if (locator) OCIDescriptorFree(locator, OCI_DTYPE_LOB);
+        }
+        col.locators.clear();
+    }
+}
+
 void OracleResultSet::reset() {
     if (m_stmt) {
-        OCIHandleFree(m_stmt, OCI_HTYPE_STMT);
+        OCIStmtRelease(m_stmt, m_err, nullptr, 0, OCI_DEFAULT);
         m_stmt = nullptr;
     }
+    freeLobLocators();
     m_columns.clear();
     m_columnsDescribed = false;
     m_hasData = false;
     m_hasError = false;
     m_errorMsg.clear();
     m_fetchedRows = 0;
+    m_rowsInBatch = 0;
+    m_batchRow = 0;
+    m_lastBatch = false;
 }
 
 OCIStmt* OracleResultSet::release() {
     OCIStmt* stmt = m_stmt;
     m_stmt = nullptr;
+    freeLobLocators();
     m_columns.clear();
     return stmt;
 }
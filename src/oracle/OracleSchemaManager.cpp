@@ -111,6 +111,9 @@ std::vector<std::string> OracleSchemaManager::getTables(const std::string& datab
 
 std::optional<TableInfo> OracleSchemaManager::getTableInfo(const std::string& database,
                                                             const std::string& table) {
+    // Read before taking a connection: getColumns acquires its own
+    auto columns = getColumns(database, table);
+
     auto conn = m_pool.acquire();
     if (!conn) return std::nullopt;
 
@@ -130,11 +133,12 @@ std::optional<TableInfo> OracleSchemaManager::getTableInfo(const std::string& da
     TableInfo info;
     info.name = table;
     info.database = database;
+    info.columns = std::move(columns);
 
     const char* rows = result.getValue(1);
     info.rowsEstimate = rows ? std::stoull(rows) : 0;
 
-    // Get primary key
+    // Get primary key; every column of a composite key is marked
     std::string pkSql = R"(
         SELECT cols.column_name
         FROM all_constraints cons
@@ -149,11 +153,15 @@ std::optional<TableInfo> OracleSchemaManager::getTableInfo(const std::string& da
     OCIStmt* pkStmt = conn->execute(pkSql);
     if (pkStmt) {
         OracleResultSet pkResult(pkStmt, conn->err(), conn->env());
-        if (pkResult.fetchRow()) {
+        while (pkResult.fetchRow()) {
             const char* pkCol = pkResult.getValue(0);
-            if (pkCol) {
+            if (!pkCol) continue;
+            if (info.primaryKeyColumn.empty()) {
                 info.primaryKeyColumn = pkCol;
             }
+            for (auto& col : info.columns) {
+                if (col.name == pkCol) col.key = "PRI";
+            }
         }
     }
 
@@ -476,7 +484,7 @@ std::string OracleSchemaManager::getCreateStatement(const std::string& database,
         return "";
     }
 
-    OracleResultSet result(stmt, conn->err(), conn->env());
+    OracleResultSet result(stmt, conn->err(), conn->env(), conn->svc());
     if (result.fetchRow()) {
         return result.getValue(0) ? result.getValue(0) : "";
     }
@@ -4,6 +4,7 @@
 #include "FormatConverter.hpp"
 #include "ErrorHandler.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <sstream>
 
 namespace sqlfuse {
@@ -25,6 +26,9 @@ std::string OracleVirtualFile::generateTableCSV() {
         m_lastError = "No Oracle connection pool";
         return "";
     }
+    if (auto parallel = parallelTableExport(false)) {
+        return *parallel;
+    }
     auto conn = pool->acquire();
 
     // Oracle uses schema.table format (database maps to schema)
@@ -35,12 +39,13 @@ std::string OracleVirtualFile::generateTableCSV() {
         sql += " FETCH FIRST " + std::to_string(m_config.max_rows_per_file) + " ROWS ONLY";
     }
 
-    OCIStmt* stmt = conn->execute(sql);
+    OCIStmt* stmt = conn->execute(sql, static_cast<ub4>(m_config.fetch_batch_rows));
     if (!stmt) {
         throw std::runtime_error("Oracle query failed: " + conn->getError());
     }
 
-    OracleResultSet result(stmt, conn->err(), conn->env());
+    OracleResultSet result(stmt, conn->err(), conn->env(), conn->svc(),
+                           static_cast<ub4>(m_config.fetch_batch_rows));
 
     CSVOptions opts;
     opts.includeHeader = m_config.include_csv_header;
@@ -54,6 +59,9 @@ std::string OracleVirtualFile::generateTableJSON() {
         m_lastError = "No Oracle connection pool";
         return "";
     }
+    if (auto parallel = parallelTableExport(true)) {
+        return *parallel;
+    }
     auto conn = pool->acquire();
 
     std::string sql = "SELECT * FROM " +
@@ -63,12 +71,13 @@ std::string OracleVirtualFile::generateTableJSON() {
         sql += " FETCH FIRST " + std::to_string(m_config.max_rows_per_file) + " ROWS ONLY";
     }
 
-    OCIStmt* stmt = conn->execute(sql);
+    OCIStmt* stmt = conn->execute(sql, static_cast<ub4>(m_config.fetch_batch_rows));
     if (!stmt) {
         throw std::runtime_error("Oracle query failed: " + conn->getError());
     }
 
-    OracleResultSet result(stmt, conn->err(), conn->env());
+    OracleResultSet result(stmt, conn->err(), conn->env(), conn->svc(),
+                           static_cast<ub4>(m_config.fetch_batch_rows));
 
     JSONOptions opts;
     opts.pretty = m_config.pretty_json;
@@ -76,6 +85,84 @@ std::string OracleVirtualFile::generateTableJSON() {
     return OracleFormatConverter::toJSON(result, opts);
 }
 
+KeySource OracleVirtualFile::exportKeySource(const std::string& pkColumn) {
+    std::string table = OracleFormatConverter::escapeIdentifier(m_path.database) + "." +
+                        OracleFormatConverter::escapeIdentifier(m_path.object_name);
+    std::string key = OracleFormatConverter::escapeIdentifier(pkColumn);
+
+    KeySource source;
+    source.bounds = [this, table, key]() -> std::optional<std::pair<std::string, std::string>> {
+        auto conn = getPool()->acquire();
+        OCIStmt* stmt = conn->execute("SELECT MIN(" + key + "), MAX(" + key + ") FROM " + table);
+        if (!stmt) {
+            throw std::runtime_error("Oracle query failed: " + conn->getError());
+        }
+        OracleResultSet result(stmt, conn->err(), conn->env(), conn->svc());
+        if (!result.fetchRow() || result.isNull(0) || result.isNull(1)) {
+            return std::nullopt;
+        }
+        return std::make_pair(std::string(result.getValue(0)), std::string(result.getValue(1)));
+    };
+    source.keyAt = [this, table, key](const std::optional<std::string>& from,
+                                      size_t offset) -> std::optional<std::string> {
+        std::string sql = "SELECT " + key + " FROM " + table;
+        if (from) {
+            sql += " WHERE " + key + " >= '" + OracleFormatConverter::escapeSQL(*from) + "'";
+        }
+        sql += " ORDER BY " + key + " OFFSET " + std::to_string(offset) +
+               " ROWS FETCH FIRST 1 ROWS ONLY";
+
+        auto conn = getPool()->acquire();
+        OCIStmt* stmt = conn->execute(sql);
+        if (!stmt) {
+            throw std::runtime_error("Oracle query failed: " + conn->getError());
+        }
+        OracleResultSet result(stmt, conn->err(), conn->env(), conn->svc());
+        if (!result.fetchRow() || result.isNull(0)) {
+            return std::nullopt;
+        }
+        return std::string(result.getValue(0));
+    };
+    return source;
+}
+
+std::string OracleVirtualFile::renderKeyRange(const std::string& pkColumn, const KeyRange& range,
+                                              bool json, bool header) {
+    std::string key = OracleFormatConverter::escapeIdentifier(pkColumn);
+    std::string sql = "SELECT * FROM " +
+                      OracleFormatConverter::escapeIdentifier(m_path.database) + "." +
+                      OracleFormatConverter::escapeIdentifier(m_path.object_name);
+    if (range.lower) {
+        sql += " WHERE " + key + " >= '" + OracleFormatConverter::escapeSQL(*range.lower) + "'";
+    }
+    if (range.upper) {
+        sql += range.lower ? " AND " : " WHERE ";
+        sql += key + " < '" + OracleFormatConverter::escapeSQL(*range.upper) + "'";
+    }
+    sql += " ORDER BY " + key;
+    if (range.limit > 0) {
+        sql += " FETCH FIRST " + std::to_string(range.limit) + " ROWS ONLY";
+    }
+
+    auto conn = getPool()->acquire();
+    OCIStmt* stmt = conn->execute(sql, static_cast<ub4>(m_config.fetch_batch_rows));
+    if (!stmt) {
+        throw std::runtime_error("Oracle query failed: " + conn->getError());
+    }
+
+    OracleResultSet result(stmt, conn->err(), conn->env(), conn->svc(),
+                           static_cast<ub4>(m_config.fetch_batch_rows));
+
+    if (json) {
+        JSONOptions opts;
+        opts.pretty = m_config.pretty_json;
+        return OracleFormatConverter::toJSON(result, opts);
+    }
+    CSVOptions opts;
+    opts.includeHeader = header;
+    return OracleFormatConverter::toCSV(result, opts);
+}
+
 std::string OracleVirtualFile::generateRowJSON() {
     auto* pool = getPool();
     if (!pool) {
@@ -101,7 +188,7 @@ std::string OracleVirtualFile::generateRowJSON() {
         throw std::runtime_error("Oracle query failed: " + conn->getError());
     }
 
-    OracleResultSet result(stmt, conn->err(), conn->env());
+    OracleResultSet result(stmt, conn->err(), conn->env(), conn->svc());
 
     if (!result.fetchRow()) {
         return "{}";
@@ -134,12 +221,13 @@ std::string OracleVirtualFile::generateViewContent() {
         sql += " FETCH FIRST " + std::to_string(m_config.max_rows_per_file) + " ROWS ONLY";
     }
 
-    OCIStmt* stmt = conn->execute(sql);
+    OCIStmt* stmt = conn->execute(sql, static_cast<ub4>(m_config.fetch_batch_rows));
     if (!stmt) {
         throw std::runtime_error("Oracle query failed: " + conn->getError());
     }
 
-    OracleResultSet result(stmt, conn->err(), conn->env());
+    OracleResultSet result(stmt, conn->err(), conn->env(), conn->svc(),
+                           static_cast<ub4>(m_config.fetch_batch_rows));
 
     if (m_path.format == FileFormat::CSV) {
         CSVOptions opts;
@@ -269,46 +357,173 @@ std::string OracleVirtualFile::generateUserInfo() {
     return out.str();
 }
 
-int OracleVirtualFile::handleTableWrite() {
-    if (m_writeBuffer.empty()) {
+namespace {
+
+// One table write in one transaction, inserted with array DML. A batch is
+// bound column by column at the width of each column's longest value, so
+// its size is bounded on that padded footprint. The bound values point into
+// the reader's buffer, so each write() executes its last batch before
+// returning; row numbers in rejection messages count across writes.
+class OracleTableWriteStream : public TableWriteStream {
+public:
+    OracleTableWriteStream(std::unique_ptr<OracleConnection> conn, std::string table,
+                           const std::vector<std::string>& columns, bool skipBadRows,
+                           bool replace, const InsertLimits& limits)
+        : m_conn(std::move(conn)),
+          m_table(std::move(table)),
+          m_columns(columns),
+          m_sql(OracleFormatConverter::buildArrayInsert(m_table, columns)),
+          m_skipBadRows(skipBadRows),
+          m_replace(replace),
+          m_limits(limits),
+          m_widths(columns.size(), 0) {}
+
+    // OCI opens the transaction implicitly with the first execute. A
+    // replace deletes rather than truncates: TRUNCATE commits at once, and
+    // readers must keep seeing the old rows until the new ones are in
+    int begin() override {
+        if (m_replace && !m_conn->executeNonQuery("DELETE FROM " +
+                                                  OracleFormatConverter::escapeIdentifier(m_table))) {
+            return fail();
+        }
         return 0;
     }
 
-    auto* pool = getPool();
-    if (!pool) {
-        m_lastError = "No Oracle connection pool";
-        return -EIO;
+    int write(RowReader& reader) override {
+        const size_t columns = m_columns.size();
+        while (reader.next()) {
+            const auto& fields = reader.row();
+            size_t padded = 0;
+            for (size_t i = 0; i < columns; ++i) {
+                size_t size = fields[i] ? fields[i]->size() : 0;
+                if (size > OracleConnection::MAX_ARRAY_BIND_BYTES) {
+                    m_error = "row " + std::to_string(m_rowNumber + 1) + ": value for " +
+                              m_columns[i] + " is longer than " +
+                              std::to_string(OracleConnection::MAX_ARRAY_BIND_BYTES) + " bytes";
+                    return -EINVAL;
+                }
+                padded += std::max(m_widths[i], size);
+            }
+            if (!m_batch.empty() && (m_batch.size() >= m_limits.maxRows ||
+                                     (m_batch.size() + 1) * padded > m_limits.maxBytes)) {
+                if (!flush()) return fail();
+            }
+            for (size_t i = 0; i < columns; ++i) {
+                m_widths[i] = std::max(m_widths[i], fields[i] ? fields[i]->size() : 0);
+            }
+            m_batch.push_back(fields);
+            ++m_rowNumber;
+        }
+        return flush() ? 0 : fail();
     }
 
-    try {
-        std::vector<RowData> rows;
-
-        if (m_path.format == FileFormat::CSV) {
-            CSVOptions opts;
-            opts.includeHeader = true;  // Assume header in written data
-            rows = FormatConverter::parseCSV(m_writeBuffer, opts);
-
-        } else if (m_path.format == FileFormat::JSON) {
-            rows = FormatConverter::parseJSON(m_writeBuffer);
-        } else {
-            return -EINVAL;
+    int finish() override {
+        if (m_rejected > 0 && !m_skipBadRows) {
+            m_error = std::to_string(m_rejected) + " rows rejected, nothing inserted; first " +
+                      m_firstRejection;
+            return errnoFor(m_firstCode);
         }
+        if (!m_conn->commit()) return fail();
+
+        spdlog::debug("Inserted {} rows into {} in {} array executes", m_loaded, m_table,
+                      m_executes);
+
+        if (m_rejected > 0) {
+            // The good rows are committed; still fail the write so the
+            // rejected ones are not lost silently
+            m_error = std::to_string(m_rejected) + " of " + std::to_string(m_rowNumber) +
+                      " rows rejected; first " + m_firstRejection;
+            spdlog::warn("{}: {}", m_table, m_error);
+            return errnoFor(m_firstCode);
+        }
+        return 0;
+    }
 
-        auto conn = pool->acquire();
+    void abort() override { m_conn->rollback(); }
 
-        for (const auto& row : rows) {
-            std::string sql = OracleFormatConverter::buildInsert(
-                m_path.database + "." + m_path.object_name, row, true);
+private:
+    static int errnoFor(int code) {
+        int err = ErrorHandler::oracleToErrno(code);
+        return err ? -err : -EIO;
+    }
+
+    int fail() {
+        m_error = m_conn->getError();
+        return errnoFor(m_conn->getErrorCode());
+    }
 
-            if (!conn->executeNonQuery(sql)) {
-                m_lastError = conn->getError();
-                return -ErrorHandler::oracleToErrno(conn->getErrorCode());
+    bool flush() {
+        if (m_batch.empty()) return true;
+        if (!m_conn->executeArray(m_sql, m_batch, m_rowErrors)) return false;
+        ++m_executes;
+        m_loaded += m_conn->affectedRows();
+        size_t batchStart = m_rowNumber - m_batch.size();
+        for (const auto& error : m_rowErrors) {
+            spdlog::debug("Row {} rejected by {}: {}", batchStart + error.row + 1, m_table,
+                          error.message);
+            if (m_rejected++ == 0) {
+                m_firstRejection =
+                    "row " + std::to_string(batchStart + error.row + 1) + ": " + error.message;
+                m_firstCode = error.code;
             }
         }
+        m_batch.clear();
+        std::fill(m_widths.begin(), m_widths.end(), 0);
+        return true;
+    }
 
-        // Commit the transaction
-        conn->commit();
+    std::unique_ptr<OracleConnection> m_conn;
+    std::string m_table;
+    std::vector<std::string> m_columns;
+    std::string m_sql;
+    bool m_skipBadRows;
+    bool m_replace;  // Empty the table first, in the same transaction
+    InsertLimits m_limits;
+
+    std::vector<OracleConnection::BindRow> m_batch;
+    std::vector<size_t> m_widths;
+    std::vector<OracleRowError> m_rowErrors;
+    size_t m_rowNumber = 0;  // Data rows read so far
+    size_t m_loaded = 0;
+    size_t m_executes = 0;
+    size_t m_rejected = 0;
+    std::string m_firstRejection;
+    int m_firstCode = 0;
+};
+
+}  // namespace
+
+std::unique_ptr<TableWriteStream> OracleVirtualFile::openTableWriteStream(
+    const std::vector<std::string>& columns) {
+    auto* pool = getPool();
+    if (!pool) {
+        return TableWriteStream::failed(-EIO, "No Oracle connection pool");
+    }
+
+    auto conn = pool->acquire();
+    if (!conn) {
+        return TableWriteStream::failed(-EIO, "No Oracle connection available");
+    }
+
+    // Oracle uses schema.table format (database maps to schema)
+    return std::make_unique<OracleTableWriteStream>(
+        std::move(conn), m_path.database + "." + m_path.object_name, columns,
+        m_config.oracle_skip_bad_rows, m_replace, insertLimits());
+}
 
+int OracleVirtualFile::rowWriteStatement(std::string& sql) {
+    try {
+        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
+        if (!table_info || table_info->primaryKeyColumn.empty()) {
+            m_lastError = "No primary key defined";
+            return -EINVAL;
+        }
+
+        // The file name identifies the row; one MERGE inserts or updates it
+        RowData row = FormatConverter::parseJSONRow(m_writeBuffer.str());
+        row[table_info->primaryKeyColumn] = m_path.row_id;
+        sql = OracleFormatConverter::buildUpsert(
+            m_path.database + "." + m_path.object_name, row, table_info->primaryKeyColumn);
         return 0;
 
     } catch (const std::exception& e) {
@@ -328,54 +543,14 @@ int OracleVirtualFile::handleRowWrite() {
         return -EIO;
     }
 
-    try {
-        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
-        if (!table_info || table_info->primaryKeyColumn.empty()) {
-            m_lastError = "No primary key defined";
-            return -EINVAL;
-        }
-
-        RowData row = FormatConverter::parseJSONRow(m_writeBuffer);
+    std::string sql;
+    if (int result = rowWriteStatement(sql); result != 0) {
+        return result;
+    }
 
+    try {
         auto conn = pool->acquire();
 
-        // Check if row exists (by checking if row_id is numeric and exists)
-        bool rowExists = false;
-        bool isNumericId = !m_path.row_id.empty() &&
-                          m_path.row_id.find_first_not_of("0123456789") == std::string::npos;
-
-        if (isNumericId) {
-            std::string checkSql = "SELECT 1 FROM " +
-                                   OracleFormatConverter::escapeIdentifier(m_path.database) + "." +
-                                   OracleFormatConverter::escapeIdentifier(m_path.object_name) +
-                                   " WHERE " + OracleFormatConverter::escapeIdentifier(table_info->primaryKeyColumn) +
-                                   " = '" + OracleFormatConverter::escapeSQL(m_path.row_id) +
-                                   "' FETCH FIRST 1 ROWS ONLY";
-            OCIStmt* stmt = conn->execute(checkSql);
-            if (stmt) {
-                OracleResultSet result(stmt, conn->err(), conn->env());
-                rowExists = result.fetchRow();
-            }
-        }
-
-        std::string sql;
-
-        if (rowExists) {
-            // UPDATE existing row
-            sql = OracleFormatConverter::buildUpdate(
-                m_path.database + "." + m_path.object_name,
-                row,
-                table_info->primaryKeyColumn,
-                m_path.row_id,
-                true);
-        } else {
-            // INSERT new row
-            sql = OracleFormatConverter::buildInsert(
-                m_path.database + "." + m_path.object_name,
-                row,
-                true);
-        }
-
         if (!conn->executeNonQuery(sql)) {
             m_lastError = conn->getError();
             return -ErrorHandler::oracleToErrno(conn->getErrorCode());
@@ -388,8 +563,61 @@ int OracleVirtualFile::handleRowWrite() {
 
     } catch (const std::exception& e) {
         m_lastError = e.what();
-        return -EINVAL;
+        return -EIO;
+    }
+}
+
+WriteBehindQueue::OpenSession OracleVirtualFile::writeSession() {
+    auto* pool = getPool();
+    if (!pool) {
+        return {};
+    }
+
+    return [pool]() -> std::optional<InsertSession> {
+        std::shared_ptr<OracleConnection> conn = pool->acquire();
+        if (!conn) {
+            return std::nullopt;
+        }
+        // OCI opens the transaction implicitly with the first statement
+        return InsertSession{[conn](const std::string& sql) { return conn->executeNonQuery(sql); },
+                             [] { return true; },
+                             [conn] { return conn->commit(); },
+                             [conn] { conn->rollback(); },
+                             [conn] { return conn->getError(); },
+                             [conn] { return -ErrorHandler::oracleToErrno(conn->getErrorCode()); }};
+    };
+}
+
+int OracleVirtualFile::applyTableDiff(const TableDiff& diff, const std::string& pkColumn) {
+    auto* pool = getPool();
+    if (!pool) {
+        m_lastError = "No Oracle connection pool";
+        return -EIO;
+    }
+
+    auto conn = pool->acquire();
+    if (!conn) {
+        m_lastError = "No Oracle connection available";
+        return -EIO;
+    }
+
+    // OCI opens the transaction implicitly with the first statement
+    for (const auto& sql : diffStatements<OracleFormatConverter>(
+             diff, m_path.database + "." + m_path.object_name, pkColumn)) {
+        if (!conn->executeNonQuery(sql)) {
+            m_lastError = conn->getError();
+            int err = ErrorHandler::oracleToErrno(conn->getErrorCode());
+            conn->rollback();
+            return err ? -err : -EIO;
+        }
+    }
+
+    if (!conn->commit()) {
+        m_lastError = conn->getError();
+        conn->rollback();
+        return -EIO;
     }
+    return 0;
 }
 
 }  // namespace sqlfuse
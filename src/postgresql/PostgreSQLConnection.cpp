@@ -8,6 +8,7 @@
 
 #include "PostgreSQLConnection.hpp"
 #include "PostgreSQLConnectionPool.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace sqlfuse {
@@ -82,11 +83,41 @@ PGresult* PostgreSQLConnection::execute(const std::string& sql) {
 
 PGresult* PostgreSQLConnection::executeParams(const std::string& sql,
                                                const char* const* paramValues,
-                                               int nParams) {
+                                               int nParams,
+                                               int resultFormat) {
     // Execute parameterized query (prevents SQL injection)
     if (!isValid()) return nullptr;
     return PQexecParams(m_conn, sql.c_str(), nParams, nullptr,
-                        paramValues, nullptr, nullptr, 0);
+                        paramValues, nullptr, nullptr, resultFormat);
+}
+
+bool PostgreSQLConnection::beginCopy(const std::string& sql) {
+    if (!isValid()) return false;
+    PGresult* res = PQexec(m_conn, sql.c_str());
+    bool ready = res && PQresultStatus(res) == PGRES_COPY_IN;
+    PQclear(res);
+    return ready;
+}
+
+bool PostgreSQLConnection::putCopyData(std::string_view data) {
+    // PQputCopyData takes an int length; split anything larger
+    constexpr size_t MAX_CHUNK = 1 << 30;
+    while (!data.empty()) {
+        size_t n = std::min(data.size(), MAX_CHUNK);
+        if (PQputCopyData(m_conn, data.data(), static_cast<int>(n)) != 1) return false;
+        data.remove_prefix(n);
+    }
+    return true;
+}
+
+PGresult* PostgreSQLConnection::endCopy(const char* abortMessage) {
+    if (PQputCopyEnd(m_conn, abortMessage) != 1) return nullptr;
+
+    PGresult* result = PQgetResult(m_conn);
+    while (PGresult* extra = PQgetResult(m_conn)) {
+        PQclear(extra);
+    }
+    return result;
 }
 
 // ============================================================================
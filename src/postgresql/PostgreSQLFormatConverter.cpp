@@ -10,6 +10,8 @@
  * - Uses OIDs to identify PostgreSQL data types
  * - Preserves numeric types (int2, int4, int8, float4, float8, numeric) in JSON
  * - Handles boolean type ('t'/'f' to true/false)
+ * - Decodes binary-format results (resultFormat = 1) by OID without a
+ *   server-side text rendering and client-side re-parse
  *
  * PostgreSQL Escaping Conventions:
  * - Identifiers: Double quotes with doubled double-quotes for escaping
@@ -17,6 +19,12 @@
  */
 
 #include "PostgreSQLFormatConverter.hpp"
+#include "ResultBatch.hpp"
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <sstream>
 
 namespace sqlfuse {
@@ -33,6 +41,15 @@ constexpr Oid INT8OID = 20;
 constexpr Oid FLOAT4OID = 700;
 constexpr Oid FLOAT8OID = 701;
 constexpr Oid NUMERICOID = 1700;
+constexpr Oid BYTEAOID = 17;
+constexpr Oid NAMEOID = 19;
+constexpr Oid TEXTOID = 25;
+constexpr Oid JSONOID = 114;
+constexpr Oid BPCHAROID = 1042;
+constexpr Oid VARCHAROID = 1043;
+constexpr Oid DATEOID = 1082;
+constexpr Oid TIMESTAMPOID = 1114;
+constexpr Oid UUIDOID = 2950;
 
 // ============================================================================
 // Type Classification Helpers
@@ -51,117 +68,455 @@ std::string PostgreSQLFormatConverter::formatValue(PGresult* result, int row, in
     if (PQgetisnull(result, row, col)) {
         return "";
     }
+    if (PQfformat(result, col) == 1) {
+        std::string out;
+        appendBinaryValue(out, PQftype(result, col),
+                          PQgetvalue(result, row, col), PQgetlength(result, row, col));
+        return out;
+    }
     return PQgetvalue(result, row, col);
 }
 
 // ============================================================================
-// CSV Output
+// Binary Result Decoding
 // ============================================================================
 
-std::string PostgreSQLFormatConverter::toCSV(PGresult* result, const CSVOptions& options) {
-    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK) {
-        return "";
+namespace {
+
+// Days between 1970-01-01 and 2000-01-01 (the PostgreSQL epoch)
+constexpr int64_t PG_EPOCH_DAYS = 10957;
+constexpr int64_t USECS_PER_DAY = 86400000000LL;
+
+// Read a big-endian signed integer of N bytes
+template<typename T>
+T readBE(const char* data) {
+    using U = std::make_unsigned_t<T>;
+    U v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        v = static_cast<U>((v << 8) | static_cast<unsigned char>(data[i]));
     }
+    return static_cast<T>(v);
+}
 
-    std::ostringstream out;
+template<typename T>
+void appendNumber(std::string& out, T value) {
+    char buf[32];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, end);
+}
 
-    int num_fields = PQnfields(result);
-    int num_rows = PQntuples(result);
+// Same spelling as float8out for the non-finite values
+template<typename T>
+void appendFloat(std::string& out, T value) {
+    if (std::isnan(value)) {
+        out += "NaN";
+    } else if (std::isinf(value)) {
+        out += value > 0 ? "Infinity" : "-Infinity";
+    } else {
+        appendNumber(out, value);
+    }
+}
+
+void appendPadded(std::string& out, int64_t value, int width) {
+    char buf[24];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    for (int n = static_cast<int>(end - buf); n < width; ++n) {
+        out += '0';
+    }
+    out.append(buf, end);
+}
+
+// Civil date from days since 1970-01-01 (Howard Hinnant's algorithm)
+void civilFromDays(int64_t z, int64_t& y, int& m, int& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = yoe + era * 400 + (m <= 2);
+}
 
-    // Header
-    if (options.includeHeader) {
-        for (int i = 0; i < num_fields; ++i) {
-            if (i > 0) out << options.delimiter;
-            out << escapeCSVField(PQfname(result, i), options);
+// Write `value` (0 <= value < 10^width) as exactly `width` digits
+char* putDigits(char* p, int64_t value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        p[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return p + width;
+}
+
+// Write YYYY-MM-DD for a day count relative to 2000-01-01 into `p` (room
+// for 32 bytes); sets `bc` if the year is BC so the caller can add the
+// suffix at the end
+char* putDate(char* p, int64_t pgDays, bool& bc) {
+    int64_t year;
+    int month, day;
+    civilFromDays(pgDays + PG_EPOCH_DAYS, year, month, day);
+    bc = year <= 0;
+    if (bc) {
+        year = 1 - year;
+    }
+    if (year < 10000) {
+        p = putDigits(p, year, 4);
+    } else {
+        p = std::to_chars(p, p + 20, year).ptr;
+    }
+    *p++ = '-';
+    p = putDigits(p, month, 2);
+    *p++ = '-';
+    return putDigits(p, day, 2);
+}
+
+void appendDate(std::string& out, int64_t pgDays) {
+    char buf[48];
+    bool bc;
+    char* end = putDate(buf, pgDays, bc);
+    out.append(buf, end);
+    if (bc) out += " BC";
+}
+
+void appendTimestamp(std::string& out, int64_t usecs) {
+    if (usecs == std::numeric_limits<int64_t>::max()) {
+        out += "infinity";
+        return;
+    }
+    if (usecs == std::numeric_limits<int64_t>::min()) {
+        out += "-infinity";
+        return;
+    }
+
+    int64_t days = usecs / USECS_PER_DAY;
+    int64_t time = usecs % USECS_PER_DAY;
+    if (time < 0) {
+        time += USECS_PER_DAY;
+        --days;
+    }
+
+    // Formatted on the stack and appended once
+    char buf[64];
+    bool bc;
+    char* p = putDate(buf, days, bc);
+    int64_t secs = time / 1000000;
+    int64_t frac = time % 1000000;
+    *p++ = ' ';
+    p = putDigits(p, secs / 3600, 2);
+    *p++ = ':';
+    p = putDigits(p, (secs / 60) % 60, 2);
+    *p++ = ':';
+    p = putDigits(p, secs % 60, 2);
+    if (frac != 0) {
+        // Fractional seconds with trailing zeros trimmed, as in text output
+        int width = 6;
+        while (frac % 10 == 0) {
+            frac /= 10;
+            --width;
         }
-        out << options.lineEnding;
+        *p++ = '.';
+        p = putDigits(p, frac, width);
+    }
+    out.append(buf, p);
+    if (bc) out += " BC";
+}
+
+// numeric: int16 ndigits, int16 weight, uint16 sign, uint16 dscale,
+// followed by ndigits base-10000 digits
+void appendNumeric(std::string& out, const char* data, int length) {
+    if (length < 8) return;
+    int16_t ndigits = readBE<int16_t>(data);
+    int16_t weight = readBE<int16_t>(data + 2);
+    uint16_t sign = readBE<uint16_t>(data + 4);
+    int dscale = readBE<uint16_t>(data + 6);
+    if (length < 8 + ndigits * 2) return;
+
+    switch (sign) {
+        case 0xC000: out += "NaN"; return;
+        case 0xD000: out += "Infinity"; return;
+        case 0xF000: out += "-Infinity"; return;
+        case 0x4000: out += '-'; break;
+        default: break;
     }
 
-    // Rows
-    for (int row = 0; row < num_rows; ++row) {
-        for (int col = 0; col < num_fields; ++col) {
-            if (col > 0) out << options.delimiter;
+    auto digit = [&](int i) -> int {
+        return (i >= 0 && i < ndigits) ? readBE<int16_t>(data + 8 + i * 2) : 0;
+    };
 
-            if (!PQgetisnull(result, row, col)) {
-                std::string value = PQgetvalue(result, row, col);
-                out << escapeCSVField(value, options);
+    if (weight < 0) {
+        out += '0';
+    } else {
+        for (int i = 0; i <= weight; ++i) {
+            if (i == 0) {
+                appendNumber(out, digit(i));
+            } else {
+                appendPadded(out, digit(i), 4);
             }
-            // NULL values are represented as empty
         }
-        out << options.lineEnding;
     }
 
-    return out.str();
+    if (dscale > 0) {
+        out += '.';
+        for (int i = weight + 1, written = 0; written < dscale; ++i) {
+            char buf[4];
+            int dg = digit(i);
+            for (int k = 3; k >= 0; --k) {
+                buf[k] = static_cast<char>('0' + dg % 10);
+                dg /= 10;
+            }
+            int take = std::min(4, dscale - written);
+            out.append(buf, take);
+            written += take;
+        }
+    }
 }
 
-std::string PostgreSQLFormatConverter::toCSV(PostgreSQLResultSet& result, const CSVOptions& options) {
-    return toCSV(result.get(), options);
+void appendHex(std::string& out, const char* data, int length) {
+    static constexpr char digits[] = "0123456789abcdef";
+    for (int i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        out += digits[c >> 4];
+        out += digits[c & 0x0F];
+    }
 }
 
-// ============================================================================
-// JSON Output
-// ============================================================================
-
-std::string PostgreSQLFormatConverter::toJSON(PGresult* result, const JSONOptions& options) {
-    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK) {
-        return options.arrayFormat ? "[]" : "{\"rows\": []}";
+}  // namespace
+
+bool PostgreSQLFormatConverter::isBinaryDecodable(Oid type) {
+    switch (type) {
+        case BOOLOID: case INT2OID: case INT4OID: case INT8OID:
+        case FLOAT4OID: case FLOAT8OID: case NUMERICOID:
+        case DATEOID: case TIMESTAMPOID: case UUIDOID: case BYTEAOID:
+        case TEXTOID: case VARCHAROID: case BPCHAROID: case NAMEOID: case JSONOID:
+            return true;
+        default:
+            return false;
     }
+}
 
+bool PostgreSQLFormatConverter::isBinaryDecodable(PGresult* result) {
     int num_fields = PQnfields(result);
-    int num_rows = PQntuples(result);
+    for (int i = 0; i < num_fields; ++i) {
+        if (!isBinaryDecodable(PQftype(result, i))) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    std::vector<std::string> column_names;
-    std::vector<Oid> column_types;
-    column_names.reserve(num_fields);
-    column_types.reserve(num_fields);
+std::string PostgreSQLFormatConverter::buildBinaryColumns(PGresult* description) {
+    std::ostringstream out;
 
+    int num_fields = PQnfields(description);
     for (int i = 0; i < num_fields; ++i) {
-        column_names.emplace_back(PQfname(result, i));
-        column_types.push_back(PQftype(result, i));
-    }
-
-    json arr = json::array();
-
-    for (int row = 0; row < num_rows; ++row) {
-        json obj = json::object();
-
-        for (int col = 0; col < num_fields; ++col) {
-            if (!PQgetisnull(result, row, col)) {
-                std::string value = PQgetvalue(result, row, col);
-
-                // Try to preserve numeric types
-                if (isNumericType(column_types[col])) {
-                    try {
-                        if (column_types[col] == FLOAT4OID ||
-                            column_types[col] == FLOAT8OID ||
-                            column_types[col] == NUMERICOID) {
-                            obj[column_names[col]] = std::stod(value);
-                        } else {
-                            obj[column_names[col]] = std::stoll(value);
-                        }
-                    } catch (...) {
-                        obj[column_names[col]] = value;
-                    }
-                } else if (isBooleanType(column_types[col])) {
-                    obj[column_names[col]] = (value == "t" || value == "true" || value == "1");
+        if (i > 0) out << ", ";
+        std::string column = escapeIdentifier(PQfname(description, i));
+        out << column;
+        if (!isBinaryDecodable(PQftype(description, i))) {
+            // No client-side decoder: let the server render it as text
+            out << "::text AS " << column;
+        }
+    }
+
+    return out.str();
+}
+
+std::string PostgreSQLFormatConverter::buildBinarySelect(const std::string& columns,
+                                                         const std::string& sql) {
+    // Replacing the star rather than wrapping the query keeps its ORDER BY
+    // at the top level, where it still orders the rows returned
+    const std::string star = "SELECT * ";
+    if (sql.compare(0, star.size(), star) != 0) {
+        return "";
+    }
+    return "SELECT " + columns + " " + sql.substr(star.size());
+}
+
+void PostgreSQLFormatConverter::appendBinaryValue(std::string& out, Oid type,
+                                                  const char* data, int length) {
+    switch (type) {
+        case BOOLOID:
+            if (length == 1) out += data[0] ? 't' : 'f';
+            return;
+        case INT2OID:
+            if (length == 2) appendNumber(out, readBE<int16_t>(data));
+            return;
+        case INT4OID:
+            if (length == 4) appendNumber(out, readBE<int32_t>(data));
+            return;
+        case INT8OID:
+            if (length == 8) appendNumber(out, readBE<int64_t>(data));
+            return;
+        case FLOAT4OID:
+            if (length == 4) appendFloat(out, std::bit_cast<float>(readBE<uint32_t>(data)));
+            return;
+        case FLOAT8OID:
+            if (length == 8) appendFloat(out, std::bit_cast<double>(readBE<uint64_t>(data)));
+            return;
+        case NUMERICOID:
+            appendNumeric(out, data, length);
+            return;
+        case DATEOID:
+            if (length == 4) {
+                int32_t days = readBE<int32_t>(data);
+                if (days == std::numeric_limits<int32_t>::max()) {
+                    out += "infinity";
+                } else if (days == std::numeric_limits<int32_t>::min()) {
+                    out += "-infinity";
                 } else {
-                    obj[column_names[col]] = value;
+                    appendDate(out, days);
                 }
-            } else if (options.includeNull) {
-                obj[column_names[col]] = nullptr;
             }
+            return;
+        case TIMESTAMPOID:
+            if (length == 8) appendTimestamp(out, readBE<int64_t>(data));
+            return;
+        case UUIDOID:
+            if (length == 16) {
+                appendHex(out, data, 4);
+                out += '-';
+                appendHex(out, data + 4, 2);
+                out += '-';
+                appendHex(out, data + 6, 2);
+                out += '-';
+                appendHex(out, data + 8, 2);
+                out += '-';
+                appendHex(out, data + 10, 6);
+            }
+            return;
+        case BYTEAOID:
+            // Matches bytea_output = hex (the server default)
+            out += "\\x";
+            appendHex(out, data, length);
+            return;
+        default:
+            // Text-like types: binary form is the text itself
+            out.append(data, static_cast<size_t>(length));
+            return;
+    }
+}
+
+// ============================================================================
+// Result Set Conversion
+// ============================================================================
+
+std::vector<std::string> PostgreSQLFormatConverter::columnNames(PGresult* result) {
+    int num_fields = PQnfields(result);
+    std::vector<std::string> names;
+    names.reserve(num_fields);
+    for (int i = 0; i < num_fields; ++i) {
+        names.emplace_back(PQfname(result, i));
+    }
+    return names;
+}
+
+void PostgreSQLFormatConverter::appendRow(PGresult* result, int row, ResultBatch& batch) {
+    std::string scratch;
+
+    for (size_t i = 0; i < batch.columnCount(); ++i) {
+        int col = static_cast<int>(i);
+        ResultColumn& column = batch.column(i);
+
+        if (PQgetisnull(result, row, col)) {
+            column.appendNull();
+            continue;
+        }
+
+        const char* data = PQgetvalue(result, row, col);
+        int length = PQgetlength(result, row, col);
+        Oid type = PQftype(result, col);
+
+        if (PQfformat(result, col) != 1) {
+            std::string_view value(data, static_cast<size_t>(length));
+            if (isNumericType(type)) {
+                column.appendNumber(value);
+            } else if (isBooleanType(type)) {
+                column.appendBoolean(value == "t");
+            } else {
+                column.appendText(value);
+            }
+            continue;
+        }
+
+        // Binary format: integers and booleans are taken natively; floats and
+        // numeric go through their text form so CSV matches the server's
+        // rendering and JSON keeps every digit
+        switch (type) {
+            case BOOLOID:
+                column.appendBoolean(length == 1 && data[0] != 0);
+                continue;
+            case INT2OID:
+                if (length == 2) {
+                    column.appendInteger(readBE<int16_t>(data));
+                    continue;
+                }
+                break;
+            case INT4OID:
+                if (length == 4) {
+                    column.appendInteger(readBE<int32_t>(data));
+                    continue;
+                }
+                break;
+            case INT8OID:
+                if (length == 8) {
+                    column.appendInteger(readBE<int64_t>(data));
+                    continue;
+                }
+                break;
+            default:
+                break;
         }
 
-        arr.push_back(std::move(obj));
+        scratch.clear();
+        appendBinaryValue(scratch, type, data, length);
+        if (isNumericType(type)) {
+            column.appendNumber(scratch);
+        } else {
+            column.appendText(scratch);
+        }
     }
+}
 
-    if (options.arrayFormat) {
-        return options.pretty ? arr.dump(options.indent) : arr.dump();
-    } else {
-        json wrapper = json::object();
-        wrapper["rows"] = std::move(arr);
-        return options.pretty ? wrapper.dump(options.indent) : wrapper.dump();
+bool PostgreSQLFormatConverter::fillBatch(PGresult* result, int& nextRow, ResultBatch& batch) {
+    int num_rows = PQntuples(result);
+    while (!batch.full() && nextRow < num_rows) {
+        appendRow(result, nextRow++, batch);
     }
+    return batch.rowCount() > 0;
+}
+
+// ============================================================================
+// CSV Output
+// ============================================================================
+
+std::string PostgreSQLFormatConverter::toCSV(PGresult* result, const CSVOptions& options) {
+    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK) {
+        return "";
+    }
+
+    ResultBatch batch(columnNames(result));
+    int nextRow = 0;
+    return FormatConverter::toCSV(batch, [&](ResultBatch& b) { return fillBatch(result, nextRow, b); },
+                                  options);
+}
+
+std::string PostgreSQLFormatConverter::toCSV(PostgreSQLResultSet& result, const CSVOptions& options) {
+    return toCSV(result.get(), options);
+}
+
+// ============================================================================
+// JSON Output
+// ============================================================================
+
+std::string PostgreSQLFormatConverter::toJSON(PGresult* result, const JSONOptions& options) {
+    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK) {
+        return options.arrayFormat ? "[]" : "{\"rows\": []}";
+    }
+
+    ResultBatch batch(columnNames(result));
+    int nextRow = 0;
+    return FormatConverter::toJSON(batch, [&](ResultBatch& b) { return fillBatch(result, nextRow, b); },
+                                   options);
 }
 
 std::string PostgreSQLFormatConverter::toJSON(PostgreSQLResultSet& result, const JSONOptions& options) {
@@ -174,40 +529,9 @@ std::string PostgreSQLFormatConverter::rowToJSON(PGresult* result, int row,
         return "{}";
     }
 
-    int num_fields = PQnfields(result);
-
-    json obj = json::object();
-
-    for (int col = 0; col < num_fields; ++col) {
-        const char* field_name = PQfname(result, col);
-        Oid field_type = PQftype(result, col);
-
-        if (!PQgetisnull(result, row, col)) {
-            std::string value = PQgetvalue(result, row, col);
-
-            if (isNumericType(field_type)) {
-                try {
-                    if (field_type == FLOAT4OID ||
-                        field_type == FLOAT8OID ||
-                        field_type == NUMERICOID) {
-                        obj[field_name] = std::stod(value);
-                    } else {
-                        obj[field_name] = std::stoll(value);
-                    }
-                } catch (...) {
-                    obj[field_name] = value;
-                }
-            } else if (isBooleanType(field_type)) {
-                obj[field_name] = (value == "t" || value == "true" || value == "1");
-            } else {
-                obj[field_name] = value;
-            }
-        } else if (options.includeNull) {
-            obj[field_name] = nullptr;
-        }
-    }
-
-    return options.pretty ? obj.dump(options.indent) : obj.dump();
+    ResultBatch batch(columnNames(result), 1);
+    appendRow(result, row, batch);
+    return FormatConverter::rowToJSON(batch, 0, options);
 }
 
 // ============================================================================
@@ -252,6 +576,19 @@ std::string PostgreSQLFormatConverter::buildInsert(const std::string& table,
     return sql.str();
 }
 
+InsertSyntax PostgreSQLFormatConverter::insertSyntax(const std::string& table,
+                                                     const std::vector<std::string>& columns) {
+    InsertSyntax syntax;
+    syntax.head = "INSERT INTO " + escapeIdentifier(table) + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) syntax.head += ", ";
+        syntax.head += escapeIdentifier(columns[i]);
+    }
+    syntax.head += ") VALUES ";
+    syntax.separator = ", ";
+    return syntax;
+}
+
 std::string PostgreSQLFormatConverter::buildUpdate(const std::string& table,
                                                      const RowData& row,
                                                      const std::string& pkColumn,
@@ -297,6 +634,28 @@ std::string PostgreSQLFormatConverter::buildUpdate(const std::string& table,
     return sql.str();
 }
 
+std::string PostgreSQLFormatConverter::buildUpsert(const std::string& table,
+                                                   const RowData& row,
+                                                   const std::string& pkColumn,
+                                                   bool escape) {
+    std::string sql = buildInsert(table, row, escape);
+    if (sql.empty()) {
+        return sql;
+    }
+
+    std::string updates;
+    for (const auto& [col, val] : row) {
+        if (col == pkColumn) continue;
+        if (!updates.empty()) updates += ", ";
+        std::string quoted = escapeIdentifier(col);
+        updates += quoted + " = EXCLUDED." + quoted;
+    }
+
+    sql += " ON CONFLICT (" + escapeIdentifier(pkColumn) + ") DO ";
+    sql += updates.empty() ? "NOTHING" : "UPDATE SET " + updates;
+    return sql;
+}
+
 std::string PostgreSQLFormatConverter::buildDelete(const std::string& table,
                                                      const std::string& pkColumn,
                                                      const std::string& pkValue,
@@ -360,4 +719,24 @@ std::string PostgreSQLFormatConverter::escapeSQL(const std::string& value) {
     return result;
 }
 
+void PostgreSQLFormatConverter::appendLiteral(std::string& sql, std::string_view value) {
+    // A plain '' literal takes backslashes literally (standard_conforming_strings,
+    // the default since 9.1); only values containing one need the E'' form,
+    // where the backslash is doubled as well
+    bool backslash = value.find('\\') != std::string_view::npos;
+    if (backslash) sql += 'E';
+
+    sql += '\'';
+    for (char c : value) {
+        if (c == '\'') {
+            sql += "''";
+        } else if (c == '\\') {
+            sql += "\\\\";
+        } else {
+            sql += c;
+        }
+    }
+    sql += '\'';
+}
+
 }  // namespace sqlfuse
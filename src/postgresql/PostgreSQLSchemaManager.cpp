@@ -206,6 +206,8 @@ std::vector<ColumnInfo> PostgreSQLSchemaManager::getColumns(const std::string& d
         "  FROM information_schema.table_constraints tc "
         "  JOIN information_schema.key_column_usage kcu "
         "    ON tc.constraint_name = kcu.constraint_name "
+        "    AND tc.table_schema = kcu.table_schema "
+        "    AND tc.table_name = kcu.table_name "
         "  WHERE tc.table_schema = 'public' "
         "    AND tc.table_name = '" + escapeString(table) + "' "
         "    AND tc.constraint_type = 'PRIMARY KEY'"
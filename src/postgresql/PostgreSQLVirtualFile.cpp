@@ -17,8 +17,10 @@
 #include "PostgreSQLResultSet.hpp"
 #include "PostgreSQLFormatConverter.hpp"
 #include "FormatConverter.hpp"
+#include "BatchWriter.hpp"
 #include "ErrorHandler.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <sstream>
 
 namespace sqlfuse {
@@ -38,6 +40,38 @@ PostgreSQLConnectionPool* PostgreSQLVirtualFile::getPool() {
     return dynamic_cast<PostgreSQLConnectionPool*>(&m_schema.connectionPool());
 }
 
+PGresult* PostgreSQLVirtualFile::executeSelect(PostgreSQLConnection& conn, const std::string& sql) {
+    if (!m_config.pg_binary_results) {
+        return conn.execute(sql);
+    }
+
+    // Most tables decode as they are, in one round trip. Only the fact that
+    // a table needs casts is cached, never its column list, so a column
+    // added since is still exported
+    std::string key = CacheManager::makeKey(m_path.database, m_path.object_name, "binary-text");
+    if (!m_cache.get(key)) {
+        PGresult* result = conn.executeParams(sql, nullptr, 0, 1);
+        if (!result || PQresultStatus(result) != PGRES_TUPLES_OK ||
+            PostgreSQLFormatConverter::isBinaryDecodable(result)) {
+            return result;
+        }
+        PQclear(result);
+        m_cache.put(key, "1", CacheManager::Category::Schema);
+    }
+
+    // Column types are needed to know which columns to cast to text
+    PostgreSQLResultSet description(conn.execute("SELECT * FROM (" + sql + ") AS t LIMIT 0"));
+    std::string select;
+    if (description.isOk()) {
+        select = PostgreSQLFormatConverter::buildBinarySelect(
+            PostgreSQLFormatConverter::buildBinaryColumns(description.get()), sql);
+    }
+    if (select.empty()) {
+        return conn.execute(sql);
+    }
+    return conn.executeParams(select, nullptr, 0, 1);
+}
+
 // ============================================================================
 // Content Generation - Tables
 // ============================================================================
@@ -48,6 +82,9 @@ std::string PostgreSQLVirtualFile::generateTableCSV() {
         m_lastError = "No PostgreSQL connection pool";
         return "";
     }
+    if (auto parallel = parallelTableExport(false)) {
+        return *parallel;
+    }
     auto conn = pool->acquire();
 
     std::string sql = "SELECT * FROM \"" + m_path.object_name + "\"";
@@ -55,7 +92,7 @@ std::string PostgreSQLVirtualFile::generateTableCSV() {
         sql += " LIMIT " + std::to_string(m_config.max_rows_per_file);
     }
 
-    PostgreSQLResultSet result(conn->execute(sql));
+    PostgreSQLResultSet result(executeSelect(*conn, sql));
 
     if (!result.hasData()) {
         m_lastError = result.errorMessage();
@@ -74,6 +111,9 @@ std::string PostgreSQLVirtualFile::generateTableJSON() {
         m_lastError = "No PostgreSQL connection pool";
         return "";
     }
+    if (auto parallel = parallelTableExport(true)) {
+        return *parallel;
+    }
     auto conn = pool->acquire();
 
     std::string sql = "SELECT * FROM \"" + m_path.object_name + "\"";
@@ -81,7 +121,7 @@ std::string PostgreSQLVirtualFile::generateTableJSON() {
         sql += " LIMIT " + std::to_string(m_config.max_rows_per_file);
     }
 
-    PostgreSQLResultSet result(conn->execute(sql));
+    PostgreSQLResultSet result(executeSelect(*conn, sql));
 
     if (!result.hasData()) {
         m_lastError = result.errorMessage();
@@ -94,6 +134,81 @@ std::string PostgreSQLVirtualFile::generateTableJSON() {
     return PostgreSQLFormatConverter::toJSON(result.get(), opts);
 }
 
+KeySource PostgreSQLVirtualFile::exportKeySource(const std::string& pkColumn) {
+    std::string table = "\"" + m_path.object_name + "\"";
+    std::string key = "\"" + pkColumn + "\"";
+
+    // Keys travel as text and are compared as literals of the key's type
+    KeySource source;
+    source.bounds = [this, table, key]() -> std::optional<std::pair<std::string, std::string>> {
+        auto conn = getPool()->acquire();
+        PostgreSQLResultSet result(
+            conn->execute("SELECT MIN(" + key + ")::text, MAX(" + key + ")::text FROM " + table));
+        if (!result.isOk()) {
+            throw std::runtime_error(std::string("PostgreSQL query failed: ") + result.errorMessage());
+        }
+        if (!result.fetchRow() || !result.getField(0) || !result.getField(1)) {
+            return std::nullopt;
+        }
+        return std::make_pair(std::string(result.getField(0)), std::string(result.getField(1)));
+    };
+    source.keyAt = [this, table, key](const std::optional<std::string>& from,
+                                      size_t offset) -> std::optional<std::string> {
+        auto conn = getPool()->acquire();
+        std::string sql = "SELECT " + key + "::text FROM " + table;
+        if (from) {
+            sql += " WHERE " + key + " >= " + conn->escapeString(*from);
+        }
+        sql += " ORDER BY " + key + " LIMIT 1 OFFSET " + std::to_string(offset);
+
+        PostgreSQLResultSet result(conn->execute(sql));
+        if (!result.isOk()) {
+            throw std::runtime_error(std::string("PostgreSQL query failed: ") + result.errorMessage());
+        }
+        if (!result.fetchRow() || !result.getField(0)) {
+            return std::nullopt;
+        }
+        return std::string(result.getField(0));
+    };
+    return source;
+}
+
+std::string PostgreSQLVirtualFile::renderKeyRange(const std::string& pkColumn,
+                                                  const KeyRange& range, bool json,
+                                                  bool header) {
+    auto conn = getPool()->acquire();
+
+    std::string key = "\"" + pkColumn + "\"";
+    std::string sql = "SELECT * FROM \"" + m_path.object_name + "\"";
+    if (range.lower) {
+        sql += " WHERE " + key + " >= " + conn->escapeString(*range.lower);
+    }
+    if (range.upper) {
+        sql += range.lower ? " AND " : " WHERE ";
+        sql += key + " < " + conn->escapeString(*range.upper);
+    }
+    // Qualified: a key cast to text for a binary result would sort as text
+    sql += " ORDER BY \"" + m_path.object_name + "\"." + key;
+    if (range.limit > 0) {
+        sql += " LIMIT " + std::to_string(range.limit);
+    }
+
+    PostgreSQLResultSet result(executeSelect(*conn, sql));
+
+    if (!result.hasData()) {
+        throw std::runtime_error(std::string("PostgreSQL query failed: ") + result.errorMessage());
+    }
+
+    if (json) {
+        JSONOptions opts;
+        opts.pretty = m_config.pretty_json;
+        return PostgreSQLFormatConverter::toJSON(result.get(), opts);
+    }
+    CSVOptions opts;
+    opts.includeHeader = header;
+    return PostgreSQLFormatConverter::toCSV(result.get(), opts);
+}
+
 // ============================================================================
 // Content Generation - Individual Rows
 // ============================================================================
@@ -151,7 +266,7 @@ std::string PostgreSQLVirtualFile::generateViewContent() {
         sql += " LIMIT " + std::to_string(m_config.max_rows_per_file);
     }
 
-    PostgreSQLResultSet result(conn->execute(sql));
+    PostgreSQLResultSet result(executeSelect(*conn, sql));
 
     if (!result.hasData()) {
         m_lastError = result.errorMessage();
@@ -260,44 +375,221 @@ std::string PostgreSQLVirtualFile::generateUserInfo() {
 // Write Operations
 // ============================================================================
 
-int PostgreSQLVirtualFile::handleTableWrite() {
-    if (m_writeBuffer.empty()) {
+namespace {
+
+constexpr size_t COPY_CHUNK_BYTES = 256 * 1024;  // Bytes per PQputCopyData call
+
+// One table write in one transaction. With COPY, rows from every write()
+// are re-encoded as CSV (an unquoted empty field is NULL, "" the empty
+// string) into a single COPY ... FROM STDIN that stays open until finish();
+// the server sees one load however many pieces the file arrived in.
+class PostgreSQLTableWriteStream : public TableWriteStream {
+public:
+    // `merge` is empty, or the statements that move the rows from the
+    // temporary staging table `target` into the table
+    PostgreSQLTableWriteStream(std::unique_ptr<PostgreSQLConnection> conn, std::string table,
+                               std::string target, const std::vector<std::string>& columns,
+                               std::string merge, bool copy, const InsertLimits& limits)
+        : m_conn(std::move(conn)),
+          m_table(std::move(table)),
+          m_target(std::move(target)),
+          m_merge(std::move(merge)),
+          m_copy(copy),
+          m_batcher(PostgreSQLFormatConverter::insertSyntax(m_target, columns),
+                    PostgreSQLFormatConverter::appendLiteral,
+                    InsertSession{[this](const std::string& sql) { return run(sql); },
+                                  [] { return true; },  // The stream owns the transaction
+                                  [] { return true; },
+                                  [] {},
+                                  [this] { return m_error; }},
+                    limits) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i > 0) m_columnList += ", ";
+            m_columnList += PostgreSQLFormatConverter::escapeIdentifier(columns[i]);
+        }
+    }
+
+    int begin() override {
+        if (!run("BEGIN")) return -EIO;
+        if (!m_merge.empty() &&
+            !run("CREATE TEMP TABLE " + PostgreSQLFormatConverter::escapeIdentifier(m_target) +
+                 " (LIKE " + PostgreSQLFormatConverter::escapeIdentifier(m_table) +
+                 " INCLUDING DEFAULTS) ON COMMIT DROP")) {
+            return -EIO;
+        }
+        m_batcher.begin();
         return 0;
     }
 
+    int write(RowReader& reader) override {
+        if (!m_copy) {
+            if (m_batcher.append(reader)) return 0;
+            m_error = m_batcher.error();
+            return -EIO;
+        }
+
+        if (!m_copying) {
+            if (!m_conn->beginCopy("COPY " +
+                                   PostgreSQLFormatConverter::escapeIdentifier(m_target) + " (" +
+                                   m_columnList + ") FROM STDIN WITH (FORMAT csv)")) {
+                m_error = m_conn->error();
+                return -EIO;
+            }
+            m_copying = true;
+        }
+
+        std::string chunk;
+        while (reader.next()) {
+            const auto& fields = reader.row();
+            for (size_t i = 0; i < fields.size(); ++i) {
+                if (i > 0) chunk += ',';
+                if (!fields[i]) continue;
+                if (fields[i]->empty()) {
+                    chunk += "\"\"";
+                } else {
+                    m_csv.writeField(*fields[i], chunk);
+                }
+            }
+            chunk += '\n';
+            if (chunk.size() >= COPY_CHUNK_BYTES && !send(chunk)) return -EIO;
+        }
+        return send(chunk) ? 0 : -EIO;
+    }
+
+    int finish() override {
+        uint64_t rows = m_batcher.rows();
+        if (m_copying) {
+            PostgreSQLResultSet copied(m_conn->endCopy());
+            m_copying = false;
+            if (!copied.isOk()) {
+                m_error = copied.errorMessage();
+                return -EIO;
+            }
+            rows = m_conn->affectedRows(copied.get());
+        }
+        if (!m_batcher.finish()) {
+            m_error = m_batcher.error();
+            return -EIO;
+        }
+        if ((!m_merge.empty() && !run(m_merge)) || !run("COMMIT")) return -EIO;
+
+        spdlog::debug("Loaded {} rows into {} with {}{}", rows, m_table,
+                      m_copy ? "COPY" : std::to_string(m_batcher.statements()) + " INSERTs",
+                      m_merge.empty() ? "" : " (via staging table)");
+        return 0;
+    }
+
+    void abort() override {
+        if (m_copying) {
+            PQclear(m_conn->endCopy("sql-fuse: table write aborted"));
+            m_copying = false;
+        }
+        m_batcher.abort();
+        PQclear(m_conn->execute("ROLLBACK"));
+    }
+
+private:
+    bool run(const std::string& sql) {
+        PostgreSQLResultSet result(m_conn->execute(sql));
+        if (result.isOk()) return true;
+        m_error = result.errorMessage();
+        return false;
+    }
+
+    bool send(std::string& chunk) {
+        if (!chunk.empty() && !m_conn->putCopyData(chunk)) {
+            m_error = m_conn->error();
+            return false;
+        }
+        chunk.clear();
+        return true;
+    }
+
+    std::unique_ptr<PostgreSQLConnection> m_conn;
+    std::string m_table;
+    std::string m_target;  // The table, or the staging table when merging
+    std::string m_merge;
+    std::string m_columnList;
+    bool m_copy;
+    bool m_copying = false;
+    CSVBatchWriter m_csv;
+    InsertBatcher m_batcher;
+};
+
+}  // namespace
+
+std::unique_ptr<TableWriteStream> PostgreSQLVirtualFile::openTableWriteStream(
+    const std::vector<std::string>& columns) {
     auto* pool = getPool();
     if (!pool) {
-        m_lastError = "No PostgreSQL connection pool";
-        return -EIO;
+        return TableWriteStream::failed(-EIO, "No PostgreSQL connection pool");
     }
 
-    try {
-        std::vector<RowData> rows;
-
-        if (m_path.format == FileFormat::CSV) {
-            CSVOptions opts;
-            opts.includeHeader = true;  // Assume header in written data
-            rows = FormatConverter::parseCSV(m_writeBuffer, opts);
+    const std::string stage = "sqlfuse_copy_stage";
+    const std::string table = PostgreSQLFormatConverter::escapeIdentifier(m_path.object_name);
+    std::string columnList;
+    for (const auto& column : columns) {
+        if (!columnList.empty()) columnList += ", ";
+        columnList += PostgreSQLFormatConverter::escapeIdentifier(column);
+    }
+    std::string target = m_path.object_name;
+    std::string merge;
+
+    if (m_replace) {
+        // Load beside the table, then swap the contents in at commit, so the
+        // table is locked only for the final copy, not while the file arrives.
+        // DELETE rather than TRUNCATE: TRUNCATE fails on a table referenced
+        // by a foreign key, skips ON DELETE triggers, and shows concurrent
+        // snapshot readers an empty table
+        target = stage;
+        merge = "DELETE FROM " + table + "; INSERT INTO " + table + " (" + columnList +
+                ") SELECT " + columnList + " FROM \"" + stage + "\"";
+    } else if (m_config.pg_copy_writes && m_config.pg_copy_upsert) {
+        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
+        const std::string pk = table_info ? table_info->primaryKeyColumn : "";
+        if (pk.empty() || std::find(columns.begin(), columns.end(), pk) == columns.end()) {
+            return TableWriteStream::failed(-EINVAL,
+                                            "Upsert needs the primary key column in the data");
+        }
 
-        } else if (m_path.format == FileFormat::JSON) {
-            rows = FormatConverter::parseJSON(m_writeBuffer);
-        } else {
-            return -EINVAL;
+        std::string updates;
+        for (const auto& column : columns) {
+            if (column == pk) continue;
+            std::string quoted = PostgreSQLFormatConverter::escapeIdentifier(column);
+            if (!updates.empty()) updates += ", ";
+            updates += quoted + " = EXCLUDED." + quoted;
         }
 
-        auto conn = pool->acquire();
+        target = stage;
+        merge = "INSERT INTO " + table + " (" + columnList + ") SELECT " + columnList +
+                " FROM \"" + stage + "\" ON CONFLICT (" +
+                PostgreSQLFormatConverter::escapeIdentifier(pk) + ") DO " +
+                (updates.empty() ? "NOTHING" : "UPDATE SET " + updates);
+    }
 
-        for (const auto& row : rows) {
-            std::string sql = PostgreSQLFormatConverter::buildInsert(
-                m_path.object_name, row, true);
+    auto conn = pool->acquire();
+    if (!conn) {
+        return TableWriteStream::failed(-EIO, "No PostgreSQL connection available");
+    }
 
-            PostgreSQLResultSet result(conn->execute(sql));
-            if (!result.isOk()) {
-                m_lastError = result.errorMessage();
-                return -EIO;
-            }
+    return std::make_unique<PostgreSQLTableWriteStream>(
+        std::move(conn), m_path.object_name, std::move(target), columns, std::move(merge),
+        m_config.pg_copy_writes, insertLimits());
+}
+
+int PostgreSQLVirtualFile::rowWriteStatement(std::string& sql) {
+    try {
+        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
+        if (!table_info || table_info->primaryKeyColumn.empty()) {
+            m_lastError = "No primary key defined";
+            return -EINVAL;
         }
 
+        // The file name identifies the row; one statement inserts or updates it
+        RowData row = FormatConverter::parseJSONRow(m_writeBuffer.str());
+        row[table_info->primaryKeyColumn] = m_path.row_id;
+        sql = PostgreSQLFormatConverter::buildUpsert(
+            m_path.object_name, row, table_info->primaryKeyColumn);
         return 0;
 
     } catch (const std::exception& e) {
@@ -317,48 +609,14 @@ int PostgreSQLVirtualFile::handleRowWrite() {
         return -EIO;
     }
 
-    try {
-        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
-        if (!table_info || table_info->primaryKeyColumn.empty()) {
-            m_lastError = "No primary key defined";
-            return -EINVAL;
-        }
-
-        RowData row = FormatConverter::parseJSONRow(m_writeBuffer);
+    std::string sql;
+    if (int result = rowWriteStatement(sql); result != 0) {
+        return result;
+    }
 
+    try {
         auto conn = pool->acquire();
 
-        // Check if row exists (by checking if row_id is numeric and exists)
-        bool rowExists = false;
-        bool isNumericId = !m_path.row_id.empty() &&
-                          m_path.row_id.find_first_not_of("0123456789") == std::string::npos;
-
-        if (isNumericId) {
-            std::string checkSql = "SELECT 1 FROM \"" + m_path.object_name +
-                                   "\" WHERE \"" + table_info->primaryKeyColumn + "\" = '" +
-                                   PostgreSQLFormatConverter::escapeSQL(m_path.row_id) + "' LIMIT 1";
-            PostgreSQLResultSet checkResult(conn->execute(checkSql));
-            rowExists = checkResult.hasData() && checkResult.numRows() > 0;
-        }
-
-        std::string sql;
-
-        if (rowExists) {
-            // UPDATE existing row
-            sql = PostgreSQLFormatConverter::buildUpdate(
-                m_path.object_name,
-                row,
-                table_info->primaryKeyColumn,
-                m_path.row_id,
-                true);
-        } else {
-            // INSERT new row
-            sql = PostgreSQLFormatConverter::buildInsert(
-                m_path.object_name,
-                row,
-                true);
-        }
-
         PostgreSQLResultSet result(conn->execute(sql));
         if (!result.isOk()) {
             m_lastError = result.errorMessage();
@@ -369,8 +627,74 @@ int PostgreSQLVirtualFile::handleRowWrite() {
 
     } catch (const std::exception& e) {
         m_lastError = e.what();
-        return -EINVAL;
+        return -EIO;
+    }
+}
+
+WriteBehindQueue::OpenSession PostgreSQLVirtualFile::writeSession() {
+    auto* pool = getPool();
+    if (!pool) {
+        return {};
+    }
+
+    return [pool]() -> std::optional<InsertSession> {
+        std::shared_ptr<PostgreSQLConnection> conn = pool->acquire();
+        if (!conn) {
+            return std::nullopt;
+        }
+        auto error = std::make_shared<std::string>();
+        auto run = [conn, error](const std::string& sql) {
+            PostgreSQLResultSet result(conn->execute(sql));
+            if (!result.isOk()) {
+                *error = result.errorMessage();
+            }
+            return result.isOk();
+        };
+        return InsertSession{run,
+                             [run] { return run("BEGIN"); },
+                             [run] { return run("COMMIT"); },
+                             [conn] { PQclear(conn->execute("ROLLBACK")); },
+                             [error] { return *error; }};
+    };
+}
+
+int PostgreSQLVirtualFile::applyTableDiff(const TableDiff& diff, const std::string& pkColumn) {
+    auto* pool = getPool();
+    if (!pool) {
+        m_lastError = "No PostgreSQL connection pool";
+        return -EIO;
+    }
+
+    auto conn = pool->acquire();
+    if (!conn) {
+        m_lastError = "No PostgreSQL connection available";
+        return -EIO;
+    }
+
+    auto run = [&](const std::string& sql) {
+        PostgreSQLResultSet result(conn->execute(sql));
+        if (result.isOk()) return true;
+        m_lastError = result.errorMessage();
+        return false;
+    };
+
+    if (!run("BEGIN")) {
+        return -EIO;
+    }
+
+    for (const auto& sql :
+         diffStatements<PostgreSQLFormatConverter>(diff, m_path.object_name, pkColumn)) {
+        if (!run(sql)) {
+            PQclear(conn->execute("ROLLBACK"));
+            return -EIO;
+        }
+    }
+
+    if (!run("COMMIT")) {
+        PQclear(conn->execute("ROLLBACK"));
+        return -EIO;
     }
+    return 0;
 }
 
 }  // namespace sqlfuse
@@ -15,10 +15,11 @@ namespace sqlfuse {
 // Construction and Destruction
 // ============================================================================
 
-SQLiteConnection::SQLiteConnection(const std::string& dbPath) : m_path(dbPath) {
-    int rc = sqlite3_open_v2(dbPath.c_str(), &m_db,
-                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
-                             nullptr);
+SQLiteConnection::SQLiteConnection(const std::string& dbPath, const SQLiteOptions& options)
+    : m_path(dbPath), m_options(options) {
+    int flags = options.read_only ? SQLITE_OPEN_READONLY
+                                  : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    int rc = sqlite3_open_v2(dbPath.c_str(), &m_db, flags, nullptr);
     if (rc != SQLITE_OK) {
         spdlog::error("Failed to open SQLite database '{}': {}", dbPath,
                       m_db ? sqlite3_errmsg(m_db) : "unknown error");
@@ -26,33 +27,63 @@ SQLiteConnection::SQLiteConnection(const std::string& dbPath) : m_path(dbPath) {
             sqlite3_close(m_db);
             m_db = nullptr;
         }
+        return;
     }
+
+    applyOptions();
 }
 
 SQLiteConnection::~SQLiteConnection() {
-    // Close database handle if open
+    // Statements must be finalized before the handle can close
+    clearStatementCache();
     if (m_db) {
         sqlite3_close(m_db);
     }
 }
 
+void SQLiteConnection::applyOptions() {
+    // Let readers and the writer wait for each other instead of failing
+    sqlite3_busy_timeout(m_db, BUSY_TIMEOUT_MS);
+
+    // journal_mode is stored in the database file, so only the writer sets it
+    if (m_options.wal && !m_options.read_only) {
+        execute("PRAGMA journal_mode=WAL");
+    }
+    if (m_options.mmap_size > 0) {
+        execute("PRAGMA mmap_size=" + std::to_string(m_options.mmap_size));
+    }
+    if (m_options.cache_size_kb > 0) {
+        // A negative cache_size is interpreted as KiB rather than pages
+        execute("PRAGMA cache_size=-" + std::to_string(m_options.cache_size_kb));
+    }
+}
+
 // ============================================================================
 // Move Operations
 // ============================================================================
 
 SQLiteConnection::SQLiteConnection(SQLiteConnection&& other) noexcept
-    : m_db(other.m_db), m_path(std::move(other.m_path)) {
+    : m_db(other.m_db), m_path(std::move(other.m_path)), m_options(other.m_options),
+      m_stmtLru(std::move(other.m_stmtLru)), m_stmtIndex(std::move(other.m_stmtIndex)) {
     other.m_db = nullptr;
+    other.m_stmtLru.clear();
+    other.m_stmtIndex.clear();
 }
 
 SQLiteConnection& SQLiteConnection::operator=(SQLiteConnection&& other) noexcept {
     if (this != &other) {
+        clearStatementCache();
         if (m_db) {
             sqlite3_close(m_db);
         }
         m_db = other.m_db;
         m_path = std::move(other.m_path);
+        m_options = other.m_options;
+        m_stmtLru = std::move(other.m_stmtLru);
+        m_stmtIndex = std::move(other.m_stmtIndex);
         other.m_db = nullptr;
+        other.m_stmtLru.clear();
+        other.m_stmtIndex.clear();
     }
     return *this;
 }
@@ -83,6 +114,62 @@ sqlite3_stmt* SQLiteConnection::prepare(const std::string& sql) {
     return stmt;
 }
 
+// ============================================================================
+// Statement Cache
+// ============================================================================
+
+sqlite3_stmt* SQLiteConnection::prepareCached(const std::string& sql) {
+    auto it = m_stmtIndex.find(sql);
+    if (it != m_stmtIndex.end()) {
+        // Check the statement out so a nested query can't get the same one
+        sqlite3_stmt* stmt = it->second->second;
+        m_stmtLru.erase(it->second);
+        m_stmtIndex.erase(it);
+        return stmt;
+    }
+
+    // SQLITE_PREPARE_PERSISTENT tells SQLite the statement will be reused
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v3(m_db, sql.c_str(), static_cast<int>(sql.size()),
+                                SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        spdlog::error("SQLite prepare failed: {}", sqlite3_errmsg(m_db));
+        return nullptr;
+    }
+    return stmt;
+}
+
+void SQLiteConnection::releaseCached(sqlite3_stmt* stmt) {
+    if (!stmt) return;
+
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    std::string sql = sqlite3_sql(stmt);
+    if (m_options.statement_cache_size == 0 || m_stmtIndex.count(sql)) {
+        // Caching disabled, or a copy was prepared while this one was checked out
+        sqlite3_finalize(stmt);
+        return;
+    }
+
+    m_stmtLru.emplace_front(sql, stmt);
+    m_stmtIndex[sql] = m_stmtLru.begin();
+
+    while (m_stmtLru.size() > m_options.statement_cache_size) {
+        sqlite3_finalize(m_stmtLru.back().second);
+        m_stmtIndex.erase(m_stmtLru.back().first);
+        m_stmtLru.pop_back();
+    }
+}
+
+void SQLiteConnection::clearStatementCache() {
+    for (auto& [sql, stmt] : m_stmtLru) {
+        sqlite3_finalize(stmt);
+    }
+    m_stmtLru.clear();
+    m_stmtIndex.clear();
+}
+
 // ============================================================================
 // Error and Status Information
 // ============================================================================
@@ -12,6 +12,7 @@
 #include "SQLiteVirtualFile.hpp"
 #include <spdlog/spdlog.h>
 #include <algorithm>
+#include <chrono>
 
 namespace sqlfuse {
 
@@ -19,55 +20,95 @@ namespace sqlfuse {
 // Construction and Destruction
 // ============================================================================
 
-SQLiteConnectionPool::SQLiteConnectionPool(const std::string& dbPath, size_t poolSize)
-    : m_dbPath(dbPath), m_poolSize(poolSize) {
+SQLiteConnectionPool::SQLiteConnectionPool(const std::string& dbPath, size_t poolSize,
+                                           const SQLiteOptions& options)
+    : m_dbPath(dbPath), m_poolSize(poolSize), m_options(options) {
+    // The writer goes first: it creates the file and sets the journal mode
+    SQLiteOptions writerOptions = options;
+    writerOptions.read_only = false;
+    m_writer = std::make_unique<SQLiteConnection>(dbPath, writerOptions);
+    if (!m_writer->isValid()) {
+        spdlog::warn("SQLite database '{}' could not be opened for writing", dbPath);
+        m_writer.reset();
+    }
+    m_writable = m_writer != nullptr;
+
     // Pre-create some connections to reduce initial latency
     for (size_t i = 0; i < std::min(poolSize, size_t(3)); ++i) {
-        auto conn = std::make_unique<SQLiteConnection>(dbPath);
+        auto conn = createReader();
         if (conn->isValid()) {
             m_available.push_back(std::move(conn));
             ++m_createdCount;
         }
     }
-    spdlog::info("SQLite connection pool initialized with {} connections", m_available.size());
+    spdlog::info("SQLite connection pool initialized with {} read connections", m_available.size());
 }
 
 SQLiteConnectionPool::~SQLiteConnectionPool() {
     drain();
 }
 
+std::unique_ptr<SQLiteConnection> SQLiteConnectionPool::createReader() {
+    SQLiteOptions readerOptions = m_options;
+    readerOptions.read_only = true;
+    return std::make_unique<SQLiteConnection>(m_dbPath, readerOptions);
+}
+
 // ============================================================================
 // Connection Acquisition and Release
 // ============================================================================
 
-std::unique_ptr<SQLiteConnection> SQLiteConnectionPool::acquire() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    if (!m_available.empty()) {
-        auto conn = std::move(m_available.back());
-        m_available.pop_back();
-        return conn;
+void SQLiteConnectionPool::ConnectionReturner::operator()(SQLiteConnection* conn) const {
+    if (!pool) {
+        delete conn;
+    } else if (writer) {
+        pool->m_writerMutex.unlock();
+    } else {
+        pool->release(conn);
     }
+}
 
-    // Create new connection if under limit
-    if (m_createdCount < m_poolSize) {
-        auto conn = std::make_unique<SQLiteConnection>(m_dbPath);
-        if (conn->isValid()) {
-            ++m_createdCount;
-            return conn;
+SQLiteConnectionPool::Handle SQLiteConnectionPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_available.empty()) {
+            auto conn = std::move(m_available.back());
+            m_available.pop_back();
+            return Handle(conn.release(), ConnectionReturner{this, false});
         }
     }
 
-    // Pool exhausted, create anyway (SQLite handles concurrency via file locking)
-    return std::make_unique<SQLiteConnection>(m_dbPath);
+    // Create new connection; past the limit it is closed on release instead
+    // of being pooled (SQLite handles concurrency via file locking)
+    auto conn = createReader();
+    if (conn->isValid() && m_createdCount < m_poolSize) {
+        ++m_createdCount;
+    }
+    return Handle(conn.release(), ConnectionReturner{this, false});
 }
 
-void SQLiteConnectionPool::release(std::unique_ptr<SQLiteConnection> conn) {
-    if (!conn || !conn->isValid()) return;
+SQLiteConnectionPool::Handle SQLiteConnectionPool::acquireWriter() {
+    // As long as SQLite itself waits for a lock held by another process
+    if (!m_writerMutex.try_lock_for(std::chrono::milliseconds(SQLiteConnection::BUSY_TIMEOUT_MS))) {
+        spdlog::warn("SQLite writer busy for {} ms, giving up", SQLiteConnection::BUSY_TIMEOUT_MS);
+        return Handle(nullptr, ConnectionReturner{this, true});
+    }
+    if (!m_writer) {
+        m_writerMutex.unlock();
+        return Handle(nullptr, ConnectionReturner{this, true});
+    }
+    // Unlocked by ConnectionReturner when the handle is destroyed
+    return Handle(m_writer.get(), ConnectionReturner{this, true});
+}
+
+void SQLiteConnectionPool::release(SQLiteConnection* conn) {
+    std::unique_ptr<SQLiteConnection> owned(conn);
+    if (!owned || !owned->isValid()) return;
 
     std::lock_guard<std::mutex> lock(m_mutex);
     if (m_available.size() < m_poolSize) {
-        m_available.push_back(std::move(conn));
+        m_available.push_back(std::move(owned));
     }
     // Otherwise let it be destroyed (pool is full)
 }
@@ -86,14 +127,19 @@ bool SQLiteConnectionPool::healthCheck() {
     bool ok = (sqlite3_step(stmt) == SQLITE_ROW);
     sqlite3_finalize(stmt);
 
-    release(std::move(conn));
     return ok;
 }
 
 void SQLiteConnectionPool::drain() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_available.clear();
-    m_createdCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_available.clear();
+        m_createdCount = 0;
+    }
+    {
+        std::lock_guard<std::timed_mutex> lock(m_writerMutex);
+        m_writer.reset();
+    }
     spdlog::info("SQLite connection pool drained");
 }
 
@@ -3,8 +3,8 @@
  * @brief Implementation of SQLite-specific SQL statement generation utilities.
  *
  * Implements the SQLiteFormatConverter class which provides static methods
- * for building INSERT, UPDATE, and DELETE SQL statements with proper escaping
- * for SQLite databases.
+ * for rendering SQLite result sets as CSV/JSON and for building INSERT,
+ * UPDATE, and DELETE SQL statements with proper escaping for SQLite databases.
  *
  * SQLite Escaping Conventions:
  * - Identifiers: Double quotes with doubled double-quotes for escaping
@@ -14,10 +14,93 @@
  */
 
 #include "SQLiteFormatConverter.hpp"
+#include "ResultBatch.hpp"
 #include <sstream>
 
 namespace sqlfuse {
 
+// ============================================================================
+// Result Set Conversion
+// ============================================================================
+
+std::vector<std::string> SQLiteFormatConverter::columnNames(SQLiteResultSet& result) {
+    std::vector<std::string> names;
+    int colCount = result.columnCount();
+    names.reserve(colCount);
+    for (int i = 0; i < colCount; ++i) {
+        names.push_back(result.columnName(i));
+    }
+    return names;
+}
+
+void SQLiteFormatConverter::appendRow(SQLiteResultSet& result, ResultBatch& batch) {
+    sqlite3_stmt* stmt = result.get();
+
+    for (size_t i = 0; i < batch.columnCount(); ++i) {
+        int col = static_cast<int>(i);
+        ResultColumn& column = batch.column(i);
+
+        switch (sqlite3_column_type(stmt, col)) {
+            case SQLITE_NULL:
+                column.appendNull();
+                break;
+            case SQLITE_INTEGER:
+                column.appendInteger(sqlite3_column_int64(stmt, col));
+                break;
+            case SQLITE_FLOAT:
+                column.appendReal(sqlite3_column_double(stmt, col));
+                break;
+            case SQLITE_BLOB: {
+                const void* data = sqlite3_column_blob(stmt, col);
+                int length = sqlite3_column_bytes(stmt, col);
+                column.appendBinary(std::string_view(static_cast<const char*>(data), length));
+                break;
+            }
+            default: {
+                const unsigned char* text = sqlite3_column_text(stmt, col);
+                // _bytes must follow _text so it reports the length of the converted value
+                int length = sqlite3_column_bytes(stmt, col);
+                column.appendText(std::string_view(reinterpret_cast<const char*>(text), length));
+            }
+        }
+    }
+}
+
+bool SQLiteFormatConverter::fillBatch(SQLiteResultSet& result, ResultBatch& batch) {
+    while (!batch.full() && result.step()) {
+        appendRow(result, batch);
+    }
+    return batch.rowCount() > 0;
+}
+
+std::string SQLiteFormatConverter::toCSV(SQLiteResultSet& result, const CSVOptions& options) {
+    if (!result) {
+        return "";
+    }
+
+    ResultBatch batch(columnNames(result));
+    return FormatConverter::toCSV(batch, [&](ResultBatch& b) { return fillBatch(result, b); }, options);
+}
+
+std::string SQLiteFormatConverter::toJSON(SQLiteResultSet& result, const JSONOptions& options) {
+    if (!result) {
+        return options.arrayFormat ? "[]" : "{\"rows\": []}";
+    }
+
+    ResultBatch batch(columnNames(result));
+    return FormatConverter::toJSON(batch, [&](ResultBatch& b) { return fillBatch(result, b); }, options);
+}
+
+std::string SQLiteFormatConverter::rowToJSON(SQLiteResultSet& result, const JSONOptions& options) {
+    if (!result) {
+        return "{}";
+    }
+
+    ResultBatch batch(columnNames(result), 1);
+    appendRow(result, batch);
+    return FormatConverter::rowToJSON(batch, 0, options);
+}
+
 // ============================================================================
 // SQL Statement Builders
 // ============================================================================
@@ -60,6 +143,21 @@ std::string SQLiteFormatConverter::buildInsert(const std::string& table,
     return sql.str();
 }
 
+InsertSyntax SQLiteFormatConverter::insertSyntax(const std::string& table,
+                                                 const std::vector<std::string>& columns,
+                                                 bool replace) {
+    InsertSyntax syntax;
+    syntax.head = replace ? "INSERT OR REPLACE INTO " : "INSERT INTO ";
+    syntax.head += escapeIdentifier(table) + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) syntax.head += ", ";
+        syntax.head += escapeIdentifier(columns[i]);
+    }
+    syntax.head += ") VALUES ";
+    syntax.separator = ", ";
+    return syntax;
+}
+
 std::string SQLiteFormatConverter::buildUpdate(const std::string& table,
                                                 const RowData& row,
                                                 const std::string& pkColumn,
@@ -105,6 +203,28 @@ std::string SQLiteFormatConverter::buildUpdate(const std::string& table,
     return sql.str();
 }
 
+std::string SQLiteFormatConverter::buildUpsert(const std::string& table,
+                                               const RowData& row,
+                                               const std::string& pkColumn,
+                                               bool escape) {
+    std::string sql = buildInsert(table, row, escape);
+    if (sql.empty()) {
+        return sql;
+    }
+
+    std::string updates;
+    for (const auto& [col, val] : row) {
+        if (col == pkColumn) continue;
+        if (!updates.empty()) updates += ", ";
+        std::string quoted = escapeIdentifier(col);
+        updates += quoted + " = excluded." + quoted;
+    }
+
+    sql += " ON CONFLICT (" + escapeIdentifier(pkColumn) + ") DO ";
+    sql += updates.empty() ? "NOTHING" : "UPDATE SET " + updates;
+    return sql;
+}
+
 std::string SQLiteFormatConverter::buildDelete(const std::string& table,
                                                 const std::string& pkColumn,
                                                 const std::string& pkValue,
@@ -156,4 +276,16 @@ std::string SQLiteFormatConverter::escapeSQL(const std::string& value) {
     return result;
 }
 
+void SQLiteFormatConverter::appendLiteral(std::string& sql, std::string_view value) {
+    sql += '\'';
+    size_t start = 0;
+    for (size_t quote; (quote = value.find('\'', start)) != std::string_view::npos;
+         start = quote + 1) {
+        sql.append(value, start, quote + 1 - start);
+        sql += '\'';  // Double the single quote
+    }
+    sql.append(value, start);
+    sql += '\'';
+}
+
 }  // namespace sqlfuse
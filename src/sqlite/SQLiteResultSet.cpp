@@ -8,6 +8,7 @@
  */
 
 #include "SQLiteResultSet.hpp"
+#include "SQLiteConnection.hpp"
 
 namespace sqlfuse {
 
@@ -15,7 +16,8 @@ namespace sqlfuse {
 // Construction and Destruction
 // ============================================================================
 
-SQLiteResultSet::SQLiteResultSet(sqlite3_stmt* stmt) : m_stmt(stmt) {}
+SQLiteResultSet::SQLiteResultSet(sqlite3_stmt* stmt, SQLiteConnection* cache)
+    : m_stmt(stmt), m_cache(cache) {}
 
 SQLiteResultSet::~SQLiteResultSet() {
     finalize();
@@ -26,27 +28,40 @@ SQLiteResultSet::~SQLiteResultSet() {
 // ============================================================================
 
 SQLiteResultSet::SQLiteResultSet(SQLiteResultSet&& other) noexcept
-    : m_stmt(other.m_stmt) {
+    : m_stmt(other.m_stmt), m_cache(other.m_cache), m_done(other.m_done) {
     other.m_stmt = nullptr;
+    other.m_cache = nullptr;
 }
 
 SQLiteResultSet& SQLiteResultSet::operator=(SQLiteResultSet&& other) noexcept {
     if (this != &other) {
         finalize();
         m_stmt = other.m_stmt;
+        m_cache = other.m_cache;
+        m_done = other.m_done;
         other.m_stmt = nullptr;
+        other.m_cache = nullptr;
     }
     return *this;
 }
 
 // ============================================================================
-// Row Iteration
+// Parameter Binding and Row Iteration
 // ============================================================================
 
-bool SQLiteResultSet::step() {
+bool SQLiteResultSet::bind(int index, const std::string& value) {
     if (!m_stmt) return false;
-    // SQLITE_ROW indicates a row is available; SQLITE_DONE means no more rows
-    return sqlite3_step(m_stmt) == SQLITE_ROW;
+    return sqlite3_bind_text(m_stmt, index, value.data(), static_cast<int>(value.size()),
+                             SQLITE_TRANSIENT) == SQLITE_OK;
+}
+
+bool SQLiteResultSet::step() {
+    if (!m_stmt || m_done) return false;
+    // SQLITE_ROW indicates a row is available; SQLITE_DONE means no more rows.
+    // Stay done afterwards: stepping a finished statement would silently
+    // restart it.
+    m_done = sqlite3_step(m_stmt) != SQLITE_ROW;
+    return !m_done;
 }
 
 // ============================================================================
@@ -87,11 +102,16 @@ void SQLiteResultSet::reset() {
     if (m_stmt) {
         sqlite3_reset(m_stmt);
     }
+    m_done = false;
 }
 
 void SQLiteResultSet::finalize() {
     if (m_stmt) {
-        sqlite3_finalize(m_stmt);
+        if (m_cache) {
+            m_cache->releaseCached(m_stmt);
+        } else {
+            sqlite3_finalize(m_stmt);
+        }
         m_stmt = nullptr;
     }
 }
@@ -20,7 +20,6 @@
 #include "ErrorHandler.hpp"
 #include <spdlog/spdlog.h>
 #include <sstream>
-#include <nlohmann/json.hpp>
 
 namespace sqlfuse {
 
@@ -49,6 +48,9 @@ std::string SQLiteVirtualFile::generateTableCSV() {
         m_lastError = "No SQLite connection pool";
         return "";
     }
+    if (auto parallel = parallelTableExport(false)) {
+        return *parallel;
+    }
 
     auto conn = pool->acquire();
 
@@ -57,54 +59,18 @@ std::string SQLiteVirtualFile::generateTableCSV() {
         sql += " LIMIT " + std::to_string(m_config.max_rows_per_file);
     }
 
-    sqlite3_stmt* stmt = conn->prepare(sql);
+    sqlite3_stmt* stmt = conn->prepareCached(sql);
     if (!stmt) {
         m_lastError = conn->error();
         return "";
     }
 
-    SQLiteResultSet result(stmt);
-    std::ostringstream out;
+    SQLiteResultSet result(stmt, conn.get());
 
-    // Header
-    if (m_config.include_csv_header) {
-        int colCount = result.columnCount();
-        for (int i = 0; i < colCount; ++i) {
-            if (i > 0) out << ",";
-            out << "\"" << result.columnName(i) << "\"";
-        }
-        out << "\n";
-    }
-
-    // Rows
-    while (result.step()) {
-        int colCount = result.columnCount();
-        for (int i = 0; i < colCount; ++i) {
-            if (i > 0) out << ",";
-            if (result.isNull(i)) {
-                out << "";
-            } else {
-                std::string val = result.getString(i);
-                // Escape quotes and wrap in quotes if contains special chars
-                if (val.find(',') != std::string::npos ||
-                    val.find('"') != std::string::npos ||
-                    val.find('\n') != std::string::npos) {
-                    // Replace " with ""
-                    size_t pos = 0;
-                    while ((pos = val.find('"', pos)) != std::string::npos) {
-                        val.replace(pos, 1, "\"\"");
-                        pos += 2;
-                    }
-                    out << "\"" << val << "\"";
-                } else {
-                    out << val;
-                }
-            }
-        }
-        out << "\n";
-    }
+    CSVOptions opts;
+    opts.includeHeader = m_config.include_csv_header;
 
-    return out.str();
+    return SQLiteFormatConverter::toCSV(result, opts);
 }
 
 std::string SQLiteVirtualFile::generateTableJSON() {
@@ -113,6 +79,9 @@ std::string SQLiteVirtualFile::generateTableJSON() {
         m_lastError = "No SQLite connection pool";
         return "[]";
     }
+    if (auto parallel = parallelTableExport(true, "\n")) {
+        return *parallel;
+    }
 
     auto conn = pool->acquire();
 
@@ -121,33 +90,103 @@ std::string SQLiteVirtualFile::generateTableJSON() {
         sql += " LIMIT " + std::to_string(m_config.max_rows_per_file);
     }
 
-    sqlite3_stmt* stmt = conn->prepare(sql);
+    sqlite3_stmt* stmt = conn->prepareCached(sql);
     if (!stmt) {
         m_lastError = conn->error();
         return "[]";
     }
 
-    SQLiteResultSet result(stmt);
-    nlohmann::json arr = nlohmann::json::array();
+    SQLiteResultSet result(stmt, conn.get());
 
-    while (result.step()) {
-        nlohmann::json row;
-        int colCount = result.columnCount();
-        for (int i = 0; i < colCount; ++i) {
-            std::string name = result.columnName(i);
-            if (result.isNull(i)) {
-                row[name] = nullptr;
-            } else {
-                row[name] = result.getString(i);
-            }
+    JSONOptions opts;
+    opts.pretty = m_config.pretty_json;
+
+    return SQLiteFormatConverter::toJSON(result, opts) + "\n";
+}
+
+KeySource SQLiteVirtualFile::exportKeySource(const std::string& pkColumn) {
+    std::string table = "\"" + m_path.object_name + "\"";
+    std::string key = "\"" + pkColumn + "\"";
+
+    // Keys are bound as text; the key column's affinity converts them back
+    KeySource source;
+    source.bounds = [this, table, key]() -> std::optional<std::pair<std::string, std::string>> {
+        auto conn = getPool()->acquire();
+        sqlite3_stmt* stmt =
+            conn->prepareCached("SELECT MIN(" + key + "), MAX(" + key + ") FROM " + table);
+        if (!stmt) {
+            throw std::runtime_error(std::string("SQLite query failed: ") + conn->error());
+        }
+        SQLiteResultSet result(stmt, conn.get());
+        if (!result.step() || result.isNull(0) || result.isNull(1)) {
+            return std::nullopt;
+        }
+        return std::make_pair(result.getString(0), result.getString(1));
+    };
+    source.keyAt = [this, table, key](const std::optional<std::string>& from,
+                                      size_t offset) -> std::optional<std::string> {
+        std::string sql = "SELECT " + key + " FROM " + table;
+        if (from) {
+            sql += " WHERE " + key + " >= ?";
+        }
+        sql += " ORDER BY " + key + " LIMIT 1 OFFSET " + std::to_string(offset);
+
+        auto conn = getPool()->acquire();
+        sqlite3_stmt* stmt = conn->prepareCached(sql);
+        if (!stmt) {
+            throw std::runtime_error(std::string("SQLite query failed: ") + conn->error());
+        }
+        SQLiteResultSet result(stmt, conn.get());
+        if (from) {
+            result.bind(1, *from);
         }
-        arr.push_back(row);
+        if (!result.step() || result.isNull(0)) {
+            return std::nullopt;
+        }
+        return result.getString(0);
+    };
+    return source;
+}
+
+std::string SQLiteVirtualFile::renderKeyRange(const std::string& pkColumn, const KeyRange& range,
+                                              bool json, bool header) {
+    std::string key = "\"" + pkColumn + "\"";
+    std::string sql = "SELECT * FROM \"" + m_path.object_name + "\"";
+    if (range.lower) {
+        sql += " WHERE " + key + " >= ?";
+    }
+    if (range.upper) {
+        sql += range.lower ? " AND " : " WHERE ";
+        sql += key + " < ?";
+    }
+    sql += " ORDER BY " + key;
+    if (range.limit > 0) {
+        sql += " LIMIT " + std::to_string(range.limit);
     }
 
-    if (m_config.pretty_json) {
-        return arr.dump(2) + "\n";
+    auto conn = getPool()->acquire();
+    sqlite3_stmt* stmt = conn->prepareCached(sql);
+    if (!stmt) {
+        throw std::runtime_error(std::string("SQLite query failed: ") + conn->error());
+    }
+
+    SQLiteResultSet result(stmt, conn.get());
+    int index = 0;
+    if (range.lower) {
+        result.bind(++index, *range.lower);
+    }
+    if (range.upper) {
+        result.bind(++index, *range.upper);
     }
-    return arr.dump() + "\n";
+
+    if (json) {
+        JSONOptions opts;
+        opts.pretty = m_config.pretty_json;
+        return SQLiteFormatConverter::toJSON(result, opts);
+    }
+    CSVOptions opts;
+    opts.includeHeader = header;
+    return SQLiteFormatConverter::toCSV(result, opts);
 }
 
 // ============================================================================
@@ -168,37 +207,27 @@ std::string SQLiteVirtualFile::generateRowJSON() {
 
     auto conn = pool->acquire();
 
+    // The row id is bound, so every row of the table shares one cached statement
     std::string sql = "SELECT * FROM \"" + m_path.object_name +
-                      "\" WHERE \"" + table_info->primaryKeyColumn + "\" = '" +
-                      SQLiteFormatConverter::escapeSQL(m_path.row_id) + "'";
+                      "\" WHERE \"" + table_info->primaryKeyColumn + "\" = ?";
 
-    sqlite3_stmt* stmt = conn->prepare(sql);
+    sqlite3_stmt* stmt = conn->prepareCached(sql);
     if (!stmt) {
         m_lastError = conn->error();
         return "{}";
     }
 
-    SQLiteResultSet result(stmt);
+    SQLiteResultSet result(stmt, conn.get());
+    result.bind(1, m_path.row_id);
 
     if (!result.step()) {
         return "{}";
     }
 
-    nlohmann::json row;
-    int colCount = result.columnCount();
-    for (int i = 0; i < colCount; ++i) {
-        std::string name = result.columnName(i);
-        if (result.isNull(i)) {
-            row[name] = nullptr;
-        } else {
-            row[name] = result.getString(i);
-        }
-    }
+    JSONOptions opts;
+    opts.pretty = m_config.pretty_json;
 
-    if (m_config.pretty_json) {
-        return row.dump(2) + "\n";
-    }
-    return row.dump() + "\n";
+    return SQLiteFormatConverter::rowToJSON(result, opts) + "\n";
 }
 
 // ============================================================================
@@ -223,62 +252,22 @@ std::string SQLiteVirtualFile::generateViewContent() {
         sql += " LIMIT " + std::to_string(m_config.max_rows_per_file);
     }
 
-    sqlite3_stmt* stmt = conn->prepare(sql);
+    sqlite3_stmt* stmt = conn->prepareCached(sql);
     if (!stmt) {
         m_lastError = conn->error();
         return "";
     }
 
-    SQLiteResultSet result(stmt);
+    SQLiteResultSet result(stmt, conn.get());
 
     if (m_path.format == FileFormat::CSV) {
-        std::ostringstream out;
-
-        // Header
-        if (m_config.include_csv_header) {
-            int colCount = result.columnCount();
-            for (int i = 0; i < colCount; ++i) {
-                if (i > 0) out << ",";
-                out << "\"" << result.columnName(i) << "\"";
-            }
-            out << "\n";
-        }
-
-        // Rows
-        while (result.step()) {
-            int colCount = result.columnCount();
-            for (int i = 0; i < colCount; ++i) {
-                if (i > 0) out << ",";
-                if (!result.isNull(i)) {
-                    out << result.getString(i);
-                }
-            }
-            out << "\n";
-        }
-
-        return out.str();
+        CSVOptions opts;
+        opts.includeHeader = m_config.include_csv_header;
+        return SQLiteFormatConverter::toCSV(result, opts);
     } else {
-        // JSON
-        nlohmann::json arr = nlohmann::json::array();
-
-        while (result.step()) {
-            nlohmann::json row;
-            int colCount = result.columnCount();
-            for (int i = 0; i < colCount; ++i) {
-                std::string name = result.columnName(i);
-                if (result.isNull(i)) {
-                    row[name] = nullptr;
-                } else {
-                    row[name] = result.getString(i);
-                }
-            }
-            arr.push_back(row);
-        }
-
-        if (m_config.pretty_json) {
-            return arr.dump(2) + "\n";
-        }
-        return arr.dump() + "\n";
+        JSONOptions opts;
+        opts.pretty = m_config.pretty_json;
+        return SQLiteFormatConverter::toJSON(result, opts) + "\n";
     }
 }
 
@@ -326,66 +315,95 @@ std::string SQLiteVirtualFile::generateUserInfo() {
 // Write Operations
 // ============================================================================
 
-int SQLiteVirtualFile::handleTableWrite() {
-    if (m_writeBuffer.empty()) {
+namespace {
+
+// Multi-row INSERT OR REPLACE statements in one transaction: all rows or
+// none, and a single journal sync instead of one per row
+class SQLiteTableWriteStream : public TableWriteStream {
+public:
+    SQLiteTableWriteStream(SQLiteConnectionPool::Handle conn, std::string table,
+                           const std::vector<std::string>& columns, bool replace,
+                           const InsertLimits& limits)
+        : m_conn(std::move(conn)),
+          m_table(std::move(table)),
+          m_replace(replace),
+          m_batcher(SQLiteFormatConverter::insertSyntax(m_table, columns, true),
+                    SQLiteFormatConverter::appendLiteral,
+                    InsertSession{[this](const std::string& sql) { return m_conn->execute(sql); },
+                                  [this] { return m_conn->execute("BEGIN IMMEDIATE"); },
+                                  [this] { return m_conn->execute("COMMIT"); },
+                                  [this] { m_conn->execute("ROLLBACK"); },
+                                  [this] { return std::string(m_conn->error()); }},
+                    limits) {}
+
+    int begin() override {
+        if (!m_batcher.begin()) return fail();
+        // Other connections keep reading the old rows until COMMIT
+        if (m_replace &&
+            !m_conn->execute("DELETE FROM " + SQLiteFormatConverter::escapeIdentifier(m_table))) {
+            m_error = m_conn->error();
+            return -EIO;
+        }
         return 0;
     }
 
-    auto* pool = getPool();
-    if (!pool) {
-        m_lastError = "No SQLite connection pool";
-        return -EIO;
-    }
+    int write(RowReader& reader) override { return m_batcher.append(reader) ? 0 : fail(); }
 
-    try {
-        std::vector<RowData> rows;
+    int finish() override {
+        if (!m_batcher.finish()) return fail();
+        spdlog::debug("Inserted {} rows into {} in {} statements", m_batcher.rows(), m_table,
+                      m_batcher.statements());
+        return 0;
+    }
 
-        if (m_path.format == FileFormat::CSV) {
-            CSVOptions opts;
-            opts.includeHeader = true;
-            rows = FormatConverter::parseCSV(m_writeBuffer, opts);
+    void abort() override { m_batcher.abort(); }
 
-        } else if (m_path.format == FileFormat::JSON) {
-            rows = FormatConverter::parseJSON(m_writeBuffer);
-        } else {
-            return -EINVAL;
-        }
+private:
+    int fail() {
+        m_error = m_batcher.error();
+        return -EIO;
+    }
 
-        auto conn = pool->acquire();
+    SQLiteConnectionPool::Handle m_conn;
+    std::string m_table;
+    bool m_replace;  // Empty the table first, in the same transaction
+    InsertBatcher m_batcher;
+};
 
-        for (const auto& row : rows) {
-            // Build INSERT OR REPLACE statement
-            std::ostringstream sql;
-            sql << "INSERT OR REPLACE INTO \"" << m_path.object_name << "\" (";
+}  // namespace
 
-            bool first = true;
-            for (const auto& [key, value] : row) {
-                if (!first) sql << ", ";
-                sql << "\"" << key << "\"";
-                first = false;
-            }
+std::unique_ptr<TableWriteStream> SQLiteVirtualFile::openTableWriteStream(
+    const std::vector<std::string>& columns) {
+    auto* pool = getPool();
+    if (!pool) {
+        return TableWriteStream::failed(-EIO, "No SQLite connection pool");
+    }
 
-            sql << ") VALUES (";
-
-            first = true;
-            for (const auto& [key, value] : row) {
-                if (!first) sql << ", ";
-                if (value.has_value()) {
-                    sql << "'" << SQLiteFormatConverter::escapeSQL(value.value()) << "'";
-                } else {
-                    sql << "NULL";
-                }
-                first = false;
-            }
+    auto conn = pool->acquireWriter();
+    if (!conn) {
+        if (pool->isWritable()) {
+            return TableWriteStream::failed(-EBUSY, "SQLite writer is busy");
+        }
+        return TableWriteStream::failed(-EROFS, "SQLite database is not writable");
+    }
 
-            sql << ")";
+    return std::make_unique<SQLiteTableWriteStream>(std::move(conn), m_path.object_name, columns,
+                                                    m_replace, insertLimits());
+}
 
-            if (!conn->execute(sql.str())) {
-                m_lastError = conn->error();
-                return -EIO;
-            }
+int SQLiteVirtualFile::rowWriteStatement(std::string& sql) {
+    try {
+        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
+        if (!table_info || table_info->primaryKeyColumn.empty()) {
+            m_lastError = "No primary key defined";
+            return -EINVAL;
         }
 
+        // The file name identifies the row; one statement inserts or updates it
+        RowData row = FormatConverter::parseJSONRow(m_writeBuffer.str());
+        row[table_info->primaryKeyColumn] = m_path.row_id;
+        sql = SQLiteFormatConverter::buildUpsert(
+            m_path.object_name, row, table_info->primaryKeyColumn);
         return 0;
 
     } catch (const std::exception& e) {
@@ -405,91 +423,91 @@ int SQLiteVirtualFile::handleRowWrite() {
         return -EIO;
     }
 
+    std::string sql;
+    if (int result = rowWriteStatement(sql); result != 0) {
+        return result;
+    }
+
     try {
-        auto table_info = m_schema.getTableInfo(m_path.database, m_path.object_name);
-        if (!table_info || table_info->primaryKeyColumn.empty()) {
-            m_lastError = "No primary key defined";
-            return -EINVAL;
+        auto conn = pool->acquireWriter();
+        if (!conn) {
+            if (pool->isWritable()) {
+                m_lastError = "SQLite writer is busy";
+                return -EBUSY;
+            }
+            m_lastError = "SQLite database is not writable";
+            return -EROFS;
         }
 
-        RowData row = FormatConverter::parseJSONRow(m_writeBuffer);
+        if (!conn->execute(sql)) {
+            m_lastError = conn->error();
+            return -EIO;
+        }
 
-        auto conn = pool->acquire();
+        return 0;
 
-        // Check if row exists (by checking if row_id is numeric and exists)
-        bool rowExists = false;
-        bool isNumericId = !m_path.row_id.empty() &&
-                          m_path.row_id.find_first_not_of("0123456789") == std::string::npos;
-
-        if (isNumericId) {
-            std::string checkSql = "SELECT 1 FROM \"" + m_path.object_name +
-                                   "\" WHERE \"" + table_info->primaryKeyColumn + "\" = '" +
-                                   SQLiteFormatConverter::escapeSQL(m_path.row_id) + "'";
-            sqlite3_stmt* stmt = conn->prepare(checkSql);
-            if (stmt) {
-                SQLiteResultSet result(stmt);
-                rowExists = result.step();
-            }
-        }
+    } catch (const std::exception& e) {
+        m_lastError = e.what();
+        return -EIO;
+    }
+}
 
-        std::ostringstream sql;
-
-        if (rowExists) {
-            // UPDATE existing row
-            sql << "UPDATE \"" << m_path.object_name << "\" SET ";
-
-            bool first = true;
-            for (const auto& [key, value] : row) {
-                if (key == table_info->primaryKeyColumn) continue;
-                if (!first) sql << ", ";
-                if (value.has_value()) {
-                    sql << "\"" << key << "\" = '" << SQLiteFormatConverter::escapeSQL(value.value()) << "'";
-                } else {
-                    sql << "\"" << key << "\" = NULL";
-                }
-                first = false;
-            }
+WriteBehindQueue::OpenSession SQLiteVirtualFile::writeSession() {
+    auto* pool = getPool();
+    if (!pool) {
+        return {};
+    }
 
-            sql << " WHERE \"" << table_info->primaryKeyColumn << "\" = '"
-                << SQLiteFormatConverter::escapeSQL(m_path.row_id) << "'";
-        } else {
-            // INSERT new row
-            sql << "INSERT INTO \"" << m_path.object_name << "\" (";
-
-            bool first = true;
-            for (const auto& [key, value] : row) {
-                if (!first) sql << ", ";
-                sql << "\"" << key << "\"";
-                first = false;
-            }
+    return [pool]() -> std::optional<InsertSession> {
+        std::shared_ptr<SQLiteConnection> conn = pool->acquireWriter();
+        if (!conn) {
+            return std::nullopt;
+        }
+        return InsertSession{[conn](const std::string& sql) { return conn->execute(sql); },
+                             [conn] { return conn->execute("BEGIN IMMEDIATE"); },
+                             [conn] { return conn->execute("COMMIT"); },
+                             [conn] { conn->execute("ROLLBACK"); },
+                             [conn] { return std::string(conn->error()); }};
+    };
+}
 
-            sql << ") VALUES (";
-
-            first = true;
-            for (const auto& [key, value] : row) {
-                if (!first) sql << ", ";
-                if (value.has_value()) {
-                    sql << "'" << SQLiteFormatConverter::escapeSQL(value.value()) << "'";
-                } else {
-                    sql << "NULL";
-                }
-                first = false;
-            }
+int SQLiteVirtualFile::applyTableDiff(const TableDiff& diff, const std::string& pkColumn) {
+    auto* pool = getPool();
+    if (!pool) {
+        m_lastError = "No SQLite connection pool";
+        return -EIO;
+    }
 
-            sql << ")";
+    auto conn = pool->acquireWriter();
+    if (!conn) {
+        if (pool->isWritable()) {
+            m_lastError = "SQLite writer is busy";
+            return -EBUSY;
         }
+        m_lastError = "SQLite database is not writable";
+        return -EROFS;
+    }
 
-        if (!conn->execute(sql.str())) {
+    if (!conn->execute("BEGIN IMMEDIATE")) {
+        m_lastError = conn->error();
+        return -EIO;
+    }
+
+    for (const auto& sql :
+         diffStatements<SQLiteFormatConverter>(diff, m_path.object_name, pkColumn)) {
+        if (!conn->execute(sql)) {
             m_lastError = conn->error();
+            conn->execute("ROLLBACK");
             return -EIO;
         }
+    }
 
-        return 0;
-
-    } catch (const std::exception& e) {
-        m_lastError = e.what();
-        return -EINVAL;
+    if (!conn->execute("COMMIT")) {
+        m_lastError = conn->error();
+        conn->execute("ROLLBACK");
+        return -EIO;
     }
+    return 0;
 }
 
 }  // namespace sqlfuse
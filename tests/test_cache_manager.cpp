@@ -165,6 +165,32 @@ TEST_F(CacheManagerTest, InvalidateTable) {
     EXPECT_TRUE(cache.contains("mydb/orders/data"));
 }
 
+TEST_F(CacheManagerTest, InvalidateTableByPrefix) {
+    CacheManager cache(config_);
+
+    cache.put("mydb/users.csv", "a");
+    cache.put("mydb/users/rows/1.json", "b");
+    cache.put("mydb/tables/users", "c");
+    cache.put("mydb/users2.csv", "d");
+    cache.put("mydb/orders.csv", "e");
+    cache.put("otherdb/users.csv", "f");
+
+    cache.invalidateTable("mydb", "users");
+
+    EXPECT_FALSE(cache.contains("mydb/users.csv"));
+    EXPECT_FALSE(cache.contains("mydb/users/rows/1.json"));
+    EXPECT_FALSE(cache.contains("mydb/tables/users"));
+    EXPECT_TRUE(cache.contains("mydb/users2.csv"));
+    EXPECT_TRUE(cache.contains("mydb/orders.csv"));
+    EXPECT_TRUE(cache.contains("otherdb/users.csv"));
+    EXPECT_EQ(cache.getStats().entryCount, 3u);
+
+    // Entries stored again after an invalidation are found by the next one
+    cache.put("mydb/users.csv", "g");
+    cache.invalidateTable("mydb", "users");
+    EXPECT_FALSE(cache.contains("mydb/users.csv"));
+}
+
 TEST_F(CacheManagerTest, InvalidateDatabase) {
     CacheManager cache(config_);
 
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "CSVReader.hpp"
+
+using namespace sqlfuse;
+
+class CSVReaderTest : public ::testing::Test {
+protected:
+    // Read every row as owned strings, "<NULL>" for NULL
+    static std::vector<std::vector<std::string>> readAll(CSVReader& reader) {
+        std::vector<std::vector<std::string>> rows;
+        while (reader.next()) {
+            std::vector<std::string> row;
+            for (const auto& field : reader.row()) {
+                row.push_back(field ? std::string(*field) : "<NULL>");
+            }
+            rows.push_back(std::move(row));
+        }
+        return rows;
+    }
+};
+
+TEST_F(CSVReaderTest, HeaderAndRows) {
+    std::string data = "id,name\n1,Alice\n2,Bob\n";
+    CSVReader reader(data);
+
+    EXPECT_THAT(reader.columns(), ::testing::ElementsAre("id", "name"));
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[1][1], "Bob");
+}
+
+TEST_F(CSVReaderTest, QuotedFieldSpansLines) {
+    std::string data = "id,note\r\n1,\"line one\r\nline \"\"two\"\"\"\r\n2,plain\r\n";
+    CSVReader reader(data);
+
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0][1], "line one\r\nline \"two\"");
+    EXPECT_EQ(rows[1][1], "plain");
+}
+
+TEST_F(CSVReaderTest, NullVersusEmptyString) {
+    std::string data = "a,b,c\n,\"\",x\n";
+    CSVReader reader(data);
+
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0][0], "<NULL>");
+    EXPECT_EQ(rows[0][1], "");
+    EXPECT_EQ(rows[0][2], "x");
+}
+
+TEST_F(CSVReaderTest, RowsFittedToColumns) {
+    std::string data = "a,b\n1\n1,2,3\n1,\n";
+    CSVReader reader(data);
+
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_THAT(rows[0], ::testing::ElementsAre("1", "<NULL>"));
+    EXPECT_THAT(rows[1], ::testing::ElementsAre("1", "2"));
+    EXPECT_THAT(rows[2], ::testing::ElementsAre("1", "<NULL>"));
+}
+
+TEST_F(CSVReaderTest, NoHeaderNamesColumns) {
+    std::string data = "1,2\n3,4";
+    CSVOptions options;
+    options.includeHeader = false;
+    CSVReader reader(data, options);
+
+    EXPECT_THAT(reader.columns(), ::testing::ElementsAre("col0", "col1"));
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[1][1], "4");
+}
+
+TEST_F(CSVReaderTest, BlankLinesAndStrayQuotes) {
+    std::string data = "a,b\n\n5'3\",x\n\r\n";
+    CSVReader reader(data);
+
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0][0], "5'3\"");
+}
+
+TEST_F(CSVReaderTest, LongFieldsCrossVectorWidth) {
+    std::string longValue(100, 'v');
+    std::string data = "a,b\n" + longValue + ",\"" + longValue + ",\"\"" + longValue + "\"\n";
+    CSVReader reader(data);
+
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0][0], longValue);
+    EXPECT_EQ(rows[0][1], longValue + ",\"" + longValue);
+}
+
+TEST_F(CSVReaderTest, MalformedInputThrows) {
+    std::string unterminated = "a\n\"open\n";
+    CSVReader reader(unterminated);
+    EXPECT_THROW(reader.next(), std::runtime_error);
+
+    std::string trailing = "a\n\"x\"y\n";
+    CSVReader reader2(trailing);
+    EXPECT_THROW(reader2.next(), std::runtime_error);
+}
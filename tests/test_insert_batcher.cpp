@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "InsertBatcher.hpp"
+#include "CSVReader.hpp"
+#include <stdexcept>
+
+using namespace sqlfuse;
+
+class InsertBatcherTest : public ::testing::Test {
+protected:
+    // Records every call; statement number `failAt` (1-based) fails
+    InsertSession session(size_t failAt = 0) {
+        return InsertSession{
+            [this, failAt](const std::string& sql) {
+                log.push_back(sql);
+                return ++executed != failAt;
+            },
+            [this] { log.push_back("BEGIN"); return true; },
+            [this] { log.push_back("COMMIT"); return true; },
+            [this] { log.push_back("ROLLBACK"); },
+            [] { return std::string("duplicate key"); }};
+    }
+
+    static InsertSyntax syntax() {
+        return InsertSyntax{"INSERT INTO t (a, b) VALUES ", "", ", ", ""};
+    }
+
+    static void literal(std::string& sql, std::string_view value) {
+        sql += '\'';
+        sql += value;
+        sql += '\'';
+    }
+
+    std::vector<std::string> log;
+    size_t executed = 0;
+};
+
+TEST_F(InsertBatcherTest, GroupsRowsByCount) {
+    std::string data = "a,b\n1,x\n2,\n3,z\n";
+    CSVReader reader(data);
+    InsertBatcher batcher(syntax(), literal, session(), InsertLimits{2, 1 << 20});
+
+    ASSERT_TRUE(batcher.load(reader));
+    EXPECT_THAT(log, ::testing::ElementsAre(
+        "BEGIN",
+        "INSERT INTO t (a, b) VALUES ('1', 'x'), ('2', NULL)",
+        "INSERT INTO t (a, b) VALUES ('3', 'z')",
+        "COMMIT"));
+    EXPECT_EQ(batcher.rows(), 3u);
+    EXPECT_EQ(batcher.statements(), 2u);
+}
+
+TEST_F(InsertBatcherTest, GroupsRowsByBytes) {
+    std::string data = "a,b\n1,x\n2,y\n3,z\n";
+    CSVReader reader(data);
+    // The head plus one row already exceeds the limit: one row per statement
+    InsertBatcher batcher(syntax(), literal, session(), InsertLimits{1000, 10});
+
+    ASSERT_TRUE(batcher.load(reader));
+    EXPECT_EQ(batcher.statements(), 3u);
+    EXPECT_EQ(log.size(), 5u);
+}
+
+TEST_F(InsertBatcherTest, RowPrefixAndTail) {
+    std::string data = "a,b\n1,x\n2,y\n";
+    CSVReader reader(data);
+    InsertBatcher batcher(InsertSyntax{"INSERT ALL", " INTO t (a, b) VALUES ", "",
+                                       " SELECT 1 FROM DUAL"},
+                          literal, session());
+
+    ASSERT_TRUE(batcher.load(reader));
+    EXPECT_EQ(log[1], "INSERT ALL INTO t (a, b) VALUES ('1', 'x') "
+                      "INTO t (a, b) VALUES ('2', 'y') SELECT 1 FROM DUAL");
+}
+
+TEST_F(InsertBatcherTest, StatementFailureRollsBack) {
+    std::string data = "a,b\n1,x\n2,y\n3,z\n";
+    CSVReader reader(data);
+    InsertBatcher batcher(syntax(), literal, session(2), InsertLimits{1, 1 << 20});
+
+    EXPECT_FALSE(batcher.load(reader));
+    EXPECT_EQ(batcher.error(), "duplicate key");
+    EXPECT_EQ(log.back(), "ROLLBACK");
+    EXPECT_THAT(log, ::testing::Not(::testing::Contains("COMMIT")));
+    EXPECT_EQ(executed, 2u);  // Rows after the failure are not sent
+}
+
+TEST_F(InsertBatcherTest, ParseErrorRollsBack) {
+    std::string data = "a,b\n1,x\n2,\"open\n";
+    CSVReader reader(data);
+    InsertBatcher batcher(syntax(), literal, session(), InsertLimits{1, 1 << 20});
+
+    EXPECT_THROW(batcher.load(reader), std::runtime_error);
+    EXPECT_EQ(log.back(), "ROLLBACK");
+}
+
+TEST_F(InsertBatcherTest, NoRowsStillCommits) {
+    std::string data = "a,b\n";
+    CSVReader reader(data);
+    InsertBatcher batcher(syntax(), literal, session());
+
+    ASSERT_TRUE(batcher.load(reader));
+    EXPECT_THAT(log, ::testing::ElementsAre("BEGIN", "COMMIT"));
+}
+
+TEST_F(InsertBatcherTest, AppendsAcrossReaders) {
+    std::string first = "a,b\n1,x\n";
+    std::string second = "2,y\n3,z\n";
+    InsertBatcher batcher(syntax(), literal, session(), InsertLimits{2, 1 << 20});
+
+    ASSERT_TRUE(batcher.begin());
+    {
+        CSVReader reader(first);
+        ASSERT_TRUE(batcher.append(reader));
+    }
+    first.assign(first.size(), '#');  // Unsent rows must not point into the buffer
+    CSVOptions noHeader;
+    noHeader.includeHeader = false;
+    CSVReader reader(second, noHeader, {"a", "b"});
+    ASSERT_TRUE(batcher.append(reader));
+    ASSERT_TRUE(batcher.finish());
+
+    EXPECT_THAT(log, ::testing::ElementsAre(
+        "BEGIN",
+        "INSERT INTO t (a, b) VALUES ('1', 'x'), ('2', 'y')",
+        "INSERT INTO t (a, b) VALUES ('3', 'z')",
+        "COMMIT"));
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "JSONRowReader.hpp"
+#include <stdexcept>
+
+using namespace sqlfuse;
+
+class JSONRowReaderTest : public ::testing::Test {
+protected:
+    // Read every row as owned strings, "<NULL>" for NULL
+    static std::vector<std::vector<std::string>> readAll(JSONRowReader& reader) {
+        std::vector<std::vector<std::string>> rows;
+        while (reader.next()) {
+            std::vector<std::string> row;
+            for (const auto& field : reader.row()) {
+                row.push_back(field ? std::string(*field) : "<NULL>");
+            }
+            rows.push_back(std::move(row));
+        }
+        return rows;
+    }
+};
+
+TEST_F(JSONRowReaderTest, ArrayOfObjects) {
+    std::string data = R"([{"id": 1, "name": "Alice"}, {"id": 2, "name": "Bob"}])";
+    JSONRowReader reader(data);
+
+    EXPECT_THAT(reader.columns(), ::testing::ElementsAre("id", "name"));
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_THAT(rows[1], ::testing::ElementsAre("2", "Bob"));
+}
+
+TEST_F(JSONRowReaderTest, RowsWrapper) {
+    std::string data = "{\n  \"rows\": [\n    {\"id\": 1},\n    {\"id\": 2}\n  ]\n}";
+    JSONRowReader reader(data);
+
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[1][0], "2");
+}
+
+TEST_F(JSONRowReaderTest, SingleObject) {
+    std::string data = R"({"id": 7, "rows": 3})";
+    JSONRowReader reader(data);
+
+    EXPECT_THAT(reader.columns(), ::testing::ElementsAre("id", "rows"));
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_THAT(rows[0], ::testing::ElementsAre("7", "3"));
+}
+
+TEST_F(JSONRowReaderTest, EmptyInput) {
+    std::string empty;
+    JSONRowReader a(empty);
+    EXPECT_FALSE(a.next());
+
+    std::string array = " [ ] ";
+    JSONRowReader b(array);
+    EXPECT_FALSE(b.next());
+}
+
+TEST_F(JSONRowReaderTest, ValueKinds) {
+    std::string data =
+        R"([{"n": null, "b": true, "f": -1.5e3, "o": {"k": [1, "]"]}, "a": [], "s": ""}])";
+    JSONRowReader reader(data);
+
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_THAT(rows[0], ::testing::ElementsAre("<NULL>", "true", "-1.5e3",
+                                                R"({"k": [1, "]"]})", "[]", ""));
+}
+
+TEST_F(JSONRowReaderTest, StringEscapes) {
+    std::string data = R"([{"s": "a\"b\\c\/d\n\t\u00e9\u20AC\ud83d\ude00"}])";
+    JSONRowReader reader(data);
+
+    ASSERT_TRUE(reader.next());
+    EXPECT_EQ(*reader.row()[0], "a\"b\\c/d\n\t\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+}
+
+TEST_F(JSONRowReaderTest, KeysMatchedByNameAfterFirstRow) {
+    std::string data = R"([{"id": 1, "name": "a", "note": "x"},
+                           {"note": "y", "id": 2},
+                           {}])";
+    JSONRowReader reader(data);
+
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_THAT(rows[1], ::testing::ElementsAre("2", "<NULL>", "y"));
+    EXPECT_THAT(rows[2], ::testing::ElementsAre("<NULL>", "<NULL>", "<NULL>"));
+}
+
+TEST_F(JSONRowReaderTest, UnknownKeyThrows) {
+    std::string data = R"([{"id": 1}, {"id": 2, "extra": 3}])";
+    JSONRowReader reader(data);
+
+    ASSERT_TRUE(reader.next());
+    EXPECT_THROW(reader.next(), std::runtime_error);
+}
+
+TEST_F(JSONRowReaderTest, NonObjectItemsSkipped) {
+    std::string data = R"([1, "x", [2], {"id": 3}, null, {"id": 4}])";
+    JSONRowReader reader(data);
+
+    EXPECT_THAT(reader.columns(), ::testing::ElementsAre("id"));
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[1][0], "4");
+}
+
+TEST_F(JSONRowReaderTest, ViewsOutliveNext) {
+    std::string data = R"([{"s": "one\ttab"}, {"s": "two"}])";
+    JSONRowReader reader(data);
+
+    ASSERT_TRUE(reader.next());
+    FieldView first = reader.row()[0];
+    ASSERT_TRUE(reader.next());
+    EXPECT_EQ(*first, "one\ttab");
+    EXPECT_EQ(*reader.row()[0], "two");
+}
+
+TEST_F(JSONRowReaderTest, MalformedInputThrows) {
+    for (std::string data : {R"([{"id": 1} {"id": 2}])", R"([{"id": "open})",
+                             R"([{"id" 1}])", R"([{"id": nope}])", R"("text")",
+                             R"([{"id": "\x"}])"}) {
+        EXPECT_THROW({
+            JSONRowReader reader(data);
+            while (reader.next()) {}
+        }, std::runtime_error) << data;
+    }
+}
+
+TEST_F(JSONRowReaderTest, GivenColumns) {
+    std::string data = R"([{"name": "Bob"}, {"id": 3, "name": "Carol"}])";
+    JSONRowReader reader(data, {"id", "name"});
+
+    EXPECT_THAT(reader.columns(), ::testing::ElementsAre("id", "name"));
+    auto rows = readAll(reader);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_THAT(rows[0], ::testing::ElementsAre("<NULL>", "Bob"));
+    EXPECT_THAT(rows[1], ::testing::ElementsAre("3", "Carol"));
+
+    std::string unknown = R"([{"id": 1, "email": "x"}])";
+    EXPECT_THROW(JSONRowReader(unknown, {"id", "name"}), std::runtime_error);
+}
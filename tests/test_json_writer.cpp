@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "JSONWriter.hpp"
+#include "ResultBatch.hpp"
+#include <limits>
+
+using namespace sqlfuse;
+
+class JSONWriterTest : public ::testing::Test {
+protected:
+    // A small document exercising nesting, empty containers and every scalar
+    static void writeSample(JSONWriter& w) {
+        w.beginObject();
+        w.key("name");
+        w.string("Alice \"A\"");
+        w.key("tags");
+        w.beginArray();
+        w.string("x");
+        w.integer(-7);
+        w.real(0.25);
+        w.boolean(true);
+        w.null();
+        w.endArray();
+        w.key("empty");
+        w.beginObject();
+        w.endObject();
+        w.key("list");
+        w.beginArray();
+        w.endArray();
+        w.key("nested");
+        w.beginArray();
+        w.beginObject();
+        w.key("id");
+        w.integer(1);
+        w.endObject();
+        w.endArray();
+        w.endObject();
+    }
+};
+
+TEST_F(JSONWriterTest, PrettyMatchesDump) {
+    std::string out;
+    JSONWriter w(out);
+    writeSample(w);
+
+    // nlohmann keeps keys sorted, so compare parsed values and layout
+    json parsed = json::parse(out);
+    EXPECT_EQ(parsed["name"], "Alice \"A\"");
+    EXPECT_EQ(parsed["tags"].size(), 5u);
+    EXPECT_THAT(out, ::testing::HasSubstr("\n  \"tags\": [\n    \"x\",\n    -7,"));
+    EXPECT_THAT(out, ::testing::HasSubstr("\"empty\": {},\n  \"list\": [],"));
+    EXPECT_EQ(w.depth(), 0u);
+}
+
+TEST_F(JSONWriterTest, Compact) {
+    std::string out;
+    JSONOptions options;
+    options.pretty = false;
+    JSONWriter w(out, options);
+    writeSample(w);
+
+    EXPECT_EQ(out, "{\"name\":\"Alice \\\"A\\\"\",\"tags\":[\"x\",-7,0.25,true,null],"
+                   "\"empty\":{},\"list\":[],\"nested\":[{\"id\":1}]}");
+}
+
+TEST_F(JSONWriterTest, EscapesControlCharacters) {
+    std::string out;
+    JSONWriter::appendString(out, std::string("a\"b\\c\n\x01", 7));
+
+    EXPECT_EQ(out, "\"a\\\"b\\\\c\\n\\u0001\"");
+}
+
+TEST_F(JSONWriterTest, NumberText) {
+    std::string out;
+    JSONOptions options;
+    options.pretty = false;
+    JSONWriter w(out, options);
+
+    w.beginArray();
+    w.number("12345678901234567890.5");
+    w.number(".5");
+    w.number("007");
+    w.number("NaN");
+    w.real(std::numeric_limits<double>::infinity());
+    w.binary(std::string("\x01\xab", 2));
+    w.endArray();
+
+    EXPECT_EQ(out, "[12345678901234567890.5,0.5,7,\"NaN\",null,\"01AB\"]");
+}
+
+TEST_F(JSONWriterTest, StreamedChunksMatchWholeDocument) {
+    ResultBatch source({"id", "name"}, 10);
+    for (int i = 0; i < 10; ++i) {
+        source.column(0).appendInteger(i);
+        source.column(1).appendText("row " + std::to_string(i));
+    }
+
+    auto filler = [&source](size_t& next) {
+        return [&source, &next](ResultBatch& batch) {
+            while (!batch.full() && next < source.rowCount()) {
+                batch.column(0).appendInteger(source.column(0).integer(next));
+                batch.column(1).appendText(source.column(1).bytes(next));
+                ++next;
+            }
+            return batch.rowCount() > 0;
+        };
+    };
+
+    for (bool arrayFormat : {true, false}) {
+        JSONOptions options;
+        options.arrayFormat = arrayFormat;
+
+        size_t next = 0;
+        ResultBatch whole({"id", "name"}, 10);
+        std::string expected = FormatConverter::toJSON(whole, filler(next), options);
+
+        next = 0;
+        ResultBatch small({"id", "name"}, 3);
+        std::string streamed;
+        size_t chunks = 0;
+        FormatConverter::writeJSON(small, filler(next), [&](std::string_view chunk) {
+            streamed += chunk;
+            ++chunks;
+        }, options);
+
+        EXPECT_EQ(streamed, expected);
+        EXPECT_EQ(chunks, 5u);  // 4 batches + closing brackets
+        EXPECT_NO_THROW(json::parse(streamed));
+    }
+}
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include "ParallelExport.hpp"
+#include "FormatConverter.hpp"
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+using namespace sqlfuse;
+
+namespace {
+
+// Keys "k00".."k99" in order, served as a backend's index would
+KeySource sortedKeys(size_t count, int* lookups = nullptr) {
+    auto key = [](size_t i) {
+        return std::string("k") + (i < 10 ? "0" : "") + std::to_string(i);
+    };
+    KeySource source;
+    source.keyAt = [=](const std::optional<std::string>& from,
+                       size_t offset) -> std::optional<std::string> {
+        if (lookups) ++*lookups;
+        size_t start = 0;
+        if (from) {
+            while (start < count && key(start) < *from) ++start;
+        }
+        if (start + offset >= count) return std::nullopt;
+        return key(start + offset);
+    };
+    return source;
+}
+
+// A table of ids rendered as the backends render JSON
+std::string render(const std::vector<std::string>& ids, bool pretty) {
+    JSONOptions options;
+    options.pretty = pretty;
+    std::vector<std::vector<SqlValue>> rows;
+    for (const auto& id : ids) {
+        rows.push_back({id});
+    }
+    return FormatConverter::toJSON({"id"}, rows, options);
+}
+
+}  // namespace
+
+TEST(ParallelExportTest, SingleRangeWithoutParallelism) {
+    auto ranges = planKeyRanges(sortedKeys(100), 1, 100, 50);
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_FALSE(ranges[0].lower);
+    EXPECT_FALSE(ranges[0].upper);
+    EXPECT_EQ(ranges[0].limit, 50u);
+}
+
+TEST(ParallelExportTest, IntegerBoundsSplitEvenly) {
+    KeySource source;
+    source.bounds = [] { return std::make_pair(std::string("1"), std::string("100")); };
+    auto ranges = planKeyRanges(source, 4, 100, 0);
+    ASSERT_EQ(ranges.size(), 4u);
+    EXPECT_FALSE(ranges[0].lower);
+    EXPECT_EQ(ranges[0].upper, "25");
+    EXPECT_EQ(ranges[1].lower, "25");
+    EXPECT_EQ(ranges[1].upper, "50");
+    EXPECT_EQ(ranges[2].upper, "75");
+    EXPECT_EQ(ranges[3].lower, "75");
+    EXPECT_FALSE(ranges[3].upper);
+}
+
+TEST(ParallelExportTest, IntegerBoundsCoverExtremes) {
+    KeySource source;
+    source.bounds = [] {
+        return std::make_pair(std::to_string(std::numeric_limits<long long>::min()),
+                              std::to_string(std::numeric_limits<long long>::max()));
+    };
+    auto ranges = planKeyRanges(source, 3, 0, 0);
+    ASSERT_EQ(ranges.size(), 3u);
+    EXPECT_EQ(ranges[1].lower, ranges[0].upper);
+    EXPECT_EQ(ranges[2].lower, ranges[1].upper);
+    EXPECT_LT(std::stoll(*ranges[0].upper), std::stoll(*ranges[1].upper));
+}
+
+TEST(ParallelExportTest, NarrowIntegerSpanMakesFewerRanges) {
+    KeySource source;
+    source.bounds = [] { return std::make_pair(std::string("5"), std::string("6")); };
+    auto ranges = planKeyRanges(source, 8, 2, 0);
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].upper, "6");
+}
+
+TEST(ParallelExportTest, TextKeysAreSampled) {
+    int lookups = 0;
+    KeySource source = sortedKeys(100, &lookups);
+    source.bounds = [] { return std::make_pair(std::string("k00"), std::string("k99")); };
+    auto ranges = planKeyRanges(source, 4, 100, 0);
+    ASSERT_EQ(ranges.size(), 4u);
+    EXPECT_EQ(ranges[0].upper, "k25");
+    EXPECT_EQ(ranges[1].upper, "k50");
+    EXPECT_EQ(ranges[2].upper, "k75");
+    EXPECT_FALSE(ranges[3].upper);
+    EXPECT_EQ(lookups, 3);
+}
+
+TEST(ParallelExportTest, LimitedExportSharesTheLimit) {
+    auto ranges = planKeyRanges(sortedKeys(100), 4, 10, 10);
+    ASSERT_EQ(ranges.size(), 4u);
+    EXPECT_EQ(ranges[0].upper, "k03");
+    EXPECT_EQ(ranges[0].limit, 3u);
+    EXPECT_EQ(ranges[1].limit, 3u);
+    EXPECT_EQ(ranges[2].limit, 3u);
+    EXPECT_EQ(ranges[3].lower, "k09");
+    EXPECT_EQ(ranges[3].limit, 1u);
+}
+
+TEST(ParallelExportTest, ShortTableEndsSampling) {
+    auto ranges = planKeyRanges(sortedKeys(5), 4, 100, 0);
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_FALSE(ranges[0].lower);
+}
+
+TEST(ParallelExportTest, EmptyTableIsOneRange) {
+    KeySource source;
+    source.bounds = [] { return std::optional<std::pair<std::string, std::string>>(); };
+    EXPECT_EQ(planKeyRanges(source, 4, 1000, 0).size(), 1u);
+}
+
+TEST(ParallelExportTest, ChunksComeBackInRangeOrder) {
+    std::vector<KeyRange> ranges(6);
+    std::atomic<int> running{0};
+    std::atomic<int> overlap{0};
+    auto chunks = renderRanges(ranges, 3, [&](const KeyRange&, size_t index) {
+        if (++running > 1) ++overlap;
+        // Later ranges finish first
+        std::this_thread::sleep_for(std::chrono::milliseconds(5 * (6 - index)));
+        --running;
+        return std::to_string(index);
+    });
+    EXPECT_EQ(chunks, (std::vector<std::string>{"0", "1", "2", "3", "4", "5"}));
+    EXPECT_GT(overlap, 0);
+}
+
+TEST(ParallelExportTest, RenderErrorIsRethrown) {
+    std::vector<KeyRange> ranges(4);
+    EXPECT_THROW(renderRanges(ranges, 2,
+                              [](const KeyRange&, size_t index) -> std::string {
+                                  if (index == 2) throw std::runtime_error("lost connection");
+                                  return "x";
+                              }),
+                 std::runtime_error);
+}
+
+TEST(ParallelExportTest, JoinedJSONMatchesOneRendering) {
+    for (bool pretty : {true, false}) {
+        std::vector<std::string> chunks = {render({"1", "2"}, pretty), render({}, pretty),
+                                           render({"3"}, pretty)};
+        EXPECT_EQ(joinJSONArrays(chunks, pretty), render({"1", "2", "3"}, pretty));
+    }
+    EXPECT_EQ(joinJSONArrays({render({}, true), render({}, true)}, true), render({}, true));
+}
+
+TEST(ParallelExportTest, ResumedJoinerJoinsLikeTheWholeJoin) {
+    for (bool pretty : {true, false}) {
+        std::vector<std::string> chunks = {render({"1"}, pretty), render({}, pretty),
+                                           render({"2", "3"}, pretty)};
+        ExportJoiner whole(true, pretty);
+        std::vector<std::string> pieces;
+        size_t offset = 0;
+        std::vector<size_t> offsets;
+        for (const auto& chunk : chunks) {
+            offsets.push_back(offset);
+            pieces.push_back(whole.next(chunk));
+            offset += pieces.back().size();
+        }
+
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            ExportJoiner resumed(true, pretty);
+            resumed.resumeAt(offsets[i]);
+            EXPECT_EQ(resumed.next(chunks[i]), pieces[i]);
+        }
+        ExportJoiner ending(true, pretty);
+        ending.resumeAt(offset);
+        EXPECT_EQ(ending.finish(), whole.finish());
+    }
+}
+
+TEST(ParallelExportTest, IntegerKeyTypes) {
+    EXPECT_TRUE(isIntegerKeyType("int(11) unsigned"));
+    EXPECT_TRUE(isIntegerKeyType("bigint"));
+    EXPECT_TRUE(isIntegerKeyType("INTEGER"));
+    EXPECT_TRUE(isIntegerKeyType("smallint"));
+    EXPECT_TRUE(isIntegerKeyType("int8"));
+    EXPECT_FALSE(isIntegerKeyType("varchar(32)"));
+    EXPECT_FALSE(isIntegerKeyType("character varying"));
+    EXPECT_FALSE(isIntegerKeyType("interval"));
+    EXPECT_FALSE(isIntegerKeyType("DECIMAL(10,2)"));
+    EXPECT_FALSE(isIntegerKeyType(""));
+}
+
+TEST(ParallelExportTest, IndexRoundTrips) {
+    ExportIndex index;
+    index.ranges = {{std::nullopt, std::string("a b"), 0},
+                    {std::string("a b"), std::string("x:\n1"), 0},
+                    {std::string("x:\n1"), std::nullopt, 7}};
+    index.offsets = {0, 120, 250, 300};
+    index.size = 301;
+
+    auto parsed = ExportIndex::parse(index.serialize());
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(parsed->size, 301u);
+    EXPECT_EQ(parsed->offsets, index.offsets);
+    ASSERT_EQ(parsed->ranges.size(), 3u);
+    EXPECT_FALSE(parsed->ranges[0].lower);
+    EXPECT_EQ(parsed->ranges[1].lower, "a b");
+    EXPECT_EQ(parsed->ranges[1].upper, "x:\n1");
+    EXPECT_FALSE(parsed->ranges[2].upper);
+    EXPECT_EQ(parsed->ranges[2].limit, 7u);
+}
+
+TEST(ParallelExportTest, MalformedIndexIsRejected) {
+    EXPECT_FALSE(ExportIndex::parse(""));
+    EXPECT_FALSE(ExportIndex::parse("10 1 0 0 - -"));           // No ending offset
+    EXPECT_FALSE(ExportIndex::parse("10 1 0 0 5:ab - 4"));      // Key past the end
+    EXPECT_FALSE(ExportIndex::parse("10 2 0 0 - - 8 0 - - 4")); // Offsets go back
+    EXPECT_FALSE(ExportIndex::parse("10 1 0 0 - - 12"));        // Ending past the file
+    EXPECT_TRUE(ExportIndex::parse("10 1 0 0 - - 9"));
+}
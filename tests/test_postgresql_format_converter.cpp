@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include "PostgreSQLFormatConverter.hpp"
+#include "BatchWriter.hpp"
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+using namespace sqlfuse;
+
+namespace {
+
+constexpr Oid BOOLOID = 16;
+constexpr Oid INT2OID = 21;
+constexpr Oid INT8OID = 20;
+constexpr Oid FLOAT4OID = 700;
+constexpr Oid FLOAT8OID = 701;
+constexpr Oid NUMERICOID = 1700;
+constexpr Oid BYTEAOID = 17;
+constexpr Oid TEXTOID = 25;
+constexpr Oid DATEOID = 1082;
+constexpr Oid TIMESTAMPOID = 1114;
+constexpr Oid TIMESTAMPTZOID = 1184;
+constexpr Oid UUIDOID = 2950;
+
+// Big-endian bytes of an integer, as the server sends it
+template<typename T>
+std::string be(T value) {
+    using U = std::make_unsigned_t<T>;
+    U v = static_cast<U>(value);
+    std::string out(sizeof(T), '\0');
+    for (size_t i = sizeof(T); i-- > 0;) {
+        out[i] = static_cast<char>(v & 0xFF);
+        v = static_cast<U>(v >> 8);
+    }
+    return out;
+}
+
+// numeric wire format: header and base-10000 digits
+std::string numeric(int16_t weight, uint16_t sign, uint16_t dscale,
+                    std::initializer_list<int16_t> digits) {
+    std::string out = be<int16_t>(static_cast<int16_t>(digits.size())) + be<int16_t>(weight) +
+                      be<uint16_t>(sign) + be<uint16_t>(dscale);
+    for (int16_t digit : digits) {
+        out += be<int16_t>(digit);
+    }
+    return out;
+}
+
+std::string decode(Oid type, const std::string& data) {
+    std::string out;
+    PostgreSQLFormatConverter::appendBinaryValue(out, type, data.data(),
+                                                 static_cast<int>(data.size()));
+    return out;
+}
+
+struct ResultDeleter {
+    void operator()(PGresult* result) const { PQclear(result); }
+};
+using Result = std::unique_ptr<PGresult, ResultDeleter>;
+
+// A result built in memory, as libpq would return it for the given
+// columns in text (format 0) or binary (format 1)
+Result makeResult(const std::vector<std::pair<std::string, Oid>>& columns, int format) {
+    Result result(PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK));
+    std::vector<PGresAttDesc> attrs(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        attrs[i] = PGresAttDesc{};
+        attrs[i].name = const_cast<char*>(columns[i].first.c_str());
+        attrs[i].typid = columns[i].second;
+        attrs[i].format = format;
+        attrs[i].typlen = -1;
+        attrs[i].atttypmod = -1;
+    }
+    PQsetResultAttrs(result.get(), static_cast<int>(attrs.size()), attrs.data());
+    return result;
+}
+
+void setValue(PGresult* result, int row, int col, const std::string& value) {
+    PQsetvalue(result, row, col, const_cast<char*>(value.data()), static_cast<int>(value.size()));
+}
+
+}  // namespace
+
+TEST(PostgreSQLBinaryTest, Integers) {
+    EXPECT_EQ(decode(INT2OID, be<int16_t>(-2)), "-2");
+    EXPECT_EQ(decode(INT8OID, be<int64_t>(std::numeric_limits<int64_t>::min())),
+              "-9223372036854775808");
+    EXPECT_EQ(decode(BOOLOID, std::string(1, '\1')), "t");
+    EXPECT_EQ(decode(BOOLOID, std::string(1, '\0')), "f");
+}
+
+TEST(PostgreSQLBinaryTest, Floats) {
+    EXPECT_EQ(decode(FLOAT4OID, be<uint32_t>(std::bit_cast<uint32_t>(1.5f))), "1.5");
+    EXPECT_EQ(decode(FLOAT8OID, be<uint64_t>(std::bit_cast<uint64_t>(0.1))), "0.1");
+    EXPECT_EQ(decode(FLOAT8OID,
+                     be<uint64_t>(std::bit_cast<uint64_t>(std::numeric_limits<double>::quiet_NaN()))),
+              "NaN");
+    EXPECT_EQ(decode(FLOAT8OID,
+                     be<uint64_t>(std::bit_cast<uint64_t>(-std::numeric_limits<double>::infinity()))),
+              "-Infinity");
+}
+
+TEST(PostgreSQLBinaryTest, NumericWeightAndScale) {
+    EXPECT_EQ(decode(NUMERICOID, numeric(1, 0, 3, {1, 2345, 6780})), "12345.678");
+    EXPECT_EQ(decode(NUMERICOID, numeric(0, 0, 0, {42})), "42");
+    // Trailing zero digit groups are not sent
+    EXPECT_EQ(decode(NUMERICOID, numeric(2, 0, 0, {1})), "100000000");
+    EXPECT_EQ(decode(NUMERICOID, numeric(-1, 0, 4, {12})), "0.0012");
+    EXPECT_EQ(decode(NUMERICOID, numeric(-2, 0, 8, {12})), "0.00000012");
+    // dscale keeps zeros the digits do not carry
+    EXPECT_EQ(decode(NUMERICOID, numeric(0, 0, 2, {7})), "7.00");
+    EXPECT_EQ(decode(NUMERICOID, numeric(0, 0, 0, {})), "0");
+}
+
+TEST(PostgreSQLBinaryTest, NumericSignAndSpecials) {
+    EXPECT_EQ(decode(NUMERICOID, numeric(0, 0x4000, 1, {1, 5000})), "-1.5");
+    EXPECT_EQ(decode(NUMERICOID, numeric(0, 0xC000, 0, {})), "NaN");
+    EXPECT_EQ(decode(NUMERICOID, numeric(0, 0xD000, 0, {})), "Infinity");
+    EXPECT_EQ(decode(NUMERICOID, numeric(0, 0xF000, 0, {})), "-Infinity");
+    // Truncated values decode to nothing rather than read past the end
+    EXPECT_EQ(decode(NUMERICOID, numeric(0, 0, 0, {1, 2}).substr(0, 10)), "");
+}
+
+TEST(PostgreSQLBinaryTest, Dates) {
+    EXPECT_EQ(decode(DATEOID, be<int32_t>(0)), "2000-01-01");
+    EXPECT_EQ(decode(DATEOID, be<int32_t>(-1)), "1999-12-31");
+    EXPECT_EQ(decode(DATEOID, be<int32_t>(-10957)), "1970-01-01");
+    EXPECT_EQ(decode(DATEOID, be<int32_t>(60)), "2000-03-01");  // 2000 is a leap year
+    // Year 0 of the proleptic calendar is 1 BC
+    EXPECT_EQ(decode(DATEOID, be<int32_t>(-730485)), "0001-01-01 BC");
+    EXPECT_EQ(decode(DATEOID, be<int32_t>(-730486)), "0002-12-31 BC");
+    EXPECT_EQ(decode(DATEOID, be<int32_t>(std::numeric_limits<int32_t>::max())), "infinity");
+    EXPECT_EQ(decode(DATEOID, be<int32_t>(std::numeric_limits<int32_t>::min())), "-infinity");
+}
+
+TEST(PostgreSQLBinaryTest, Timestamps) {
+    EXPECT_EQ(decode(TIMESTAMPOID, be<int64_t>(0)), "2000-01-01 00:00:00");
+    EXPECT_EQ(decode(TIMESTAMPOID, be<int64_t>(1500000)), "2000-01-01 00:00:01.5");
+    EXPECT_EQ(decode(TIMESTAMPOID, be<int64_t>(-1)), "1999-12-31 23:59:59.999999");
+    EXPECT_EQ(decode(TIMESTAMPOID, be<int64_t>(-730485LL * 86400000000LL + 3600000000LL)),
+              "0001-01-01 01:00:00 BC");
+    EXPECT_EQ(decode(TIMESTAMPOID, be<int64_t>(std::numeric_limits<int64_t>::max())),
+              "infinity");
+    EXPECT_EQ(decode(TIMESTAMPOID, be<int64_t>(std::numeric_limits<int64_t>::min())),
+              "-infinity");
+}
+
+TEST(PostgreSQLBinaryTest, UuidAndBytea) {
+    std::string uuid;
+    for (int i = 0; i < 16; ++i) uuid += static_cast<char>(i * 17);
+    EXPECT_EQ(decode(UUIDOID, uuid), "00112233-4455-6677-8899-aabbccddeeff");
+    EXPECT_EQ(decode(BYTEAOID, std::string("\xde\xad\x00\x0f", 4)), "\\xdead000f");
+    EXPECT_EQ(decode(BYTEAOID, ""), "\\x");
+    EXPECT_EQ(decode(TEXTOID, "caf\xc3\xa9"), "caf\xc3\xa9");
+}
+
+TEST(PostgreSQLBinaryTest, UndecodableColumnsAreCastToText) {
+    Result description = makeResult({{"id", INT8OID}, {"at", TIMESTAMPTZOID}}, 0);
+    EXPECT_FALSE(PostgreSQLFormatConverter::isBinaryDecodable(description.get()));
+    std::string columns = PostgreSQLFormatConverter::buildBinaryColumns(description.get());
+    EXPECT_EQ(columns, "\"id\", \"at\"::text AS \"at\"");
+    EXPECT_EQ(PostgreSQLFormatConverter::buildBinarySelect(
+                  columns, "SELECT * FROM \"e\" ORDER BY \"e\".\"id\" LIMIT 5"),
+              "SELECT \"id\", \"at\"::text AS \"at\" FROM \"e\" ORDER BY \"e\".\"id\" LIMIT 5");
+    EXPECT_EQ(PostgreSQLFormatConverter::buildBinarySelect(columns, "SELECT id FROM \"e\""), "");
+}
+
+TEST(PostgreSQLBinaryTest, BinaryRowsRenderLikeTextRows) {
+    std::vector<std::pair<std::string, Oid>> columns = {
+        {"id", INT8OID}, {"price", NUMERICOID}, {"day", DATEOID}, {"ok", BOOLOID}};
+    Result text = makeResult(columns, 0);
+    setValue(text.get(), 0, 0, "-7");
+    setValue(text.get(), 0, 1, "-1.5");
+    setValue(text.get(), 0, 2, "1999-12-31");
+    setValue(text.get(), 0, 3, "t");
+
+    Result binary = makeResult(columns, 1);
+    setValue(binary.get(), 0, 0, be<int64_t>(-7));
+    setValue(binary.get(), 0, 1, numeric(0, 0x4000, 1, {1, 5000}));
+    setValue(binary.get(), 0, 2, be<int32_t>(-1));
+    setValue(binary.get(), 0, 3, std::string(1, '\1'));
+
+    auto render = [&](PGresult* result, bool json) {
+        ResultBatch batch(PostgreSQLFormatConverter::columnNames(result));
+        int row = 0;
+        PostgreSQLFormatConverter::fillBatch(result, row, batch);
+        std::string out;
+        if (json) {
+            JSONOptions options;
+            options.pretty = false;
+            JSONBatchWriter writer(out, options);
+            writer.begin();
+            writer.writeRows(batch);
+            writer.finish();
+        } else {
+            CSVBatchWriter().writeRows(batch, out);
+        }
+        return out;
+    };
+    EXPECT_EQ(render(binary.get(), false), render(text.get(), false));
+    EXPECT_EQ(render(binary.get(), true), render(text.get(), true));
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "ReadAhead.hpp"
+#include <set>
+#include <stdexcept>
+
+using namespace sqlfuse;
+using namespace std::chrono_literals;
+
+class ReadAheadTest : public ::testing::Test {
+protected:
+    // Chunk i is ten copies of the letter 'a' + i
+    ChunkedContent::Render renderer() {
+        return [this](size_t index) -> std::string {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                rendered.insert(index);
+            }
+            if (index == failIndex) {
+                throw std::runtime_error("lost connection");
+            }
+            return std::string(10, static_cast<char>('a' + index));
+        };
+    }
+
+    std::set<size_t> renderedSoFar() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return rendered;
+    }
+
+    // Wait for the executor to have rendered `count` chunks ahead
+    static void awaitPrefetched(const ReadAheadExecutor& executor, size_t count) {
+        for (int i = 0; i < 400 && executor.prefetched() < count; ++i) {
+            std::this_thread::sleep_for(5ms);
+        }
+    }
+
+    std::string readAll(ChunkedContent& content, size_t step) {
+        std::string out;
+        char buf[64];
+        size_t n;
+        while ((n = content.read(buf, step, out.size())) > 0) {
+            out.append(buf, n);
+        }
+        return out;
+    }
+
+    std::mutex mutex;
+    std::set<size_t> rendered;
+    size_t failIndex = static_cast<size_t>(-1);
+};
+
+TEST_F(ReadAheadTest, RendersOnlyWhatIsRead) {
+    ChunkedContent content(4, renderer(), ExportJoiner(false, false), nullptr);
+    char buf[16];
+    ASSERT_EQ(content.read(buf, 15, 0), 15u);
+    EXPECT_EQ(std::string(buf, 15), "aaaaaaaaaabbbbb");
+    EXPECT_EQ(renderedSoFar(), (std::set<size_t>{0, 1}));
+    EXPECT_FALSE(content.complete());
+}
+
+TEST_F(ReadAheadTest, JoinsChunksInOrder) {
+    ChunkedContent content(3, renderer(), ExportJoiner(false, false, "\n"), nullptr);
+    EXPECT_EQ(readAll(content, 7), "aaaaaaaaaabbbbbbbbbbcccccccccc\n");
+    EXPECT_TRUE(content.complete());
+}
+
+TEST_F(ReadAheadTest, SequentialReadsPrefetch) {
+    ReadAheadExecutor executor(2, 2, 1 << 20);
+    ChunkedContent content(6, renderer(), ExportJoiner(false, false), &executor);
+    char buf[10];
+    ASSERT_EQ(content.read(buf, 10, 0), 10u);
+    awaitPrefetched(executor, 2);
+    EXPECT_EQ(renderedSoFar(), (std::set<size_t>{0, 1, 2}));
+    EXPECT_EQ(executor.held(), 20u);
+
+    // Reading a prefetched chunk gives its budget back and moves the window
+    ASSERT_EQ(content.read(buf, 10, 10), 10u);
+    EXPECT_EQ(std::string(buf, 10), "bbbbbbbbbb");
+    awaitPrefetched(executor, 3);
+    EXPECT_EQ(renderedSoFar(), (std::set<size_t>{0, 1, 2, 3}));
+    EXPECT_EQ(executor.held(), 20u);
+
+    EXPECT_EQ(readAll(content, 10).size(), 60u);
+    EXPECT_EQ(executor.held(), 0u);
+}
+
+TEST_F(ReadAheadTest, RandomReadsDoNotPrefetch) {
+    ReadAheadExecutor executor(2, 2, 1 << 20);
+    ChunkedContent content(6, renderer(), ExportJoiner(false, false), &executor);
+    char buf[10];
+    ASSERT_EQ(content.read(buf, 5, 12), 5u);
+    EXPECT_EQ(std::string(buf, 5), "bbbbb");
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(renderedSoFar(), (std::set<size_t>{0, 1}));
+    EXPECT_EQ(executor.prefetched(), 0u);
+}
+
+TEST_F(ReadAheadTest, BudgetLimitsPrefetch) {
+    ReadAheadExecutor executor(2, 4, 25);
+    ChunkedContent content(8, renderer(), ExportJoiner(false, false), &executor);
+    char buf[10];
+    ASSERT_EQ(content.read(buf, 10, 0), 10u);
+    awaitPrefetched(executor, 2);
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(renderedSoFar(), (std::set<size_t>{0, 1, 2}));
+    EXPECT_LE(executor.held(), 25u);
+}
+
+TEST_F(ReadAheadTest, FailedChunkFailsTheRead) {
+    failIndex = 1;
+    ChunkedContent content(3, renderer(), ExportJoiner(false, false), nullptr);
+    char buf[10];
+    EXPECT_EQ(content.read(buf, 10, 0), 10u);
+    EXPECT_THROW(content.read(buf, 10, 10), std::runtime_error);
+}
+
+TEST_F(ReadAheadTest, TakeRendersTheRest) {
+    ReadAheadExecutor executor(1, 2, 1 << 20);
+    ChunkedContent content(3, renderer(), ExportJoiner(true, false), &executor);
+    EXPECT_EQ(content.take(), "[]");  // Chunks that are not JSON arrays add nothing
+    EXPECT_EQ(executor.held(), 0u);
+}
+
+TEST_F(ReadAheadTest, ReleaseWaitsForChunksInFlight) {
+    ReadAheadExecutor executor(2, 4, 1 << 20);
+    {
+        ChunkedContent content(8, renderer(), ExportJoiner(false, false), &executor);
+        char buf[10];
+        content.read(buf, 10, 0);
+    }
+    EXPECT_EQ(executor.held(), 0u);
+}
+
+TEST_F(ReadAheadTest, IndexedReadRendersOnlyWhatItCovers) {
+    std::vector<size_t> offsets;
+    {
+        ChunkedContent first(4, renderer(), ExportJoiner(false, false, "\n"), nullptr);
+        first.take();
+        offsets = first.offsets();
+    }
+    EXPECT_EQ(offsets, (std::vector<size_t>{0, 10, 20, 30, 40}));
+    rendered.clear();
+
+    ChunkedContent content(4, renderer(), ExportJoiner(false, false, "\n"), nullptr, offsets);
+    EXPECT_EQ(content.size(), 41u);
+    char buf[16];
+    ASSERT_EQ(content.read(buf, 12, 29), 12u);
+    EXPECT_EQ(std::string(buf, 12), "cdddddddddd\n");
+    EXPECT_EQ(renderedSoFar(), (std::set<size_t>{2, 3}));
+    EXPECT_FALSE(content.complete());
+    EXPECT_EQ(content.take(), "aaaaaaaaaabbbbbbbbbbccccccccccdddddddddd\n");
+}
+
+TEST_F(ReadAheadTest, IndexedJSONReadsMatchTheWholeFile) {
+    // Chunk 1 renders no rows
+    ChunkedContent::Render render = [](size_t index) -> std::string {
+        return index == 1 ? "[]" : "[" + std::to_string(index * 11) + "]";
+    };
+    ChunkedContent whole(3, render, ExportJoiner(true, false), nullptr);
+    std::string file = whole.take();
+    EXPECT_EQ(file, "[0,22]");
+
+    for (size_t offset = 0; offset < file.size(); ++offset) {
+        ChunkedContent content(3, render, ExportJoiner(true, false), nullptr, whole.offsets());
+        char buf[8];
+        size_t n = content.read(buf, 2, offset);
+        EXPECT_EQ(std::string(buf, n), file.substr(offset, 2)) << offset;
+    }
+}
+
+TEST_F(ReadAheadTest, IndexedSequentialReadsPrefetch) {
+    ReadAheadExecutor executor(2, 2, 1 << 20);
+    ChunkedContent content(6, renderer(), ExportJoiner(false, false), &executor,
+                           {0, 10, 20, 30, 40, 50, 60});
+    char buf[10];
+    ASSERT_EQ(content.read(buf, 10, 30), 10u);  // A jump: nothing ahead yet
+    ASSERT_EQ(content.read(buf, 10, 40), 10u);
+    EXPECT_EQ(std::string(buf, 10), "eeeeeeeeee");
+    awaitPrefetched(executor, 1);
+    EXPECT_EQ(renderedSoFar(), (std::set<size_t>{3, 4, 5}));
+    EXPECT_EQ(executor.held(), 10u);
+}
+
+TEST_F(ReadAheadTest, ChangedChunkFailsIndexedRead) {
+    // Chunk 2 was one byte longer when the export was indexed
+    ChunkedContent content(3, renderer(), ExportJoiner(false, false), nullptr, {0, 10, 20, 31});
+    char buf[10];
+    EXPECT_EQ(content.read(buf, 10, 5), 10u);
+    EXPECT_THROW(content.read(buf, 10, 25), std::runtime_error);
+}
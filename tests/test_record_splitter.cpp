@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "RecordSplitter.hpp"
+#include <string>
+
+using namespace sqlfuse;
+
+TEST(RecordSplitterTest, CSVLines) {
+    RecordSplitter splitter(RecordSplitter::Format::CSV);
+    std::string data = "id,name\n1,Ali";
+    EXPECT_EQ(splitter.scan(data), 8u);
+
+    data += "ce\n2,Bob";
+    EXPECT_EQ(splitter.scan(data), 16u);
+}
+
+TEST(RecordSplitterTest, CSVQuotedLineBreaks) {
+    RecordSplitter splitter(RecordSplitter::Format::CSV);
+    std::string data = "1,\"two\nlines\"\n2,\"say \"\"hi";
+    EXPECT_EQ(splitter.scan(data), 14u);
+
+    // The doubled quote does not end the field; the line break inside does not end the record
+    data += "\"\"\nmore\"\n";
+    EXPECT_EQ(splitter.scan(data), data.size());
+}
+
+TEST(RecordSplitterTest, ConsumeShiftsOffsets) {
+    RecordSplitter splitter(RecordSplitter::Format::CSV);
+    std::string data = "a\nb\nc";
+    size_t end = splitter.scan(data);
+    ASSERT_EQ(end, 4u);
+
+    data.erase(0, end);
+    splitter.consume(end);
+    data += "d\ne";
+    EXPECT_EQ(splitter.scan(data), 3u);
+}
+
+TEST(RecordSplitterTest, JSONArrayObjects) {
+    RecordSplitter splitter(RecordSplitter::Format::JSON);
+    std::string data = R"(  [{"a": "}", "b": {"c": [1]}}, {"a": "x\")";
+    EXPECT_EQ(splitter.scan(data), data.find("},") + 1);
+    EXPECT_TRUE(splitter.streamable());
+
+    data += R"(y"}])";
+    EXPECT_EQ(splitter.scan(data), data.size() - 1);
+}
+
+TEST(RecordSplitterTest, JSONObjectDocumentIsNotStreamable) {
+    RecordSplitter splitter(RecordSplitter::Format::JSON);
+    std::string data = "\n";
+    EXPECT_EQ(splitter.scan(data), 0u);
+    EXPECT_TRUE(splitter.streamable());
+
+    data += R"({"rows": [{"a": 1}]})";
+    EXPECT_EQ(splitter.scan(data), 0u);
+    EXPECT_FALSE(splitter.streamable());
+}
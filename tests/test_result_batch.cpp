@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "BatchWriter.hpp"
+#include "FormatConverter.hpp"
+#include "ResultBatch.hpp"
+#include <functional>
+
+using namespace sqlfuse;
+using ::testing::HasSubstr;
+
+class ResultBatchTest : public ::testing::Test {
+protected:
+    // Feed the rows of `source` to a converter in batches of `capacity`
+    static FormatConverter::BatchSource batches(const ResultBatch& source, size_t capacity,
+                                                size_t& next) {
+        return [&source, capacity, &next](ResultBatch& batch) {
+            for (size_t n = 0; n < capacity && next < source.rowCount(); ++n, ++next) {
+                for (size_t col = 0; col < source.columnCount(); ++col) {
+                    const ResultColumn& from = source.column(col);
+                    ResultColumn& to = batch.column(col);
+                    if (from.isNull(next)) {
+                        to.appendNull();
+                    } else if (from.type() == ValueType::Integer) {
+                        to.appendInteger(from.integer(next));
+                    } else {
+                        to.appendText(from.bytes(next));
+                    }
+                }
+            }
+            return batch.rowCount() > 0;
+        };
+    }
+};
+
+TEST_F(ResultBatchTest, ColumnsKeepNativeTypes) {
+    ResultBatch batch({"id", "score", "name"});
+    batch.column(0).appendInteger(42);
+    batch.column(1).appendReal(0.5);
+    batch.column(2).appendText("Alice");
+
+    EXPECT_EQ(batch.rowCount(), 1u);
+    EXPECT_EQ(batch.column(0).type(), ValueType::Integer);
+    EXPECT_EQ(batch.column(0).integer(0), 42);
+    EXPECT_EQ(batch.column(1).type(), ValueType::Real);
+    EXPECT_DOUBLE_EQ(batch.column(1).real(0), 0.5);
+    EXPECT_EQ(batch.column(2).bytes(0), "Alice");
+}
+
+TEST_F(ResultBatchTest, NullBitmap) {
+    ResultBatch batch({"v"});
+    for (int i = 0; i < 130; ++i) {
+        if (i % 3 == 0) {
+            batch.column(0).appendNull();
+        } else {
+            batch.column(0).appendInteger(i);
+        }
+    }
+
+    for (size_t i = 0; i < 130; ++i) {
+        EXPECT_EQ(batch.column(0).isNull(i), i % 3 == 0) << "row " << i;
+    }
+    EXPECT_EQ(batch.column(0).integer(1), 1);
+    EXPECT_EQ(batch.column(0).integer(128), 128);
+}
+
+TEST_F(ResultBatchTest, IntegerAndRealKeepTheirTypes) {
+    ResultBatch batch({"v"});
+    batch.column(0).appendInteger(1);
+    batch.column(0).appendReal(2.5);
+
+    EXPECT_EQ(batch.column(0).type(), ValueType::Mixed);
+    EXPECT_EQ(batch.column(0).cellType(0), ValueType::Integer);
+    EXPECT_EQ(batch.column(0).bytes(0), "1");
+    EXPECT_EQ(batch.column(0).cellType(1), ValueType::Real);
+    EXPECT_EQ(batch.column(0).bytes(1), "2.5");
+}
+
+TEST_F(ResultBatchTest, MixedTypesPromoteToText) {
+    ResultBatch batch({"v"});
+    batch.column(0).appendInteger(7);
+    batch.column(0).appendNull();
+    batch.column(0).appendText("seven");
+
+    EXPECT_EQ(batch.column(0).type(), ValueType::Mixed);
+    EXPECT_EQ(batch.column(0).bytes(0), "7");
+    EXPECT_EQ(batch.column(0).cellType(0), ValueType::Integer);
+    EXPECT_TRUE(batch.column(0).isNull(1));
+    EXPECT_EQ(batch.column(0).bytes(2), "seven");
+    EXPECT_EQ(batch.column(0).cellType(2), ValueType::Text);
+}
+
+TEST_F(ResultBatchTest, ClearResetsType) {
+    ResultBatch batch({"v"});
+    batch.column(0).appendInteger(1);
+    batch.column(0).appendText("x");
+    batch.clear();
+
+    batch.column(0).appendInteger(2);
+    EXPECT_EQ(batch.column(0).type(), ValueType::Integer);
+    EXPECT_EQ(batch.column(0).integer(0), 2);
+}
+
+TEST_F(ResultBatchTest, ClearKeepsColumns) {
+    ResultBatch batch({"a", "b"}, 2);
+    batch.column(0).appendInteger(1);
+    batch.column(1).appendText("x");
+    batch.column(0).appendInteger(2);
+    batch.column(1).appendText("y");
+    EXPECT_TRUE(batch.full());
+
+    batch.clear();
+
+    EXPECT_EQ(batch.rowCount(), 0u);
+    EXPECT_EQ(batch.columnCount(), 2u);
+    EXPECT_EQ(batch.column(1).name(), "b");
+    EXPECT_FALSE(batch.full());
+}
+
+TEST_F(ResultBatchTest, CSVTypedValues) {
+    ResultBatch batch({"id", "ratio", "flag", "note"});
+    batch.column(0).appendInteger(-3);
+    batch.column(1).appendReal(2.0);
+    batch.column(2).appendBoolean(true);
+    batch.column(3).appendText("a,\"b\"");
+    batch.column(0).appendNull();
+    batch.column(1).appendNull();
+    batch.column(2).appendNull();
+    batch.column(3).appendNull();
+
+    std::string out;
+    CSVBatchWriter writer;
+    writer.writeHeader(batch, out);
+    writer.writeRows(batch, out);
+
+    EXPECT_EQ(out, "id,ratio,flag,note\n-3,2.0,t,\"a,\"\"b\"\"\"\n,,,\n");
+}
+
+TEST_F(ResultBatchTest, JSONTypedValues) {
+    ResultBatch batch({"id", "price", "bad", "ok", "blob"});
+    batch.column(0).appendInteger(1);
+    batch.column(1).appendNumber("12345678901234567890.125");
+    batch.column(2).appendNumber("NaN");
+    batch.column(3).appendBoolean(false);
+    batch.column(4).appendBinary(std::string("\x00\xff", 2));
+
+    JSONOptions options;
+    options.pretty = false;
+    auto json = FormatConverter::rowToJSON(batch, 0, options);
+
+    EXPECT_EQ(json, "{\"id\":1,\"price\":12345678901234567890.125,\"bad\":\"NaN\","
+                    "\"ok\":false,\"blob\":\"00FF\"}");
+}
+
+TEST_F(ResultBatchTest, JSONSkipsNullWhenExcluded) {
+    ResultBatch batch({"a", "b"});
+    batch.column(0).appendNull();
+    batch.column(1).appendText("x");
+
+    JSONOptions options;
+    options.pretty = false;
+    options.includeNull = false;
+
+    EXPECT_EQ(FormatConverter::rowToJSON(batch, 0, options), "{\"b\":\"x\"}");
+}
+
+TEST_F(ResultBatchTest, OutputIndependentOfBatchSize) {
+    ResultBatch source({"id", "name"}, 100);
+    for (int i = 0; i < 10; ++i) {
+        source.column(0).appendInteger(i);
+        if (i % 4 == 0) {
+            source.column(1).appendNull();
+        } else {
+            source.column(1).appendText("row " + std::to_string(i));
+        }
+    }
+
+    for (bool pretty : {false, true}) {
+        JSONOptions json;
+        json.pretty = pretty;
+
+        size_t next = 0;
+        ResultBatch whole({"id", "name"}, 100);
+        std::string expectedJSON = FormatConverter::toJSON(whole, batches(source, 100, next), json);
+        next = 0;
+        ResultBatch whole2({"id", "name"}, 100);
+        std::string expectedCSV = FormatConverter::toCSV(whole2, batches(source, 100, next));
+
+        for (size_t capacity : {1, 3, 7}) {
+            next = 0;
+            ResultBatch small({"id", "name"}, capacity);
+            EXPECT_EQ(FormatConverter::toJSON(small, batches(source, capacity, next), json),
+                      expectedJSON) << "capacity " << capacity;
+            next = 0;
+            ResultBatch small2({"id", "name"}, capacity);
+            EXPECT_EQ(FormatConverter::toCSV(small2, batches(source, capacity, next)),
+                      expectedCSV) << "capacity " << capacity;
+        }
+    }
+}
+
+// A column whose type changes from row to row (SQLite allows it) renders
+// every value as its own type, in one batch or one row per batch
+TEST_F(ResultBatchTest, MixedColumnOutputIndependentOfBatchSize) {
+    using Cell = std::function<void(ResultColumn&)>;
+    struct Case {
+        std::vector<Cell> cells;
+        std::string csv;
+        std::string json;
+    };
+    std::vector<Case> cases = {
+        // A large integer followed by a real: no rounding through double
+        {{[](ResultColumn& c) { c.appendInteger(9007199254740993); },
+          [](ResultColumn& c) { c.appendReal(2.5); }},
+         "v\n9007199254740993\n2.5\n",
+         "[{\"v\":9007199254740993},{\"v\":2.5}]"},
+        // An integer after a real stays an integer
+        {{[](ResultColumn& c) { c.appendReal(0.5); },
+          [](ResultColumn& c) { c.appendInteger(7); },
+          [](ResultColumn& c) { c.appendReal(7.0); }},
+         "v\n0.5\n7\n7.0\n",
+         "[{\"v\":0.5},{\"v\":7},{\"v\":7.0}]"},
+        // Text after numbers: the numbers stay JSON numbers
+        {{[](ResultColumn& c) { c.appendNumber("12.50"); },
+          [](ResultColumn& c) { c.appendInteger(-3); },
+          [](ResultColumn& c) { c.appendNull(); },
+          [](ResultColumn& c) { c.appendText("abc"); },
+          [](ResultColumn& c) { c.appendBoolean(true); }},
+         "v\n12.50\n-3\n\nabc\nt\n",
+         "[{\"v\":12.50},{\"v\":-3},{\"v\":null},{\"v\":\"abc\"},{\"v\":true}]"},
+    };
+
+    JSONOptions options;
+    options.pretty = false;
+    for (const Case& test : cases) {
+        for (size_t capacity : {size_t(1), ResultBatch::DEFAULT_CAPACITY}) {
+            auto fill = [&test](size_t& next) {
+                return [&test, &next](ResultBatch& batch) {
+                    for (; !batch.full() && next < test.cells.size(); ++next) {
+                        test.cells[next](batch.column(0));
+                    }
+                    return batch.rowCount() > 0;
+                };
+            };
+            size_t next = 0;
+            ResultBatch csv({"v"}, capacity);
+            EXPECT_EQ(FormatConverter::toCSV(csv, fill(next)), test.csv) << "capacity " << capacity;
+            next = 0;
+            ResultBatch json({"v"}, capacity);
+            EXPECT_EQ(FormatConverter::toJSON(json, fill(next), options), test.json)
+                << "capacity " << capacity;
+        }
+    }
+}
+
+TEST_F(ResultBatchTest, EmptyResult) {
+    ResultBatch batch({"id"});
+    auto none = [](ResultBatch&) { return false; };
+
+    JSONOptions options;
+    EXPECT_EQ(FormatConverter::toJSON(batch, none, options), "[]");
+    EXPECT_EQ(FormatConverter::toCSV(batch, none), "id\n");
+}
+
+TEST_F(ResultBatchTest, CSVSpecialScanMatchesScalar) {
+    // Every length up to a few vectors, with the special byte at every offset
+    for (size_t length = 0; length < 80; ++length) {
+        std::string clean(length, 'x');
+        EXPECT_EQ(findCSVSpecial(clean, ',', '"'), length);
+
+        for (size_t pos = 0; pos < length; ++pos) {
+            for (char special : {',', '"', '\n', '\r'}) {
+                std::string value = clean;
+                value[pos] = special;
+                EXPECT_EQ(findCSVSpecial(value, ',', '"'), pos);
+                EXPECT_EQ(findCSVSpecialScalar(value, ',', '"'), pos);
+            }
+        }
+    }
+}
+
+TEST_F(ResultBatchTest, CSVFieldQuoting) {
+    CSVBatchWriter writer;
+    std::string out;
+
+    writer.writeField(std::string(40, 'a') + "\"b\"" + std::string(40, 'c'), out);
+    EXPECT_EQ(out, "\"" + std::string(40, 'a') + "\"\"b\"\"" + std::string(40, 'c') + "\"");
+
+    out.clear();
+    writer.writeField(std::string(50, 'z') + ",", out);
+    EXPECT_EQ(out, "\"" + std::string(50, 'z') + ",\"");
+
+    out.clear();
+    writer.writeField(std::string(50, 'z'), out);
+    EXPECT_EQ(out, std::string(50, 'z'));
+}
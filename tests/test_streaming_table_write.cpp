@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "StreamingTableWrite.hpp"
+#include <cerrno>
+
+using namespace sqlfuse;
+
+namespace {
+
+// Records calls and rows; write number `failAt` (1-based) fails
+struct Log {
+    std::vector<std::string> calls;
+    std::vector<std::string> rows;
+};
+
+class FakeStream : public TableWriteStream {
+public:
+    FakeStream(Log& log, size_t failAt) : m_log(log), m_failAt(failAt) {}
+
+    int begin() override {
+        m_log.calls.push_back("begin");
+        return 0;
+    }
+
+    int write(RowReader& reader) override {
+        m_log.calls.push_back("write");
+        while (reader.next()) {
+            std::string row;
+            for (const auto& field : reader.row()) {
+                if (!row.empty()) row += '|';
+                row += field ? std::string(*field) : "<NULL>";
+            }
+            m_log.rows.push_back(row);
+        }
+        if (++m_writes == m_failAt) {
+            m_error = "disk full";
+            return -ENOSPC;
+        }
+        return 0;
+    }
+
+    int finish() override {
+        m_log.calls.push_back("finish");
+        return 0;
+    }
+
+    void abort() override { m_log.calls.push_back("abort"); }
+
+private:
+    Log& m_log;
+    size_t m_failAt;
+    size_t m_writes = 0;
+};
+
+}  // namespace
+
+class StreamingTableWriteTest : public ::testing::Test {
+protected:
+    StreamingTableWrite::OpenStream opener(size_t failAt = 0) {
+        return [this, failAt](const std::vector<std::string>& columns) {
+            this->columns = columns;
+            return std::make_unique<FakeStream>(log, failAt);
+        };
+    }
+
+    // Feed `data` in writes of `chunk` bytes
+    static int feed(StreamingTableWrite& write, const std::string& data, size_t chunk) {
+        for (size_t pos = 0; pos < data.size(); pos += chunk) {
+            std::string part = data.substr(pos, chunk);
+            if (int result = write.append(part.data(), part.size())) return result;
+        }
+        return 0;
+    }
+
+    Log log;
+    std::vector<std::string> columns;
+};
+
+TEST_F(StreamingTableWriteTest, CSVLoadsPiecesAsTheyArrive) {
+    StreamingTableWrite write(FileFormat::CSV, opener(), 16);
+    std::string data = "id,name\n1,\"Alice\nSmith\"\n2,Bob\n3,\n4,Dan";
+
+    ASSERT_EQ(feed(write, data, 5), 0);
+    EXPECT_TRUE(write.started());
+    EXPECT_EQ(write.received(), data.size());
+    EXPECT_THAT(columns, ::testing::ElementsAre("id", "name"));
+    EXPECT_LT(log.rows.size(), 4u);  // Some rows wait for the end
+
+    ASSERT_EQ(write.finish(), 0);
+    EXPECT_THAT(log.rows, ::testing::ElementsAre("1|Alice\nSmith", "2|Bob", "3|<NULL>", "4|Dan"));
+    EXPECT_EQ(log.calls.front(), "begin");
+    EXPECT_EQ(log.calls.back(), "finish");
+}
+
+TEST_F(StreamingTableWriteTest, JSONArrayInPieces) {
+    StreamingTableWrite write(FileFormat::JSON, opener(), 20);
+    std::string data = R"([
+  {"id": 1, "name": "Alice"},
+  {"name": "Bob"},
+  {"id": 3, "name": "a, \"b\" }"}
+]
+)";
+
+    ASSERT_EQ(feed(write, data, 7), 0);
+    ASSERT_EQ(write.finish(), 0);
+    EXPECT_THAT(columns, ::testing::ElementsAre("id", "name"));
+    EXPECT_THAT(log.rows, ::testing::ElementsAre("1|Alice", "<NULL>|Bob", "3|a, \"b\" }"));
+}
+
+TEST_F(StreamingTableWriteTest, TruncatedJSONFails) {
+    StreamingTableWrite write(FileFormat::JSON, opener(), 8);
+    ASSERT_EQ(feed(write, R"([{"id": 1}, {"id": 2})", 4), 0);
+
+    EXPECT_EQ(write.finish(), -EINVAL);
+    EXPECT_EQ(log.calls.back(), "abort");
+}
+
+TEST_F(StreamingTableWriteTest, SmallFileIsNotStarted) {
+    StreamingTableWrite write(FileFormat::CSV, opener(), 1024);
+    std::string data = "id\n1\n";
+    ASSERT_EQ(feed(write, data, 2), 0);
+
+    EXPECT_FALSE(write.started());
+    EXPECT_EQ(write.pending(), data);
+    EXPECT_TRUE(log.calls.empty());
+}
+
+TEST_F(StreamingTableWriteTest, JSONObjectIsDeclined) {
+    StreamingTableWrite write(FileFormat::JSON, opener(), 4);
+    std::string data = R"({"rows": [{"id": 1}]})";
+    ASSERT_EQ(feed(write, data, 3), 0);
+
+    EXPECT_TRUE(write.declined());
+    EXPECT_FALSE(write.started());
+    EXPECT_EQ(write.pending(), data);
+}
+
+TEST_F(StreamingTableWriteTest, BackendWithoutStreamingIsDeclined) {
+    StreamingTableWrite write(FileFormat::CSV,
+                              [](const std::vector<std::string>&) { return nullptr; }, 4);
+    std::string data = "id\n1\n2\n";
+    ASSERT_EQ(feed(write, data, 3), 0);
+
+    EXPECT_TRUE(write.declined());
+    EXPECT_EQ(write.pending(), data);
+}
+
+TEST_F(StreamingTableWriteTest, FailureIsSticky) {
+    StreamingTableWrite write(FileFormat::CSV, opener(1), 4);
+    std::string data = "id\n1\n2\n3\n";
+
+    EXPECT_EQ(feed(write, data, 4), -ENOSPC);
+    EXPECT_EQ(write.error(), "disk full");
+    EXPECT_EQ(log.calls.back(), "abort");
+    EXPECT_EQ(write.append("4\n", 2), -ENOSPC);
+    EXPECT_EQ(write.finish(), -ENOSPC);
+}
+
+TEST_F(StreamingTableWriteTest, AbortRollsBack) {
+    StreamingTableWrite write(FileFormat::CSV, opener(), 4);
+    ASSERT_EQ(feed(write, "id\n1\n2\n", 4), 0);
+    ASSERT_TRUE(write.started());
+
+    write.abort("non-sequential write");
+    EXPECT_EQ(log.calls.back(), "abort");
+    EXPECT_EQ(write.finish(), -EIO);
+    EXPECT_EQ(write.error(), "non-sequential write");
+}
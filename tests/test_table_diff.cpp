@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "TableDiff.hpp"
+#include "CSVReader.hpp"
+#include <stdexcept>
+
+using namespace sqlfuse;
+
+class TableDiffTest : public ::testing::Test {
+protected:
+    TableDiff diff(std::string before, std::string after) {
+        m_before = std::move(before);
+        m_after = std::move(after);
+        CSVReader beforeReader(m_before);
+        CSVReader afterReader(m_after);
+        return diffTables(beforeReader, afterReader, "id");
+    }
+
+    std::string m_before;
+    std::string m_after;
+};
+
+TEST_F(TableDiffTest, UnchangedFileIsEmpty) {
+    auto result = diff("id,name\n1,a\n2,b\n", "id,name\n1,a\n2,b\n");
+    EXPECT_TRUE(result.empty());
+    EXPECT_EQ(result.unchanged, 2u);
+}
+
+TEST_F(TableDiffTest, UpdatesOnlyChangedColumns) {
+    auto result = diff("id,name,age\n1,a,30\n2,b,40\n", "id,name,age\n1,a,31\n2,b,40\n");
+    ASSERT_EQ(result.updates.size(), 1u);
+    EXPECT_EQ(result.updates[0].first, "1");
+    ASSERT_EQ(result.updates[0].second.size(), 1u);
+    EXPECT_EQ(result.updates[0].second.at("age"), "31");
+    EXPECT_TRUE(result.inserts.empty());
+    EXPECT_TRUE(result.deletes.empty());
+    EXPECT_EQ(result.unchanged, 1u);
+}
+
+TEST_F(TableDiffTest, InsertsAndDeletesByKey) {
+    auto result = diff("id,name\n1,a\n2,b\n3,c\n", "id,name\n1,a\n3,c\n4,d\n");
+    ASSERT_EQ(result.inserts.size(), 1u);
+    EXPECT_EQ(result.inserts[0].at("id"), "4");
+    EXPECT_EQ(result.inserts[0].at("name"), "d");
+    ASSERT_EQ(result.deletes.size(), 1u);
+    EXPECT_EQ(result.deletes[0], "2");
+    EXPECT_TRUE(result.updates.empty());
+}
+
+TEST_F(TableDiffTest, ReorderedRowsAreUnchanged) {
+    auto result = diff("id,name\n1,a\n2,b\n", "id,name\n2,b\n1,a\n");
+    EXPECT_TRUE(result.empty());
+}
+
+TEST_F(TableDiffTest, NullAndEmptyStringDiffer) {
+    auto result = diff("id,name\n1,\n2,\"\"\n", "id,name\n1,\"\"\n2,\n");
+    ASSERT_EQ(result.updates.size(), 2u);
+    EXPECT_EQ(result.updates[0].second.at("name"), "");
+    EXPECT_EQ(result.updates[1].second.at("name"), std::nullopt);
+}
+
+TEST_F(TableDiffTest, DroppedColumnIsLeftAlone) {
+    auto result = diff("id,name,age\n1,a,30\n", "id,name\n1,b\n");
+    ASSERT_EQ(result.updates.size(), 1u);
+    EXPECT_EQ(result.updates[0].second.size(), 1u);
+    EXPECT_EQ(result.updates[0].second.count("age"), 0u);
+}
+
+TEST_F(TableDiffTest, RejectsMissingOrRepeatedKeys) {
+    EXPECT_THROW(diff("id,name\n1,a\n", "name\na\n"), std::runtime_error);
+    EXPECT_THROW(diff("id,name\n1,a\n", "id,name\n1,a\n1,b\n"), std::runtime_error);
+    EXPECT_THROW(diff("id,name\n1,a\n", "id,name\n,a\n"), std::runtime_error);
+}
+
+TEST_F(TableDiffTest, EmptyRenderingInsertsEverything) {
+    auto result = diff("", "id,name\n1,a\n2,b\n");
+    EXPECT_EQ(result.inserts.size(), 2u);
+    EXPECT_TRUE(result.deletes.empty());
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "VirtualFile.hpp"
+#include <map>
+
+using namespace sqlfuse;
+
+namespace {
+
+// Only what a save asks of the schema: the table's primary key
+class FakeSchema : public SchemaManager {
+public:
+    std::vector<std::string> getDatabases() override { return {"db"}; }
+    bool databaseExists(const std::string&) override { return true; }
+    std::vector<std::string> getTables(const std::string&) override { return {"t"}; }
+    std::optional<TableInfo> getTableInfo(const std::string&, const std::string& table) override {
+        TableInfo info;
+        info.name = table;
+        info.primaryKeyColumn = "id";
+        return info;
+    }
+    std::vector<ColumnInfo> getColumns(const std::string&, const std::string&) override {
+        return {};
+    }
+    std::vector<IndexInfo> getIndexes(const std::string&, const std::string&) override {
+        return {};
+    }
+    bool tableExists(const std::string&, const std::string&) override { return true; }
+    std::vector<std::string> getViews(const std::string&) override { return {}; }
+    std::optional<ViewInfo> getViewInfo(const std::string&, const std::string&) override {
+        return std::nullopt;
+    }
+    std::vector<std::string> getProcedures(const std::string&) override { return {}; }
+    std::vector<std::string> getFunctions(const std::string&) override { return {}; }
+    std::optional<RoutineInfo> getRoutineInfo(const std::string&, const std::string&,
+                                              const std::string&) override {
+        return std::nullopt;
+    }
+    std::vector<std::string> getTriggers(const std::string&) override { return {}; }
+    std::optional<TriggerInfo> getTriggerInfo(const std::string&, const std::string&) override {
+        return std::nullopt;
+    }
+    std::string getCreateStatement(const std::string&, const std::string&,
+                                   const std::string&) override {
+        return "";
+    }
+    ServerInfo getServerInfo() override { return {}; }
+    std::vector<UserInfo> getUsers() override { return {}; }
+    std::unordered_map<std::string, std::string> getGlobalVariables() override { return {}; }
+    std::unordered_map<std::string, std::string> getSessionVariables() override { return {}; }
+    std::vector<std::string> getRowIds(const std::string&, const std::string&, size_t,
+                                       size_t) override {
+        return {};
+    }
+    uint64_t getRowCount(const std::string&, const std::string&) override { return 0; }
+    void invalidateTable(const std::string&, const std::string&) override {}
+    void invalidateDatabase(const std::string&) override {}
+    void invalidateAll() override {}
+    ConnectionPool& connectionPool() override { throw std::logic_error("no pool"); }
+};
+
+// The database is a map of row id to the row file's text; saves are counted
+struct FakeDatabase {
+    std::map<std::string, std::string> rows;
+    std::string table;  // Table file contents
+    int rowSaves = 0;
+    int tableSaves = 0;
+};
+
+class FakeFile : public VirtualFile {
+public:
+    FakeFile(const ParsedPath& path, SchemaManager& schema, CacheManager& cache,
+             const DataConfig& config, FakeDatabase& db)
+        : VirtualFile(path, schema, cache, config), m_db(db) {}
+
+protected:
+    std::string generateTableCSV() override { return m_db.table; }
+    std::string generateTableJSON() override { return m_db.table; }
+    std::string generateRowJSON() override { return m_db.rows[m_path.row_id]; }
+    std::string generateViewContent() override { return ""; }
+    std::string generateDatabaseInfo() override { return ""; }
+    std::string generateUserInfo() override { return ""; }
+
+    int handleRowWrite() override {
+        ++m_db.rowSaves;
+        m_db.rows[m_path.row_id] = m_writeBuffer.str();
+        return 0;
+    }
+    int handleTableWrite() override {
+        ++m_db.tableSaves;
+        m_db.table += m_writeBuffer.str();
+        return 0;
+    }
+
+private:
+    FakeDatabase& m_db;
+};
+
+}  // namespace
+
+class VirtualFileSaveTest : public ::testing::Test {
+protected:
+    VirtualFileSaveTest() : cache(CacheConfig{}) {
+        config.stream_table_writes = false;
+        db.rows["1"] = "{\"id\":1,\"name\":\"old\"}";
+    }
+
+    std::unique_ptr<FakeFile> open(NodeType type, FileFormat format, const std::string& row = "") {
+        ParsedPath path;
+        path.type = type;
+        path.database = "db";
+        path.object_name = "t";
+        path.format = format;
+        path.row_id = row;
+        auto file = std::make_unique<FakeFile>(path, schema, cache, config, db);
+        file->setWriteCounters(&counters);
+        return file;
+    }
+
+    // An editor's save: truncate, write the whole file, flush
+    static int save(VirtualFile& file, const std::string& data) {
+        file.truncate(0);
+        file.write(data.data(), data.size(), 0);
+        return file.flush();
+    }
+
+    FakeSchema schema;
+    CacheManager cache;
+    DataConfig config;
+    WriteCounters counters;
+    FakeDatabase db;
+};
+
+TEST_F(VirtualFileSaveTest, RepeatedSaveOfSameDataIsCoalesced) {
+    auto file = open(NodeType::TableRowFile, FileFormat::JSON, "1");
+    EXPECT_EQ(save(*file, "{\"name\":\"new\"}"), 0);
+    EXPECT_EQ(save(*file, "{\"name\":\"new\"}"), 0);
+    EXPECT_EQ(file->flush(true), 0);
+    EXPECT_EQ(db.rowSaves, 1);
+    EXPECT_EQ(counters.coalesced, 1u);
+
+    EXPECT_EQ(save(*file, "{\"name\":\"newer\"}"), 0);
+    EXPECT_EQ(db.rowSaves, 2);
+}
+
+// The file showed the row as it was when read; writing that back after the
+// row changed in the database must save it, whatever the cache still holds
+TEST_F(VirtualFileSaveTest, RowChangedInDatabaseThenOldContentWrittenBack) {
+    auto file = open(NodeType::TableRowFile, FileFormat::JSON, "1");
+    std::string old = file->getContent();
+    EXPECT_EQ(old, "{\"id\":1,\"name\":\"old\"}");
+
+    db.rows["1"] = "{\"id\":1,\"name\":\"changed elsewhere\"}";
+
+    EXPECT_EQ(save(*file, old), 0);
+    EXPECT_EQ(db.rowSaves, 1);
+    EXPECT_EQ(db.rows["1"], old);
+
+    // Likewise for another handle, which only has the cached rendering
+    db.rows["1"] = "{\"id\":1,\"name\":\"changed again\"}";
+    auto other = open(NodeType::TableRowFile, FileFormat::JSON, "1");
+    EXPECT_EQ(save(*other, old), 0);
+    EXPECT_EQ(db.rowSaves, 2);
+    EXPECT_EQ(db.rows["1"], old);
+}
+
+// Writing the same rows to a table file again inserts them again
+TEST_F(VirtualFileSaveTest, AppendingTableWritesAreNotCoalesced) {
+    auto file = open(NodeType::TableFile, FileFormat::CSV);
+    file->write("2,b\n", 4, 0);
+    EXPECT_EQ(file->flush(), 0);
+    file->write("2,b\n", 4, 0);
+    EXPECT_EQ(file->flush(), 0);
+    EXPECT_EQ(db.tableSaves, 2);
+    EXPECT_EQ(db.table, "2,b\n2,b\n");
+}
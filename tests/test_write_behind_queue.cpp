@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "WriteBehindQueue.hpp"
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace sqlfuse;
+using namespace std::chrono_literals;
+
+class WriteBehindQueueTest : public ::testing::Test {
+protected:
+    // Records every call; a statement equal to `failSql` fails without an
+    // errno (-EIO), one in `codes` fails with its errno
+    WriteBehindQueue::OpenSession opener() {
+        return [this]() -> std::optional<InsertSession> {
+            return InsertSession{
+                [this](const std::string& sql) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    log.push_back(sql);
+                    auto code = codes.find(sql);
+                    lastCode = code != codes.end() ? code->second : 0;
+                    return sql != failSql && code == codes.end();
+                },
+                [this] { record("BEGIN"); return true; },
+                [this] {
+                    record("COMMIT");
+                    lastCode = commitCode;
+                    return !failCommit;
+                },
+                [this] { record("ROLLBACK"); lastCode = 0; },
+                [] { return std::string("constraint violation"); },
+                [this] { return lastCode; }};
+        };
+    }
+
+    WriteBehindQueue::Committed committed() {
+        return [this](const std::string&, const std::string&) { ++invalidations; };
+    }
+
+    void record(const std::string& entry) {
+        std::lock_guard<std::mutex> lock(mutex);
+        log.push_back(entry);
+    }
+
+    std::mutex mutex;
+    std::vector<std::string> log;
+    std::string failSql;
+    std::map<std::string, int> codes;
+    bool failCommit = false;
+    int commitCode = 0;
+    int lastCode = 0;
+    std::atomic<int> invalidations{0};
+};
+
+TEST_F(WriteBehindQueueTest, GroupsStatementsIntoOneTransaction) {
+    std::vector<std::shared_future<WriteBehindQueue::Outcome>> done;
+    {
+        WriteBehindQueue queue(committed(), WriteDurability::Flush, 1h, 100, 1);
+        done.push_back(queue.enqueue("db", "t", "A", opener()));
+        done.push_back(queue.enqueue("db", "t", "B", opener()));
+        done.push_back(queue.enqueue("db", "t", "C", opener()));
+    }  // Destruction commits what is queued
+    for (auto& outcome : done) {
+        EXPECT_EQ(outcome.get().result, 0);
+    }
+    EXPECT_EQ(log, (std::vector<std::string>{"BEGIN", "A", "B", "C", "COMMIT"}));
+    EXPECT_EQ(invalidations, 1);
+}
+
+TEST_F(WriteBehindQueueTest, FullQueueCommitsWithoutWaiting) {
+    WriteBehindQueue queue(committed(), WriteDurability::Flush, 1h, 2, 1);
+    auto first = queue.enqueue("db", "t", "A", opener());
+    auto second = queue.enqueue("db", "t", "B", opener());
+    ASSERT_EQ(second.wait_for(5s), std::future_status::ready);
+    EXPECT_EQ(first.get().result, 0);
+    EXPECT_EQ(queue.groups(), 1u);
+    EXPECT_EQ(queue.statements(), 2u);
+}
+
+TEST_F(WriteBehindQueueTest, WindowCommitsInBackground) {
+    WriteBehindQueue queue(committed(), WriteDurability::Release, 10ms, 100, 2);
+    auto outcome = queue.enqueue("db", "t", "A", opener());
+    ASSERT_EQ(outcome.wait_for(5s), std::future_status::ready);
+    EXPECT_EQ(outcome.get().result, 0);
+}
+
+TEST_F(WriteBehindQueueTest, FailedStatementIsDroppedFromGroup) {
+    failSql = "B";
+    std::vector<std::shared_future<WriteBehindQueue::Outcome>> done;
+    {
+        WriteBehindQueue queue(committed(), WriteDurability::Flush, 1h, 100, 1);
+        done.push_back(queue.enqueue("db", "t", "A", opener()));
+        done.push_back(queue.enqueue("db", "t", "B", opener()));
+        done.push_back(queue.enqueue("db", "t", "C", opener()));
+    }
+    EXPECT_EQ(done[0].get().result, 0);
+    EXPECT_EQ(done[1].get().result, -EIO);
+    EXPECT_EQ(done[1].get().error, "constraint violation");
+    EXPECT_EQ(done[2].get().result, 0);
+    EXPECT_EQ(log, (std::vector<std::string>{"BEGIN", "A", "B", "ROLLBACK", "BEGIN", "A", "C",
+                                             "COMMIT"}));
+}
+
+TEST_F(WriteBehindQueueTest, FailedStatementsGetTheirOwnErrno) {
+    codes = {{"B", -EEXIST}, {"C", -EACCES}};
+    std::vector<std::shared_future<WriteBehindQueue::Outcome>> done;
+    {
+        WriteBehindQueue queue(committed(), WriteDurability::Flush, 1h, 100, 1);
+        for (const char* sql : {"A", "B", "C", "D"}) {
+            done.push_back(queue.enqueue("db", "t", sql, opener()));
+        }
+    }
+    EXPECT_EQ(done[0].get().result, 0);
+    EXPECT_EQ(done[1].get().result, -EEXIST);
+    EXPECT_EQ(done[2].get().result, -EACCES);
+    EXPECT_EQ(done[3].get().result, 0);
+}
+
+TEST_F(WriteBehindQueueTest, FailedCommitReportsItsErrno) {
+    failCommit = true;
+    commitCode = -ETIMEDOUT;
+    std::vector<std::shared_future<WriteBehindQueue::Outcome>> done;
+    {
+        WriteBehindQueue queue(committed(), WriteDurability::Flush, 1h, 100, 1);
+        done.push_back(queue.enqueue("db", "t", "A", opener()));
+        done.push_back(queue.enqueue("db", "t", "B", opener()));
+    }
+    EXPECT_EQ(done[0].get().result, -ETIMEDOUT);
+    EXPECT_EQ(done[1].get().result, -ETIMEDOUT);
+}
+
+TEST_F(WriteBehindQueueTest, FailedCommitFailsGroup) {
+    failCommit = true;
+    std::shared_future<WriteBehindQueue::Outcome> outcome;
+    {
+        WriteBehindQueue queue(committed(), WriteDurability::Flush, 1h, 100, 1);
+        outcome = queue.enqueue("db", "t", "A", opener());
+    }
+    EXPECT_EQ(outcome.get().result, -EIO);
+}
+
+TEST_F(WriteBehindQueueTest, MissingConnectionFailsGroup) {
+    std::shared_future<WriteBehindQueue::Outcome> outcome;
+    {
+        WriteBehindQueue queue(committed(), WriteDurability::Flush, 1h, 100, 1);
+        outcome = queue.enqueue("db", "t", "A", [] { return std::optional<InsertSession>(); });
+    }
+    EXPECT_EQ(outcome.get().result, -EIO);
+}
+
+TEST_F(WriteBehindQueueTest, TablesCommitSeparately) {
+    {
+        WriteBehindQueue queue(committed(), WriteDurability::Flush, 1h, 100, 1);
+        queue.enqueue("db", "a", "A", opener());
+        queue.enqueue("db", "b", "B", opener());
+    }
+    EXPECT_EQ(invalidations, 2);
+}
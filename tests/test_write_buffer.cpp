@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "WriteBuffer.hpp"
+
+using namespace sqlfuse;
+
+TEST(WriteBufferTest, SequentialWrites) {
+    WriteBuffer buffer;
+    buffer.write(0, "id,name\n", 8);
+    buffer.write(8, "1,Alice\n", 8);
+
+    EXPECT_EQ(buffer.size(), 16u);
+    EXPECT_EQ(buffer.str(), "id,name\n1,Alice\n");
+}
+
+TEST(WriteBufferTest, WritesAcrossChunks) {
+    constexpr size_t chunk = WriteBuffer::CHUNK_BYTES;
+    std::string data(chunk + 100, 'x');
+    data[chunk - 1] = 'a';
+    data[chunk] = 'b';
+
+    WriteBuffer buffer;
+    buffer.write(0, data.data(), data.size());
+    EXPECT_EQ(buffer.str(), data);
+    EXPECT_EQ(buffer.at(chunk - 1), 'a');
+    EXPECT_EQ(buffer.at(chunk), 'b');
+    EXPECT_EQ(buffer.substr(chunk - 1, 2), "ab");
+}
+
+TEST(WriteBufferTest, GapsReadAsZero) {
+    WriteBuffer buffer;
+    buffer.write(WriteBuffer::CHUNK_BYTES * 2 + 3, "z", 1);
+
+    EXPECT_EQ(buffer.size(), WriteBuffer::CHUNK_BYTES * 2 + 4);
+    EXPECT_EQ(buffer.at(5), '\0');
+    EXPECT_EQ(buffer.substr(WriteBuffer::CHUNK_BYTES * 2 + 2, 10), std::string("\0z", 2));
+}
+
+TEST(WriteBufferTest, OverwriteAndResize) {
+    WriteBuffer buffer;
+    buffer.write(0, "hello world", 11);
+    buffer.write(6, "there", 5);
+    EXPECT_EQ(buffer.str(), "hello there");
+
+    buffer.resize(5);
+    EXPECT_EQ(buffer.str(), "hello");
+
+    // Truncated bytes do not come back when the file grows again
+    buffer.resize(8);
+    EXPECT_EQ(buffer.str(), std::string("hello\0\0\0", 8));
+
+    buffer.clear();
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(WriteBufferTest, EqualsComparesEveryByte) {
+    WriteBuffer buffer;
+    std::string data(WriteBuffer::CHUNK_BYTES + 10, 'a');
+    buffer.write(0, data.data(), data.size());
+    EXPECT_TRUE(buffer.equals(data));
+
+    std::string changed = data;
+    changed[WriteBuffer::CHUNK_BYTES + 5] = 'b';
+    EXPECT_FALSE(buffer.equals(changed));
+    EXPECT_FALSE(buffer.equals(data.substr(1)));
+
+    // A chunk never written holds zero bytes
+    WriteBuffer sparse;
+    sparse.write(WriteBuffer::CHUNK_BYTES, "x", 1);
+    std::string zeros(WriteBuffer::CHUNK_BYTES, '\0');
+    EXPECT_TRUE(sparse.equals(zeros + "x"));
+    zeros[3] = 'y';
+    EXPECT_FALSE(sparse.equals(zeros + "x"));
+}